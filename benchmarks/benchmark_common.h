@@ -0,0 +1,203 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2012-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#ifndef PCL_BENCHMARKS_BENCHMARK_COMMON_H_
+#define PCL_BENCHMARKS_BENCHMARK_COMMON_H_
+
+#include <benchmark/benchmark.h>
+#include <pcl/point_cloud.h>
+#include <pcl/point_types.h>
+#include <pcl/common/common.h>
+#include <pcl/filters/filter.h>
+#include <pcl/io/pcd_io.h>
+#include <boost/filesystem.hpp>
+#include <cmath>
+#include <cstdio>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace pcl
+{
+  namespace benchmarks
+  {
+    /** \brief A cloud the benchmarks run on: one of the PCD files given on the command
+      * line, or a scaled up copy of it.
+      */
+    struct BenchmarkCloud
+    {
+      /** \brief Name used in the benchmark names, e.g. "bunny" or "bunny_1000000". */
+      std::string name;
+
+      /** \brief The points, without NaNs. */
+      pcl::PointCloud<pcl::PointXYZ>::Ptr cloud;
+
+      /** \brief A length scale for the parameters of the benchmarks: 1% of the bounding box
+        * diagonal of the original cloud. Scaled copies keep the one of their original, so that
+        * they have the same point density.
+        */
+      float resolution;
+    };
+
+    /** \brief Get the clouds loaded by loadClouds (). */
+    inline std::vector<BenchmarkCloud>&
+    getClouds ()
+    {
+      static std::vector<BenchmarkCloud> clouds;
+      return (clouds);
+    }
+
+    /** \brief Build a synthetic cloud of at least nr_points points by tiling copies of a cloud
+      * on a grid in the x-y plane, with a gap between neighboring copies.
+      */
+    inline pcl::PointCloud<pcl::PointXYZ>::Ptr
+    scaleCloud (const pcl::PointCloud<pcl::PointXYZ> &cloud, size_t nr_points)
+    {
+      pcl::PointXYZ min_pt, max_pt;
+      pcl::getMinMax3D (cloud, min_pt, max_pt);
+      const float step_x = 1.5f * (max_pt.x - min_pt.x);
+      const float step_y = 1.5f * (max_pt.y - min_pt.y);
+
+      const size_t nr_copies = (nr_points + cloud.size () - 1) / cloud.size ();
+      const size_t side = static_cast<size_t> (std::ceil (std::sqrt (static_cast<double> (nr_copies))));
+
+      pcl::PointCloud<pcl::PointXYZ>::Ptr scaled (new pcl::PointCloud<pcl::PointXYZ>);
+      scaled->reserve (nr_copies * cloud.size ());
+      for (size_t c = 0; c < nr_copies; ++c)
+      {
+        const float dx = static_cast<float> (c % side) * step_x;
+        const float dy = static_cast<float> (c / side) * step_y;
+        for (size_t i = 0; i < cloud.size (); ++i)
+          scaled->push_back (pcl::PointXYZ (cloud[i].x + dx, cloud[i].y + dy, cloud[i].z));
+      }
+      return (scaled);
+    }
+
+    /** \brief Load the PCD files given on the command line, and add copies of each of them
+      * scaled up to the given sizes.
+      * \return false if no cloud could be loaded
+      */
+    inline bool
+    loadClouds (int argc, char** argv, const std::vector<size_t> &scaled_sizes)
+    {
+      std::vector<BenchmarkCloud> &clouds = getClouds ();
+      for (int a = 1; a < argc; ++a)
+      {
+        pcl::PointCloud<pcl::PointXYZ> input;
+        if (pcl::io::loadPCDFile (argv[a], input) < 0)
+        {
+          fprintf (stderr, "Could not load %s, skipping it.\n", argv[a]);
+          continue;
+        }
+        BenchmarkCloud original;
+        original.name = boost::filesystem::path (argv[a]).stem ().string ();
+        original.cloud.reset (new pcl::PointCloud<pcl::PointXYZ>);
+        std::vector<int> indices;
+        pcl::removeNaNFromPointCloud (input, *original.cloud, indices);
+        if (original.cloud->empty ())
+          continue;
+        pcl::PointXYZ min_pt, max_pt;
+        pcl::getMinMax3D (*original.cloud, min_pt, max_pt);
+        original.resolution = 0.01f * (max_pt.getVector3fMap () - min_pt.getVector3fMap ()).norm ();
+        clouds.push_back (original);
+
+        for (size_t s = 0; s < scaled_sizes.size (); ++s)
+        {
+          BenchmarkCloud scaled = original;
+          scaled.cloud = scaleCloud (*original.cloud, scaled_sizes[s]);
+          std::ostringstream name;
+          name << original.name << "_" << scaled_sizes[s];
+          scaled.name = name.str ();
+          clouds.push_back (scaled);
+        }
+      }
+      return (!clouds.empty ());
+    }
+
+    /** \brief Report the throughput of a benchmark in points per second (items_per_second). */
+    inline void
+    setThroughput (benchmark::State &state, size_t nr_points)
+    {
+      state.SetItemsProcessed (static_cast<int64_t> (state.iterations ()) * static_cast<int64_t> (nr_points));
+      state.counters["points"] = static_cast<double> (nr_points);
+    }
+
+    /** \brief Register a benchmark function once for each loaded cloud with at most
+      * max_points points. The function gets the index of its cloud as state.range (0).
+      */
+    inline void
+    registerForClouds (const std::string &name, void (*function) (benchmark::State&),
+                       size_t max_points = 0)
+    {
+      const std::vector<BenchmarkCloud> &clouds = getClouds ();
+      for (size_t c = 0; c < clouds.size (); ++c)
+      {
+        if (max_points != 0 && clouds[c].cloud->size () > max_points)
+          continue;
+        benchmark::RegisterBenchmark ((name + "/" + clouds[c].name).c_str (), function)
+          ->Arg (static_cast<int> (c))
+          ->Unit (benchmark::kMillisecond)
+          ->UseRealTime ();
+      }
+    }
+  }
+}
+
+/** \brief Define the main function of a benchmark executable. The benchmarks are registered by
+  * a registerBenchmarks () function defined in the same file, once the clouds are loaded.
+  *
+  * Usage: benchmark_xxx cloud_1.pcd [cloud_2.pcd ...] [--benchmark_out=results.json ...]
+  */
+#define PCL_BENCHMARK_MAIN()                                                              \
+  int                                                                                     \
+  main (int argc, char** argv)                                                            \
+  {                                                                                       \
+    benchmark::Initialize (&argc, argv);                                                  \
+    std::vector<size_t> scaled_sizes;                                                     \
+    scaled_sizes.push_back (100000);                                                      \
+    scaled_sizes.push_back (1000000);                                                     \
+    if (!pcl::benchmarks::loadClouds (argc, argv, scaled_sizes))                          \
+    {                                                                                     \
+      fprintf (stderr, "Usage: %s cloud.pcd [cloud.pcd ...] [benchmark options]\n", argv[0]); \
+      return (-1);                                                                        \
+    }                                                                                     \
+    registerBenchmarks ();                                                                \
+    benchmark::RunSpecifiedBenchmarks ();                                                 \
+    return (0);                                                                           \
+  }
+
+#endif  // PCL_BENCHMARKS_BENCHMARK_COMMON_H_
@@ -0,0 +1,172 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2012-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#include "benchmark_common.h"
+#include <pcl/features/normal_3d.h>
+#include <pcl/features/normal_3d_omp.h>
+#include <pcl/features/fpfh.h>
+#include <pcl/features/fpfh_omp.h>
+#include <pcl/features/shot_omp.h>
+#include <pcl/search/kdtree.h>
+
+using namespace pcl::benchmarks;
+
+/** \brief FPFH is only run on clouds up to this size, it takes minutes on the larger ones. */
+static const size_t FPFH_MAX_POINTS = 100000;
+
+/** \brief SHOT is only run on clouds up to this size, for the same reason. */
+static const size_t SHOT_MAX_POINTS = 100000;
+
+template <typename NormalEstimator> static void
+BM_NormalEstimation (benchmark::State &state)
+{
+  const BenchmarkCloud &input = getClouds ()[state.range (0)];
+  NormalEstimator ne;
+  ne.setInputCloud (input.cloud);
+  ne.setSearchMethod (pcl::search::KdTree<pcl::PointXYZ>::Ptr (new pcl::search::KdTree<pcl::PointXYZ>));
+  ne.setKSearch (10);
+  pcl::PointCloud<pcl::Normal> normals;
+  while (state.KeepRunning ())
+  {
+    ne.compute (normals);
+    benchmark::DoNotOptimize (normals.points.data ());
+  }
+  setThroughput (state, input.cloud->size ());
+}
+
+template <typename FPFHEstimator> static void
+BM_FPFHEstimation (benchmark::State &state)
+{
+  const BenchmarkCloud &input = getClouds ()[state.range (0)];
+  pcl::search::KdTree<pcl::PointXYZ>::Ptr tree (new pcl::search::KdTree<pcl::PointXYZ>);
+
+  pcl::PointCloud<pcl::Normal>::Ptr normals (new pcl::PointCloud<pcl::Normal>);
+  pcl::NormalEstimation<pcl::PointXYZ, pcl::Normal> ne;
+  ne.setInputCloud (input.cloud);
+  ne.setSearchMethod (tree);
+  ne.setKSearch (10);
+  ne.compute (*normals);
+
+  FPFHEstimator fpfh;
+  fpfh.setInputCloud (input.cloud);
+  fpfh.setInputNormals (normals);
+  fpfh.setSearchMethod (tree);
+  fpfh.setRadiusSearch (3.0 * input.resolution);
+  pcl::PointCloud<pcl::FPFHSignature33> features;
+  while (state.KeepRunning ())
+  {
+    fpfh.compute (features);
+    benchmark::DoNotOptimize (features.points.data ());
+  }
+  setThroughput (state, input.cloud->size ());
+}
+
+static void
+BM_FPFHEstimationOMPNeighborCache (benchmark::State &state)
+{
+  const BenchmarkCloud &input = getClouds ()[state.range (0)];
+  pcl::search::KdTree<pcl::PointXYZ>::Ptr tree (new pcl::search::KdTree<pcl::PointXYZ>);
+
+  pcl::PointCloud<pcl::Normal>::Ptr normals (new pcl::PointCloud<pcl::Normal>);
+  pcl::NormalEstimation<pcl::PointXYZ, pcl::Normal> ne;
+  ne.setInputCloud (input.cloud);
+  ne.setSearchMethod (tree);
+  ne.setKSearch (10);
+  ne.compute (*normals);
+
+  pcl::FPFHEstimationOMP<pcl::PointXYZ, pcl::Normal, pcl::FPFHSignature33> fpfh;
+  fpfh.setInputCloud (input.cloud);
+  fpfh.setInputNormals (normals);
+  fpfh.setSearchMethod (tree);
+  fpfh.setRadiusSearch (3.0 * input.resolution);
+  fpfh.setNeighborCacheSize (size_t (1) << 30);
+  pcl::PointCloud<pcl::FPFHSignature33> features;
+  while (state.KeepRunning ())
+  {
+    fpfh.compute (features);
+    benchmark::DoNotOptimize (features.points.data ());
+  }
+  setThroughput (state, input.cloud->size ());
+}
+
+template <bool UseFusedLRF> static void
+BM_SHOTEstimationOMP (benchmark::State &state)
+{
+  const BenchmarkCloud &input = getClouds ()[state.range (0)];
+  pcl::search::KdTree<pcl::PointXYZ>::Ptr tree (new pcl::search::KdTree<pcl::PointXYZ>);
+
+  pcl::PointCloud<pcl::Normal>::Ptr normals (new pcl::PointCloud<pcl::Normal>);
+  pcl::NormalEstimation<pcl::PointXYZ, pcl::Normal> ne;
+  ne.setInputCloud (input.cloud);
+  ne.setSearchMethod (tree);
+  ne.setKSearch (10);
+  ne.compute (*normals);
+
+  pcl::SHOTEstimationOMP<pcl::PointXYZ, pcl::Normal, pcl::SHOT352> shot;
+  shot.setInputCloud (input.cloud);
+  shot.setInputNormals (normals);
+  shot.setSearchMethod (tree);
+  shot.setRadiusSearch (3.0 * input.resolution);
+  shot.setUseFusedLRF (UseFusedLRF);
+  pcl::PointCloud<pcl::SHOT352> features;
+  while (state.KeepRunning ())
+  {
+    shot.compute (features);
+    benchmark::DoNotOptimize (features.points.data ());
+  }
+  setThroughput (state, input.cloud->size ());
+}
+
+static void
+registerBenchmarks ()
+{
+  registerForClouds ("NormalEstimation",
+                     BM_NormalEstimation<pcl::NormalEstimation<pcl::PointXYZ, pcl::Normal> >);
+  registerForClouds ("NormalEstimationOMP",
+                     BM_NormalEstimation<pcl::NormalEstimationOMP<pcl::PointXYZ, pcl::Normal> >);
+  registerForClouds ("FPFHEstimation",
+                     BM_FPFHEstimation<pcl::FPFHEstimation<pcl::PointXYZ, pcl::Normal, pcl::FPFHSignature33> >,
+                     FPFH_MAX_POINTS);
+  registerForClouds ("FPFHEstimationOMP",
+                     BM_FPFHEstimation<pcl::FPFHEstimationOMP<pcl::PointXYZ, pcl::Normal, pcl::FPFHSignature33> >,
+                     FPFH_MAX_POINTS);
+  registerForClouds ("FPFHEstimationOMPNeighborCache", BM_FPFHEstimationOMPNeighborCache, FPFH_MAX_POINTS);
+  registerForClouds ("SHOTEstimationOMP", BM_SHOTEstimationOMP<false>, SHOT_MAX_POINTS);
+  registerForClouds ("SHOTEstimationOMPFusedLRF", BM_SHOTEstimationOMP<true>, SHOT_MAX_POINTS);
+}
+
+PCL_BENCHMARK_MAIN ()
@@ -0,0 +1,116 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2012-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#include "benchmark_common.h"
+#include <pcl/filters/voxel_grid.h>
+#include <pcl/filters/radius_outlier_removal.h>
+#include <pcl/filters/statistical_outlier_removal.h>
+
+using namespace pcl::benchmarks;
+
+static void
+BM_VoxelGrid (benchmark::State &state)
+{
+  const BenchmarkCloud &input = getClouds ()[state.range (0)];
+  pcl::VoxelGrid<pcl::PointXYZ> grid;
+  grid.setInputCloud (input.cloud);
+  grid.setLeafSize (input.resolution, input.resolution, input.resolution);
+  pcl::PointCloud<pcl::PointXYZ> output;
+  while (state.KeepRunning ())
+  {
+    grid.filter (output);
+    benchmark::DoNotOptimize (output.points.data ());
+  }
+  setThroughput (state, input.cloud->size ());
+  state.counters["output_points"] = static_cast<double> (output.size ());
+}
+
+/** \brief Statistical outlier removal with the given number of threads (0: all cores). */
+template <unsigned int Threads> static void
+BM_StatisticalOutlierRemoval (benchmark::State &state)
+{
+  const BenchmarkCloud &input = getClouds ()[state.range (0)];
+  pcl::StatisticalOutlierRemoval<pcl::PointXYZ> sor;
+  sor.setInputCloud (input.cloud);
+  sor.setMeanK (16);
+  sor.setStddevMulThresh (1.0);
+  sor.setNumberOfThreads (Threads);
+  pcl::PointCloud<pcl::PointXYZ> output;
+  while (state.KeepRunning ())
+  {
+    sor.filter (output);
+    benchmark::DoNotOptimize (output.points.data ());
+  }
+  setThroughput (state, input.cloud->size ());
+  state.counters["output_points"] = static_cast<double> (output.size ());
+}
+
+/** \brief Radius outlier removal with the given number of threads (0: all cores), counting the neighbors with
+  * searches or a voxel grid.
+  */
+template <unsigned int Threads, bool VoxelCounting> static void
+BM_RadiusOutlierRemoval (benchmark::State &state)
+{
+  const BenchmarkCloud &input = getClouds ()[state.range (0)];
+  pcl::RadiusOutlierRemoval<pcl::PointXYZ> ror;
+  ror.setInputCloud (input.cloud);
+  ror.setRadiusSearch (3.0 * input.resolution);
+  ror.setMinNeighborsInRadius (8);
+  ror.setNumberOfThreads (Threads);
+  ror.setUseVoxelCounting (VoxelCounting);
+  pcl::PointCloud<pcl::PointXYZ> output;
+  while (state.KeepRunning ())
+  {
+    ror.filter (output);
+    benchmark::DoNotOptimize (output.points.data ());
+  }
+  setThroughput (state, input.cloud->size ());
+  state.counters["output_points"] = static_cast<double> (output.size ());
+}
+
+static void
+registerBenchmarks ()
+{
+  registerForClouds ("VoxelGrid", BM_VoxelGrid);
+  registerForClouds ("StatisticalOutlierRemoval", BM_StatisticalOutlierRemoval<1>);
+  registerForClouds ("StatisticalOutlierRemovalParallel", BM_StatisticalOutlierRemoval<0>);
+  registerForClouds ("RadiusOutlierRemoval", BM_RadiusOutlierRemoval<1, false>);
+  registerForClouds ("RadiusOutlierRemovalParallel", BM_RadiusOutlierRemoval<0, false>);
+  registerForClouds ("RadiusOutlierRemovalVoxelCounting", BM_RadiusOutlierRemoval<0, true>);
+}
+
+PCL_BENCHMARK_MAIN ()
@@ -0,0 +1,117 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2012-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#include "benchmark_common.h"
+
+using namespace pcl::benchmarks;
+
+/** \brief The PCD encodings benchmarked by BM_PCDReader. */
+enum PCDEncoding
+{
+  PCD_BINARY,
+  PCD_BINARY_COMPRESSED,
+  PCD_BINARY_COMPRESSED_CHUNKED
+};
+
+/** \brief Write a cloud with the given encoding to a temporary file, and return its name. */
+static std::string
+writeBenchmarkFile (const BenchmarkCloud &input, PCDEncoding encoding)
+{
+  const boost::filesystem::path file_name = boost::filesystem::temp_directory_path () /
+    boost::filesystem::unique_path ("pcl_benchmark_%%%%%%%%.pcd");
+  pcl::PCDWriter writer;
+  switch (encoding)
+  {
+    case PCD_BINARY:
+      writer.writeBinary (file_name.string (), *input.cloud);
+      break;
+    case PCD_BINARY_COMPRESSED:
+      writer.writeBinaryCompressed (file_name.string (), *input.cloud);
+      break;
+    case PCD_BINARY_COMPRESSED_CHUNKED:
+      writer.setCompressionChunkSize (65536);
+      writer.writeBinaryCompressed (file_name.string (), *input.cloud);
+      break;
+  }
+  return (file_name.string ());
+}
+
+template <PCDEncoding encoding> static void
+BM_PCDReader (benchmark::State &state)
+{
+  const BenchmarkCloud &input = getClouds ()[state.range (0)];
+  const std::string file_name = writeBenchmarkFile (input, encoding);
+  state.counters["bytes"] = static_cast<double> (boost::filesystem::file_size (file_name));
+
+  pcl::PCDReader reader;
+  pcl::PCLPointCloud2 cloud;
+  while (state.KeepRunning ())
+  {
+    reader.read (file_name, cloud);
+    benchmark::DoNotOptimize (cloud.data.data ());
+  }
+  boost::filesystem::remove (file_name);
+  setThroughput (state, input.cloud->size ());
+}
+
+template <PCDEncoding encoding> static void
+BM_PCDWriter (benchmark::State &state)
+{
+  const BenchmarkCloud &input = getClouds ()[state.range (0)];
+  std::string file_name;
+  while (state.KeepRunning ())
+  {
+    file_name = writeBenchmarkFile (input, encoding);
+    state.PauseTiming ();
+    boost::filesystem::remove (file_name);
+    state.ResumeTiming ();
+  }
+  setThroughput (state, input.cloud->size ());
+}
+
+static void
+registerBenchmarks ()
+{
+  registerForClouds ("PCDReader/binary", BM_PCDReader<PCD_BINARY>);
+  registerForClouds ("PCDReader/binary_compressed", BM_PCDReader<PCD_BINARY_COMPRESSED>);
+  registerForClouds ("PCDReader/binary_compressed_chunked", BM_PCDReader<PCD_BINARY_COMPRESSED_CHUNKED>);
+  registerForClouds ("PCDWriter/binary", BM_PCDWriter<PCD_BINARY>);
+  registerForClouds ("PCDWriter/binary_compressed", BM_PCDWriter<PCD_BINARY_COMPRESSED>);
+  registerForClouds ("PCDWriter/binary_compressed_chunked", BM_PCDWriter<PCD_BINARY_COMPRESSED_CHUNKED>);
+}
+
+PCL_BENCHMARK_MAIN ()
@@ -0,0 +1,113 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2012-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#include "benchmark_common.h"
+#include <pcl/common/transforms.h>
+#include <pcl/registration/icp.h>
+#include <pcl/registration/ndt.h>
+
+using namespace pcl::benchmarks;
+
+/** \brief ICP and NDT are only run on clouds up to this size. */
+static const size_t ICP_MAX_POINTS = 100000;
+
+static void
+BM_IterativeClosestPoint (benchmark::State &state)
+{
+  const BenchmarkCloud &input = getClouds ()[state.range (0)];
+
+  // Align the cloud to a copy of itself, rotated by 5 degrees and shifted by two resolutions
+  Eigen::Affine3f transform (Eigen::AngleAxisf (static_cast<float> (5.0 * M_PI / 180.0), Eigen::Vector3f::UnitZ ()));
+  transform.translation () = Eigen::Vector3f::Constant (2.0f * input.resolution);
+  pcl::PointCloud<pcl::PointXYZ>::Ptr target (new pcl::PointCloud<pcl::PointXYZ>);
+  pcl::transformPointCloud (*input.cloud, *target, transform);
+
+  pcl::IterativeClosestPoint<pcl::PointXYZ, pcl::PointXYZ> icp;
+  icp.setInputSource (input.cloud);
+  icp.setInputTarget (target);
+  icp.setMaximumIterations (20);
+  icp.setMaxCorrespondenceDistance (10.0 * input.resolution);
+  pcl::PointCloud<pcl::PointXYZ> aligned;
+  while (state.KeepRunning ())
+  {
+    icp.align (aligned);
+    benchmark::DoNotOptimize (aligned.points.data ());
+  }
+  setThroughput (state, input.cloud->size ());
+  state.counters["fitness"] = icp.getFitnessScore ();
+}
+
+typedef pcl::NormalDistributionsTransform<pcl::PointXYZ, pcl::PointXYZ> NDT;
+
+template <NDT::NeighborSearchMethod Method> static void
+BM_NormalDistributionsTransform (benchmark::State &state)
+{
+  const BenchmarkCloud &input = getClouds ()[state.range (0)];
+
+  Eigen::Affine3f transform (Eigen::AngleAxisf (static_cast<float> (2.0 * M_PI / 180.0), Eigen::Vector3f::UnitZ ()));
+  transform.translation () = Eigen::Vector3f::Constant (2.0f * input.resolution);
+  pcl::PointCloud<pcl::PointXYZ>::Ptr target (new pcl::PointCloud<pcl::PointXYZ>);
+  pcl::transformPointCloud (*input.cloud, *target, transform);
+
+  NDT ndt;
+  ndt.setResolution (static_cast<float> (20.0 * input.resolution));
+  ndt.setStepSize (0.1);
+  ndt.setTransformationEpsilon (1e-6);
+  ndt.setMaximumIterations (10);
+  ndt.setNeighborSearchMethod (Method);
+  ndt.setNumberOfThreads (0);
+  ndt.setInputSource (input.cloud);
+  ndt.setInputTarget (target);
+  pcl::PointCloud<pcl::PointXYZ> aligned;
+  while (state.KeepRunning ())
+  {
+    ndt.align (aligned);
+    benchmark::DoNotOptimize (aligned.points.data ());
+  }
+  setThroughput (state, input.cloud->size ());
+  state.counters["fitness"] = ndt.getFitnessScore ();
+}
+
+static void
+registerBenchmarks ()
+{
+  registerForClouds ("IterativeClosestPoint", BM_IterativeClosestPoint, ICP_MAX_POINTS);
+  registerForClouds ("NormalDistributionsTransform/KDTREE", BM_NormalDistributionsTransform<NDT::KDTREE>, ICP_MAX_POINTS);
+  registerForClouds ("NormalDistributionsTransform/DIRECT7", BM_NormalDistributionsTransform<NDT::DIRECT7>, ICP_MAX_POINTS);
+}
+
+PCL_BENCHMARK_MAIN ()
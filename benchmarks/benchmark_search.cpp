@@ -0,0 +1,167 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2012-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#include "benchmark_common.h"
+#include <pcl/kdtree/kdtree_flann.h>
+#include <pcl/octree/octree_search.h>
+
+using namespace pcl::benchmarks;
+
+static void
+BM_KdTreeFLANNBuild (benchmark::State &state)
+{
+  const BenchmarkCloud &input = getClouds ()[state.range (0)];
+  while (state.KeepRunning ())
+  {
+    pcl::KdTreeFLANN<pcl::PointXYZ> tree;
+    tree.setInputCloud (input.cloud);
+  }
+  setThroughput (state, input.cloud->size ());
+}
+
+static void
+BM_KdTreeFLANNNearestKSearch (benchmark::State &state)
+{
+  const BenchmarkCloud &input = getClouds ()[state.range (0)];
+  pcl::KdTreeFLANN<pcl::PointXYZ> tree;
+  tree.setInputCloud (input.cloud);
+  std::vector<int> k_indices (10);
+  std::vector<float> k_sqr_distances (10);
+  while (state.KeepRunning ())
+  {
+    for (size_t i = 0; i < input.cloud->size (); ++i)
+      tree.nearestKSearch ((*input.cloud)[i], 10, k_indices, k_sqr_distances);
+    benchmark::DoNotOptimize (k_indices.data ());
+  }
+  setThroughput (state, input.cloud->size ());
+}
+
+static void
+BM_KdTreeFLANNRadiusSearch (benchmark::State &state)
+{
+  const BenchmarkCloud &input = getClouds ()[state.range (0)];
+  pcl::KdTreeFLANN<pcl::PointXYZ> tree;
+  tree.setInputCloud (input.cloud);
+  std::vector<int> k_indices;
+  std::vector<float> k_sqr_distances;
+  while (state.KeepRunning ())
+  {
+    for (size_t i = 0; i < input.cloud->size (); ++i)
+      tree.radiusSearch ((*input.cloud)[i], input.resolution, k_indices, k_sqr_distances);
+    benchmark::DoNotOptimize (k_indices.data ());
+  }
+  setThroughput (state, input.cloud->size ());
+}
+
+template <bool Contiguous> static void
+BM_OctreeNearestKSearch (benchmark::State &state)
+{
+  const BenchmarkCloud &input = getClouds ()[state.range (0)];
+  pcl::octree::OctreePointCloudSearch<pcl::PointXYZ> tree (input.resolution);
+  tree.setInputCloud (input.cloud);
+  tree.addPointsFromInputCloud ();
+  if (Contiguous)
+    tree.buildContiguousLeaves ();
+  std::vector<int> k_indices (10);
+  std::vector<float> k_sqr_distances (10);
+  while (state.KeepRunning ())
+  {
+    for (size_t i = 0; i < input.cloud->size (); ++i)
+      tree.nearestKSearch ((*input.cloud)[i], 10, k_indices, k_sqr_distances);
+    benchmark::DoNotOptimize (k_indices.data ());
+  }
+  setThroughput (state, input.cloud->size ());
+}
+
+template <bool Contiguous> static void
+BM_OctreeRadiusSearch (benchmark::State &state)
+{
+  const BenchmarkCloud &input = getClouds ()[state.range (0)];
+  pcl::octree::OctreePointCloudSearch<pcl::PointXYZ> tree (input.resolution);
+  tree.setInputCloud (input.cloud);
+  tree.addPointsFromInputCloud ();
+  if (Contiguous)
+    tree.buildContiguousLeaves ();
+  std::vector<int> k_indices;
+  std::vector<float> k_sqr_distances;
+  while (state.KeepRunning ())
+  {
+    for (size_t i = 0; i < input.cloud->size (); ++i)
+      tree.radiusSearch ((*input.cloud)[i], input.resolution, k_indices, k_sqr_distances);
+    benchmark::DoNotOptimize (k_indices.data ());
+  }
+  setThroughput (state, input.cloud->size ());
+}
+
+template <bool Radius> static void
+BM_OctreeBatchSearch (benchmark::State &state)
+{
+  const BenchmarkCloud &input = getClouds ()[state.range (0)];
+  pcl::octree::OctreePointCloudSearch<pcl::PointXYZ> tree (input.resolution);
+  tree.setInputCloud (input.cloud);
+  tree.addPointsFromInputCloud ();
+  tree.buildContiguousLeaves ();
+  const std::vector<int> indices;
+  std::vector<size_t> offsets;
+  std::vector<int> k_indices;
+  std::vector<float> k_sqr_distances;
+  while (state.KeepRunning ())
+  {
+    if (Radius)
+      tree.radiusSearch (*input.cloud, indices, input.resolution, offsets, k_indices, k_sqr_distances);
+    else
+      tree.nearestKSearch (*input.cloud, indices, 10, offsets, k_indices, k_sqr_distances);
+    benchmark::DoNotOptimize (k_indices.data ());
+  }
+  setThroughput (state, input.cloud->size ());
+}
+
+static void
+registerBenchmarks ()
+{
+  registerForClouds ("KdTreeFLANN/Build", BM_KdTreeFLANNBuild);
+  registerForClouds ("KdTreeFLANN/NearestKSearch", BM_KdTreeFLANNNearestKSearch);
+  registerForClouds ("KdTreeFLANN/RadiusSearch", BM_KdTreeFLANNRadiusSearch);
+  registerForClouds ("Octree/NearestKSearch", BM_OctreeNearestKSearch<false>);
+  registerForClouds ("Octree/NearestKSearchContiguous", BM_OctreeNearestKSearch<true>);
+  registerForClouds ("Octree/RadiusSearch", BM_OctreeRadiusSearch<false>);
+  registerForClouds ("Octree/RadiusSearchContiguous", BM_OctreeRadiusSearch<true>);
+  registerForClouds ("Octree/BatchNearestKSearch", BM_OctreeBatchSearch<false>);
+  registerForClouds ("Octree/BatchRadiusSearch", BM_OctreeBatchSearch<true>);
+}
+
+PCL_BENCHMARK_MAIN ()
@@ -0,0 +1,116 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2012-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#include "benchmark_common.h"
+#include <pcl/search/kdtree.h>
+#include <pcl/features/normal_3d.h>
+#include <pcl/segmentation/extract_clusters.h>
+#include <pcl/segmentation/region_growing.h>
+
+using namespace pcl::benchmarks;
+
+/** \brief Euclidean clustering with the given number of threads (1: serial region growing, 0: all cores),
+  * searching the neighbors with a kd-tree or a voxel grid.
+  */
+template <unsigned int Threads, bool VoxelGrid> static void
+BM_EuclideanClusterExtraction (benchmark::State &state)
+{
+  const BenchmarkCloud &input = getClouds ()[state.range (0)];
+  pcl::EuclideanClusterExtraction<pcl::PointXYZ> ec;
+  ec.setInputCloud (input.cloud);
+  ec.setSearchMethod (pcl::search::KdTree<pcl::PointXYZ>::Ptr (new pcl::search::KdTree<pcl::PointXYZ>));
+  ec.setClusterTolerance (3.0 * input.resolution);
+  ec.setMinClusterSize (1);
+  ec.setNumberOfThreads (Threads);
+  ec.setUseVoxelGrid (VoxelGrid);
+  std::vector<pcl::PointIndices> clusters;
+  while (state.KeepRunning ())
+  {
+    clusters.clear ();
+    ec.extract (clusters);
+    benchmark::DoNotOptimize (clusters.data ());
+  }
+  setThroughput (state, input.cloud->size ());
+  state.counters["clusters"] = static_cast<double> (clusters.size ());
+}
+
+/** \brief Region growing with the given number of threads (1: serial growth, 0: all cores). With Reuse, every
+  * iteration changes the smoothness threshold and keeps the neighbours found in the previous one.
+  */
+template <unsigned int Threads, bool Reuse> static void
+BM_RegionGrowing (benchmark::State &state)
+{
+  const BenchmarkCloud &input = getClouds ()[state.range (0)];
+  pcl::search::KdTree<pcl::PointXYZ>::Ptr tree (new pcl::search::KdTree<pcl::PointXYZ>);
+
+  pcl::PointCloud<pcl::Normal>::Ptr normals (new pcl::PointCloud<pcl::Normal>);
+  pcl::NormalEstimation<pcl::PointXYZ, pcl::Normal> ne;
+  ne.setInputCloud (input.cloud);
+  ne.setSearchMethod (tree);
+  ne.setKSearch (10);
+  ne.compute (*normals);
+
+  pcl::RegionGrowing<pcl::PointXYZ, pcl::Normal> rg;
+  rg.setInputCloud (input.cloud);
+  rg.setInputNormals (normals);
+  rg.setSearchMethod (tree);
+  rg.setNumberOfThreads (Threads);
+  rg.setReuseNeighboursFlag (Reuse);
+  std::vector<pcl::PointIndices> clusters;
+  int iteration = 0;
+  while (state.KeepRunning ())
+  {
+    rg.setSmoothnessThreshold (static_cast<float> (20 + 5 * (iteration++ % 4)) / 180.0f * static_cast<float> (M_PI));
+    rg.extract (clusters);
+    benchmark::DoNotOptimize (clusters.data ());
+  }
+  setThroughput (state, input.cloud->size ());
+  state.counters["clusters"] = static_cast<double> (clusters.size ());
+}
+
+static void
+registerBenchmarks ()
+{
+  registerForClouds ("EuclideanClusterExtraction", BM_EuclideanClusterExtraction<1, false>);
+  registerForClouds ("EuclideanClusterExtractionParallel", BM_EuclideanClusterExtraction<0, false>);
+  registerForClouds ("EuclideanClusterExtractionVoxelGrid", BM_EuclideanClusterExtraction<0, true>);
+  registerForClouds ("RegionGrowing", BM_RegionGrowing<1, false>);
+  registerForClouds ("RegionGrowingParallel", BM_RegionGrowing<0, false>);
+  registerForClouds ("RegionGrowingReuseNeighbours", BM_RegionGrowing<1, true>);
+}
+
+PCL_BENCHMARK_MAIN ()
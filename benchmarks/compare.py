@@ -0,0 +1,70 @@
+#!/usr/bin/env python
+"""Compare two sets of PCL benchmark results.
+
+Usage: compare.py <old> <new> [--threshold PERCENT]
+
+<old> and <new> are either JSON files written with --benchmark_out, or directories of them
+(e.g. the benchmarks/results directory written by "make benchmarks", copied aside for each
+commit). Benchmarks are matched by name, and the change of their throughput (points/s) is
+printed. The exit code is 1 if any benchmark got slower by more than the threshold.
+"""
+
+from __future__ import print_function
+
+import argparse
+import json
+import os
+import sys
+
+
+def load_results(path):
+    """Return {benchmark name: (items per second, real time)} for a file or directory."""
+    files = [path]
+    if os.path.isdir(path):
+        files = [os.path.join(path, f) for f in sorted(os.listdir(path)) if f.endswith(".json")]
+    results = {}
+    for file_name in files:
+        with open(file_name) as f:
+            data = json.load(f)
+        for b in data.get("benchmarks", []):
+            if b.get("run_type", "iteration") != "iteration":
+                continue
+            results[b["name"]] = (b.get("items_per_second"), b.get("real_time"))
+    return results
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split("\n")[0])
+    parser.add_argument("old")
+    parser.add_argument("new")
+    parser.add_argument("--threshold", type=float, default=5.0,
+                        help="slowdown in percent above which a benchmark is a regression")
+    args = parser.parse_args()
+
+    old = load_results(args.old)
+    new = load_results(args.new)
+
+    regressions = 0
+    width = max([len(n) for n in new] + [9])
+    print("%-*s %14s %14s %9s" % (width, "Benchmark", "old points/s", "new points/s", "change"))
+    for name in sorted(new):
+        if name not in old:
+            print("%-*s %14s %14.4g %9s" % (width, name, "-", new[name][0] or 0, "new"))
+            continue
+        old_rate, new_rate = old[name][0], new[name][0]
+        if not old_rate or not new_rate:
+            continue
+        change = 100.0 * (new_rate - old_rate) / old_rate
+        flag = ""
+        if change < -args.threshold:
+            flag = "  REGRESSION"
+            regressions += 1
+        print("%-*s %14.4g %14.4g %+8.1f%%%s" % (width, name, old_rate, new_rate, change, flag))
+    for name in sorted(set(old) - set(new)):
+        print("%-*s %14.4g %14s %9s" % (width, name, old[name][0] or 0, "-", "removed"))
+
+    return 1 if regressions else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -394,6 +394,40 @@ macro(PCL_ADD_TEST _name _exename)
     add_dependencies(tests ${_exename})
 endmacro(PCL_ADD_TEST)
 
+###############################################################################
+# Add a benchmark target.
+# _name The benchmark name.
+# ARGN :
+#    FILES the source files for the benchmark
+#    ARGUMENTS Arguments for the benchmark executable
+#    LINK_WITH link benchmark executable with libraries
+# The benchmark is run by the "benchmarks" target, which writes its results to
+# ${PROJECT_BINARY_DIR}/benchmarks/results/${_name}.json
+macro(PCL_ADD_BENCHMARK _name)
+    set(options)
+    set(oneValueArgs)
+    set(multiValueArgs FILES ARGUMENTS LINK_WITH)
+    cmake_parse_arguments(PCL_ADD_BENCHMARK "${options}" "${oneValueArgs}" "${multiValueArgs}" ${ARGN} )
+    add_executable(${_name} ${PCL_ADD_BENCHMARK_FILES})
+    if(NOT WIN32)
+      set_target_properties(${_name} PROPERTIES RUNTIME_OUTPUT_DIRECTORY ${CMAKE_CURRENT_BINARY_DIR})
+    endif(NOT WIN32)
+    target_link_libraries(${_name} ${PCL_ADD_BENCHMARK_LINK_WITH} benchmark::benchmark ${Boost_LIBRARIES})
+    if(USE_PROJECT_FOLDERS)
+      set_target_properties(${_name} PROPERTIES FOLDER "Benchmarks")
+    endif(USE_PROJECT_FOLDERS)
+
+    set(_results_dir "${PROJECT_BINARY_DIR}/benchmarks/results")
+    add_custom_target(run_${_name}
+                      COMMAND ${CMAKE_COMMAND} -E make_directory "${_results_dir}"
+                      COMMAND ${_name} ${PCL_ADD_BENCHMARK_ARGUMENTS}
+                              "--benchmark_out=${_results_dir}/${_name}.json" "--benchmark_out_format=json"
+                      DEPENDS ${_name}
+                      WORKING_DIRECTORY ${CMAKE_CURRENT_BINARY_DIR}
+                      VERBATIM)
+    add_dependencies(benchmarks run_${_name})
+endmacro(PCL_ADD_BENCHMARK)
+
 ###############################################################################
 # Add an example target.
 # _name The example name.
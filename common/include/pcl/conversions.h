@@ -55,6 +55,9 @@
 #ifndef Q_MOC_RUN
 #include <boost/foreach.hpp>
 #endif
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
 
 namespace pcl
 {
@@ -350,6 +353,286 @@ namespace pcl
       }
     }
   }
+
+  namespace detail
+  {
+    /** \brief Check whether two field lists describe the same layout. */
+    inline bool
+    sameFields (const std::vector<pcl::PCLPointField>& a, const std::vector<pcl::PCLPointField>& b)
+    {
+      if (a.size () != b.size ())
+        return (false);
+      for (size_t i = 0; i < a.size (); ++i)
+        if (a[i].name != b[i].name || a[i].offset != b[i].offset ||
+            a[i].datatype != b[i].datatype || a[i].count != b[i].count)
+          return (false);
+      return (true);
+    }
+
+    /** \brief De-interleave a row of serialized points into point structs: 12 bytes (x, y, z)
+      * go to the start of the struct, and optionally 4 more bytes (e.g., intensity or rgb) to
+      * another offset. Bytes 12 to 15 of the struct are left untouched.
+      * \param[in] msg_data pointer to the first serialized point of the row
+      * \param[in] msg_end end of the serialized data, which must not be read past
+      * \param[in] point_step the size of a serialized point
+      * \param[in] nr_points the number of points in the row
+      * \param[in] xyz_offset the offset of x, y and z in the serialized point
+      * \param[in] copy_extra whether to copy the extra 4 bytes
+      * \param[in] extra_serialized_offset the offset of the extra bytes in the serialized point
+      * \param[in] extra_struct_offset the offset of the extra bytes in the struct
+      * \param[out] points the first point struct of the row
+      */
+    template <typename PointT> void
+    copyXYZPoints (const uint8_t* msg_data, const uint8_t* msg_end, uint32_t point_step, size_t nr_points,
+                   uint32_t xyz_offset, bool copy_extra, uint32_t extra_serialized_offset,
+                   uint32_t extra_struct_offset, PointT* points)
+    {
+      size_t i = 0;
+#if defined(__SSE2__)
+      // Move x, y and z with one 16 byte load and store, as long as the load stays within the data
+      const __m128 mask = _mm_castsi128_ps (_mm_set_epi32 (0, -1, -1, -1));
+      for (; i < nr_points && msg_data + i * point_step + xyz_offset + 16 <= msg_end; ++i)
+      {
+        float* out = reinterpret_cast<float*> (&points[i]);
+        const __m128 xyz = _mm_loadu_ps (reinterpret_cast<const float*> (msg_data + i * point_step + xyz_offset));
+        _mm_storeu_ps (out, _mm_or_ps (_mm_and_ps (mask, xyz), _mm_andnot_ps (mask, _mm_loadu_ps (out))));
+        if (copy_extra)
+          memcpy (reinterpret_cast<uint8_t*> (&points[i]) + extra_struct_offset, msg_data + i * point_step + extra_serialized_offset, 4);
+      }
+#else
+      (void)msg_end;
+#endif
+      for (; i < nr_points; ++i)
+      {
+        memcpy (&points[i], msg_data + i * point_step + xyz_offset, 12);
+        if (copy_extra)
+          memcpy (reinterpret_cast<uint8_t*> (&points[i]) + extra_struct_offset, msg_data + i * point_step + extra_serialized_offset, 4);
+      }
+    }
+  } // namespace detail
+
+  /** \brief Converter between PCLPointCloud2 and pcl::PointCloud<PointT>, for streams of clouds
+    * which share the same layout.
+    *
+    * Unlike the free fromPCLPointCloud2 () function, the converter keeps its field mapping between
+    * calls, and only rebuilds it when the fields or the point step of the message change. Based on
+    * the mapping, the points are then copied:
+    *   - with a single memcpy, when the message has the layout of PointT itself (e.g., it was
+    *     created by toPCLPointCloud2 ()); padding bytes are copied as well in that case
+    *   - with a (SSE2 when available) de-interleave, when x, y and z are contiguous in the message
+    *     and at most one more 4 byte field is mapped, e.g. for XYZ, XYZI and XYZRGB clouds with
+    *     foreign layouts
+    *   - field by field otherwise, as fromPCLPointCloud2 () does.
+    *
+    * \code
+    * pcl::PCLPointCloud2Converter<pcl::PointXYZI> converter;
+    * pcl::PointCloud<pcl::PointXYZI> cloud;
+    * while (getNextMessage (msg))
+    *   converter.fromPCLPointCloud2 (msg, cloud);
+    * \endcode
+    * \ingroup common
+    */
+  template <typename PointT>
+  class PCLPointCloud2Converter
+  {
+    public:
+      /** \brief The ways points can be copied out of a message. */
+      enum CopyMode
+      {
+        COPY_FIELDS,     // one memcpy per (coalesced) field and point
+        COPY_BLOCK,      // one memcpy for all the points
+        COPY_XYZ,        // de-interleave of x, y and z
+        COPY_XYZ_EXTRA   // de-interleave of x, y and z, plus one 4 byte field
+      };
+
+      /** \brief Empty constructor. */
+      PCLPointCloud2Converter ()
+        : msg_fields_ ()
+        , msg_point_step_ (0)
+        , has_mapping_ (false)
+        , field_map_ ()
+        , mode_ (COPY_FIELDS)
+        , xyz_offset_ (0)
+        , extra_serialized_offset_ (0)
+        , extra_struct_offset_ (0)
+        , point_fields_ ()
+      {
+        for_each_type<typename traits::fieldList<PointT>::type> (detail::FieldAdder<PointT> (point_fields_));
+      }
+
+      /** \brief Convert a PCLPointCloud2 binary data blob into a pcl::PointCloud<T> object.
+        * \param[in] msg the PCLPointCloud2 binary blob
+        * \param[out] cloud the resultant pcl::PointCloud<T>
+        */
+      void
+      fromPCLPointCloud2 (const pcl::PCLPointCloud2& msg, pcl::PointCloud<PointT>& cloud)
+      {
+        if (!has_mapping_ || msg.point_step != msg_point_step_ || !detail::sameFields (msg.fields, msg_fields_))
+          updateMapping (msg);
+
+        cloud.header   = msg.header;
+        cloud.width    = msg.width;
+        cloud.height   = msg.height;
+        cloud.is_dense = msg.is_dense == 1;
+
+        const size_t nr_points = static_cast<size_t> (msg.width) * msg.height;
+        cloud.points.resize (nr_points);
+        if (nr_points == 0)
+          return;
+
+        const uint8_t* msg_end = &msg.data[0] + msg.data.size ();
+        switch (mode_)
+        {
+          case COPY_BLOCK:
+          {
+            uint8_t* cloud_data = reinterpret_cast<uint8_t*> (&cloud.points[0]);
+            const size_t cloud_row_step = sizeof (PointT) * msg.width;
+            if (msg.row_step == cloud_row_step)
+              memcpy (cloud_data, &msg.data[0], cloud_row_step * msg.height);
+            else
+              for (uint32_t row = 0; row < msg.height; ++row)
+                memcpy (cloud_data + row * cloud_row_step, &msg.data[row * msg.row_step], cloud_row_step);
+            break;
+          }
+          case COPY_XYZ:
+          case COPY_XYZ_EXTRA:
+          {
+            for (uint32_t row = 0; row < msg.height; ++row)
+              detail::copyXYZPoints (&msg.data[row * msg.row_step], msg_end, msg.point_step, msg.width,
+                                     xyz_offset_, mode_ == COPY_XYZ_EXTRA, extra_serialized_offset_,
+                                     extra_struct_offset_, &cloud.points[row * msg.width]);
+            break;
+          }
+          default:
+          {
+            uint8_t* cloud_data = reinterpret_cast<uint8_t*> (&cloud.points[0]);
+            for (uint32_t row = 0; row < msg.height; ++row)
+            {
+              const uint8_t* row_data = &msg.data[row * msg.row_step];
+              for (uint32_t col = 0; col < msg.width; ++col, cloud_data += sizeof (PointT))
+              {
+                const uint8_t* msg_data = row_data + col * msg.point_step;
+                for (size_t m = 0; m < field_map_.size (); ++m)
+                  memcpy (cloud_data + field_map_[m].struct_offset, msg_data + field_map_[m].serialized_offset, field_map_[m].size);
+              }
+            }
+            break;
+          }
+        }
+      }
+
+      /** \brief Convert a pcl::PointCloud<T> object to a PCLPointCloud2 binary data blob, reusing
+        * the field description of PointT.
+        * \param[in] cloud the input pcl::PointCloud<T>
+        * \param[out] msg the resultant PCLPointCloud2 binary blob
+        */
+      void
+      toPCLPointCloud2 (const pcl::PointCloud<PointT>& cloud, pcl::PCLPointCloud2& msg) const
+      {
+        if (cloud.width == 0 && cloud.height == 0)
+        {
+          msg.width  = static_cast<uint32_t> (cloud.points.size ());
+          msg.height = 1;
+        }
+        else
+        {
+          assert (cloud.points.size () == cloud.width * cloud.height);
+          msg.height = cloud.height;
+          msg.width  = cloud.width;
+        }
+
+        size_t data_size = sizeof (PointT) * cloud.points.size ();
+        msg.data.resize (data_size);
+        if (data_size)
+          memcpy (&msg.data[0], &cloud.points[0], data_size);
+
+        msg.fields     = point_fields_;
+        msg.header     = cloud.header;
+        msg.point_step = sizeof (PointT);
+        msg.row_step   = static_cast<uint32_t> (sizeof (PointT) * msg.width);
+        msg.is_dense   = cloud.is_dense;
+      }
+
+      /** \brief Get the field mapping built for the last converted message layout. */
+      inline const MsgFieldMap&
+      getFieldMap () const { return (field_map_); }
+
+      /** \brief Get the way points of the last converted message layout are copied. */
+      inline CopyMode
+      getCopyMode () const { return (mode_); }
+
+    private:
+      /** \brief Rebuild the field mapping and select the copy mode for the layout of a message. */
+      void
+      updateMapping (const pcl::PCLPointCloud2& msg)
+      {
+        msg_fields_ = msg.fields;
+        msg_point_step_ = msg.point_step;
+        has_mapping_ = true;
+        field_map_.clear ();
+        createMapping<PointT> (msg.fields, field_map_);
+
+        mode_ = COPY_FIELDS;
+        if (msg.point_step == sizeof (PointT) &&
+            (detail::sameFields (msg.fields, point_fields_) ||
+             (field_map_.size () == 1 && field_map_[0].serialized_offset == 0 &&
+              field_map_[0].struct_offset == 0 && field_map_[0].size == sizeof (PointT))))
+        {
+          mode_ = COPY_BLOCK;
+          return;
+        }
+
+        // The de-interleave stores 16 bytes at the start of each struct
+        if (sizeof (PointT) < 16 || field_map_.empty () || field_map_.size () > 2)
+          return;
+        int xyz = -1;
+        for (size_t m = 0; m < field_map_.size (); ++m)
+          if (field_map_[m].struct_offset == 0 && field_map_[m].size == 12)
+            xyz = static_cast<int> (m);
+        if (xyz == -1)
+          return;
+        xyz_offset_ = static_cast<uint32_t> (field_map_[xyz].serialized_offset);
+        if (field_map_.size () == 1)
+        {
+          mode_ = COPY_XYZ;
+          return;
+        }
+        const detail::FieldMapping& extra = field_map_[1 - xyz];
+        if (extra.size == 4)
+        {
+          extra_serialized_offset_ = static_cast<uint32_t> (extra.serialized_offset);
+          extra_struct_offset_ = static_cast<uint32_t> (extra.struct_offset);
+          mode_ = COPY_XYZ_EXTRA;
+        }
+      }
+
+      /** \brief The fields of the message layout the mapping was built for. */
+      std::vector<pcl::PCLPointField> msg_fields_;
+
+      /** \brief The point step of the message layout the mapping was built for. */
+      uint32_t msg_point_step_;
+
+      /** \brief Whether a mapping was built already. */
+      bool has_mapping_;
+
+      /** \brief The mapping between the message fields and the fields of PointT. */
+      MsgFieldMap field_map_;
+
+      /** \brief The way points are copied. */
+      CopyMode mode_;
+
+      /** \brief Offset of x, y and z in the message, for the de-interleave. */
+      uint32_t xyz_offset_;
+
+      /** \brief Offset of the extra field in the message, for the de-interleave. */
+      uint32_t extra_serialized_offset_;
+
+      /** \brief Offset of the extra field in PointT, for the de-interleave. */
+      uint32_t extra_struct_offset_;
+
+      /** \brief The fields of PointT, as written by toPCLPointCloud2 (). */
+      std::vector<pcl::PCLPointField> point_fields_;
+  };
 }
 
 #endif  //#ifndef PCL_CONVERSIONS_H_
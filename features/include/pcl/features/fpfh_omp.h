@@ -68,6 +68,10 @@ namespace pcl
     *     doesn't have finite 3D coordinates. Therefore, any point that contains
     *     NaN data on x, y, or z, will have its FPFH feature property set to NaN.
     *
+    * The neighborhoods found by the first search pass can be cached and reused by the pass which weights
+    * the SPFH signatures, see setNeighborCacheSize (). This saves one radius search per point at the cost
+    * of memory. The result does not depend on the number of threads nor on the cache size.
+    *
     * \author Radu B. Rusu
     * \ingroup features
     */
@@ -95,7 +99,8 @@ namespace pcl
       /** \brief Initialize the scheduler and set the number of threads to use.
         * \param[in] nr_threads the number of hardware threads to use (0 sets the value back to automatic)
         */
-      FPFHEstimationOMP (unsigned int nr_threads = 0) : nr_bins_f1_ (11), nr_bins_f2_ (11), nr_bins_f3_ (11), threads_ (nr_threads)
+      FPFHEstimationOMP (unsigned int nr_threads = 0) : nr_bins_f1_ (11), nr_bins_f2_ (11), nr_bins_f3_ (11), threads_ (nr_threads),
+                                                        neighbor_cache_size_ (0), spfh_hist_ ()
       {
         feature_name_ = "FPFHEstimationOMP";
       }
@@ -106,7 +111,58 @@ namespace pcl
       inline void 
       setNumberOfThreads (unsigned int nr_threads = 0) { threads_ = nr_threads; }
 
+      /** \brief Set the maximum amount of memory used to cache neighborhoods between the search passes.
+        * Neighborhoods which do not fit into the budget are searched for again. The budget is split evenly
+        * between fixed blocks of query points, so it is only approximately respected.
+        * \param[in] max_bytes the memory budget in bytes (0 disables the cache, the default)
+        */
+      inline void
+      setNeighborCacheSize (size_t max_bytes) { neighbor_cache_size_ = max_bytes; }
+
+      /** \brief Get the maximum amount of memory used to cache neighborhoods between the search passes. */
+      inline size_t
+      getNeighborCacheSize () const { return (neighbor_cache_size_); }
+
     private:
+      /** \brief Number of consecutive query points processed as one block. Blocks are the unit of work
+        * distributed over the threads, and each of them gets an equal share of the neighbor cache.
+        */
+      static const int BLOCK_SIZE = 256;
+
+      /** \brief The neighborhoods of a block of query points, stored back to back. Neighborhoods are
+        * cached in query order until the share of the memory budget of the block is used up, so that
+        * the first size () query points of the block are cached.
+        */
+      struct NeighborBlock
+      {
+        NeighborBlock () : offsets (1, 0), indices (), sqr_dists (), full (false) {}
+
+        /** \brief Append the neighborhood of the next query point of the block, if it fits into max_bytes. */
+        inline void
+        push (const std::vector<int> &nn_indices, const std::vector<float> &nn_dists, size_t max_bytes)
+        {
+          const size_t bytes = (indices.size () + nn_indices.size ()) * (sizeof (int) + sizeof (float)) +
+                               (offsets.size () + 1) * sizeof (int);
+          if (full || bytes > max_bytes)
+          {
+            full = true;
+            return;
+          }
+          indices.insert (indices.end (), nn_indices.begin (), nn_indices.end ());
+          sqr_dists.insert (sqr_dists.end (), nn_dists.begin (), nn_dists.end ());
+          offsets.push_back (static_cast<int> (indices.size ()));
+        }
+
+        /** \brief The number of cached neighborhoods. */
+        inline size_t
+        size () const { return (offsets.size () - 1); }
+
+        std::vector<int> offsets;
+        std::vector<int> indices;
+        std::vector<float> sqr_dists;
+        bool full;
+      };
+
       /** \brief Estimate the Fast Point Feature Histograms (FPFH) descriptors at a set of points given by
         * <setInputCloud (), setIndices ()> using the surface in setSearchSurface () and the spatial locator in
         * setSearchMethod ()
@@ -115,12 +171,44 @@ namespace pcl
       void 
       computeFeature (PointCloudOut &output);
 
+      /** \brief Compute the SPFH signature of a point into a row of spfh_hist_.
+        * \param[in] p_idx the index of the point in the surface
+        * \param[in] row the row of spfh_hist_ to write
+        * \param[in] nn_indices the neighborhood of the point
+        * \param[out] hist_f1 a 1 x nr_bins_f1_ scratch matrix
+        * \param[out] hist_f2 a 1 x nr_bins_f2_ scratch matrix
+        * \param[out] hist_f3 a 1 x nr_bins_f3_ scratch matrix
+        */
+      void
+      computeSPFHRow (int p_idx, int row, const std::vector<int> &nn_indices,
+                      Eigen::MatrixXf &hist_f1, Eigen::MatrixXf &hist_f2, Eigen::MatrixXf &hist_f3);
+
+      /** \brief Weight the SPFH signatures of a neighborhood into a FPFH signature, like
+        * weightPointSPFHSignature () but reading the signatures from spfh_hist_.
+        * \param[in] nn_indices the indices of the neighbors in the surface
+        * \param[in] nn_dists the squared distances to the neighbors
+        * \param[in] nr_neighbors the size of the neighborhood
+        * \param[in] spfh_hist_lookup the row of spfh_hist_ of each surface point
+        * \param[out] fpfh_histogram the resultant FPFH signature
+        */
+      void
+      weightSPFHRows (const int *nn_indices, const float *nn_dists, size_t nr_neighbors,
+                      const std::vector<int> &spfh_hist_lookup, float *fpfh_histogram) const;
     public:
       /** \brief The number of subdivisions for each angular feature interval. */
       int nr_bins_f1_, nr_bins_f2_, nr_bins_f3_;
     private:
       /** \brief The number of threads the scheduler should use. */
       unsigned int threads_;
+
+      /** \brief The memory budget of the neighbor cache, in bytes. */
+      size_t neighbor_cache_size_;
+
+      /** \brief The SPFH signatures, one row per point. The f1, f2 and f3 histograms of a point are
+        * stored next to each other and rows are padded to a multiple of 4 floats, so that the weighting
+        * pass reads each signature from a contiguous, aligned block of memory.
+        */
+      Eigen::Matrix<float, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor> spfh_hist_;
   };
 }
 
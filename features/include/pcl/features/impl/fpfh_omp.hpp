@@ -43,111 +43,278 @@
 
 #include <pcl/features/fpfh_omp.h>
 
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
 //////////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointInT, typename PointNT, typename PointOutT> void
-pcl::FPFHEstimationOMP<PointInT, PointNT, PointOutT>::computeFeature (PointCloudOut &output)
+pcl::FPFHEstimationOMP<PointInT, PointNT, PointOutT>::computeSPFHRow (
+    int p_idx, int row, const std::vector<int> &nn_indices,
+    Eigen::MatrixXf &hist_f1, Eigen::MatrixXf &hist_f2, Eigen::MatrixXf &hist_f3)
 {
-  std::vector<int> spfh_indices_vec;
-  std::vector<int> spfh_hist_lookup (surface_->points.size ());
-
-  // Build a list of (unique) indices for which we will need to compute SPFH signatures
-  // (We need an SPFH signature for every point that is a neighbor of any point in input_[indices_])
-  if (surface_ != input_ ||
-      indices_->size () != surface_->points.size ())
-  { 
-    std::vector<int> nn_indices (k_); // \note These resizes are irrelevant for a radiusSearch ().
-    std::vector<float> nn_dists (k_); 
-
-    std::set<int> spfh_indices_set;
-    for (size_t idx = 0; idx < indices_->size (); ++idx)
+  hist_f1.setZero (1, nr_bins_f1_);
+  hist_f2.setZero (1, nr_bins_f2_);
+  hist_f3.setZero (1, nr_bins_f3_);
+  this->computePointSPFHSignature (*surface_, *normals_, p_idx, 0, nn_indices, hist_f1, hist_f2, hist_f3);
+
+  float *spfh = spfh_hist_.data () + static_cast<size_t> (row) * spfh_hist_.cols ();
+  for (int d = 0; d < nr_bins_f1_; ++d)
+    spfh[d] = hist_f1 (0, d);
+  for (int d = 0; d < nr_bins_f2_; ++d)
+    spfh[nr_bins_f1_ + d] = hist_f2 (0, d);
+  for (int d = 0; d < nr_bins_f3_; ++d)
+    spfh[nr_bins_f1_ + nr_bins_f2_ + d] = hist_f3 (0, d);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointInT, typename PointNT, typename PointOutT> void
+pcl::FPFHEstimationOMP<PointInT, PointNT, PointOutT>::weightSPFHRows (
+    const int *nn_indices, const float *nn_dists, size_t nr_neighbors,
+    const std::vector<int> &spfh_hist_lookup, float *fpfh_histogram) const
+{
+  // Same operations in the same order as weightPointSPFHSignature (), so that both give the same result
+  const int nr_bins_f12 = nr_bins_f1_ + nr_bins_f2_;
+  const int nr_bins = nr_bins_f12 + nr_bins_f3_;
+  double sum_f1 = 0.0, sum_f2 = 0.0, sum_f3 = 0.0;
+
+  for (int d = 0; d < nr_bins; ++d)
+    fpfh_histogram[d] = 0.0f;
+
+  for (size_t idx = 0; idx < nr_neighbors; ++idx)
+  {
+    // Minus the query point itself
+    if (nn_dists[idx] == 0)
+      continue;
+
+    // Standard weighting function used
+    const float weight = 1.0f / nn_dists[idx];
+    const float *spfh = spfh_hist_.data () + static_cast<size_t> (spfh_hist_lookup[nn_indices[idx]]) * spfh_hist_.cols ();
+
+    for (int d = 0; d < nr_bins_f1_; ++d)
     {
-      int p_idx = (*indices_)[idx];
-      if (!isFinite ((*input_)[p_idx]) ||
-          this->searchForNeighbors (p_idx, search_parameter_, nn_indices, nn_dists) == 0)
-        continue;
-      
-      spfh_indices_set.insert (nn_indices.begin (), nn_indices.end ());
+      const float val = spfh[d] * weight;
+      sum_f1 += val;
+      fpfh_histogram[d] += val;
+    }
+    for (int d = nr_bins_f1_; d < nr_bins_f12; ++d)
+    {
+      const float val = spfh[d] * weight;
+      sum_f2 += val;
+      fpfh_histogram[d] += val;
+    }
+    for (int d = nr_bins_f12; d < nr_bins; ++d)
+    {
+      const float val = spfh[d] * weight;
+      sum_f3 += val;
+      fpfh_histogram[d] += val;
     }
-    spfh_indices_vec.resize (spfh_indices_set.size ());
-    std::copy (spfh_indices_set.begin (), spfh_indices_set.end (), spfh_indices_vec.begin ());
-  }
-  else
-  {
-    // Special case: When a feature must be computed at every point, there is no need for a neighborhood search
-    spfh_indices_vec.resize (indices_->size ());
-    for (int idx = 0; idx < static_cast<int> (indices_->size ()); ++idx)
-      spfh_indices_vec[idx] = idx;
   }
 
-  // Initialize the arrays that will store the SPFH signatures
-  size_t data_size = spfh_indices_vec.size ();
-  hist_f1_.setZero (data_size, nr_bins_f1_);
-  hist_f2_.setZero (data_size, nr_bins_f2_);
-  hist_f3_.setZero (data_size, nr_bins_f3_);
+  // Histogram values sum up to 100
+  if (sum_f1 != 0)
+    sum_f1 = 100.0 / sum_f1;
+  if (sum_f2 != 0)
+    sum_f2 = 100.0 / sum_f2;
+  if (sum_f3 != 0)
+    sum_f3 = 100.0 / sum_f3;
 
-  std::vector<int> nn_indices (k_); // \note These resizes are irrelevant for a radiusSearch ().
-  std::vector<float> nn_dists (k_); 
-
-  // Compute SPFH signatures for every point that needs them
+  for (int d = 0; d < nr_bins_f1_; ++d)
+    fpfh_histogram[d] *= static_cast<float> (sum_f1);
+  for (int d = nr_bins_f1_; d < nr_bins_f12; ++d)
+    fpfh_histogram[d] *= static_cast<float> (sum_f2);
+  for (int d = nr_bins_f12; d < nr_bins; ++d)
+    fpfh_histogram[d] *= static_cast<float> (sum_f3);
+}
 
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointInT, typename PointNT, typename PointOutT> void
+pcl::FPFHEstimationOMP<PointInT, PointNT, PointOutT>::computeFeature (PointCloudOut &output)
+{
 #ifdef _OPENMP
-#pragma omp parallel for shared (spfh_hist_lookup) private (nn_indices, nn_dists) num_threads(threads_)
+  const int nr_threads = threads_ == 0 ? omp_get_num_procs () : static_cast<int> (threads_);
+#else
+  const int nr_threads = 1;
 #endif
-  for (int i = 0; i < static_cast<int> (spfh_indices_vec.size ()); ++i)
-  {
-    // Get the next point index
-    int p_idx = spfh_indices_vec[i];
+  const int nr_bins = nr_bins_f1_ + nr_bins_f2_ + nr_bins_f3_;
+  const int nr_surface_points = static_cast<int> (surface_->points.size ());
+  const int nr_queries = static_cast<int> (indices_->size ());
 
-    // Find the neighborhood around p_idx
-    if (!isFinite ((*input_)[p_idx]) ||
-        this->searchForNeighbors (*surface_, p_idx, search_parameter_, nn_indices, nn_dists) == 0)
-      continue;
+  // When a feature must be computed at every point, there is no need for a search pass to find the
+  // points which need a SPFH signature: all of them do, and the row of a point is its index. The
+  // neighborhoods found by the SPFH pass are then cached by point index. Otherwise the first pass
+  // searches the neighborhoods of input_[indices_], which are cached by position in indices_.
+  const bool all_points = surface_ == input_ && nr_queries == nr_surface_points;
+  const int nr_keys = all_points ? nr_surface_points : nr_queries;
+  std::vector<NeighborBlock> neighbor_cache (neighbor_cache_size_ == 0 ? 0 : (nr_keys + BLOCK_SIZE - 1) / BLOCK_SIZE);
+  const size_t block_budget = neighbor_cache.empty () ? 0 : neighbor_cache_size_ / neighbor_cache.size ();
+  const int nr_cache_blocks = static_cast<int> (neighbor_cache.size ());
 
-    // Estimate the SPFH signature around p_idx
-    this->computePointSPFHSignature (*surface_, *normals_, p_idx, i, nn_indices, hist_f1_, hist_f2_, hist_f3_);
+  std::vector<int> spfh_hist_lookup (nr_surface_points);
+  std::vector<int> spfh_indices_vec;
+  const int stride = (nr_bins + 3) & ~3;
 
-    // Populate a lookup table for converting a point index to its corresponding row in the spfh_hist_* matrices
-    spfh_hist_lookup[p_idx] = i;
-  }
+  if (!all_points)
+  {
+    // Mark every point that is a neighbor of any point in input_[indices_]: these need a SPFH signature.
+    // Threads only ever store 1 into needs_spfh, so they do not need to synchronize.
+    std::vector<char> needs_spfh (nr_surface_points, 0);
+    const int nr_blocks = (nr_queries + BLOCK_SIZE - 1) / BLOCK_SIZE;
+#ifdef _OPENMP
+#pragma omp parallel num_threads(nr_threads)
+#endif
+    {
+      std::vector<int> nn_indices (k_); // \note These resizes are irrelevant for a radiusSearch ().
+      std::vector<float> nn_dists (k_);
+#ifdef _OPENMP
+#pragma omp for schedule(dynamic, 1)
+#endif
+      for (int b = 0; b < nr_blocks; ++b)
+      {
+        const int end = std::min (nr_queries, (b + 1) * BLOCK_SIZE);
+        for (int idx = b * BLOCK_SIZE; idx < end; ++idx)
+        {
+          const int p_idx = (*indices_)[idx];
+          if (!isFinite ((*input_)[p_idx]) ||
+              this->searchForNeighbors (p_idx, search_parameter_, nn_indices, nn_dists) == 0)
+          {
+            nn_indices.clear ();
+            nn_dists.clear ();
+          }
+          for (size_t i = 0; i < nn_indices.size (); ++i)
+            needs_spfh[nn_indices[i]] = 1;
+          if (b < nr_cache_blocks)
+            neighbor_cache[b].push (nn_indices, nn_dists, block_budget);
+        }
+      }
+    }
+
+    // Rows are assigned in point index order
+    for (int p_idx = 0; p_idx < nr_surface_points; ++p_idx)
+    {
+      if (!needs_spfh[p_idx])
+        continue;
+      spfh_hist_lookup[p_idx] = static_cast<int> (spfh_indices_vec.size ());
+      spfh_indices_vec.push_back (p_idx);
+    }
+    spfh_hist_.setZero (spfh_indices_vec.size (), stride);
 
-  // Initialize the array that will store the FPFH signature
-  int nr_bins = nr_bins_f1_ + nr_bins_f2_ + nr_bins_f3_;
+    // Compute SPFH signatures for every point that needs them
+    const int nr_spfh = static_cast<int> (spfh_indices_vec.size ());
+#ifdef _OPENMP
+#pragma omp parallel num_threads(nr_threads)
+#endif
+    {
+      std::vector<int> nn_indices (k_);
+      std::vector<float> nn_dists (k_);
+      Eigen::MatrixXf hist_f1, hist_f2, hist_f3;
+#ifdef _OPENMP
+#pragma omp for schedule(dynamic, BLOCK_SIZE)
+#endif
+      for (int i = 0; i < nr_spfh; ++i)
+      {
+        const int p_idx = spfh_indices_vec[i];
+        if (!isFinite ((*surface_)[p_idx]) ||
+            this->searchForNeighbors (*surface_, p_idx, search_parameter_, nn_indices, nn_dists) == 0)
+          continue;
+        computeSPFHRow (p_idx, i, nn_indices, hist_f1, hist_f2, hist_f3);
+      }
+    }
+  }
+  else
+  {
+    for (int p_idx = 0; p_idx < nr_surface_points; ++p_idx)
+      spfh_hist_lookup[p_idx] = p_idx;
+    spfh_hist_.setZero (nr_surface_points, stride);
 
-  nn_indices.clear();
-  nn_dists.clear();
+    // Compute SPFH signatures for every point, caching the neighborhoods
+    const int nr_blocks = (nr_surface_points + BLOCK_SIZE - 1) / BLOCK_SIZE;
+#ifdef _OPENMP
+#pragma omp parallel num_threads(nr_threads)
+#endif
+    {
+      std::vector<int> nn_indices (k_);
+      std::vector<float> nn_dists (k_);
+      Eigen::MatrixXf hist_f1, hist_f2, hist_f3;
+#ifdef _OPENMP
+#pragma omp for schedule(dynamic, 1)
+#endif
+      for (int b = 0; b < nr_blocks; ++b)
+      {
+        const int end = std::min (nr_surface_points, (b + 1) * BLOCK_SIZE);
+        for (int p_idx = b * BLOCK_SIZE; p_idx < end; ++p_idx)
+        {
+          if (!isFinite ((*surface_)[p_idx]) ||
+              this->searchForNeighbors (*surface_, p_idx, search_parameter_, nn_indices, nn_dists) == 0)
+          {
+            nn_indices.clear ();
+            nn_dists.clear ();
+          }
+          else
+            computeSPFHRow (p_idx, p_idx, nn_indices, hist_f1, hist_f2, hist_f3);
+          if (b < nr_cache_blocks)
+            neighbor_cache[b].push (nn_indices, nn_dists, block_budget);
+        }
+      }
+    }
+  }
 
   // Iterate over the entire index vector
 #ifdef _OPENMP
-#pragma omp parallel for shared (output) private (nn_indices, nn_dists) num_threads(threads_)
+#pragma omp parallel num_threads(nr_threads)
 #endif
-  for (int idx = 0; idx < static_cast<int> (indices_->size ()); ++idx)
   {
-    // Find the indices of point idx's neighbors...
-    if (!isFinite ((*input_)[(*indices_)[idx]]) ||
-        this->searchForNeighbors ((*indices_)[idx], search_parameter_, nn_indices, nn_dists) == 0)
+    std::vector<int> nn_indices (k_);
+    std::vector<float> nn_dists (k_);
+    std::vector<float> fpfh_histogram (nr_bins);
+#ifdef _OPENMP
+#pragma omp for schedule(dynamic, BLOCK_SIZE)
+#endif
+    for (int idx = 0; idx < nr_queries; ++idx)
     {
-      for (int d = 0; d < nr_bins; ++d)
-        output.points[idx].histogram[d] = std::numeric_limits<float>::quiet_NaN ();
-  
-      output.is_dense = false;
-      continue;
-    }
+      const int p_idx = (*indices_)[idx];
+      const int key = all_points ? p_idx : idx;
+      const int *neighbors = NULL;
+      const float *sqr_dists = NULL;
+      size_t nr_neighbors = 0;
 
+      // Reuse the neighborhood of the first pass if it is cached, search for it again otherwise
+      const NeighborBlock *block = key / BLOCK_SIZE < nr_cache_blocks ? &neighbor_cache[key / BLOCK_SIZE] : NULL;
+      if (block && static_cast<size_t> (key % BLOCK_SIZE) < block->size ())
+      {
+        const int begin = block->offsets[key % BLOCK_SIZE];
+        nr_neighbors = block->offsets[key % BLOCK_SIZE + 1] - begin;
+        if (nr_neighbors > 0)
+        {
+          neighbors = &block->indices[begin];
+          sqr_dists = &block->sqr_dists[begin];
+        }
+      }
+      else if (isFinite ((*input_)[p_idx]) &&
+               this->searchForNeighbors (p_idx, search_parameter_, nn_indices, nn_dists) > 0)
+      {
+        neighbors = &nn_indices[0];
+        sqr_dists = &nn_dists[0];
+        nr_neighbors = nn_indices.size ();
+      }
 
-    // ... and remap the nn_indices values so that they represent row indices in the spfh_hist_* matrices 
-    // instead of indices into surface_->points
-    for (size_t i = 0; i < nn_indices.size (); ++i)
-      nn_indices[i] = spfh_hist_lookup[nn_indices[i]];
+      if (nr_neighbors == 0)
+      {
+        for (int d = 0; d < nr_bins; ++d)
+          output.points[idx].histogram[d] = std::numeric_limits<float>::quiet_NaN ();
 
-    // Compute the FPFH signature (i.e. compute a weighted combination of local SPFH signatures) ...
-    Eigen::VectorXf fpfh_histogram = Eigen::VectorXf::Zero (nr_bins);
-    weightPointSPFHSignature (hist_f1_, hist_f2_, hist_f3_, nn_indices, nn_dists, fpfh_histogram);
+        output.is_dense = false;
+        continue;
+      }
 
-    // ...and copy it into the output cloud
-    for (int d = 0; d < nr_bins; ++d)
-      output.points[idx].histogram[d] = fpfh_histogram[d];
-  }
+      // Compute the FPFH signature (i.e. compute a weighted combination of local SPFH signatures) ...
+      weightSPFHRows (neighbors, sqr_dists, nr_neighbors, spfh_hist_lookup, &fpfh_histogram[0]);
 
+      // ...and copy it into the output cloud
+      for (int d = 0; d < nr_bins; ++d)
+        output.points[idx].histogram[d] = fpfh_histogram[d];
+    }
+  }
 }
 
 #define PCL_INSTANTIATE_FPFHEstimationOMP(T,NT,OutT) template class PCL_EXPORTS pcl::FPFHEstimationOMP<T,NT,OutT>;
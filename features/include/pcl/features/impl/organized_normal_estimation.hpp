@@ -0,0 +1,269 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2012-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#ifndef PCL_FEATURES_IMPL_ORGANIZED_NORMAL_ESTIMATION_H_
+#define PCL_FEATURES_IMPL_ORGANIZED_NORMAL_ESTIMATION_H_
+
+#include <pcl/features/organized_normal_estimation.h>
+#include <pcl/features/normal_3d.h>
+#include <pcl/common/point_tests.h>
+#include <algorithm>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointInT, typename PointOutT> bool
+pcl::OrganizedNormalEstimation<PointInT, PointOutT>::initCompute ()
+{
+  // The neighborhoods come from the image structure, so no search method is needed
+  if (!PCLBase<PointInT>::initCompute ())
+  {
+    PCL_ERROR ("[pcl::%s::initCompute] Init failed.\n", getClassName ().c_str ());
+    return (false);
+  }
+  if (input_->points.empty ())
+  {
+    PCL_ERROR ("[pcl::%s::compute] input_ is empty!\n", getClassName ().c_str ());
+    return (false);
+  }
+  if (!input_->isOrganized ())
+  {
+    PCL_ERROR ("[pcl::%s::initCompute] Input dataset is not organized (height = 1).\n", getClassName ().c_str ());
+    return (false);
+  }
+  return (true);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointInT, typename PointOutT> bool
+pcl::OrganizedNormalEstimation<PointInT, PointOutT>::computeTile (
+    int x0, int y0, int x1, int y1, PointCloudOut &output) const
+{
+  const int width = static_cast<int> (input_->width);
+  const int height = static_cast<int> (input_->height);
+  const float bad_point = std::numeric_limits<float>::quiet_NaN ();
+
+  // The input region whose points fall into the rectangles of the tile points
+  const int in_x0 = (std::max) (x0 - rect_width_2_, 0);
+  const int in_x1 = (std::min) (x1 + rect_width_2_, width);
+  const int in_y0 = (std::max) (y0 - rect_height_2_, 0);
+  const int in_y1 = (std::min) (y1 + rect_height_2_, height);
+  const int tile_width = x1 - x0;
+
+  // Accumulate relative to a point of the region, so that the second order moments do not
+  // lose the precision needed for the covariance of points far away from the origin
+  double ox = 0, oy = 0, oz = 0;
+  bool found_origin = false;
+  for (int v = in_y0; v < in_y1 && !found_origin; ++v)
+  {
+    for (int u = in_x0; u < in_x1; ++u)
+    {
+      const PointInT &pt = (*input_) (u, v);
+      if (pcl::isFinite (pt))
+      {
+        ox = pt.x; oy = pt.y; oz = pt.z;
+        found_origin = true;
+        break;
+      }
+    }
+  }
+  if (!found_origin)
+  {
+    for (int v = y0; v < y1; ++v)
+      for (int u = x0; u < x1; ++u)
+        output (u, v).normal_x = output (u, v).normal_y = output (u, v).normal_z = output (u, v).curvature = bad_point;
+    return (false);
+  }
+
+  // Horizontal pass: for every input row, the moments of the rectangle rows of the tile columns
+  std::vector<Moments> point_moments (in_x1 - in_x0);
+  std::vector<Moments> row_sums ((in_y1 - in_y0) * tile_width);
+  for (int v = in_y0; v < in_y1; ++v)
+  {
+    for (int u = in_x0; u < in_x1; ++u)
+    {
+      const PointInT &pt = (*input_) (u, v);
+      Moments &m = point_moments[u - in_x0];
+      if (!pcl::isFinite (pt))
+      {
+        m.clear ();
+        continue;
+      }
+      const double x = pt.x - ox, y = pt.y - oy, z = pt.z - oz;
+      m.n = 1;
+      m.x = x; m.y = y; m.z = z;
+      m.xx = x * x; m.xy = x * y; m.xz = x * z;
+      m.yy = y * y; m.yz = y * z; m.zz = z * z;
+    }
+
+    Moments sum;
+    sum.clear ();
+    for (int u = (std::max) (x0 - rect_width_2_, 0); u <= (std::min) (x0 + rect_width_2_, width - 1); ++u)
+      sum.add (point_moments[u - in_x0]);
+
+    Moments *row = &row_sums[(v - in_y0) * tile_width];
+    row[0] = sum;
+    for (int u = x0 + 1; u < x1; ++u)
+    {
+      if (u + rect_width_2_ < width)
+        sum.add (point_moments[u + rect_width_2_ - in_x0]);
+      if (u - rect_width_2_ - 1 >= 0)
+        sum.subtract (point_moments[u - rect_width_2_ - 1 - in_x0]);
+      row[u - x0] = sum;
+    }
+  }
+
+  // Vertical pass: slide the rectangles down the tile, one row of sums at a time
+  std::vector<Moments> sums (tile_width);
+  for (int u = 0; u < tile_width; ++u)
+    sums[u].clear ();
+  for (int v = (std::max) (y0 - rect_height_2_, 0); v <= (std::min) (y0 + rect_height_2_, height - 1); ++v)
+    for (int u = 0; u < tile_width; ++u)
+      sums[u].add (row_sums[(v - in_y0) * tile_width + u]);
+
+  bool dense = true;
+  for (int v = y0; v < y1; ++v)
+  {
+    if (v > y0)
+    {
+      if (v + rect_height_2_ < height)
+      {
+        const Moments *row = &row_sums[(v + rect_height_2_ - in_y0) * tile_width];
+        for (int u = 0; u < tile_width; ++u)
+          sums[u].add (row[u]);
+      }
+      if (v - rect_height_2_ - 1 >= 0)
+      {
+        const Moments *row = &row_sums[(v - rect_height_2_ - 1 - in_y0) * tile_width];
+        for (int u = 0; u < tile_width; ++u)
+          sums[u].subtract (row[u]);
+      }
+    }
+
+    for (int u = 0; u < tile_width; ++u)
+    {
+      const PointInT &pt = (*input_) (x0 + u, v);
+      PointOutT &normal = output (x0 + u, v);
+      const Moments &m = sums[u];
+      if (!pcl::isFinite (pt) || m.n < 3)
+      {
+        normal.normal_x = normal.normal_y = normal.normal_z = normal.curvature = bad_point;
+        dense = false;
+        continue;
+      }
+
+      // Covariance matrix normalized by the number of points, as in computeMeanAndCovarianceMatrix ()
+      const double inv_n = 1.0 / m.n;
+      const double mx = m.x * inv_n, my = m.y * inv_n, mz = m.z * inv_n;
+      Eigen::Matrix3f covariance_matrix;
+      covariance_matrix.coeffRef (0) = static_cast<float> (m.xx * inv_n - mx * mx);
+      covariance_matrix.coeffRef (1) = static_cast<float> (m.xy * inv_n - mx * my);
+      covariance_matrix.coeffRef (2) = static_cast<float> (m.xz * inv_n - mx * mz);
+      covariance_matrix.coeffRef (4) = static_cast<float> (m.yy * inv_n - my * my);
+      covariance_matrix.coeffRef (5) = static_cast<float> (m.yz * inv_n - my * mz);
+      covariance_matrix.coeffRef (8) = static_cast<float> (m.zz * inv_n - mz * mz);
+      covariance_matrix.coeffRef (3) = covariance_matrix.coeff (1);
+      covariance_matrix.coeffRef (6) = covariance_matrix.coeff (2);
+      covariance_matrix.coeffRef (7) = covariance_matrix.coeff (5);
+
+      solvePlaneParameters (covariance_matrix, normal.normal_x, normal.normal_y, normal.normal_z, normal.curvature);
+      flipNormalTowardsViewpoint (pt, vpx_, vpy_, vpz_, normal.normal_x, normal.normal_y, normal.normal_z);
+    }
+  }
+  return (dense);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointInT, typename PointOutT> void
+pcl::OrganizedNormalEstimation<PointInT, PointOutT>::computeFeature (PointCloudOut &output)
+{
+  // The tiles write into an organized cloud: the output itself if it covers the whole input
+  const bool organized_output = indices_->size () == input_->points.size () &&
+                                output.width == input_->width && output.height == input_->height;
+  PointCloudOut full_output;
+  if (!organized_output)
+  {
+    full_output.points.resize (input_->points.size ());
+    full_output.width = input_->width;
+    full_output.height = input_->height;
+  }
+  PointCloudOut &normals = organized_output ? output : full_output;
+
+  const int width = static_cast<int> (input_->width);
+  const int height = static_cast<int> (input_->height);
+  const int tile_width = TILE_WIDTH, tile_height = TILE_HEIGHT;
+  const int nr_tiles_x = (width + tile_width - 1) / tile_width;
+  const int nr_tiles_y = (height + tile_height - 1) / tile_height;
+  const int nr_tiles = nr_tiles_x * nr_tiles_y;
+  std::vector<char> tile_dense (nr_tiles);
+
+#ifdef _OPENMP
+  const unsigned int threads = threads_ == 0 ? omp_get_num_procs () : threads_;
+#pragma omp parallel for schedule(dynamic, 1) num_threads(threads)
+#endif
+  for (int tile = 0; tile < nr_tiles; ++tile)
+  {
+    const int x0 = (tile % nr_tiles_x) * tile_width;
+    const int y0 = (tile / nr_tiles_x) * tile_height;
+    tile_dense[tile] = computeTile (x0, y0, (std::min) (x0 + tile_width, width), (std::min) (y0 + tile_height, height), normals);
+  }
+
+  if (organized_output)
+  {
+    output.is_dense = std::find (tile_dense.begin (), tile_dense.end (), 0) == tile_dense.end ();
+    return;
+  }
+
+  // Copy out the normals of the given indices
+  output.is_dense = true;
+  for (size_t idx = 0; idx < indices_->size (); ++idx)
+  {
+    const PointOutT &normal = normals.points[(*indices_)[idx]];
+    output.points[idx].normal_x = normal.normal_x;
+    output.points[idx].normal_y = normal.normal_y;
+    output.points[idx].normal_z = normal.normal_z;
+    output.points[idx].curvature = normal.curvature;
+    if (!pcl_isfinite (normal.normal_x))
+      output.is_dense = false;
+  }
+}
+
+#define PCL_INSTANTIATE_OrganizedNormalEstimation(T,NT) template class PCL_EXPORTS pcl::OrganizedNormalEstimation<T,NT>;
+
+#endif    // PCL_FEATURES_IMPL_ORGANIZED_NORMAL_ESTIMATION_H_
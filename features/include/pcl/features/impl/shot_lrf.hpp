@@ -40,6 +40,7 @@
 #ifndef PCL_FEATURES_IMPL_SHOT_LRF_H_
 #define PCL_FEATURES_IMPL_SHOT_LRF_H_
 
+#include <algorithm>
 #include <utility>
 #include <pcl/features/shot_lrf.h>
 
@@ -48,12 +49,24 @@
 template<typename PointInT, typename PointOutT> float
 pcl::SHOTLocalReferenceFrameEstimation<PointInT, PointOutT>::getLocalRF (const int& current_point_idx, Eigen::Matrix3f &rf)
 {
-  const Eigen::Vector4f& central_point = (*input_)[current_point_idx].getVector4fMap ();
   std::vector<int> n_indices;
   std::vector<float> n_sqr_distances;
 
   this->searchForNeighbors (current_point_idx, search_parameter_, n_indices, n_sqr_distances);
 
+  return (computeLocalRF (*surface_, (*input_)[current_point_idx].getVector4fMap (), search_parameter_,
+                          n_indices, n_sqr_distances, rf));
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template<typename PointInT, typename PointOutT> float
+pcl::SHOTLocalReferenceFrameEstimation<PointInT, PointOutT>::computeLocalRF (const pcl::PointCloud<PointInT> &surface,
+                                                                          const Eigen::Vector4f &central_point,
+                                                                          double radius,
+                                                                          const std::vector<int> &n_indices,
+                                                                          const std::vector<float> &n_sqr_distances,
+                                                                          Eigen::Matrix3f &rf)
+{
   Eigen::Matrix<double, Eigen::Dynamic, 4> vij (n_indices.size (), 4);
 
   Eigen::Matrix3d cov_m = Eigen::Matrix3d::Zero ();
@@ -63,9 +76,22 @@ pcl::SHOTLocalReferenceFrameEstimation<PointInT, PointOutT>::getLocalRF (const i
 
   int valid_nn_points = 0;
 
-  for (size_t i_idx = 0; i_idx < n_indices.size (); ++i_idx)
+  // The disambiguation below needs the neighbors sorted by distance, sort them if the search did not
+  std::vector<std::pair<float, size_t> > order;
+  for (size_t i_idx = 1; i_idx < n_sqr_distances.size (); ++i_idx)
+    if (n_sqr_distances[i_idx] < n_sqr_distances[i_idx - 1])
+    {
+      order.resize (n_sqr_distances.size ());
+      for (size_t k = 0; k < order.size (); ++k)
+        order[k] = std::make_pair (n_sqr_distances[k], k);
+      std::sort (order.begin (), order.end ());
+      break;
+    }
+
+  for (size_t k = 0; k < n_indices.size (); ++k)
   {
-    Eigen::Vector4f pt = surface_->points[n_indices[i_idx]].getVector4fMap ();
+    const size_t i_idx = order.empty () ? k : order[k].second;
+    Eigen::Vector4f pt = surface.points[n_indices[i_idx]].getVector4fMap ();
     if (pt.head<3> () == central_point.head<3> ())
 		  continue;
 
@@ -73,7 +99,7 @@ pcl::SHOTLocalReferenceFrameEstimation<PointInT, PointOutT>::getLocalRF (const i
     vij.row (valid_nn_points).matrix () = (pt - central_point).cast<double> ();
     vij (valid_nn_points, 3) = 0;
 
-    distance = search_parameter_ - sqrt (n_sqr_distances[i_idx]);
+    distance = radius - sqrt (n_sqr_distances[i_idx]);
 
     // Multiply vij * vij'
     cov_m += distance * (vij.row (valid_nn_points).head<3> ().transpose () * vij.row (valid_nn_points).head<3> ());
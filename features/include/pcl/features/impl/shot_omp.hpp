@@ -43,6 +43,9 @@
 #include <pcl/features/shot_omp.h>
 #include <pcl/common/time.h>
 #include <pcl/features/shot_lrf_omp.h>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 
 template<typename PointInT, typename PointNT, typename PointOutT, typename PointRFT> bool
 pcl::SHOTEstimationOMP<PointInT, PointNT, PointOutT, PointRFT>::initCompute ()
@@ -62,6 +65,27 @@ pcl::SHOTEstimationOMP<PointInT, PointNT, PointOutT, PointRFT>::initCompute ()
     return (false);
   }
 
+  descLength_ = nr_grid_sector_ * (nr_shape_bins_ + 1);
+
+  sqradius_ = search_radius_ * search_radius_;
+  radius3_4_ = (search_radius_ * 3) / 4;
+  radius1_4_ = search_radius_ / 4;
+  radius1_2_ = search_radius_ / 2;
+
+  // Fused mode: the frames are computed from the neighborhoods searched for the descriptors
+  lrf_fused_ = use_fused_lrf_ && frames_never_defined_ && (lrf_radius_ <= 0 || lrf_radius_ == search_radius_);
+  if (lrf_fused_)
+  {
+    // A new cloud, as the frames of a previous computation may still be referenced by the user
+    fused_frames_.reset (new PointCloudLRF);
+    fused_frames_->points.resize (indices_->size ());
+    fused_frames_->width = static_cast<uint32_t> (indices_->size ());
+    fused_frames_->height = 1;
+    fused_frames_->is_dense = true;
+    frames_ = fused_frames_;
+    return (true);
+  }
+
   // Default LRF estimation alg: SHOTLocalReferenceFrameEstimationOMP
   typename boost::shared_ptr<SHOTLocalReferenceFrameEstimationOMP<PointInT, PointRFT> > lrf_estimator(new SHOTLocalReferenceFrameEstimationOMP<PointInT, PointRFT>());
   lrf_estimator->setRadiusSearch ((lrf_radius_ > 0 ? lrf_radius_ : search_radius_));
@@ -120,73 +144,146 @@ pcl::SHOTColorEstimationOMP<PointInT, PointNT, PointOutT, PointRFT>::initCompute
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////////
-template<typename PointInT, typename PointNT, typename PointOutT, typename PointRFT> void
-pcl::SHOTEstimationOMP<PointInT, PointNT, PointOutT, PointRFT>::computeFeature (PointCloudOut &output)
+template<typename PointInT, typename PointNT, typename PointOutT, typename PointRFT> bool
+pcl::SHOTEstimationOMP<PointInT, PointNT, PointOutT, PointRFT>::computePointDescriptor (
+    int idx, std::vector<int> &nn_indices, std::vector<float> &nn_dists, Eigen::VectorXf &shot)
 {
-  descLength_ = nr_grid_sector_ * (nr_shape_bins_ + 1);
+  const int index = (*indices_)[idx];
+  if (!isFinite ((*input_)[index]))
+  {
+    if (lrf_fused_)
+      fused_frames_->points[idx].x_axis[0] = fused_frames_->points[idx].y_axis[0] =
+        fused_frames_->points[idx].z_axis[0] = std::numeric_limits<float>::quiet_NaN ();
+    return (false);
+  }
 
-  sqradius_ = search_radius_ * search_radius_;
-  radius3_4_ = (search_radius_ * 3) / 4;
-  radius1_4_ = search_radius_ / 4;
-  radius1_2_ = search_radius_ / 2;
+  if (lrf_fused_)
+  {
+    // One search for both the reference frame and the descriptor
+    this->searchForNeighbors (index, search_parameter_, nn_indices, nn_dists);
+
+    Eigen::Matrix3f rf;
+    PointRFT &current_frame = fused_frames_->points[idx];
+    if (SHOTLocalReferenceFrameEstimation<PointInT, PointRFT>::computeLocalRF (
+          *surface_, (*input_)[index].getVector4fMap (), search_radius_, nn_indices, nn_dists, rf) == std::numeric_limits<float>::max ())
+      fused_frames_->is_dense = false;
+    for (int d = 0; d < 3; ++d)
+    {
+      current_frame.x_axis[d] = rf.row (0)[d];
+      current_frame.y_axis[d] = rf.row (1)[d];
+      current_frame.z_axis[d] = rf.row (2)[d];
+    }
+  }
+
+  const PointRFT& current_frame = (*frames_)[idx];
+  if (!pcl_isfinite (current_frame.x_axis[0]) ||
+      !pcl_isfinite (current_frame.y_axis[0]) ||
+      !pcl_isfinite (current_frame.z_axis[0]))
+  {
+    PCL_WARN ("[pcl::%s::computeFeature] The local reference frame is not valid! Aborting description of point with index %d\n",
+      getClassName ().c_str (), index);
+    return (false);
+  }
+
+  if (!lrf_fused_ && this->searchForNeighbors (index, search_parameter_, nn_indices, nn_dists) == 0)
+    return (false);
+
+  // Estimate the SHOT at each patch
+  this->computePointSHOT (idx, nn_indices, nn_dists, shot);
+  return (true);
+}
 
+//////////////////////////////////////////////////////////////////////////////////////////////
+template<typename PointInT, typename PointNT, typename PointOutT, typename PointRFT> void
+pcl::SHOTEstimationOMP<PointInT, PointNT, PointOutT, PointRFT>::computeFeature (PointCloudOut &output)
+{
   assert(descLength_ == 352);
 
   int data_size = static_cast<int> (indices_->size ());
 
   output.is_dense = true;
-  // Iterating over the entire index vector
 #ifdef _OPENMP
-#pragma omp parallel for num_threads(threads_)
+  const int threads = threads_ == 0 ? omp_get_num_procs () : static_cast<int> (threads_);
+#pragma omp parallel num_threads (threads)
 #endif
-  for (int idx = 0; idx < data_size; ++idx)
   {
+    // Per thread buffers, reused for all the points of the thread
+    Eigen::VectorXf shot (descLength_);
+    std::vector<int> nn_indices;
+    std::vector<float> nn_dists;
 
-    Eigen::VectorXf shot;
-    shot.setZero (descLength_);
-
-    bool lrf_is_nan = false;
-    const PointRFT& current_frame = (*frames_)[idx];
-    if (!pcl_isfinite (current_frame.x_axis[0]) ||
-        !pcl_isfinite (current_frame.y_axis[0]) ||
-        !pcl_isfinite (current_frame.z_axis[0]))
+    // Iterating over the entire index vector
+#ifdef _OPENMP
+#pragma omp for schedule (dynamic, 64)
+#endif
+    for (int idx = 0; idx < data_size; ++idx)
     {
-      PCL_WARN ("[pcl::%s::computeFeature] The local reference frame is not valid! Aborting description of point with index %d\n",
-        getClassName ().c_str (), (*indices_)[idx]);
-      lrf_is_nan = true;
-    }
-
-    // Allocate enough space to hold the results
-    // \note This resize is irrelevant for a radiusSearch ().
-    std::vector<int> nn_indices (k_);
-    std::vector<float> nn_dists (k_);
+      if (!computePointDescriptor (idx, nn_indices, nn_dists, shot))
+      {
+        // Copy into the resultant cloud
+        for (int d = 0; d < descLength_; ++d)
+          output.points[idx].descriptor[d] = std::numeric_limits<float>::quiet_NaN ();
+        for (int d = 0; d < 9; ++d)
+          output.points[idx].rf[d] = std::numeric_limits<float>::quiet_NaN ();
+
+        output.is_dense = false;
+        continue;
+      }
 
-    if (!isFinite ((*input_)[(*indices_)[idx]]) || lrf_is_nan || this->searchForNeighbors ((*indices_)[idx], search_parameter_, nn_indices,
-                                                                                           nn_dists) == 0)
-    {
       // Copy into the resultant cloud
       for (int d = 0; d < shot.size (); ++d)
-        output.points[idx].descriptor[d] = std::numeric_limits<float>::quiet_NaN ();
-      for (int d = 0; d < 9; ++d)
-        output.points[idx].rf[d] = std::numeric_limits<float>::quiet_NaN ();
-
-      output.is_dense = false;
-      continue;
+        output.points[idx].descriptor[d] = shot[d];
+      for (int d = 0; d < 3; ++d)
+      {
+        output.points[idx].rf[d + 0] = frames_->points[idx].x_axis[d];
+        output.points[idx].rf[d + 3] = frames_->points[idx].y_axis[d];
+        output.points[idx].rf[d + 6] = frames_->points[idx].z_axis[d];
+      }
     }
+  }
+}
 
-    // Estimate the SHOT at each patch
-    this->computePointSHOT (idx, nn_indices, nn_dists, shot);
+//////////////////////////////////////////////////////////////////////////////////////////////
+template<typename PointInT, typename PointNT, typename PointOutT, typename PointRFT> bool
+pcl::SHOTEstimationOMP<PointInT, PointNT, PointOutT, PointRFT>::computeDescriptorMatrix (DescriptorMatrix &descriptors,
+                                                                                         size_t &stride)
+{
+  if (!initCompute ())
+  {
+    descriptors.clear ();
+    stride = 0;
+    return (false);
+  }
 
-    // Copy into the resultant cloud
-    for (int d = 0; d < shot.size (); ++d)
-      output.points[idx].descriptor[d] = shot[d];
-    for (int d = 0; d < 3; ++d)
+  // Round the rows up to 4 floats, so that each of them starts at a 16 byte boundary
+  stride = (static_cast<size_t> (descLength_) + 3) & ~static_cast<size_t> (3);
+  descriptors.assign (indices_->size () * stride, 0.0f);
+
+  int data_size = static_cast<int> (indices_->size ());
+#ifdef _OPENMP
+  const int threads = threads_ == 0 ? omp_get_num_procs () : static_cast<int> (threads_);
+#pragma omp parallel num_threads (threads)
+#endif
+  {
+    Eigen::VectorXf shot (descLength_);
+    std::vector<int> nn_indices;
+    std::vector<float> nn_dists;
+
+#ifdef _OPENMP
+#pragma omp for schedule (dynamic, 64)
+#endif
+    for (int idx = 0; idx < data_size; ++idx)
     {
-      output.points[idx].rf[d + 0] = frames_->points[idx].x_axis[d];
-      output.points[idx].rf[d + 3] = frames_->points[idx].y_axis[d];
-      output.points[idx].rf[d + 6] = frames_->points[idx].z_axis[d];
+      float *row = &descriptors[static_cast<size_t> (idx) * stride];
+      if (computePointDescriptor (idx, nn_indices, nn_dists, shot))
+        Eigen::Map<Eigen::VectorXf> (row, descLength_) = shot;
+      else
+        std::fill (row, row + descLength_, std::numeric_limits<float>::quiet_NaN ());
     }
   }
+
+  this->deinitCompute ();
+  return (true);
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////////
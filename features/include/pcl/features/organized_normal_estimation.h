@@ -0,0 +1,270 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2012-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#ifndef PCL_FEATURES_ORGANIZED_NORMAL_ESTIMATION_H_
+#define PCL_FEATURES_ORGANIZED_NORMAL_ESTIMATION_H_
+
+#include <pcl/point_cloud.h>
+#include <pcl/point_types.h>
+#include <pcl/features/feature.h>
+
+namespace pcl
+{
+  /** \brief OrganizedNormalEstimation estimates surface normals and curvatures on organized point clouds
+    * from the covariance matrix of a rectangular pixel neighborhood around each point, like
+    * NormalEstimation does for the neighbors found by a search.
+    *
+    * The neighborhood sums are computed with separable running box sums, so the cost per point does not
+    * depend on the rectangle size. Unlike the float integral images of IntegralImageNormalEstimation, the
+    * sums are accumulated in double precision relative to a local origin per tile, which keeps the
+    * covariance accurate for points far away from the sensor. The rectangle is clipped at the image
+    * borders, so border points get normals from their remaining neighbors. Invalid (NaN) points are
+    * skipped, and points with less than three valid neighbors get NaN normals.
+    *
+    * The image is processed in fixed size tiles, in parallel if more than one thread is used. The result
+    * does not depend on the number of threads.
+    *
+    * \note The output is computed for the whole cloud; if indices are given, the normals of the
+    * indexed points are copied out of it.
+    * \ingroup features
+    */
+  template <typename PointInT, typename PointOutT>
+  class OrganizedNormalEstimation : public Feature<PointInT, PointOutT>
+  {
+    public:
+      typedef boost::shared_ptr<OrganizedNormalEstimation<PointInT, PointOutT> > Ptr;
+      typedef boost::shared_ptr<const OrganizedNormalEstimation<PointInT, PointOutT> > ConstPtr;
+      typedef typename Feature<PointInT, PointOutT>::PointCloudIn  PointCloudIn;
+      typedef typename Feature<PointInT, PointOutT>::PointCloudOut PointCloudOut;
+
+      using Feature<PointInT, PointOutT>::input_;
+      using Feature<PointInT, PointOutT>::indices_;
+      using Feature<PointInT, PointOutT>::feature_name_;
+      using Feature<PointInT, PointOutT>::getClassName;
+      using Feature<PointInT, PointOutT>::tree_;
+      using Feature<PointInT, PointOutT>::k_;
+
+      /** \brief Constructor.
+        * \param[in] nr_threads the number of hardware threads to use (0 sets the value back to automatic)
+        */
+      OrganizedNormalEstimation (unsigned int nr_threads = 0)
+        : rect_width_2_ (2)
+        , rect_height_2_ (2)
+        , vpx_ (0.0f)
+        , vpy_ (0.0f)
+        , vpz_ (0.0f)
+        , use_sensor_origin_ (true)
+        , threads_ (nr_threads)
+      {
+        feature_name_ = "OrganizedNormalEstimation";
+        tree_.reset ();
+        k_ = 1;
+      }
+
+      /** \brief Set the size of the pixel rectangle centered at each point that is used for its normal.
+        * Even sizes are rounded up to the next odd size. Defaults to 5 x 5.
+        * \param[in] width the width of the rectangle, in pixels
+        * \param[in] height the height of the rectangle, in pixels
+        */
+      inline void
+      setRectSize (int width, int height)
+      {
+        rect_width_2_ = width > 0 ? width / 2 : 0;
+        rect_height_2_ = height > 0 ? height / 2 : 0;
+      }
+
+      /** \brief Get the size of the pixel rectangle centered at each point that is used for its normal.
+        * \param[out] width the width of the rectangle, in pixels
+        * \param[out] height the height of the rectangle, in pixels
+        */
+      inline void
+      getRectSize (int &width, int &height) const
+      {
+        width = 2 * rect_width_2_ + 1;
+        height = 2 * rect_height_2_ + 1;
+      }
+
+      /** \brief Provide a pointer to the input dataset (overwrites the PCLBase::setInputCloud method).
+        * \param[in] cloud the const boost shared pointer to a PointCloud message
+        */
+      virtual inline void
+      setInputCloud (const typename PointCloudIn::ConstPtr &cloud)
+      {
+        input_ = cloud;
+        if (use_sensor_origin_)
+        {
+          vpx_ = input_->sensor_origin_.coeff (0);
+          vpy_ = input_->sensor_origin_.coeff (1);
+          vpz_ = input_->sensor_origin_.coeff (2);
+        }
+      }
+
+      /** \brief Set the viewpoint.
+        * \param[in] vpx the X coordinate of the viewpoint
+        * \param[in] vpy the Y coordinate of the viewpoint
+        * \param[in] vpz the Z coordinate of the viewpoint
+        */
+      inline void
+      setViewPoint (float vpx, float vpy, float vpz)
+      {
+        vpx_ = vpx;
+        vpy_ = vpy;
+        vpz_ = vpz;
+        use_sensor_origin_ = false;
+      }
+
+      /** \brief Get the viewpoint.
+        * \param[out] vpx x-coordinate of the view point
+        * \param[out] vpy y-coordinate of the view point
+        * \param[out] vpz z-coordinate of the view point
+        */
+      inline void
+      getViewPoint (float &vpx, float &vpy, float &vpz) const
+      {
+        vpx = vpx_;
+        vpy = vpy_;
+        vpz = vpz_;
+      }
+
+      /** \brief Use the sensor origin of the input cloud as the viewpoint, instead of a viewpoint
+        * given with setViewPoint ().
+        */
+      inline void
+      useSensorOriginAsViewPoint ()
+      {
+        use_sensor_origin_ = true;
+        if (input_)
+        {
+          vpx_ = input_->sensor_origin_.coeff (0);
+          vpy_ = input_->sensor_origin_.coeff (1);
+          vpz_ = input_->sensor_origin_.coeff (2);
+        }
+        else
+        {
+          vpx_ = 0;
+          vpy_ = 0;
+          vpz_ = 0;
+        }
+      }
+
+      /** \brief Set the number of threads to use.
+        * \param[in] nr_threads the number of hardware threads to use (0 sets the value back to automatic)
+        */
+      inline void
+      setNumberOfThreads (unsigned int nr_threads = 0) { threads_ = nr_threads; }
+
+    protected:
+      /** \brief Number of image rows in a tile. */
+      static const int TILE_HEIGHT = 32;
+
+      /** \brief Number of image columns in a tile. */
+      static const int TILE_WIDTH = 64;
+
+      /** \brief Zeroth, first and second order moments of a set of points, relative to a local origin. */
+      struct Moments
+      {
+        double n, x, y, z, xx, xy, xz, yy, yz, zz;
+
+        inline void
+        clear ()
+        {
+          n = x = y = z = xx = xy = xz = yy = yz = zz = 0;
+        }
+
+        inline void
+        add (const Moments &m)
+        {
+          n += m.n; x += m.x; y += m.y; z += m.z;
+          xx += m.xx; xy += m.xy; xz += m.xz; yy += m.yy; yz += m.yz; zz += m.zz;
+        }
+
+        inline void
+        subtract (const Moments &m)
+        {
+          n -= m.n; x -= m.x; y -= m.y; z -= m.z;
+          xx -= m.xx; xy -= m.xy; xz -= m.xz; yy -= m.yy; yz -= m.yz; zz -= m.zz;
+        }
+      };
+
+      /** \brief Check that the input is organized, without creating a search method.
+        * \return true if the normals can be computed
+        */
+      virtual bool
+      initCompute ();
+
+      /** \brief Compute the normals of one tile of the image.
+        * \param[in] x0 the first column of the tile
+        * \param[in] y0 the first row of the tile
+        * \param[in] x1 one past the last column of the tile
+        * \param[in] y1 one past the last row of the tile
+        * \param[out] output the organized output cloud
+        * \return true if all the normals of the tile are finite
+        */
+      bool
+      computeTile (int x0, int y0, int x1, int y1, PointCloudOut &output) const;
+
+      /** \brief Estimate normals for all points given in <setInputCloud (), setIndices ()>.
+        * \param[out] output the resultant point cloud model dataset that contains surface normals and curvatures
+        */
+      void
+      computeFeature (PointCloudOut &output);
+
+      /** \brief Half of the width of the neighborhood rectangle. */
+      int rect_width_2_;
+
+      /** \brief Half of the height of the neighborhood rectangle. */
+      int rect_height_2_;
+
+      /** \brief Values describing the viewpoint ("pinhole" camera model assumed). By default, the viewpoint is set to 0,0,0. */
+      float vpx_, vpy_, vpz_;
+
+      /** \brief Whether the sensor origin of the input cloud or a user given viewpoint should be used. */
+      bool use_sensor_origin_;
+
+      /** \brief The number of threads the scheduler should use. */
+      unsigned int threads_;
+
+    public:
+      EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+  };
+}
+
+#ifdef PCL_NO_PRECOMPILE
+#include <pcl/features/impl/organized_normal_estimation.hpp>
+#endif
+
+#endif  //#ifndef PCL_FEATURES_ORGANIZED_NORMAL_ESTIMATION_H_
@@ -77,6 +77,23 @@ namespace pcl
       /** \brief Empty destructor */
       virtual ~SHOTLocalReferenceFrameEstimation () {}
 
+      /** \brief Computes the disambiguated local RF of a point from a neighborhood which was already searched for.
+        * \param[in] surface the cloud which the neighbors are taken from
+        * \param[in] central_point the point to compute the RF of
+        * \param[in] radius the radius of the neighborhood
+        * \param[in] n_indices the indices of the neighbors in \a surface, in any order
+        * \param[in] n_sqr_distances the squared distances of the neighbors to \a central_point
+        * \param[out] rf reference frame to compute
+        * \return 0, or std::numeric_limits<float>::max () if the neighborhood is too small and \a rf is set to NaN
+        */
+      static float
+      computeLocalRF (const pcl::PointCloud<PointInT> &surface,
+                      const Eigen::Vector4f &central_point,
+                      double radius,
+                      const std::vector<int> &n_indices,
+                      const std::vector<float> &n_sqr_distances,
+                      Eigen::Matrix3f &rf);
+
     protected:
       using Feature<PointInT, PointOutT>::feature_name_;
       using Feature<PointInT, PointOutT>::getClassName;
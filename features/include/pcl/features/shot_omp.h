@@ -82,7 +82,9 @@ namespace pcl
       using Feature<PointInT, PointOutT>::surface_;
       using Feature<PointInT, PointOutT>::fake_surface_;
       using FeatureFromNormals<PointInT, PointNT, PointOutT>::normals_;
+      using Feature<PointInT, PointOutT>::tree_;
       using FeatureWithLocalReferenceFrames<PointInT, PointRFT>::frames_;
+      using FeatureWithLocalReferenceFrames<PointInT, PointRFT>::frames_never_defined_;
       using SHOTEstimationBase<PointInT, PointNT, PointOutT, PointRFT>::lrf_radius_;
       using SHOTEstimation<PointInT, PointNT, PointOutT, PointRFT>::descLength_;
       using SHOTEstimation<PointInT, PointNT, PointOutT, PointRFT>::nr_grid_sector_;
@@ -94,9 +96,14 @@ namespace pcl
 
       typedef typename Feature<PointInT, PointOutT>::PointCloudOut PointCloudOut;
       typedef typename Feature<PointInT, PointOutT>::PointCloudIn PointCloudIn;
+      typedef typename FeatureWithLocalReferenceFrames<PointInT, PointRFT>::PointCloudLRF PointCloudLRF;
+
+      /** \brief Row major descriptor matrix, see computeDescriptorMatrix (). */
+      typedef std::vector<float, Eigen::aligned_allocator<float> > DescriptorMatrix;
 
       /** \brief Empty constructor. */
-      SHOTEstimationOMP (unsigned int nr_threads = 0) : SHOTEstimation<PointInT, PointNT, PointOutT, PointRFT> (), threads_ (nr_threads)
+      SHOTEstimationOMP (unsigned int nr_threads = 0) : SHOTEstimation<PointInT, PointNT, PointOutT, PointRFT> (), threads_ (nr_threads),
+                                                        use_fused_lrf_ (false), lrf_fused_ (false), fused_frames_ ()
       { };
       /** \brief Initialize the scheduler and set the number of threads to use.
         * \param nr_threads the number of hardware threads to use (0 sets the value back to automatic)
@@ -104,6 +111,36 @@ namespace pcl
       inline void
       setNumberOfThreads (unsigned int nr_threads = 0) { threads_ = nr_threads; }
 
+      /** \brief Set whether the local reference frames are computed together with the descriptors.
+        * The default estimation searches the neighborhood of each point once for its reference frame and once
+        * more for its descriptor. In fused mode, the reference frame is computed from the neighborhood of the
+        * descriptor, so there is a single radius search per point. The reference frames are the same, and they
+        * are available from getInputReferenceFrames () after the computation.
+        * \note The fused mode only applies when no reference frames were given with setInputReferenceFrames (),
+        * and when the LRF radius is the search radius. It sorts the results of the search method.
+        * \param[in] use_fused_lrf true to compute the reference frames with the descriptors (default: false)
+        */
+      inline void
+      setUseFusedLRF (bool use_fused_lrf) { use_fused_lrf_ = use_fused_lrf; }
+
+      /** \brief Get whether the local reference frames are computed together with the descriptors. */
+      inline bool
+      getUseFusedLRF () const { return (use_fused_lrf_); }
+
+      /** \brief Estimate the SHOT descriptors at the points given by <setInputCloud (), setIndices ()> into a
+        * row major matrix of floats, which can be handed to FLANN without copying:
+        * \code
+        * flann::Matrix<float> dataset (&descriptors[0], nr_points, 352, stride * sizeof (float));
+        * \endcode
+        * Each row holds the 352 values of a descriptor, or NaN values for the points which can not be described.
+        * The rows are padded to a multiple of 4 floats, so that all of them start at a 16 byte boundary.
+        * \param[out] descriptors the descriptors, one row per point
+        * \param[out] stride the number of floats from the start of a row to the start of the next one
+        * \return false if the estimation could not be initialized
+        */
+      bool
+      computeDescriptorMatrix (DescriptorMatrix &descriptors, size_t &stride);
+
     protected:
 
       /** \brief Estimate the Signatures of Histograms of OrienTations (SHOT) descriptors at a set of points given by
@@ -118,8 +155,30 @@ namespace pcl
       bool
       initCompute ();
 
+      /** \brief Estimate the SHOT descriptor of a point, and its reference frame first in fused mode.
+        * \param[in] idx the index of the point in indices_
+        * \param[out] nn_indices scratch buffer for the indices of the neighbors
+        * \param[out] nn_dists scratch buffer for the squared distances of the neighbors
+        * \param[out] shot the descriptor, of descLength_ values
+        * \return false if the point can not be described, in which case \a shot is not set
+        */
+      bool
+      computePointDescriptor (int idx,
+                              std::vector<int> &nn_indices,
+                              std::vector<float> &nn_dists,
+                              Eigen::VectorXf &shot);
+
       /** \brief The number of threads the scheduler should use. */
       unsigned int threads_;
+
+      /** \brief Whether the local reference frames should be computed with the descriptors. */
+      bool use_fused_lrf_;
+
+      /** \brief Whether the local reference frames are computed with the descriptors by the current computation. */
+      bool lrf_fused_;
+
+      /** \brief The reference frames filled in by the current computation in fused mode. */
+      typename PointCloudLRF::Ptr fused_frames_;
   };
 
   /** \brief SHOTColorEstimationOMP estimates the Signature of Histograms of OrienTations (SHOT) descriptor for a given point cloud dataset
@@ -42,6 +42,12 @@
 
 #include <pcl/filters/radius_outlier_removal.h>
 #include <pcl/common/io.h>
+#include <algorithm>
+#include <limits>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointT> void
@@ -80,22 +86,62 @@ pcl::RadiusOutlierRemoval<PointT>::applyFilterIndices (std::vector<int> &indices
     return;
   }
 
+  std::vector<char> has_neighbors (indices_->size ());
+  if (use_voxel_counting_)
+    countNeighborsInVoxels (has_neighbors);
+  else
+    searchNeighbors (has_neighbors);
+
+  indices.resize (indices_->size ());
+  removed_indices_->resize (indices_->size ());
+  int oii = 0, rii = 0;  // oii = output indices iterator, rii = removed indices iterator
+
+  for (int iii = 0; iii < static_cast<int> (indices_->size ()); ++iii)  // iii = input indices iterator
+  {
+    // Points having too few neighbors are outliers and are passed to removed indices
+    // Unless negative was set, then it's the opposite condition
+    if (!has_neighbors[iii] != negative_)
+    {
+      if (extract_removed_indices_)
+        (*removed_indices_)[rii++] = (*indices_)[iii];
+      continue;
+    }
+
+    // Otherwise it was a normal point for output (inlier)
+    indices[oii++] = (*indices_)[iii];
+  }
+
+  // Resize the output arrays
+  indices.resize (oii);
+  removed_indices_->resize (rii);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> void
+pcl::RadiusOutlierRemoval<PointT>::searchNeighbors (std::vector<char> &has_neighbors)
+{
   // Initialize the search class
   if (!searcher_)
   {
     if (input_->isOrganized ())
       searcher_.reset (new pcl::search::OrganizedNeighbor<PointT> ());
     else
-      searcher_.reset (new pcl::search::KdTree<PointT> (false));
+    {
+      pcl::search::KdTree<PointT> *tree = new pcl::search::KdTree<PointT> (false);
+      tree->setEpsilon (search_epsilon_);
+      searcher_.reset (tree);
+    }
   }
   searcher_->setInputCloud (input_);
 
-  // The arrays to be used
-  std::vector<int> nn_indices (indices_->size ());
-  std::vector<float> nn_dists (indices_->size ());
-  indices.resize (indices_->size ());
-  removed_indices_->resize (indices_->size ());
-  int oii = 0, rii = 0;  // oii = output indices iterator, rii = removed indices iterator
+#ifdef _OPENMP
+  const int threads = threads_ == 0 ? omp_get_num_procs () : static_cast<int> (threads_);
+#endif
+  const int nr_indices = static_cast<int> (indices_->size ());
+
+  // The arrays to be used, one copy per thread
+  std::vector<int> nn_indices (min_pts_radius_ + 1);
+  std::vector<float> nn_dists (min_pts_radius_ + 1);
 
   // If the data is dense => use nearest-k search
   if (input_->is_dense)
@@ -104,80 +150,175 @@ pcl::RadiusOutlierRemoval<PointT>::applyFilterIndices (std::vector<int> &indices
     int mean_k = min_pts_radius_ + 1;
     double nn_dists_max = search_radius_ * search_radius_;
 
-    for (std::vector<int>::const_iterator it = indices_->begin (); it != indices_->end (); ++it)
+#ifdef _OPENMP
+#pragma omp parallel for firstprivate (nn_indices, nn_dists) num_threads (threads) schedule (dynamic, 256)
+#endif
+    for (int iii = 0; iii < nr_indices; ++iii)
     {
       // Perform the nearest-k search
-      int k = searcher_->nearestKSearch (*it, mean_k, nn_indices, nn_dists);
+      int k = searcher_->nearestKSearch ((*indices_)[iii], mean_k, nn_indices, nn_dists);
 
       // Check the number of neighbors
       // Note: nn_dists is sorted, so check the last item
-      bool chk_neighbors = true;
-      if (k == mean_k)
-      {
-        if (negative_)
-        {
-          chk_neighbors = false;
-          if (nn_dists_max < nn_dists[k-1])
-          {
-            chk_neighbors = true;
-          }
-        }
-        else
-        {
-          chk_neighbors = true;
-          if (nn_dists_max < nn_dists[k-1])
-          {
-            chk_neighbors = false;
-          }
-        }
-      }
-      else
-      {
-        if (negative_)
-          chk_neighbors = true;
-        else
-          chk_neighbors = false;
-      }
-
-      // Points having too few neighbors are outliers and are passed to removed indices
-      // Unless negative was set, then it's the opposite condition
-      if (!chk_neighbors)
+      has_neighbors[iii] = (k == mean_k && nn_dists[k-1] <= nn_dists_max);
+    }
+  }
+  // NaN or Inf values could exist => use radius search
+  else
+  {
+#ifdef _OPENMP
+#pragma omp parallel for firstprivate (nn_indices, nn_dists) num_threads (threads) schedule (dynamic, 256)
+#endif
+    for (int iii = 0; iii < nr_indices; ++iii)
+    {
+      // Invalid points have no neighbors
+      const PointT &query = input_->points[(*indices_)[iii]];
+      if (!pcl_isfinite (query.x) || !pcl_isfinite (query.y) || !pcl_isfinite (query.z))
       {
-        if (extract_removed_indices_)
-          (*removed_indices_)[rii++] = *it;
+        has_neighbors[iii] = false;
         continue;
       }
 
-      // Otherwise it was a normal point for output (inlier)
-      indices[oii++] = *it;
+      // Perform the radius search, it can stop as soon as enough neighbors are found
+      // Note: k includes the query point, so is always at least 1
+      int k = searcher_->radiusSearch ((*indices_)[iii], search_radius_, nn_indices, nn_dists, min_pts_radius_ + 1);
+      has_neighbors[iii] = (k > min_pts_radius_);
     }
   }
-  // NaN or Inf values could exist => use radius search
-  else
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> void
+pcl::RadiusOutlierRemoval<PointT>::countNeighborsInVoxels (std::vector<char> &has_neighbors)
+{
+#ifdef _OPENMP
+  const int threads = threads_ == 0 ? omp_get_num_procs () : static_cast<int> (threads_);
+#endif
+  const int nr_points = static_cast<int> (input_->points.size ());
+  const int nr_indices = static_cast<int> (indices_->size ());
+
+  // The diagonal of a voxel is (slightly less than) the radius, so all points of a voxel are neighbors. Neighbors are
+  // then at most two voxels apart along each axis.
+  const double inverse_voxel_size = std::sqrt (3.0) / (search_radius_ * (1.0 - 1e-5));
+  const double sqr_radius = search_radius_ * search_radius_;
+
+  Eigen::Vector3d min_p = Eigen::Vector3d::Constant (std::numeric_limits<double>::max ());
+  Eigen::Vector3d max_p = Eigen::Vector3d::Constant (-std::numeric_limits<double>::max ());
+  for (int i = 0; i < nr_points; ++i)
+  {
+    const PointT &point = input_->points[i];
+    if (!pcl_isfinite (point.x) || !pcl_isfinite (point.y) || !pcl_isfinite (point.z))
+      continue;
+    const Eigen::Vector3d p (point.x, point.y, point.z);
+    min_p = min_p.cwiseMin (p);
+    max_p = max_p.cwiseMax (p);
+  }
+
+  // Voxel coordinates are shifted by two voxels and the grid is padded by two voxels on each side, so that the keys
+  // of the neighbors of a voxel never wrap around into another row of the grid
+  const Eigen::Vector3d grid_min = (min_p * inverse_voxel_size).array ().floor () - 2.0;
+  Eigen::Vector3d grid_size = (max_p * inverse_voxel_size).array ().floor () - grid_min.array () + 3.0;
+  grid_size = grid_size.cwiseMax (Eigen::Vector3d::Ones ());
+  if (grid_size.prod () > static_cast<double> (std::numeric_limits<int64_t>::max () / 2))
+  {
+    PCL_WARN ("[pcl::%s::applyFilter] Radius (%f) too small for the extent of the cloud, searching the neighbors instead.\n", getClassName ().c_str (), search_radius_);
+    searchNeighbors (has_neighbors);
+    return;
+  }
+  const int64_t stride_y = static_cast<int64_t> (grid_size[0]);
+  const int64_t stride_z = stride_y * static_cast<int64_t> (grid_size[1]);
+
+  // Sort all the points of the cloud by voxel, invalid points are sorted last and are nobody's neighbors
+  const int64_t invalid_key = std::numeric_limits<int64_t>::max ();
+  std::vector<std::pair<int64_t, int> > keys (nr_points);
+#ifdef _OPENMP
+#pragma omp parallel for num_threads (threads) schedule (static)
+#endif
+  for (int i = 0; i < nr_points; ++i)
   {
-    for (std::vector<int>::const_iterator it = indices_->begin (); it != indices_->end (); ++it)
+    const PointT &point = input_->points[i];
+    keys[i].second = i;
+    if (!pcl_isfinite (point.x) || !pcl_isfinite (point.y) || !pcl_isfinite (point.z))
     {
-      // Perform the radius search
-      // Note: k includes the query point, so is always at least 1
-      int k = searcher_->radiusSearch (*it, search_radius_, nn_indices, nn_dists);
+      keys[i].first = invalid_key;
+      continue;
+    }
+    const Eigen::Vector3d ijk = (Eigen::Vector3d (point.x, point.y, point.z) * inverse_voxel_size).array ().floor () - grid_min.array ();
+    keys[i].first = static_cast<int64_t> (ijk[0]) + static_cast<int64_t> (ijk[1]) * stride_y + static_cast<int64_t> (ijk[2]) * stride_z;
+  }
+  std::sort (keys.begin (), keys.end ());
 
-      // Points having too few neighbors are outliers and are passed to removed indices
-      // Unless negative was set, then it's the opposite condition
-      if ((!negative_ && k <= min_pts_radius_) || (negative_ && k > min_pts_radius_))
+  // One voxel per run of equal keys
+  std::vector<int64_t> voxel_keys;
+  std::vector<int> voxel_begin;
+  for (int k = 0; k < nr_points && keys[k].first != invalid_key; ++k)
+  {
+    if (voxel_keys.empty () || voxel_keys.back () != keys[k].first)
+    {
+      voxel_keys.push_back (keys[k].first);
+      voxel_begin.push_back (k);
+    }
+  }
+  voxel_begin.push_back (static_cast<int> (std::lower_bound (keys.begin (), keys.end (), std::make_pair (invalid_key, 0)) - keys.begin ()));
+
+#ifdef _OPENMP
+#pragma omp parallel for num_threads (threads) schedule (dynamic, 256)
+#endif
+  for (int iii = 0; iii < nr_indices; ++iii)
+  {
+    const PointT &query = input_->points[(*indices_)[iii]];
+    has_neighbors[iii] = false;
+    if (!pcl_isfinite (query.x) || !pcl_isfinite (query.y) || !pcl_isfinite (query.z))
+      continue;
+
+    const Eigen::Vector3d ijk = (Eigen::Vector3d (query.x, query.y, query.z) * inverse_voxel_size).array ().floor () - grid_min.array ();
+    const int64_t key = static_cast<int64_t> (ijk[0]) + static_cast<int64_t> (ijk[1]) * stride_y + static_cast<int64_t> (ijk[2]) * stride_z;
+
+    // Note: the voxel of the query includes the query point, like the searches do
+    const int own = static_cast<int> (std::lower_bound (voxel_keys.begin (), voxel_keys.end (), key) - voxel_keys.begin ());
+    if (voxel_begin[own + 1] - voxel_begin[own] > min_pts_radius_)
+    {
+      has_neighbors[iii] = true;
+      continue;
+    }
+
+    // The neighboring voxels of each row along x are consecutive in voxel_keys, they are collected as ranges of points
+    int ranges[25][2];
+    int nr_ranges = 0, nr_candidates = 0;
+    for (int dz = -2; dz <= 2; ++dz)
+    {
+      for (int dy = -2; dy <= 2; ++dy)
       {
-        if (extract_removed_indices_)
-          (*removed_indices_)[rii++] = *it;
-        continue;
+        const int64_t row_key = key + dy * stride_y + dz * stride_z;
+        const int first = static_cast<int> (std::lower_bound (voxel_keys.begin (), voxel_keys.end (), row_key - 2) - voxel_keys.begin ());
+        const int last = static_cast<int> (std::upper_bound (voxel_keys.begin () + first, voxel_keys.end (), row_key + 2) - voxel_keys.begin ());
+        if (first == last)
+          continue;
+        ranges[nr_ranges][0] = voxel_begin[first];
+        ranges[nr_ranges][1] = voxel_begin[last];
+        nr_candidates += voxel_begin[last] - voxel_begin[first];
+        ++nr_ranges;
       }
+    }
+    if (nr_candidates <= min_pts_radius_)
+      continue;
 
-      // Otherwise it was a normal point for output (inlier)
-      indices[oii++] = *it;
+    // Count the neighbors until there are enough of them
+    int nr_neighbors = 0;
+    for (int r = 0; r < nr_ranges && nr_neighbors <= min_pts_radius_; ++r)
+    {
+      for (int k = ranges[r][0]; k < ranges[r][1]; ++k)
+      {
+        const PointT &point = input_->points[keys[k].second];
+        const double dx = static_cast<double> (point.x) - query.x;
+        const double dy = static_cast<double> (point.y) - query.y;
+        const double dz = static_cast<double> (point.z) - query.z;
+        if (dx * dx + dy * dy + dz * dz <= sqr_radius && ++nr_neighbors > min_pts_radius_)
+          break;
+      }
     }
+    has_neighbors[iii] = (nr_neighbors > min_pts_radius_);
   }
-
-  // Resize the output arrays
-  indices.resize (oii);
-  removed_indices_->resize (rii);
 }
 
 #define PCL_INSTANTIATE_RadiusOutlierRemoval(T) template class PCL_EXPORTS pcl::RadiusOutlierRemoval<T>;
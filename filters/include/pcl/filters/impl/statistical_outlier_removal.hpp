@@ -43,6 +43,10 @@
 #include <pcl/filters/statistical_outlier_removal.h>
 #include <pcl/common/io.h>
 
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointT> void
 pcl::StatisticalOutlierRemoval<PointT>::applyFilter (PointCloud &output)
@@ -78,11 +82,19 @@ pcl::StatisticalOutlierRemoval<PointT>::applyFilterIndices (std::vector<int> &in
     if (input_->isOrganized ())
       searcher_.reset (new pcl::search::OrganizedNeighbor<PointT> ());
     else
-      searcher_.reset (new pcl::search::KdTree<PointT> (false));
+    {
+      pcl::search::KdTree<PointT> *tree = new pcl::search::KdTree<PointT> (false);
+      tree->setEpsilon (search_epsilon_);
+      searcher_.reset (tree);
+    }
   }
   searcher_->setInputCloud (input_);
 
-  // The arrays to be used
+#ifdef _OPENMP
+  const int threads = threads_ == 0 ? omp_get_num_procs () : static_cast<int> (threads_);
+#endif
+
+  // The arrays to be used, the neighbor arrays are copied for each thread
   std::vector<int> nn_indices (mean_k_);
   std::vector<float> nn_dists (mean_k_);
   std::vector<float> distances (indices_->size ());
@@ -92,6 +104,9 @@ pcl::StatisticalOutlierRemoval<PointT>::applyFilterIndices (std::vector<int> &in
 
   // First pass: Compute the mean distances for all points with respect to their k nearest neighbors
   int valid_distances = 0;
+#ifdef _OPENMP
+#pragma omp parallel for firstprivate (nn_indices, nn_dists) reduction (+:valid_distances) num_threads (threads) schedule (dynamic, 256)
+#endif
   for (int iii = 0; iii < static_cast<int> (indices_->size ()); ++iii)  // iii = input indices iterator
   {
     if (!pcl_isfinite (input_->points[(*indices_)[iii]].x) ||
@@ -206,7 +206,11 @@ struct cloud_point_index_idx
   unsigned int cloud_point_index;
 
   cloud_point_index_idx (unsigned int idx_, unsigned int cloud_point_index_) : idx (idx_), cloud_point_index (cloud_point_index_) {}
-  bool operator < (const cloud_point_index_idx &p) const { return (idx < p.idx); }
+  // Ties are broken on the point index, so that the centroids are always accumulated in the same order
+  bool operator < (const cloud_point_index_idx &p) const
+  {
+    return (idx < p.idx || (idx == p.idx && cloud_point_index < p.cloud_point_index));
+  }
 };
 
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////
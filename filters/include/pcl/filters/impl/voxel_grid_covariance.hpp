@@ -43,6 +43,12 @@
 #include <pcl/filters/voxel_grid_covariance.h>
 #include <Eigen/Dense>
 #include <Eigen/Cholesky>
+#include <algorithm>
+#include <fstream>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 
 //////////////////////////////////////////////////////////////////////////////////////////
 template<typename PointT> void
@@ -97,6 +103,8 @@ pcl::VoxelGridCovariance<PointT>::applyFilter (PointCloud &output)
 
   // Clear the leaves
   leaves_.clear ();
+  leaf_voxel_indices_.clear ();
+  leaf_table_.clear ();
 
   // Set up the division multiplier
   divb_mul_ = Eigen::Vector4i (1, div_b_[0], div_b_[0] * div_b_[1], 0);
@@ -119,6 +127,7 @@ pcl::VoxelGridCovariance<PointT>::applyFilter (PointCloud &output)
   }
 
   // If we don't want to process the entire cloud, but rather filter points far away from the viewpoint first...
+  int distance_offset = -1;
   if (!filter_field_name_.empty ())
   {
     // Get the distance field index
@@ -126,21 +135,40 @@ pcl::VoxelGridCovariance<PointT>::applyFilter (PointCloud &output)
     int distance_idx = pcl::getFieldIndex (*input_, filter_field_name_, fields);
     if (distance_idx == -1)
       PCL_WARN ("[pcl::%s::applyFilter] Invalid filter field name. Index is %d.\n", getClassName ().c_str (), distance_idx);
+    else
+      distance_offset = fields[distance_idx].offset;
+  }
 
-    // First pass: go over all points and insert them into the right leaf
-    for (size_t cp = 0; cp < input_->points.size (); ++cp)
-    {
-      if (!input_->is_dense)
-        // Check if the point is invalid
-        if (!pcl_isfinite (input_->points[cp].x) ||
-            !pcl_isfinite (input_->points[cp].y) ||
-            !pcl_isfinite (input_->points[cp].z))
-          continue;
+#ifdef _OPENMP
+  const int nr_threads = threads_ == 0 ? omp_get_num_procs () : static_cast<int> (threads_);
+#endif
+
+  // First pass: go over all points and compute the index of the leaf they fall into. The keys hold the leaf index
+  // in the upper and the point index in the lower 32 bits, so sorting them groups the points of each leaf in input order.
+  const int nr_input = static_cast<int> (input_->points.size ());
+  const uint64_t invalid_key = std::numeric_limits<uint64_t>::max ();
+  std::vector<uint64_t> keys (nr_input);
+#ifdef _OPENMP
+#pragma omp parallel for num_threads(nr_threads) schedule(static)
+#endif
+  for (int cp = 0; cp < nr_input; ++cp)
+  {
+    keys[cp] = invalid_key;
+    const PointT &point = input_->points[cp];
+
+    if (!input_->is_dense)
+      // Check if the point is invalid
+      if (!pcl_isfinite (point.x) ||
+          !pcl_isfinite (point.y) ||
+          !pcl_isfinite (point.z))
+        continue;
 
+    if (distance_offset >= 0)
+    {
       // Get the distance value
-      const uint8_t* pt_data = reinterpret_cast<const uint8_t*> (&input_->points[cp]);
+      const uint8_t* pt_data = reinterpret_cast<const uint8_t*> (&point);
       float distance_value = 0;
-      memcpy (&distance_value, pt_data + fields[distance_idx].offset, sizeof (float));
+      memcpy (&distance_value, pt_data + distance_offset, sizeof (float));
 
       if (filter_limit_negative_)
       {
@@ -154,219 +182,219 @@ pcl::VoxelGridCovariance<PointT>::applyFilter (PointCloud &output)
         if ((distance_value > filter_limit_max_) || (distance_value < filter_limit_min_))
           continue;
       }
+    }
 
-      int ijk0 = static_cast<int> (floor (input_->points[cp].x * inverse_leaf_size_[0]) - static_cast<float> (min_b_[0]));
-      int ijk1 = static_cast<int> (floor (input_->points[cp].y * inverse_leaf_size_[1]) - static_cast<float> (min_b_[1]));
-      int ijk2 = static_cast<int> (floor (input_->points[cp].z * inverse_leaf_size_[2]) - static_cast<float> (min_b_[2]));
-
-      // Compute the centroid leaf index
-      int idx = ijk0 * divb_mul_[0] + ijk1 * divb_mul_[1] + ijk2 * divb_mul_[2];
+    int ijk0 = static_cast<int> (floor (point.x * inverse_leaf_size_[0]) - static_cast<float> (min_b_[0]));
+    int ijk1 = static_cast<int> (floor (point.y * inverse_leaf_size_[1]) - static_cast<float> (min_b_[1]));
+    int ijk2 = static_cast<int> (floor (point.z * inverse_leaf_size_[2]) - static_cast<float> (min_b_[2]));
 
-      Leaf& leaf = leaves_[idx];
-      if (leaf.nr_points == 0)
-      {
-        leaf.centroid.resize (centroid_size);
-        leaf.centroid.setZero ();
-      }
+    // Compute the centroid leaf index
+    int idx = ijk0 * divb_mul_[0] + ijk1 * divb_mul_[1] + ijk2 * divb_mul_[2];
 
-      Eigen::Vector3d pt3d (input_->points[cp].x, input_->points[cp].y, input_->points[cp].z);
-      // Accumulate point sum for centroid calculation
-      leaf.mean_ += pt3d;
-      // Accumulate x*xT for single pass covariance calculation
-      leaf.cov_ += pt3d * pt3d.transpose ();
+    keys[cp] = (static_cast<uint64_t> (idx) << 32) | static_cast<uint64_t> (cp);
+  }
+  keys.erase (std::remove (keys.begin (), keys.end (), invalid_key), keys.end ());
+  std::sort (keys.begin (), keys.end ());
 
-      // Do we need to process all the fields?
-      if (!downsample_all_data_)
-      {
-        Eigen::Vector4f pt (input_->points[cp].x, input_->points[cp].y, input_->points[cp].z, 0);
-        leaf.centroid.template head<4> () += pt;
-      }
-      else
-      {
-        // Copy all the fields
-        Eigen::VectorXf centroid = Eigen::VectorXf::Zero (centroid_size);
-        pcl::for_each_type<FieldList> (NdCopyPointEigenFunctor<PointT> (input_->points[cp], centroid));
-        // ---[ RGB special case
-        if (rgba_index >= 0)
-        {
-          // Fill r/g/b data, assuming that the order is BGRA
-          const pcl::RGB& rgb = *reinterpret_cast<const RGB*> (reinterpret_cast<const char*> (&input_->points[cp]) + rgba_index);
-          centroid[centroid_size - 4] = rgb.a;
-          centroid[centroid_size - 3] = rgb.r;
-          centroid[centroid_size - 2] = rgb.g;
-          centroid[centroid_size - 1] = rgb.b;
-        }
-        leaf.centroid += centroid;
-      }
-      ++leaf.nr_points;
+  // Allocate one leaf per run of equal leaf indices
+  std::vector<size_t> leaf_begin;
+  for (size_t k = 0; k < keys.size (); ++k)
+  {
+    const size_t idx = static_cast<size_t> (keys[k] >> 32);
+    if (leaf_voxel_indices_.empty () || leaf_voxel_indices_.back () != idx)
+    {
+      leaf_voxel_indices_.push_back (idx);
+      leaf_begin.push_back (k);
     }
   }
-  // No distance filtering, process all data
-  else
+  leaf_begin.push_back (keys.size ());
+  const int nr_leaves = static_cast<int> (leaf_voxel_indices_.size ());
+  leaves_.resize (nr_leaves);
+
+  // Second pass: go over all leaves and compute centroids and covariance matrices
+  std::vector<char> is_centroid (nr_leaves, 0);
+#ifdef _OPENMP
+#pragma omp parallel num_threads(nr_threads)
+#endif
   {
-    // First pass: go over all points and insert them into the right leaf
-    for (size_t cp = 0; cp < input_->points.size (); ++cp)
+    // Eigen values and vectors calculated to prevent near singluar matrices
+    Eigen::SelfAdjointEigenSolver<Eigen::Matrix3d> eigensolver;
+    Eigen::Matrix3d eigen_val;
+    Eigen::Vector3d pt_sum;
+    Eigen::VectorXf centroid (centroid_size);
+
+    // Eigen values less than a threshold of max eigen value are inflated to a set fraction of the max eigen value.
+    double min_covar_eigvalue;
+
+#ifdef _OPENMP
+#pragma omp for schedule(dynamic, 256)
+#endif
+    for (int li = 0; li < nr_leaves; ++li)
     {
-      if (!input_->is_dense)
-        // Check if the point is invalid
-        if (!pcl_isfinite (input_->points[cp].x) ||
-            !pcl_isfinite (input_->points[cp].y) ||
-            !pcl_isfinite (input_->points[cp].z))
-          continue;
-
-      int ijk0 = static_cast<int> (floor (input_->points[cp].x * inverse_leaf_size_[0]) - static_cast<float> (min_b_[0]));
-      int ijk1 = static_cast<int> (floor (input_->points[cp].y * inverse_leaf_size_[1]) - static_cast<float> (min_b_[1]));
-      int ijk2 = static_cast<int> (floor (input_->points[cp].z * inverse_leaf_size_[2]) - static_cast<float> (min_b_[2]));
-
-      // Compute the centroid leaf index
-      int idx = ijk0 * divb_mul_[0] + ijk1 * divb_mul_[1] + ijk2 * divb_mul_[2];
+      Leaf& leaf = leaves_[li];
+      leaf.centroid.setZero (centroid_size);
 
-      //int idx = (((input_->points[cp].getArray4fmap () * inverse_leaf_size_).template cast<int> ()).matrix () - min_b_).dot (divb_mul_);
-      Leaf& leaf = leaves_[idx];
-      if (leaf.nr_points == 0)
+      for (size_t k = leaf_begin[li]; k < leaf_begin[li + 1]; ++k)
       {
-        leaf.centroid.resize (centroid_size);
-        leaf.centroid.setZero ();
-      }
+        const PointT &point = input_->points[static_cast<size_t> (keys[k] & 0xffffffffu)];
 
-      Eigen::Vector3d pt3d (input_->points[cp].x, input_->points[cp].y, input_->points[cp].z);
-      // Accumulate point sum for centroid calculation
-      leaf.mean_ += pt3d;
-      // Accumulate x*xT for single pass covariance calculation
-      leaf.cov_ += pt3d * pt3d.transpose ();
+        Eigen::Vector3d pt3d (point.x, point.y, point.z);
+        // Accumulate point sum for centroid calculation
+        leaf.mean_ += pt3d;
+        // Accumulate x*xT for single pass covariance calculation
+        leaf.cov_ += pt3d * pt3d.transpose ();
 
-      // Do we need to process all the fields?
-      if (!downsample_all_data_)
-      {
-        Eigen::Vector4f pt (input_->points[cp].x, input_->points[cp].y, input_->points[cp].z, 0);
-        leaf.centroid.template head<4> () += pt;
-      }
-      else
-      {
-        // Copy all the fields
-        Eigen::VectorXf centroid = Eigen::VectorXf::Zero (centroid_size);
-        pcl::for_each_type<FieldList> (NdCopyPointEigenFunctor<PointT> (input_->points[cp], centroid));
-        // ---[ RGB special case
-        if (rgba_index >= 0)
+        // Do we need to process all the fields?
+        if (!downsample_all_data_)
+        {
+          Eigen::Vector4f pt (point.x, point.y, point.z, 0);
+          leaf.centroid.template head<4> () += pt;
+        }
+        else
         {
-          // Fill r/g/b data, assuming that the order is BGRA
-          const pcl::RGB& rgb = *reinterpret_cast<const RGB*> (reinterpret_cast<const char*> (&input_->points[cp]) + rgba_index);
-          centroid[centroid_size - 4] = rgb.a;
-          centroid[centroid_size - 3] = rgb.r;
-          centroid[centroid_size - 2] = rgb.g;
-          centroid[centroid_size - 1] = rgb.b;
+          // Copy all the fields
+          centroid.setZero ();
+          pcl::for_each_type<FieldList> (NdCopyPointEigenFunctor<PointT> (point, centroid));
+          // ---[ RGB special case
+          if (rgba_index >= 0)
+          {
+            // Fill r/g/b data, assuming that the order is BGRA
+            const pcl::RGB& rgb = *reinterpret_cast<const RGB*> (reinterpret_cast<const char*> (&point) + rgba_index);
+            centroid[centroid_size - 4] = rgb.a;
+            centroid[centroid_size - 3] = rgb.r;
+            centroid[centroid_size - 2] = rgb.g;
+            centroid[centroid_size - 1] = rgb.b;
+          }
+          leaf.centroid += centroid;
         }
-        leaf.centroid += centroid;
+        ++leaf.nr_points;
       }
-      ++leaf.nr_points;
-    }
-  }
 
-  // Second pass: go over all leaves and compute centroids and covariance matrices
-  output.points.reserve (leaves_.size ());
-  if (searchable_)
-    voxel_centroids_leaf_indices_.reserve (leaves_.size ());
-  int cp = 0;
-  if (save_leaf_layout_)
-    leaf_layout_.resize (div_b_[0] * div_b_[1] * div_b_[2], -1);
+      // Normalize the centroid
+      leaf.centroid /= static_cast<float> (leaf.nr_points);
+      // Point sum used for single pass covariance calculation
+      pt_sum = leaf.mean_;
+      // Normalize mean
+      leaf.mean_ /= leaf.nr_points;
 
-  // Eigen values and vectors calculated to prevent near singluar matrices
-  Eigen::SelfAdjointEigenSolver<Eigen::Matrix3d> eigensolver;
-  Eigen::Matrix3d eigen_val;
-  Eigen::Vector3d pt_sum;
+      // If the voxel contains sufficient points, its covariance is calculated and is added to the voxel centroids and output clouds.
+      // Points with less than the minimum points will have a can not be accuratly approximated using a normal distribution.
+      if (leaf.nr_points >= min_points_per_voxel_)
+      {
+        is_centroid[li] = 1;
 
-  // Eigen values less than a threshold of max eigen value are inflated to a set fraction of the max eigen value.
-  double min_covar_eigvalue;
+        // Single pass covariance calculation
+        leaf.cov_ = (leaf.cov_ - 2 * (pt_sum * leaf.mean_.transpose ())) / leaf.nr_points + leaf.mean_ * leaf.mean_.transpose ();
+        leaf.cov_ *= (leaf.nr_points - 1.0) / leaf.nr_points;
 
-  for (typename std::map<size_t, Leaf>::iterator it = leaves_.begin (); it != leaves_.end (); ++it)
-  {
+        //Normalize Eigen Val such that max no more than 100x min.
+        eigensolver.compute (leaf.cov_);
+        eigen_val = eigensolver.eigenvalues ().asDiagonal ();
+        leaf.evecs_ = eigensolver.eigenvectors ();
 
-    // Normalize the centroid
-    Leaf& leaf = it->second;
+        if (eigen_val (0, 0) < 0 || eigen_val (1, 1) < 0 || eigen_val (2, 2) <= 0)
+        {
+          leaf.nr_points = -1;
+          continue;
+        }
 
-    // Normalize the centroid
-    leaf.centroid /= static_cast<float> (leaf.nr_points);
-    // Point sum used for single pass covariance calculation
-    pt_sum = leaf.mean_;
-    // Normalize mean
-    leaf.mean_ /= leaf.nr_points;
+        // Avoids matrices near singularities (eq 6.11)[Magnusson 2009]
 
-    // If the voxel contains sufficient points, its covariance is calculated and is added to the voxel centroids and output clouds.
-    // Points with less than the minimum points will have a can not be accuratly approximated using a normal distribution.
-    if (leaf.nr_points >= min_points_per_voxel_)
-    {
-      if (save_leaf_layout_)
-        leaf_layout_[it->first] = cp++;
+        min_covar_eigvalue = min_covar_eigvalue_mult_ * eigen_val (2, 2);
+        if (eigen_val (0, 0) < min_covar_eigvalue)
+        {
+          eigen_val (0, 0) = min_covar_eigvalue;
 
-      output.push_back (PointT ());
+          if (eigen_val (1, 1) < min_covar_eigvalue)
+          {
+            eigen_val (1, 1) = min_covar_eigvalue;
+          }
 
-      // Do we need to process all the fields?
-      if (!downsample_all_data_)
-      {
-        output.points.back ().x = leaf.centroid[0];
-        output.points.back ().y = leaf.centroid[1];
-        output.points.back ().z = leaf.centroid[2];
-      }
-      else
-      {
-        pcl::for_each_type<FieldList> (pcl::NdCopyEigenPointFunctor<PointT> (leaf.centroid, output.back ()));
-        // ---[ RGB special case
-        if (rgba_index >= 0)
+          leaf.cov_ = leaf.evecs_ * eigen_val * leaf.evecs_.inverse ();
+        }
+        leaf.evals_ = eigen_val.diagonal ();
+
+        leaf.icov_ = leaf.cov_.inverse ();
+        if (leaf.icov_.maxCoeff () == std::numeric_limits<float>::infinity ( )
+            || leaf.icov_.minCoeff () == -std::numeric_limits<float>::infinity ( ) )
         {
-          pcl::RGB& rgb = *reinterpret_cast<RGB*> (reinterpret_cast<char*> (&output.points.back ()) + rgba_index);
-          rgb.a = leaf.centroid[centroid_size - 4];
-          rgb.r = leaf.centroid[centroid_size - 3];
-          rgb.g = leaf.centroid[centroid_size - 2];
-          rgb.b = leaf.centroid[centroid_size - 1];
+          leaf.nr_points = -1;
         }
       }
+    }
+  }
+  // The point keys are not needed anymore, release them before the output is allocated
+  std::vector<uint64_t> ().swap (keys);
 
-      // Stores the voxel indice for fast access searching
-      if (searchable_)
-        voxel_centroids_leaf_indices_.push_back (static_cast<int> (it->first));
-
-      // Single pass covariance calculation
-      leaf.cov_ = (leaf.cov_ - 2 * (pt_sum * leaf.mean_.transpose ())) / leaf.nr_points + leaf.mean_ * leaf.mean_.transpose ();
-      leaf.cov_ *= (leaf.nr_points - 1.0) / leaf.nr_points;
+  // Third pass: add the centroids of the voxels with sufficient points to the output, in voxel index order
+  output.points.reserve (nr_leaves);
+  voxel_centroids_leaf_indices_.reserve (nr_leaves);
+  int cp = 0;
+  if (save_leaf_layout_)
+    leaf_layout_.resize (div_b_[0] * div_b_[1] * div_b_[2], -1);
 
-      //Normalize Eigen Val such that max no more than 100x min.
-      eigensolver.compute (leaf.cov_);
-      eigen_val = eigensolver.eigenvalues ().asDiagonal ();
-      leaf.evecs_ = eigensolver.eigenvectors ();
+  for (int li = 0; li < nr_leaves; ++li)
+  {
+    if (!is_centroid[li])
+      continue;
+    const Leaf& leaf = leaves_[li];
 
-      if (eigen_val (0, 0) < 0 || eigen_val (1, 1) < 0 || eigen_val (2, 2) <= 0)
-      {
-        leaf.nr_points = -1;
-        continue;
-      }
+    if (save_leaf_layout_)
+      leaf_layout_[leaf_voxel_indices_[li]] = cp++;
 
-      // Avoids matrices near singularities (eq 6.11)[Magnusson 2009]
+    output.push_back (PointT ());
 
-      min_covar_eigvalue = min_covar_eigvalue_mult_ * eigen_val (2, 2);
-      if (eigen_val (0, 0) < min_covar_eigvalue)
+    // Do we need to process all the fields?
+    if (!downsample_all_data_)
+    {
+      output.points.back ().x = leaf.centroid[0];
+      output.points.back ().y = leaf.centroid[1];
+      output.points.back ().z = leaf.centroid[2];
+    }
+    else
+    {
+      pcl::for_each_type<FieldList> (pcl::NdCopyEigenPointFunctor<PointT> (leaf.centroid, output.back ()));
+      // ---[ RGB special case
+      if (rgba_index >= 0)
       {
-        eigen_val (0, 0) = min_covar_eigvalue;
+        pcl::RGB& rgb = *reinterpret_cast<RGB*> (reinterpret_cast<char*> (&output.points.back ()) + rgba_index);
+        rgb.a = leaf.centroid[centroid_size - 4];
+        rgb.r = leaf.centroid[centroid_size - 3];
+        rgb.g = leaf.centroid[centroid_size - 2];
+        rgb.b = leaf.centroid[centroid_size - 1];
+      }
+    }
 
-        if (eigen_val (1, 1) < min_covar_eigvalue)
-        {
-          eigen_val (1, 1) = min_covar_eigvalue;
-        }
+    // Stores the leaf position for fast access searching
+    voxel_centroids_leaf_indices_.push_back (li);
+  }
 
-        leaf.cov_ = leaf.evecs_ * eigen_val * leaf.evecs_.inverse ();
-      }
-      leaf.evals_ = eigen_val.diagonal ();
+  buildLeafTable ();
 
-      leaf.icov_ = leaf.cov_.inverse ();
-      if (leaf.icov_.maxCoeff () == std::numeric_limits<float>::infinity ( )
-          || leaf.icov_.minCoeff () == -std::numeric_limits<float>::infinity ( ) )
-      {
-        leaf.nr_points = -1;
-      }
+  output.width = static_cast<uint32_t> (output.points.size ());
+}
 
-    }
+//////////////////////////////////////////////////////////////////////////////////////////
+template<typename PointT> void
+pcl::VoxelGridCovariance<PointT>::buildLeafTable ()
+{
+  // At least two slots, so that the hash shift stays below 64
+  size_t table_size = 2;
+  leaf_table_shift_ = 63;
+  while (table_size < 2 * leaf_voxel_indices_.size ())
+  {
+    table_size <<= 1;
+    --leaf_table_shift_;
   }
+  leaf_table_.assign (table_size, -1);
 
-  output.width = static_cast<uint32_t> (output.points.size ());
+  for (size_t li = 0; li < leaf_voxel_indices_.size (); ++li)
+  {
+    size_t slot = hashVoxelIndex (leaf_voxel_indices_[li]);
+    while (leaf_table_[slot] >= 0)
+      slot = (slot + 1) & (table_size - 1);
+    leaf_table_[slot] = static_cast<int> (li);
+  }
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////
@@ -392,10 +420,10 @@ pcl::VoxelGridCovariance<PointT>::getNeighborhoodAtPoint (const PointT& referenc
     // Checking if the specified cell is in the grid
     if ((diff2min <= displacement.array ()).all () && (diff2max >= displacement.array ()).all ())
     {
-      typename std::map<size_t, Leaf>::iterator leaf_iter = leaves_.find (((ijk + displacement - min_b_).dot (divb_mul_)));
-      if (leaf_iter != leaves_.end () && leaf_iter->second.nr_points >= min_points_per_voxel_)
+      const int leaf_idx = findLeaf ((ijk + displacement - min_b_).dot (divb_mul_));
+      if (leaf_idx >= 0 && leaves_[leaf_idx].nr_points >= min_points_per_voxel_)
       {
-        LeafConstPtr leaf = &(leaf_iter->second);
+        LeafConstPtr leaf = &leaves_[leaf_idx];
         neighbors.push_back (leaf);
       }
     }
@@ -404,6 +432,320 @@ pcl::VoxelGridCovariance<PointT>::getNeighborhoodAtPoint (const PointT& referenc
   return (static_cast<int> (neighbors.size ()));
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////
+template<typename PointT> int
+pcl::VoxelGridCovariance<PointT>::getNeighborhoodAtPoint (const Eigen::MatrixXi &relative_coordinates,
+                                                          const PointT &reference_point,
+                                                          std::vector<LeafConstPtr> &neighbors) const
+{
+  neighbors.clear ();
+  neighbors.reserve (relative_coordinates.cols ());
+
+  const Eigen::Vector4i ijk = getVoxelCoordinates (reference_point);
+  for (int ni = 0; ni < relative_coordinates.cols (); ni++)
+    appendUsableLeaf (ijk + (Eigen::Vector4i () << relative_coordinates.col (ni), 0).finished (), neighbors);
+
+  return (static_cast<int> (neighbors.size ()));
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+template<typename PointT> int
+pcl::VoxelGridCovariance<PointT>::getVoxelAtPoint (const PointT &reference_point,
+                                                   std::vector<LeafConstPtr> &neighbors) const
+{
+  neighbors.clear ();
+  appendUsableLeaf (getVoxelCoordinates (reference_point), neighbors);
+  return (static_cast<int> (neighbors.size ()));
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+template<typename PointT> int
+pcl::VoxelGridCovariance<PointT>::getFaceNeighborsAtPoint (const PointT &reference_point,
+                                                           std::vector<LeafConstPtr> &neighbors) const
+{
+  neighbors.clear ();
+  neighbors.reserve (7);
+
+  const Eigen::Vector4i ijk = getVoxelCoordinates (reference_point);
+  appendUsableLeaf (ijk, neighbors);
+  for (int d = 0; d < 3; ++d)
+  {
+    Eigen::Vector4i displacement = Eigen::Vector4i::Zero ();
+    displacement[d] = -1;
+    appendUsableLeaf (ijk + displacement, neighbors);
+    displacement[d] = 1;
+    appendUsableLeaf (ijk + displacement, neighbors);
+  }
+
+  return (static_cast<int> (neighbors.size ()));
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+template<typename PointT> int
+pcl::VoxelGridCovariance<PointT>::getAllNeighborsAtPoint (const PointT &reference_point,
+                                                          std::vector<LeafConstPtr> &neighbors) const
+{
+  neighbors.clear ();
+  neighbors.reserve (27);
+
+  const Eigen::Vector4i ijk = getVoxelCoordinates (reference_point);
+  appendUsableLeaf (ijk, neighbors);
+  for (int dz = -1; dz <= 1; ++dz)
+    for (int dy = -1; dy <= 1; ++dy)
+      for (int dx = -1; dx <= 1; ++dx)
+        if (dx != 0 || dy != 0 || dz != 0)
+          appendUsableLeaf (ijk + Eigen::Vector4i (dx, dy, dz, 0), neighbors);
+
+  return (static_cast<int> (neighbors.size ()));
+}
+
+namespace pcl
+{
+  namespace detail
+  {
+    /** \brief Magic bytes and version at the start of a VoxelGridCovariance file. */
+    const char VOXEL_GRID_COVARIANCE_MAGIC[8] = { 'P', 'C', 'L', 'V', 'G', 'C', 0, 1 };
+
+    /** \brief Number of doubles stored per leaf in a VoxelGridCovariance file: mean, covariance,
+      * inverse covariance, eigen vectors and eigen values.
+      */
+    const size_t VOXEL_GRID_COVARIANCE_LEAF_DOUBLES = 3 + 9 + 9 + 9 + 3;
+
+    template <typename T> inline void
+    writeBinary (std::ofstream &fs, const T *data, size_t count)
+    {
+      if (count > 0)
+        fs.write (reinterpret_cast<const char*> (data), count * sizeof (T));
+    }
+
+    template <typename T, typename Alloc> inline void
+    writeBinary (std::ofstream &fs, const std::vector<T, Alloc> &data)
+    {
+      if (!data.empty ())
+        writeBinary (fs, &data[0], data.size ());
+    }
+
+    template <typename T> inline void
+    readBinary (std::ifstream &fs, T *data, size_t count)
+    {
+      if (count > 0)
+        fs.read (reinterpret_cast<char*> (data), count * sizeof (T));
+    }
+
+    template <typename T, typename Alloc> inline void
+    readBinary (std::ifstream &fs, std::vector<T, Alloc> &data)
+    {
+      if (!data.empty ())
+        readBinary (fs, &data[0], data.size ());
+    }
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+template<typename PointT> bool
+pcl::VoxelGridCovariance<PointT>::saveLeaves (const std::string &file_name) const
+{
+  using namespace pcl::detail;
+
+  std::ofstream fs (file_name.c_str (), std::ios::out | std::ios::binary | std::ios::trunc);
+  if (!fs.is_open ())
+  {
+    PCL_ERROR ("[pcl::%s::saveLeaves] Could not open %s for writing!\n", getClassName ().c_str (), file_name.c_str ());
+    return (false);
+  }
+
+  // Header: grid geometry and the sizes of the arrays that follow
+  const uint64_t nr_leaves = leaves_.size ();
+  const uint64_t nr_centroids = voxel_centroids_ ? voxel_centroids_->points.size () : 0;
+  const int32_t centroid_size = leaves_.empty () ? 0 : static_cast<int32_t> (leaves_[0].centroid.size ());
+  const uint32_t point_size = sizeof (PointT);
+  const int32_t min_points_per_voxel = min_points_per_voxel_;
+  writeBinary (fs, VOXEL_GRID_COVARIANCE_MAGIC, 8);
+  writeBinary (fs, &point_size, 1);
+  writeBinary (fs, leaf_size_.data (), 4);
+  writeBinary (fs, min_b_.data (), 4);
+  writeBinary (fs, max_b_.data (), 4);
+  writeBinary (fs, div_b_.data (), 4);
+  writeBinary (fs, divb_mul_.data (), 4);
+  writeBinary (fs, &min_points_per_voxel, 1);
+  writeBinary (fs, &min_covar_eigvalue_mult_, 1);
+  writeBinary (fs, &nr_leaves, 1);
+  writeBinary (fs, &centroid_size, 1);
+  writeBinary (fs, &nr_centroids, 1);
+
+  // Leaves, one array per field so that they can be read back in bulk
+  std::vector<uint64_t> voxel_indices (leaf_voxel_indices_.begin (), leaf_voxel_indices_.end ());
+  std::vector<int32_t> nr_points (nr_leaves);
+  std::vector<double> statistics (nr_leaves * VOXEL_GRID_COVARIANCE_LEAF_DOUBLES);
+  std::vector<float> centroids (nr_leaves * centroid_size);
+  for (size_t li = 0; li < nr_leaves; ++li)
+  {
+    const Leaf &leaf = leaves_[li];
+    nr_points[li] = leaf.nr_points;
+    double *stats = &statistics[li * VOXEL_GRID_COVARIANCE_LEAF_DOUBLES];
+    Eigen::Vector3d::Map (stats) = leaf.mean_;
+    Eigen::Matrix3d::Map (stats + 3) = leaf.cov_;
+    Eigen::Matrix3d::Map (stats + 12) = leaf.icov_;
+    Eigen::Matrix3d::Map (stats + 21) = leaf.evecs_;
+    Eigen::Vector3d::Map (stats + 30) = leaf.evals_;
+    if (centroid_size > 0)
+      Eigen::VectorXf::Map (&centroids[li * centroid_size], centroid_size) = leaf.centroid;
+  }
+  writeBinary (fs, voxel_indices);
+  writeBinary (fs, nr_points);
+  writeBinary (fs, statistics);
+  writeBinary (fs, centroids);
+
+  // Voxel centroids and the leaves they belong to
+  if (nr_centroids > 0)
+  {
+    writeBinary (fs, voxel_centroids_leaf_indices_);
+    writeBinary (fs, voxel_centroids_->points);
+  }
+
+  if (!fs.good ())
+  {
+    PCL_ERROR ("[pcl::%s::saveLeaves] Error writing to %s!\n", getClassName ().c_str (), file_name.c_str ());
+    return (false);
+  }
+  return (true);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+template<typename PointT> bool
+pcl::VoxelGridCovariance<PointT>::loadLeaves (const std::string &file_name, bool searchable)
+{
+  using namespace pcl::detail;
+
+  std::ifstream fs (file_name.c_str (), std::ios::in | std::ios::binary);
+  if (!fs.is_open ())
+  {
+    PCL_ERROR ("[pcl::%s::loadLeaves] Could not open %s for reading!\n", getClassName ().c_str (), file_name.c_str ());
+    return (false);
+  }
+
+  char magic[8];
+  uint32_t point_size = 0;
+  readBinary (fs, magic, 8);
+  readBinary (fs, &point_size, 1);
+  if (!fs.good () || !std::equal (magic, magic + 8, VOXEL_GRID_COVARIANCE_MAGIC) || point_size != sizeof (PointT))
+  {
+    PCL_ERROR ("[pcl::%s::loadLeaves] %s is not a voxel structure file for this point type!\n", getClassName ().c_str (), file_name.c_str ());
+    return (false);
+  }
+
+  Eigen::Vector4f leaf_size;
+  Eigen::Vector4i min_b, max_b, div_b, divb_mul;
+  int32_t min_points_per_voxel = 0, centroid_size = 0;
+  double min_covar_eigvalue_mult = 0;
+  uint64_t nr_leaves = 0, nr_centroids = 0;
+  readBinary (fs, leaf_size.data (), 4);
+  readBinary (fs, min_b.data (), 4);
+  readBinary (fs, max_b.data (), 4);
+  readBinary (fs, div_b.data (), 4);
+  readBinary (fs, divb_mul.data (), 4);
+  readBinary (fs, &min_points_per_voxel, 1);
+  readBinary (fs, &min_covar_eigvalue_mult, 1);
+  readBinary (fs, &nr_leaves, 1);
+  readBinary (fs, &centroid_size, 1);
+  readBinary (fs, &nr_centroids, 1);
+  if (!fs.good () || centroid_size < 0 || nr_centroids > nr_leaves ||
+      div_b[0] < 1 || div_b[1] < 1 || div_b[2] < 1)
+  {
+    PCL_ERROR ("[pcl::%s::loadLeaves] Invalid header in %s!\n", getClassName ().c_str (), file_name.c_str ());
+    return (false);
+  }
+
+  // Check the counts against the grid and the rest of the file before allocating anything
+  const uint64_t nr_voxels = static_cast<uint64_t> (div_b[0]) * div_b[1] * div_b[2];
+  const std::streampos data_begin = fs.tellg ();
+  fs.seekg (0, std::ios::end);
+  const uint64_t remaining = static_cast<uint64_t> (fs.tellg () - data_begin);
+  fs.seekg (data_begin);
+  const uint64_t leaf_bytes = sizeof (uint64_t) + sizeof (int32_t) + VOXEL_GRID_COVARIANCE_LEAF_DOUBLES * sizeof (double) +
+                              static_cast<uint64_t> (centroid_size) * sizeof (float);
+  const uint64_t centroid_bytes = sizeof (int) + sizeof (PointT);
+  if (!fs.good () || nr_leaves > nr_voxels || nr_leaves > remaining / leaf_bytes ||
+      nr_centroids > (remaining - nr_leaves * leaf_bytes) / centroid_bytes)
+  {
+    PCL_ERROR ("[pcl::%s::loadLeaves] The leaf counts in %s do not match the grid or the file size!\n", getClassName ().c_str (), file_name.c_str ());
+    return (false);
+  }
+
+  std::vector<uint64_t> voxel_indices (nr_leaves);
+  std::vector<int32_t> nr_points (nr_leaves);
+  std::vector<double> statistics (nr_leaves * VOXEL_GRID_COVARIANCE_LEAF_DOUBLES);
+  std::vector<float> centroids (nr_leaves * centroid_size);
+  std::vector<int> centroid_leaf_indices (nr_centroids);
+  PointCloudPtr voxel_centroids (new PointCloud);
+  voxel_centroids->points.resize (nr_centroids);
+  readBinary (fs, voxel_indices);
+  readBinary (fs, nr_points);
+  readBinary (fs, statistics);
+  readBinary (fs, centroids);
+  readBinary (fs, centroid_leaf_indices);
+  readBinary (fs, voxel_centroids->points);
+  if (!fs.good ())
+  {
+    PCL_ERROR ("[pcl::%s::loadLeaves] Unexpected end of file in %s!\n", getClassName ().c_str (), file_name.c_str ());
+    return (false);
+  }
+  for (size_t i = 0; i < voxel_indices.size (); ++i)
+    if (voxel_indices[i] >= nr_voxels)
+    {
+      PCL_ERROR ("[pcl::%s::loadLeaves] Invalid voxel index in %s!\n", getClassName ().c_str (), file_name.c_str ());
+      return (false);
+    }
+  for (size_t i = 0; i < centroid_leaf_indices.size (); ++i)
+    if (centroid_leaf_indices[i] < 0 || centroid_leaf_indices[i] >= static_cast<int> (nr_leaves))
+    {
+      PCL_ERROR ("[pcl::%s::loadLeaves] Invalid centroid leaf index in %s!\n", getClassName ().c_str (), file_name.c_str ());
+      return (false);
+    }
+
+  // Everything was read successfully, replace the current structure
+  this->setLeafSize (leaf_size);
+  min_b_ = min_b;
+  max_b_ = max_b;
+  div_b_ = div_b;
+  divb_mul_ = divb_mul;
+  min_points_per_voxel_ = min_points_per_voxel;
+  min_covar_eigvalue_mult_ = min_covar_eigvalue_mult;
+
+  leaf_voxel_indices_.assign (voxel_indices.begin (), voxel_indices.end ());
+  leaves_.resize (nr_leaves);
+  for (size_t li = 0; li < nr_leaves; ++li)
+  {
+    Leaf &leaf = leaves_[li];
+    leaf.nr_points = nr_points[li];
+    const double *stats = &statistics[li * VOXEL_GRID_COVARIANCE_LEAF_DOUBLES];
+    leaf.mean_ = Eigen::Vector3d::Map (stats);
+    leaf.cov_ = Eigen::Matrix3d::Map (stats + 3);
+    leaf.icov_ = Eigen::Matrix3d::Map (stats + 12);
+    leaf.evecs_ = Eigen::Matrix3d::Map (stats + 21);
+    leaf.evals_ = Eigen::Vector3d::Map (stats + 30);
+    if (centroid_size > 0)
+      leaf.centroid = Eigen::VectorXf::Map (&centroids[li * centroid_size], centroid_size);
+    else
+      leaf.centroid.resize (0);
+  }
+  buildLeafTable ();
+
+  voxel_centroids->width = static_cast<uint32_t> (nr_centroids);
+  voxel_centroids->height = 1;
+  voxel_centroids->is_dense = true;
+  voxel_centroids_ = voxel_centroids;
+  voxel_centroids_leaf_indices_.swap (centroid_leaf_indices);
+
+  searchable_ = searchable;
+  if (searchable_ && voxel_centroids_->size () > 0)
+  {
+    // Initiates kdtree of the centroids of voxels containing a sufficient number of points
+    kdtree_.setInputCloud (voxel_centroids_);
+  }
+  return (true);
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////
 template<typename PointT> void
 pcl::VoxelGridCovariance<PointT>::getDisplayCloud (pcl::PointCloud<PointXYZ>& cell_cloud)
@@ -422,9 +764,9 @@ pcl::VoxelGridCovariance<PointT>::getDisplayCloud (pcl::PointCloud<PointXYZ>& ce
   Eigen::Vector3d dist_point;
 
   // Generate points for each occupied voxel with sufficient points.
-  for (typename std::map<size_t, Leaf>::iterator it = leaves_.begin (); it != leaves_.end (); ++it)
+  for (typename LeafVector::const_iterator it = leaves_.begin (); it != leaves_.end (); ++it)
   {
-    Leaf& leaf = it->second;
+    const Leaf& leaf = *it;
 
     if (leaf.nr_points >= min_points_per_voxel_)
     {
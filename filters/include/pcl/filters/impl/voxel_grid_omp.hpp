@@ -0,0 +1,389 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2012-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#ifndef PCL_FILTERS_IMPL_VOXEL_GRID_OMP_H_
+#define PCL_FILTERS_IMPL_VOXEL_GRID_OMP_H_
+
+#include <pcl/common/centroid.h>
+#include <pcl/common/common.h>
+#include <pcl/common/io.h>
+#include <pcl/filters/voxel_grid_omp.h>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+namespace pcl
+{
+  namespace detail
+  {
+    /** \brief Mapping between a 64 bit voxel index and the index of a point falling into it. */
+    struct VoxelGridOMPIndex
+    {
+      uint64_t idx;
+      unsigned int cloud_point_index;
+    };
+
+    /** \brief Perform one pass of a parallel, stable LSD radix sort over \a in, using the byte found at
+      * \a shift either in the voxel index or in the point index as the key.
+      * \param[in] in the entries to sort
+      * \param[out] out the entries, stably reordered according to the selected byte
+      * \param[in] on_point_index true to use the point index as key, false to use the voxel index
+      * \param[in] shift the bit offset of the key byte
+      * \param[in] nr_threads the number of threads (and thus contiguous chunks) to use
+      * \return false if all the entries share the same key byte, in which case \a out is left untouched
+      */
+    inline bool
+    voxelGridRadixPass (const std::vector<VoxelGridOMPIndex> &in, std::vector<VoxelGridOMPIndex> &out,
+                        bool on_point_index, int shift, int nr_threads)
+    {
+      const int nr_buckets = 256;
+      const size_t n = in.size ();
+      std::vector<size_t> histogram (nr_threads * nr_buckets, 0);
+
+      // Count the key bytes in each thread's chunk
+#ifdef _OPENMP
+#pragma omp parallel for num_threads (nr_threads)
+#endif
+      for (int t = 0; t < nr_threads; ++t)
+      {
+        size_t * const hist = &histogram[t * nr_buckets];
+        const size_t end = n * (t + 1) / nr_threads;
+        for (size_t i = n * t / nr_threads; i < end; ++i)
+        {
+          const uint64_t key = on_point_index ? in[i].cloud_point_index : in[i].idx;
+          ++hist[(key >> shift) & 0xFF];
+        }
+      }
+
+      // Exclusive prefix sum in (bucket, thread) order, so that the scatter is stable
+      size_t sum = 0;
+      for (int b = 0; b < nr_buckets; ++b)
+      {
+        size_t bucket_size = 0;
+        for (int t = 0; t < nr_threads; ++t)
+        {
+          const size_t count = histogram[t * nr_buckets + b];
+          histogram[t * nr_buckets + b] = sum;
+          sum += count;
+          bucket_size += count;
+        }
+        // All the keys fall into the same bucket, nothing to reorder
+        if (bucket_size == n)
+          return (false);
+      }
+
+      // Scatter each thread's chunk to its final position
+#ifdef _OPENMP
+#pragma omp parallel for num_threads (nr_threads)
+#endif
+      for (int t = 0; t < nr_threads; ++t)
+      {
+        size_t * const offset = &histogram[t * nr_buckets];
+        const size_t end = n * (t + 1) / nr_threads;
+        for (size_t i = n * t / nr_threads; i < end; ++i)
+        {
+          const uint64_t key = on_point_index ? in[i].cloud_point_index : in[i].idx;
+          out[offset[(key >> shift) & 0xFF]++] = in[i];
+        }
+      }
+      return (true);
+    }
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> void
+pcl::VoxelGridOMP<PointT>::applyFilter (PointCloud &output)
+{
+  // Has the input dataset been set already?
+  if (!input_)
+  {
+    PCL_WARN ("[pcl::%s::applyFilter] No input dataset given!\n", getClassName ().c_str ());
+    output.width = output.height = 0;
+    output.points.clear ();
+    return;
+  }
+
+  // Copy the header (and thus the frame_id) + allocate enough space for points
+  output.height       = 1;                    // downsampling breaks the organized structure
+  output.is_dense     = true;                 // we filter out invalid points
+
+#ifdef _OPENMP
+  const int nr_threads = threads_ == 0 ? omp_get_num_procs () : static_cast<int> (threads_);
+#else
+  const int nr_threads = 1;
+#endif
+
+  Eigen::Vector4f min_p, max_p;
+  // Get the minimum and maximum dimensions
+  if (!filter_field_name_.empty ()) // If we don't want to process the entire cloud...
+    getMinMax3D<PointT> (input_, *indices_, filter_field_name_, static_cast<float> (filter_limit_min_), static_cast<float> (filter_limit_max_), min_p, max_p, filter_limit_negative_);
+  else
+    getMinMax3D<PointT> (*input_, *indices_, min_p, max_p);
+
+  // Check that the leaf size is not too small, given the size of the data
+  int64_t dx = static_cast<int64_t>((max_p[0] - min_p[0]) * inverse_leaf_size_[0])+1;
+  int64_t dy = static_cast<int64_t>((max_p[1] - min_p[1]) * inverse_leaf_size_[1])+1;
+  int64_t dz = static_cast<int64_t>((max_p[2] - min_p[2]) * inverse_leaf_size_[2])+1;
+
+  // The voxel indices are 64 bit wide, only the dense leaf layout is limited to 32 bit indices
+  const bool fits_int32 = (static_cast<double> (dx) * static_cast<double> (dy) * static_cast<double> (dz)) <=
+                          static_cast<double> (std::numeric_limits<int32_t>::max ());
+  if ((static_cast<double> (dx) * static_cast<double> (dy) * static_cast<double> (dz)) >=
+      static_cast<double> (std::numeric_limits<int64_t>::max ()) || (save_leaf_layout_ && !fits_int32))
+  {
+    PCL_WARN("[pcl::%s::applyFilter] Leaf size is too small for the input dataset. Integer indices would overflow.", getClassName().c_str());
+    output = *input_;
+    return;
+  }
+
+  // Compute the minimum and maximum bounding box values
+  min_b_[0] = static_cast<int> (floor (min_p[0] * inverse_leaf_size_[0]));
+  max_b_[0] = static_cast<int> (floor (max_p[0] * inverse_leaf_size_[0]));
+  min_b_[1] = static_cast<int> (floor (min_p[1] * inverse_leaf_size_[1]));
+  max_b_[1] = static_cast<int> (floor (max_p[1] * inverse_leaf_size_[1]));
+  min_b_[2] = static_cast<int> (floor (min_p[2] * inverse_leaf_size_[2]));
+  max_b_[2] = static_cast<int> (floor (max_p[2] * inverse_leaf_size_[2]));
+
+  // Compute the number of divisions needed along all axis
+  div_b_ = max_b_ - min_b_ + Eigen::Vector4i::Ones ();
+  div_b_[3] = 0;
+
+  // Set up the division multiplier, in 64 bit for the voxel indices computed here
+  const uint64_t mul_y = static_cast<uint64_t> (div_b_[0]);
+  const uint64_t mul_z = static_cast<uint64_t> (div_b_[0]) * static_cast<uint64_t> (div_b_[1]);
+  const uint64_t nr_voxels = mul_z * static_cast<uint64_t> (div_b_[2]);
+  if (nr_voxels <= static_cast<uint64_t> (std::numeric_limits<int32_t>::max ()))
+    divb_mul_ = Eigen::Vector4i (1, div_b_[0], div_b_[0] * div_b_[1], 0);
+  else
+    divb_mul_.setZero ();
+
+  // Get the distance field index
+  std::vector<pcl::PCLPointField> fields;
+  int distance_idx = -1;
+  if (!filter_field_name_.empty ())
+  {
+    distance_idx = pcl::getFieldIndex (*input_, filter_field_name_, fields);
+    if (distance_idx == -1)
+      PCL_WARN ("[pcl::%s::applyFilter] Invalid filter field name. Index is %d.\n", getClassName ().c_str (), distance_idx);
+  }
+
+  // First pass: go over all points and compute their voxel index. Each thread processes a contiguous
+  // chunk of the indices, so that concatenating the per-thread results preserves the input order
+  const size_t nr_indices = indices_->size ();
+  std::vector<std::vector<pcl::detail::VoxelGridOMPIndex> > chunks (nr_threads);
+  std::vector<uint64_t> chunk_max_idx (nr_threads, 0);
+  bool indices_sorted = true;
+#ifdef _OPENMP
+#pragma omp parallel for num_threads (nr_threads) reduction (&& : indices_sorted)
+#endif
+  for (int t = 0; t < nr_threads; ++t)
+  {
+    const size_t begin = nr_indices * t / nr_threads;
+    const size_t end = nr_indices * (t + 1) / nr_threads;
+    std::vector<pcl::detail::VoxelGridOMPIndex> &chunk = chunks[t];
+    chunk.reserve (end - begin);
+    for (size_t i = begin; i < end; ++i)
+    {
+      const int index = (*indices_)[i];
+      if (i > 0 && (*indices_)[i - 1] > index)
+        indices_sorted = false;
+
+      const PointT &point = input_->points[index];
+      if (!input_->is_dense)
+        // Check if the point is invalid
+        if (!pcl_isfinite (point.x) || 
+            !pcl_isfinite (point.y) || 
+            !pcl_isfinite (point.z))
+          continue;
+
+      if (!filter_field_name_.empty ())
+      {
+        // Get the distance value
+        const uint8_t* pt_data = reinterpret_cast<const uint8_t*> (&point);
+        float distance_value = 0;
+        memcpy (&distance_value, pt_data + fields[distance_idx].offset, sizeof (float));
+
+        if (filter_limit_negative_)
+        {
+          // Use a threshold for cutting out points which inside the interval
+          if ((distance_value < filter_limit_max_) && (distance_value > filter_limit_min_))
+            continue;
+        }
+        else
+        {
+          // Use a threshold for cutting out points which are too close/far away
+          if ((distance_value > filter_limit_max_) || (distance_value < filter_limit_min_))
+            continue;
+        }
+      }
+
+      int ijk0 = static_cast<int> (floor (point.x * inverse_leaf_size_[0]) - static_cast<float> (min_b_[0]));
+      int ijk1 = static_cast<int> (floor (point.y * inverse_leaf_size_[1]) - static_cast<float> (min_b_[1]));
+      int ijk2 = static_cast<int> (floor (point.z * inverse_leaf_size_[2]) - static_cast<float> (min_b_[2]));
+
+      // Compute the centroid leaf index
+      pcl::detail::VoxelGridOMPIndex entry;
+      entry.idx = static_cast<uint64_t> (ijk0) + static_cast<uint64_t> (ijk1) * mul_y + static_cast<uint64_t> (ijk2) * mul_z;
+      entry.cloud_point_index = static_cast<unsigned int> (index);
+      chunk.push_back (entry);
+      chunk_max_idx[t] = std::max (chunk_max_idx[t], entry.idx);
+    }
+  }
+
+  std::vector<size_t> chunk_offsets (nr_threads + 1, 0);
+  uint64_t max_idx = 0;
+  for (int t = 0; t < nr_threads; ++t)
+  {
+    chunk_offsets[t + 1] = chunk_offsets[t] + chunks[t].size ();
+    max_idx = std::max (max_idx, chunk_max_idx[t]);
+  }
+
+  std::vector<pcl::detail::VoxelGridOMPIndex> index_vector (chunk_offsets[nr_threads]);
+#ifdef _OPENMP
+#pragma omp parallel for num_threads (nr_threads)
+#endif
+  for (int t = 0; t < nr_threads; ++t)
+  {
+    std::copy (chunks[t].begin (), chunks[t].end (), index_vector.begin () + chunk_offsets[t]);
+    std::vector<pcl::detail::VoxelGridOMPIndex> ().swap (chunks[t]);
+  }
+
+  // Second pass: sort the index_vector vector by (voxel index, point index), like VoxelGrid does, so
+  // that the centroids are accumulated in the same order. When the indices are not ascending, the
+  // point index is sorted on first, which the stable passes on the voxel index then preserve
+  std::vector<pcl::detail::VoxelGridOMPIndex> sort_buffer (index_vector.size ());
+  if (!indices_sorted)
+  {
+    for (int shift = 0; shift < 32; shift += 8)
+      if (pcl::detail::voxelGridRadixPass (index_vector, sort_buffer, true, shift, nr_threads))
+        index_vector.swap (sort_buffer);
+  }
+  for (int shift = 0; shift < 64 && (max_idx >> shift) != 0; shift += 8)
+    if (pcl::detail::voxelGridRadixPass (index_vector, sort_buffer, false, shift, nr_threads))
+      index_vector.swap (sort_buffer);
+  std::vector<pcl::detail::VoxelGridOMPIndex> ().swap (sort_buffer);
+
+  // Third pass: count output cells
+  // we need to skip all the same, adjacent idx values
+  unsigned int index = 0;
+  // first_and_last_indices_vector[i] represents the index in index_vector of the first point in
+  // index_vector belonging to the voxel which corresponds to the i-th output point,
+  // and of the first point not belonging to.
+  std::vector<std::pair<unsigned int, unsigned int> > first_and_last_indices_vector;
+  // Worst case size
+  first_and_last_indices_vector.reserve (index_vector.size ());
+  while (index < index_vector.size ()) 
+  {
+    unsigned int i = index + 1;
+    while (i < index_vector.size () && index_vector[i].idx == index_vector[index].idx) 
+      ++i;
+    if (i - index >= min_points_per_voxel_)
+      first_and_last_indices_vector.push_back (std::pair<unsigned int, unsigned int> (index, i));
+    index = i;
+  }
+
+  // Fourth pass: compute centroids, insert them into their final position
+  output.points.resize (first_and_last_indices_vector.size ());
+  if (save_leaf_layout_)
+  {
+    try
+    { 
+      // Resizing won't reset old elements to -1.  If leaf_layout_ has been used previously, it needs to be re-initialized to -1
+      uint32_t new_layout_size = div_b_[0]*div_b_[1]*div_b_[2];
+      //This is the number of elements that need to be re-initialized to -1
+      uint32_t reinit_size = std::min (static_cast<unsigned int> (new_layout_size), static_cast<unsigned int> (leaf_layout_.size()));
+      for (uint32_t i = 0; i < reinit_size; i++)
+      {
+        leaf_layout_[i] = -1;
+      }        
+      leaf_layout_.resize (new_layout_size, -1);           
+    }
+    catch (std::bad_alloc&)
+    {
+      throw PCLException("VoxelGrid bin size is too low; impossible to allocate memory for layout", 
+        "voxel_grid_omp.hpp", "applyFilter");	
+    }
+    catch (std::length_error&)
+    {
+      throw PCLException("VoxelGrid bin size is too low; impossible to allocate memory for layout", 
+        "voxel_grid_omp.hpp", "applyFilter");	
+    }
+  }
+
+#ifdef _OPENMP
+#pragma omp parallel for num_threads (nr_threads)
+#endif
+  for (int cp = 0; cp < static_cast<int> (first_and_last_indices_vector.size ()); ++cp)
+  {
+    // calculate centroid - sum values from all input points, that have the same idx value in index_vector array
+    unsigned int first_index = first_and_last_indices_vector[cp].first;
+    unsigned int last_index = first_and_last_indices_vector[cp].second;
+
+    // cp is the centroid final position in the resulting PointCloud
+    if (save_leaf_layout_)
+      leaf_layout_[index_vector[first_index].idx] = cp;
+
+    //Limit downsampling to coords
+    if (!downsample_all_data_)
+    {
+      Eigen::Vector4f centroid (Eigen::Vector4f::Zero ());
+
+      for (unsigned int li = first_index; li < last_index; ++li)
+        centroid += input_->points[index_vector[li].cloud_point_index].getVector4fMap ();
+
+      centroid /= static_cast<float> (last_index - first_index);
+      output.points[cp].getVector4fMap () = centroid;
+    }
+    else
+    {
+      CentroidPoint<PointT> centroid;
+
+      // fill in the accumulator with leaf points
+      for (unsigned int li = first_index; li < last_index; ++li)
+        centroid.add (input_->points[index_vector[li].cloud_point_index]);  
+
+      centroid.get (output.points[cp]);
+    }
+  }
+  output.width = static_cast<uint32_t> (output.points.size ());
+}
+
+#define PCL_INSTANTIATE_VoxelGridOMP(T) template class PCL_EXPORTS pcl::VoxelGridOMP<T>;
+
+#endif    // PCL_FILTERS_IMPL_VOXEL_GRID_OMP_H_
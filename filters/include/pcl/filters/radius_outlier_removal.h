@@ -90,7 +90,10 @@ namespace pcl
         FilterIndices<PointT>::FilterIndices (extract_removed_indices),
         searcher_ (),
         search_radius_ (0.0),
-        min_pts_radius_ (1)
+        min_pts_radius_ (1),
+        search_epsilon_ (0.0f),
+        use_voxel_counting_ (false),
+        threads_ (1)
       {
         filter_name_ = "RadiusOutlierRemoval";
       }
@@ -139,6 +142,55 @@ namespace pcl
         return (min_pts_radius_);
       }
 
+      /** \brief Set the error bound of the nearest neighbor searches, which allows approximate searches.
+        * \details A neighbor found at distance d is within (1 + eps) d of the true one. This only applies when the
+        * data is not organized, as the default kd-tree is then used.
+        * \param[in] eps the search epsilon precision (default = 0, exact searches)
+        */
+      inline void
+      setSearchEpsilon (float eps)
+      {
+        search_epsilon_ = eps;
+        searcher_.reset ();
+      }
+
+      /** \brief Get the error bound of the nearest neighbor searches. */
+      inline float
+      getSearchEpsilon () const
+      {
+        return (search_epsilon_);
+      }
+
+      /** \brief Set whether the neighbors are counted with a voxel grid instead of a search per point.
+        * \details The points are hashed into voxels whose diagonal is the search radius. A point whose voxel already
+        * holds more than setMinNeighborsInRadius() points is an inlier, and a point whose neighboring voxels hold too
+        * few points is an outlier, without measuring any distance. The remaining points count their neighbors in the
+        * neighboring voxels and stop as soon as there are enough of them. The result is the same as with the searches,
+        * which is much faster on dense clouds.
+        * \param[in] use_voxel_counting true to count the neighbors with a voxel grid (default = false)
+        */
+      inline void
+      setUseVoxelCounting (bool use_voxel_counting)
+      {
+        use_voxel_counting_ = use_voxel_counting;
+      }
+
+      /** \brief Get whether the neighbors are counted with a voxel grid instead of a search per point. */
+      inline bool
+      getUseVoxelCounting () const
+      {
+        return (use_voxel_counting_);
+      }
+
+      /** \brief Set the number of threads the neighbors are counted with.
+        * \param[in] nr_threads the number of hardware threads to use (0 sets the value back to automatic)
+        */
+      inline void
+      setNumberOfThreads (unsigned int nr_threads = 0)
+      {
+        threads_ = nr_threads;
+      }
+
     protected:
       using PCLBase<PointT>::input_;
       using PCLBase<PointT>::indices_;
@@ -171,6 +223,18 @@ namespace pcl
       void
       applyFilterIndices (std::vector<int> &indices);
 
+      /** \brief Find which of the points indexed by indices_ have enough neighbors, with a search per point.
+        * \param[out] has_neighbors nonzero for the points with more than min_pts_radius_ neighbors (query included)
+        */
+      void
+      searchNeighbors (std::vector<char> &has_neighbors);
+
+      /** \brief Find which of the points indexed by indices_ have enough neighbors, with a voxel grid.
+        * \param[out] has_neighbors nonzero for the points with more than min_pts_radius_ neighbors (query included)
+        */
+      void
+      countNeighborsInVoxels (std::vector<char> &has_neighbors);
+
     private:
       /** \brief A pointer to the spatial search object. */
       SearcherPtr searcher_;
@@ -180,6 +244,15 @@ namespace pcl
 
       /** \brief The minimum number of neighbors that a point needs to have in the given search radius to be considered an inlier. */
       int min_pts_radius_;
+
+      /** \brief The error bound of the nearest neighbor searches (default = 0). */
+      float search_epsilon_;
+
+      /** \brief Whether the neighbors are counted with a voxel grid (default = false). */
+      bool use_voxel_counting_;
+
+      /** \brief The number of threads the neighbors are counted with (default = 1). */
+      unsigned int threads_;
   };
 
   //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -99,7 +99,9 @@ namespace pcl
         FilterIndices<PointT>::FilterIndices (extract_removed_indices),
         searcher_ (),
         mean_k_ (1),
-        std_mul_ (0.0)
+        std_mul_ (0.0),
+        search_epsilon_ (0.0f),
+        threads_ (1)
       {
         filter_name_ = "StatisticalOutlierRemoval";
       }
@@ -143,6 +145,34 @@ namespace pcl
         return (std_mul_);
       }
 
+      /** \brief Set the error bound of the nearest neighbor searches, which allows approximate searches.
+        * \details A neighbor found at distance d is within (1 + eps) d of the true one, so the mean distances are
+        * slightly overestimated. This only applies when the data is not organized, as the default kd-tree is then used.
+        * \param[in] eps the search epsilon precision (default = 0, exact searches)
+        */
+      inline void
+      setSearchEpsilon (float eps)
+      {
+        search_epsilon_ = eps;
+        searcher_.reset ();
+      }
+
+      /** \brief Get the error bound of the nearest neighbor searches. */
+      inline float
+      getSearchEpsilon () const
+      {
+        return (search_epsilon_);
+      }
+
+      /** \brief Set the number of threads the mean distances are computed with.
+        * \param[in] nr_threads the number of hardware threads to use (0 sets the value back to automatic)
+        */
+      inline void
+      setNumberOfThreads (unsigned int nr_threads = 0)
+      {
+        threads_ = nr_threads;
+      }
+
     protected:
       using PCLBase<PointT>::input_;
       using PCLBase<PointT>::indices_;
@@ -185,6 +215,12 @@ namespace pcl
       /** \brief Standard deviations threshold (i.e., points outside of 
         * \f$ \mu \pm \sigma \cdot std\_mul \f$ will be marked as outliers). */
       double std_mul_;
+
+      /** \brief The error bound of the nearest neighbor searches (default = 0). */
+      float search_epsilon_;
+
+      /** \brief The number of threads the mean distances are computed with (default = 1). */
+      unsigned int threads_;
   };
 
   /** \brief @b StatisticalOutlierRemoval uses point neighborhood statistics to filter outlier data. For more
@@ -40,7 +40,6 @@
 
 #include <pcl/filters/boost.h>
 #include <pcl/filters/voxel_grid.h>
-#include <map>
 #include <pcl/point_types.h>
 #include <pcl/kdtree/kdtree_flann.h>
 
@@ -193,6 +192,9 @@ namespace pcl
       /** \brief Const pointer to VoxelGridCovariance leaf structure */
       typedef const Leaf* LeafConstPtr;
 
+      /** \brief Flat storage of the leaves, sorted by voxel index. */
+      typedef std::vector<Leaf, Eigen::aligned_allocator<Leaf> > LeafVector;
+
     public:
 
       /** \brief Constructor.
@@ -203,9 +205,13 @@ namespace pcl
         min_points_per_voxel_ (6),
         min_covar_eigvalue_mult_ (0.01),
         leaves_ (),
+        leaf_voxel_indices_ (),
+        leaf_table_ (),
+        leaf_table_shift_ (63),
         voxel_centroids_ (),
         voxel_centroids_leaf_indices_ (),
-        kdtree_ ()
+        kdtree_ (),
+        threads_ (1)
       {
         downsample_all_data_ = false;
         save_leaf_layout_ = false;
@@ -259,6 +265,16 @@ namespace pcl
         return min_covar_eigvalue_mult_;
       }
 
+      /** \brief Set the number of threads used to build the voxel structure.
+        * The result does not depend on the number of threads.
+        * \param[in] nr_threads the number of hardware threads to use (0 sets the value back to automatic)
+        */
+      inline void
+      setNumberOfThreads (unsigned int nr_threads = 0)
+      {
+        threads_ = nr_threads;
+      }
+
       /** \brief Filter cloud and initializes voxel structure.
        * \param[out] output cloud containing centroids of voxels containing a sufficient number of points
        * \param[in] searchable flag if voxel structure is searchable, if true then kdtree is built
@@ -302,14 +318,8 @@ namespace pcl
       inline LeafConstPtr
       getLeaf (int index)
       {
-        typename std::map<size_t, Leaf>::iterator leaf_iter = leaves_.find (index);
-        if (leaf_iter != leaves_.end ())
-        {
-          LeafConstPtr ret (&(leaf_iter->second));
-          return ret;
-        }
-        else
-          return NULL;
+        const int leaf_idx = findLeaf (static_cast<size_t> (index));
+        return (leaf_idx < 0 ? NULL : &leaves_[leaf_idx]);
       }
 
       /** \brief Get the voxel containing point p.
@@ -328,15 +338,7 @@ namespace pcl
         int idx = ijk0 * divb_mul_[0] + ijk1 * divb_mul_[1] + ijk2 * divb_mul_[2];
 
         // Find leaf associated with index
-        typename std::map<size_t, Leaf>::iterator leaf_iter = leaves_.find (idx);
-        if (leaf_iter != leaves_.end ())
-        {
-          // If such a leaf exists return the pointer to the leaf structure
-          LeafConstPtr ret (&(leaf_iter->second));
-          return ret;
-        }
-        else
-          return NULL;
+        return (getLeaf (idx));
       }
 
       /** \brief Get the voxel containing point p.
@@ -355,16 +357,7 @@ namespace pcl
         int idx = ijk0 * divb_mul_[0] + ijk1 * divb_mul_[1] + ijk2 * divb_mul_[2];
 
         // Find leaf associated with index
-        typename std::map<size_t, Leaf>::iterator leaf_iter = leaves_.find (idx);
-        if (leaf_iter != leaves_.end ())
-        {
-          // If such a leaf exists return the pointer to the leaf structure
-          LeafConstPtr ret (&(leaf_iter->second));
-          return ret;
-        }
-        else
-          return NULL;
-
+        return (getLeaf (idx));
       }
 
       /** \brief Get the voxels surrounding point p, not including the voxel containing point p.
@@ -376,15 +369,75 @@ namespace pcl
       int
       getNeighborhoodAtPoint (const PointT& reference_point, std::vector<LeafConstPtr> &neighbors);
 
-      /** \brief Get the leaf structure map
-       * \return a map contataining all leaves
+      /** \brief Get the voxels at the given displacements from the voxel containing point p.
+       * \note Only voxels containing a sufficient number of points and a valid covariance are used.
+       * Each voxel is looked up in constant time, no kd-tree is needed.
+       * \param[in] relative_coordinates the displacements in voxels, one per column (3 x n)
+       * \param[in] reference_point the point to get the leaf structures around
+       * \param[out] neighbors the leaves found, in the order of the displacements
+       * \return number of neighbors found
+       */
+      int
+      getNeighborhoodAtPoint (const Eigen::MatrixXi &relative_coordinates, const PointT &reference_point,
+                              std::vector<LeafConstPtr> &neighbors) const;
+
+      /** \brief Get the voxel containing point p, if it is usable.
+       * \param[in] reference_point the point to get the leaf structure at
+       * \param[out] neighbors the leaf found (at most one)
+       * \return number of neighbors found
+       */
+      int
+      getVoxelAtPoint (const PointT &reference_point, std::vector<LeafConstPtr> &neighbors) const;
+
+      /** \brief Get the voxel containing point p and its 6 face neighbors, if they are usable.
+       * \param[in] reference_point the point to get the leaf structures around
+       * \param[out] neighbors the leaves found (at most 7)
+       * \return number of neighbors found
+       */
+      int
+      getFaceNeighborsAtPoint (const PointT &reference_point, std::vector<LeafConstPtr> &neighbors) const;
+
+      /** \brief Get the voxel containing point p and its 26 neighbors, if they are usable.
+       * \param[in] reference_point the point to get the leaf structures around
+       * \param[out] neighbors the leaves found (at most 27)
+       * \return number of neighbors found
        */
-      inline const std::map<size_t, Leaf>&
-      getLeaves ()
+      int
+      getAllNeighborsAtPoint (const PointT &reference_point, std::vector<LeafConstPtr> &neighbors) const;
+
+      /** \brief Get all leaves, sorted by voxel index (see \ref getLeafVoxelIndices).
+       * \return a vector contataining all leaves
+       */
+      inline const LeafVector&
+      getLeaves () const
       {
         return leaves_;
       }
 
+      /** \brief Get the voxel index of each leaf, in the order of \ref getLeaves. */
+      inline const std::vector<size_t>&
+      getLeafVoxelIndices () const
+      {
+        return leaf_voxel_indices_;
+      }
+
+      /** \brief Save the voxel structure to a binary file, so that it can be loaded without the input cloud.
+       * \note The file is written in the byte order of the host.
+       * \param[in] file_name the name of the file to write
+       * \return true if the file was written successfully
+       */
+      bool
+      saveLeaves (const std::string &file_name) const;
+
+      /** \brief Load a voxel structure saved with \ref saveLeaves, replacing the current one.
+       * The leaf size, the voxel centroids and the minimum number of points per voxel are restored as well.
+       * \param[in] file_name the name of the file to read
+       * \param[in] searchable flag if voxel structure is searchable, if true then kdtree is built
+       * \return true if the file was read successfully
+       */
+      bool
+      loadLeaves (const std::string &file_name, bool searchable = false);
+
       /** \brief Get a pointcloud containing the voxel centroids
        * \note Only voxels containing a sufficient number of points are used.
        * \return a map contataining all leaves
@@ -517,6 +570,59 @@ namespace pcl
        */
       void applyFilter (PointCloud &output);
 
+      /** \brief Build the hash table used to look leaves up by voxel index from \ref leaf_voxel_indices_. */
+      void
+      buildLeafTable ();
+
+      /** \brief Hash a voxel index into \ref leaf_table_. This is a multiplicative (Fibonacci) hash
+       * which keeps the high bits of the product, so that voxel indices which only differ in
+       * their high bits, e.g. neighboring rows of a grid with a power of two width, do not collide.
+       */
+      inline size_t
+      hashVoxelIndex (size_t voxel_index) const
+      {
+        return (static_cast<size_t> ((static_cast<uint64_t> (voxel_index) * 0x9E3779B97F4A7C15ull) >> leaf_table_shift_));
+      }
+
+      /** \brief Find the leaf at the given voxel index in constant time.
+       * \param[in] voxel_index the index of the voxel
+       * \return the position of the leaf in \ref leaves_, or -1 if the voxel is empty
+       */
+      inline int
+      findLeaf (size_t voxel_index) const
+      {
+        if (leaf_table_.empty ())
+          return (-1);
+        // Open addressing with linear probing, the table is at most half full
+        for (size_t slot = hashVoxelIndex (voxel_index); leaf_table_[slot] >= 0; slot = (slot + 1) & (leaf_table_.size () - 1))
+          if (leaf_voxel_indices_[leaf_table_[slot]] == voxel_index)
+            return (leaf_table_[slot]);
+        return (-1);
+      }
+
+      /** \brief Append the usable leaf at the given voxel coordinates to a list of leaves, if there is one.
+       * \param[in] ijk the integer coordinates of the voxel
+       * \param[in,out] neighbors the list of leaves
+       */
+      inline void
+      appendUsableLeaf (const Eigen::Vector4i &ijk, std::vector<LeafConstPtr> &neighbors) const
+      {
+        if ((ijk.array () < min_b_.array ()).any () || (ijk.array () > max_b_.array ()).any ())
+          return;
+        const int leaf_idx = findLeaf (static_cast<size_t> ((ijk - min_b_).dot (divb_mul_)));
+        if (leaf_idx >= 0 && leaves_[leaf_idx].nr_points >= min_points_per_voxel_)
+          neighbors.push_back (&leaves_[leaf_idx]);
+      }
+
+      /** \brief Get the integer coordinates of the voxel containing a point. */
+      inline Eigen::Vector4i
+      getVoxelCoordinates (const PointT &p) const
+      {
+        return (Eigen::Vector4i (static_cast<int> (floor (p.x * inverse_leaf_size_[0])),
+                                 static_cast<int> (floor (p.y * inverse_leaf_size_[1])),
+                                 static_cast<int> (floor (p.z * inverse_leaf_size_[2])), 0));
+      }
+
       /** \brief Flag to determine if voxel structure is searchable. */
       bool searchable_;
 
@@ -526,17 +632,29 @@ namespace pcl
       /** \brief Minimum allowable ratio between eigenvalues to prevent singular covariance matrices. */
       double min_covar_eigvalue_mult_;
 
-      /** \brief Voxel structure containing all leaf nodes (includes voxels with less than a sufficient number of points). */
-      std::map<size_t, Leaf> leaves_;
+      /** \brief Voxel structure containing all leaf nodes, sorted by voxel index (includes voxels with less than a sufficient number of points). */
+      LeafVector leaves_;
+
+      /** \brief Voxel index of each leaf in \ref leaves_. */
+      std::vector<size_t> leaf_voxel_indices_;
+
+      /** \brief Open addressing hash table of positions in \ref leaves_ (-1 marks an empty slot), its size is a power of two. */
+      std::vector<int> leaf_table_;
+
+      /** \brief 64 minus the base 2 logarithm of the size of \ref leaf_table_, used by hashVoxelIndex (). */
+      int leaf_table_shift_;
 
       /** \brief Point cloud containing centroids of voxels containing atleast minimum number of points. */
       PointCloudPtr voxel_centroids_;
 
-      /** \brief Indices of leaf structurs associated with each point in \ref voxel_centroids_ (used for searching). */
+      /** \brief Positions in \ref leaves_ of the leaf structurs associated with each point in \ref voxel_centroids_ (used for searching). */
       std::vector<int> voxel_centroids_leaf_indices_;
 
       /** \brief KdTree generated using \ref voxel_centroids_ (used for searching). */
       KdTreeFLANN<PointT> kdtree_;
+
+      /** \brief The number of threads the voxel structure is built with. */
+      unsigned int threads_;
   };
 }
 
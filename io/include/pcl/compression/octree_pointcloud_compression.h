@@ -167,16 +167,6 @@ namespace pcl
 
         }
 
-        /** \brief Add point at index from input pointcloud dataset to octree
-         * \param[in] pointIdx_arg the index representing the point in the dataset given by \a setInputCloud to be added
-         */
-        virtual void
-        addPointIdx (const int pointIdx_arg)
-        {
-          ++object_count_;
-          OctreePointCloud<PointT, LeafT, BranchT, OctreeT>::addPointIdx(pointIdx_arg);
-        }
-
         /** \brief Provide a pointer to the output data set.
           * \param cloud_arg: the boost shared pointer to a PointCloud message
           */
@@ -214,6 +204,17 @@ namespace pcl
 
       protected:
 
+        /** \brief Add point at index from input pointcloud dataset to a leaf node and count it
+         * \param[in] leaf_arg container of the leaf node
+         * \param[in] pointIdx_arg the index representing the point in the dataset given by \a setInputCloud to be added
+         */
+        virtual void
+        addPointToLeaf (LeafT& leaf_arg, const int pointIdx_arg)
+        {
+          ++object_count_;
+          OctreePointCloud<PointT, LeafT, BranchT, OctreeT>::addPointToLeaf (leaf_arg, pointIdx_arg);
+        }
+
         /** \brief Write frame information to output stream
           * \param compressed_tree_data_out_arg: binary output stream
           */
@@ -47,6 +47,7 @@
 #include <pcl/point_cloud.h>
 #include <boost/asio.hpp>
 #include <string>
+#include <vector>
 
 #define HDL_Grabber_toRadians(x) ((x) * M_PI / 180.0)
 
@@ -211,6 +212,46 @@ namespace pcl
       virtual uint8_t
       getMaximumNumberOfLasers () const;
 
+      /** \brief Enables or disables the organized output of the sweep point clouds.
+       *         In organized mode, every sweep has one row per laser, ordered by elevation from the top, and one column per
+       *         azimuth bin, starting at angle "0". Cells without a valid return hold NaN points, so that the sweeps can be
+       *         processed with OrganizedNeighbor or IntegralImageNormalEstimation. If several returns of a laser fall into
+       *         the same bin, the last one is kept. The scan point clouds of single packets are never organized.
+       *         This should be called while the grabber is stopped.
+       *         Default: disabled
+       * \param[in] organized whether the sweep point clouds are organized
+       * \param[in] azimuthBins number of azimuth bins (columns) of an organized sweep. The default of 1800 matches the
+       *            0.2 degree firing interval of the HDL-32 and VLP-16 spinning at 10 Hz
+       */
+      void
+      setOrganizedOutput (const bool organized,
+                          const unsigned int azimuthBins = 1800);
+
+      /** \brief Returns true if the sweep point clouds are organized
+       */
+      bool
+      getOrganizedOutput () const;
+
+      /** \brief Enables or disables the fast replay of the PCAP file.
+       *         In fast mode, the PCAP file is memory mapped and replayed as fast as possible instead of at the recorded
+       *         rate. It is split at the sweep boundaries and the packets of several sweeps are decoded in parallel.
+       *         The signals are still emitted in the order of the file, from the replay thread.
+       *         The fast replay does not need libpcap. It only considers UDP packets over IPv4 and Ethernet,
+       *         with or without an 802.1Q VLAN tag.
+       *         This should be called while the grabber is stopped.
+       *         Default: disabled
+       * \param[in] fast whether the PCAP file is replayed as fast as possible
+       * \param[in] nrThreads number of decoding threads (0 uses the number of hardware threads)
+       */
+      void
+      setFastPcapReplay (const bool fast,
+                         const unsigned int nrThreads = 0);
+
+      /** \brief Returns true if the PCAP file is replayed as fast as possible
+       */
+      bool
+      getFastPcapReplay () const;
+
     protected:
       static const uint16_t HDL_DATA_PORT = 2368;
       static const uint16_t HDL_NUM_ROT_ANGLES = 36001;
@@ -246,6 +287,34 @@ namespace pcl
           uint8_t sensorType;
       };
 
+      /** \brief A laser return of a packet, converted to cartesian coordinates */
+      struct HDLDecodedReturn
+      {
+          float x;
+          float y;
+          float z;
+          float intensity;
+          uint32_t rgba;
+          /** \brief Azimuth in hundredths of degrees */
+          double azimuth;
+          uint8_t laser;
+          /** \brief The return has finite coordinates within the distance thresholds */
+          bool valid;
+          /** \brief Second return of a dual return packet. It neither starts a sweep nor updates the last azimuth. */
+          bool dual;
+      };
+
+      /** \brief The returns of a packet, in the order in which they are added to the point clouds */
+      struct HDLDecodedPacket
+      {
+          std::vector<HDLDecodedReturn> returns;
+          uint32_t gpsTimestamp;
+          uint16_t startAngle;
+          uint16_t endAngle;
+          /** \brief The packet is also emitted as a scan point cloud */
+          bool hasScan;
+      };
+
       struct HDLLaserCorrection
       {
           double azimuthCorrection;
@@ -264,6 +333,16 @@ namespace pcl
       boost::shared_ptr<pcl::PointCloud<pcl::PointXYZ> > current_scan_xyz_, current_sweep_xyz_;
       boost::shared_ptr<pcl::PointCloud<pcl::PointXYZI> > current_scan_xyzi_, current_sweep_xyzi_;
       boost::shared_ptr<pcl::PointCloud<pcl::PointXYZRGBA> > current_scan_xyzrgba_, current_sweep_xyzrgba_;
+      /** \brief Number of valid returns added to the current sweep. */
+      uint32_t current_sweep_size_;
+      /** \brief Whether the sweep point clouds are organized. */
+      bool organized_output_;
+      /** \brief Number of columns of the organized sweep point clouds. */
+      unsigned int azimuth_bins_;
+      /** \brief Number of rows of the organized sweep point clouds. */
+      unsigned int organized_rows_;
+      /** \brief Row of each laser in the organized sweep point clouds. */
+      unsigned int laser_rows_[HDL_MAX_NUM_LASERS];
       boost::signals2::signal<sig_cb_velodyne_hdl_sweep_point_cloud_xyz>* sweep_xyz_signal_;
       boost::signals2::signal<sig_cb_velodyne_hdl_sweep_point_cloud_xyzrgba>* sweep_xyzrgba_signal_;
       boost::signals2::signal<sig_cb_velodyne_hdl_sweep_point_cloud_xyzi>* sweep_xyzi_signal_;
@@ -280,9 +359,53 @@ namespace pcl
       void
       computeXYZI (pcl::PointXYZI& pointXYZI,
                    uint16_t azimuth,
-                   HDLLaserReturn laserReturn,
-                   HDLLaserCorrection correction);
+                   const HDLLaserReturn& laserReturn,
+                   const HDLLaserCorrection& correction) const;
 
+      /** \brief Converts the returns of a packet to cartesian coordinates. This does not modify the state of the grabber,
+       *         so that packets can be decoded in parallel.
+       * \param[in] dataPacket the packet
+       * \param[out] decoded the returns of the packet
+       */
+      virtual void
+      decodePacket (const HDLDataPacket& dataPacket,
+                    HDLDecodedPacket& decoded) const;
+
+      /** \brief Adds the returns of a decoded packet to the scan and sweep point clouds, emitting the completed ones.
+       * \param[in] decoded the returns of the packet
+       */
+      void
+      assemblePacket (const HDLDecodedPacket& decoded);
+
+      /** \brief Prepares the scan point clouds for the next packet, reusing clouds which no callback holds anymore.
+       */
+      void
+      resetCurrentScan ();
+
+      /** \brief Prepares the sweep point clouds for the next sweep, reusing clouds which no callback holds anymore.
+       */
+      void
+      resetCurrentSweep ();
+
+      /** \brief Adds a valid return to the sweep point clouds, at the cell of its laser and azimuth in organized mode.
+       * \param[in] xyz the point
+       * \param[in] xyzi the point with its intensity
+       * \param[in] xyzrgba the point with the color of its laser
+       * \param[in] laser the number of the laser
+       * \param[in] azimuth the azimuth of the return in hundredths of degrees
+       */
+      void
+      addSweepPoint (const pcl::PointXYZ& xyz,
+                     const pcl::PointXYZI& xyzi,
+                     const pcl::PointXYZRGBA& xyzrgba,
+                     const uint8_t laser,
+                     const double azimuth);
+
+      /** \brief Converts a data packet to point clouds, emitting the scan and the completed sweep.
+       * \param[in] dataPacket the packet
+       */
+      virtual void
+      toPointClouds (HDLDataPacket *dataPacket);
 
     private:
       static double *cos_lookup_table_;
@@ -298,12 +421,19 @@ namespace pcl
       boost::thread *hdl_read_packet_thread_;
       bool terminate_read_packet_thread_;
       pcl::RGB laser_rgb_mapping_[HDL_MAX_NUM_LASERS];
+      /** \brief Hands out point clouds which return to the pool once the callbacks release them. */
+      template <typename PointT> class CloudPool;
+      boost::shared_ptr<CloudPool<pcl::PointXYZ> > scan_pool_xyz_, sweep_pool_xyz_;
+      boost::shared_ptr<CloudPool<pcl::PointXYZI> > scan_pool_xyzi_, sweep_pool_xyzi_;
+      boost::shared_ptr<CloudPool<pcl::PointXYZRGBA> > scan_pool_xyzrgba_, sweep_pool_xyzrgba_;
+      HDLDecodedPacket decoded_packet_;
+      uint32_t scan_counter_;
+      uint32_t sweep_counter_;
+      bool fast_pcap_replay_;
+      unsigned int replay_threads_;
       float min_distance_threshold_;
       float max_distance_threshold_;
 
-      virtual void
-      toPointClouds (HDLDataPacket *dataPacket);
-
       virtual boost::asio::ip::address
       getDefaultNetworkAddress ();
 
@@ -332,6 +462,16 @@ namespace pcl
 
 #endif //#ifdef HAVE_PCAP
 
+      void
+      replayPcapFile ();
+
+      void
+      decodePcapChunks (const std::vector<const uint8_t *>& packets,
+                        const std::vector<size_t>& chunkBegin,
+                        const size_t firstChunk,
+                        const size_t chunkStep,
+                        std::vector<HDLDecodedPacket>& decoded) const;
+
       bool
       isAddressUnspecified (const boost::asio::ip::address& ip_address);
 
@@ -291,6 +291,24 @@ pcl::PCDWriter::writeBinaryCompressed (const std::string &file_name,
     throw pcl::IOException ("[pcl::PCDWriter::writeBinaryCompressed] Input point cloud has no data!");
     return (-1);
   }
+
+  if (getCompressionChunkSize () > 0)
+  {
+    std::vector<pcl::PCLPointField> fields;
+    pcl::getFields (cloud, fields);
+    std::vector<char> body;
+    compressChunked (reinterpret_cast<const uint8_t*> (&cloud.points[0]), sizeof (PointT), cloud.points.size (), fields, body);
+
+    std::string buffer = generateHeader<PointT> (cloud) + "DATA binary_compressed_chunked\n";
+    buffer.append (&body[0], body.size ());
+    if (writeMapped (file_name, buffer.data (), buffer.size ()))
+    {
+      throw pcl::IOException ("[pcl::PCDWriter::writeBinaryCompressed] Error writing the chunked data!");
+      return (-1);
+    }
+    return (0);
+  }
+
   int data_idx = 0;
   std::ostringstream oss;
   oss << generateHeader<PointT> (cloud) << "DATA binary_compressed\n";
@@ -974,5 +992,102 @@ pcl::PCDWriter::writeASCII (const std::string &file_name,
   return (0);
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template <typename T> pcl::PCDMappedCloud::FieldView<T>
+pcl::PCDMappedCloud::getField (const std::string &field_name, unsigned int element) const
+{
+  if (!isOpen ())
+  {
+    PCL_ERROR ("[pcl::PCDMappedCloud::getField] No file is mapped!\n");
+    return (FieldView<T> ());
+  }
+
+  int idx = pcl::getFieldIndex (info_, field_name);
+  if (idx == -1)
+  {
+    PCL_ERROR ("[pcl::PCDMappedCloud::getField] Field %s not found!\n", field_name.c_str ());
+    return (FieldView<T> ());
+  }
+
+  const pcl::PCLPointField &field = info_.fields[idx];
+  if (field.datatype != pcl::traits::asEnum<T>::value)
+  {
+    PCL_ERROR ("[pcl::PCDMappedCloud::getField] Field %s has datatype %d, which does not match the requested one!\n",
+               field_name.c_str (), static_cast<int> (field.datatype));
+    return (FieldView<T> ());
+  }
+  if (element >= field.count)
+  {
+    PCL_ERROR ("[pcl::PCDMappedCloud::getField] Field %s has only %u elements!\n", field_name.c_str (), field.count);
+    return (FieldView<T> ());
+  }
+
+  return (FieldView<T> (data_ + field.offset + element * sizeof (T), info_.point_step, size ()));
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> int
+pcl::PCDMappedCloud::copyToPointCloud (pcl::PointCloud<PointT> &cloud) const
+{
+  if (!isOpen ())
+  {
+    PCL_ERROR ("[pcl::PCDMappedCloud::copyToPointCloud] No file is mapped!\n");
+    return (-1);
+  }
+
+  MsgFieldMap field_map;
+  createMapping<PointT> (info_.fields, field_map);
+
+  cloud.header = info_.header;
+  cloud.width = info_.width;
+  cloud.height = info_.height;
+  cloud.is_dense = false;
+  cloud.sensor_origin_ = origin_;
+  cloud.sensor_orientation_ = orientation_;
+  cloud.points.resize (size ());
+
+  const uint8_t *point_data = data_;
+  for (size_t i = 0; i < cloud.points.size (); ++i, point_data += info_.point_step)
+    copyPoint (point_data, field_map, cloud.points[i]);
+
+  return (0);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> int
+pcl::PCDMappedCloud::copyToPointCloud (const std::vector<int> &indices, pcl::PointCloud<PointT> &cloud) const
+{
+  if (!isOpen ())
+  {
+    PCL_ERROR ("[pcl::PCDMappedCloud::copyToPointCloud] No file is mapped!\n");
+    return (-1);
+  }
+
+  for (size_t i = 0; i < indices.size (); ++i)
+  {
+    if (indices[i] < 0 || static_cast<size_t> (indices[i]) >= size ())
+    {
+      PCL_ERROR ("[pcl::PCDMappedCloud::copyToPointCloud] Index %d is out of range (%lu points)!\n", indices[i], static_cast<unsigned long> (size ()));
+      return (-1);
+    }
+  }
+
+  MsgFieldMap field_map;
+  createMapping<PointT> (info_.fields, field_map);
+
+  cloud.header = info_.header;
+  cloud.width = static_cast<uint32_t> (indices.size ());
+  cloud.height = 1;
+  cloud.is_dense = false;
+  cloud.sensor_origin_ = origin_;
+  cloud.sensor_orientation_ = orientation_;
+  cloud.points.resize (indices.size ());
+
+  for (size_t i = 0; i < indices.size (); ++i)
+    copyPoint (getPointData (indices[i]), field_map, cloud.points[i]);
+
+  return (0);
+}
+
 #endif  //#ifndef PCL_IO_PCD_IO_H_
 
@@ -42,6 +42,7 @@
 
 #include <pcl/point_cloud.h>
 #include <pcl/io/file_io.h>
+#include <boost/noncopyable.hpp>
 
 namespace pcl
 {
@@ -53,7 +54,7 @@ namespace pcl
   {
     public:
       /** Empty constructor */
-      PCDReader () : FileReader () {}
+      PCDReader () : FileReader (), threads_ (0) {}
       /** Empty destructor */
       ~PCDReader () {}
 
@@ -100,7 +101,7 @@ namespace pcl
         * \param[out] origin the sensor acquisition origin (only for > PCD_V7 - null if not present)
         * \param[out] orientation the sensor acquisition orientation (only for > PCD_V7 - identity if not present)
         * \param[out] pcd_version the PCD version of the file (i.e., PCD_V6, PCD_V7)
-        * \param[out] data_type the type of data (0 = ASCII, 1 = Binary, 2 = Binary compressed) 
+        * \param[out] data_type the type of data (0 = ASCII, 1 = Binary, 2 = Binary compressed, 3 = Binary compressed in chunks) 
         * \param[out] data_idx the offset of cloud data within the file
         *
         * \return
@@ -128,7 +129,7 @@ namespace pcl
         * \param[out] origin the sensor acquisition origin (only for > PCD_V7 - null if not present)
         * \param[out] orientation the sensor acquisition orientation (only for > PCD_V7 - identity if not present)
         * \param[out] pcd_version the PCD version of the file (i.e., PCD_V6, PCD_V7)
-        * \param[out] data_type the type of data (0 = ASCII, 1 = Binary, 2 = Binary compressed) 
+        * \param[out] data_type the type of data (0 = ASCII, 1 = Binary, 2 = Binary compressed, 3 = Binary compressed in chunks) 
         * \param[out] data_idx the offset of cloud data within the file
         * \param[in] offset the offset of where to expect the PCD Header in the
         * file (optional parameter). One usage example for setting the offset
@@ -213,6 +214,30 @@ namespace pcl
       readBodyBinary (const unsigned char *data, pcl::PCLPointCloud2 &cloud,
                        int pcd_version, bool compressed, unsigned int data_idx);
 
+      /** \brief Read the point cloud data (body) of a binary_compressed_chunked PCD file from
+        * a block of memory. The chunks are decompressed in parallel.
+        *
+        * For use after readHeader(), when the resulting data_type == 3.
+        *
+        * \param[in] data the memory location from which to read the body.
+        * \param[in] data_size the size of the memory block, used to check the chunk table.
+        * \param[out] cloud the resultant point cloud dataset to be filled.
+        * \param[in] data_idx the offset of the body, as reported by readHeader().
+        *
+        * \return
+        *  * < 0 (-1) on error
+        *  * == 0 on success
+        */
+      int
+      readBodyBinaryChunked (const unsigned char *data, size_t data_size,
+                             pcl::PCLPointCloud2 &cloud, unsigned int data_idx);
+
+      /** \brief Set the number of threads used to decompress binary_compressed_chunked files.
+        * \param[in] nr_threads the number of hardware threads to use (0 sets the value back to automatic)
+        */
+      inline void
+      setNumberOfThreads (unsigned int nr_threads = 0) { threads_ = nr_threads; }
+
       /** \brief Read a point cloud data from a PCD file and store it into a pcl/PCLPointCloud2.
         * \param[in] file_name the name of the file containing the actual PointCloud data
         * \param[out] cloud the resultant PointCloud message read from disk
@@ -285,6 +310,184 @@ namespace pcl
         return (res);
       }
 
+    private:
+      /** \brief The number of threads used to decompress chunked data. */
+      unsigned int threads_;
+
+    public:
+      EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+  };
+
+  /** \brief Read-only, memory-mapped view of the points stored in a binary PCD file.
+    *
+    * Opening a file only parses its header and maps it into memory; the points are paged in
+    * by the operating system as they are accessed. This makes it possible to inspect or
+    * crop very large files without loading (or even having memory for) all of their data.
+    *
+    * Individual fields can be accessed in place through strided FieldView objects. Since
+    * the point data follows a textual header, it is in general not aligned, and values are
+    * copied out on access. To hand the data to algorithms working on pcl::PointCloud, such
+    * as filters or search, use copyToPointCloud (), which converts straight from the mapped
+    * file without going through an intermediate PCLPointCloud2.
+    *
+    * \note Only \b binary PCD files can be mapped; ASCII and binary_compressed files have
+    * to be read with PCDReader.
+    * \ingroup io
+    */
+  class PCL_EXPORTS PCDMappedCloud : boost::noncopyable
+  {
+    public:
+      typedef boost::shared_ptr<PCDMappedCloud> Ptr;
+      typedef boost::shared_ptr<const PCDMappedCloud> ConstPtr;
+
+      /** \brief Strided view of one field of a mapped cloud.
+        * \note The view is only valid as long as the PCDMappedCloud it was obtained from
+        * stays open.
+        */
+      template <typename T>
+      class FieldView
+      {
+        public:
+          /** \brief Empty constructor, creates an invalid view. */
+          FieldView () : data_ (NULL), stride_ (0), size_ (0) {}
+
+          /** \brief Constructor.
+            * \param[in] data pointer to the field of the first point
+            * \param[in] stride the distance between two consecutive points, in bytes
+            * \param[in] size the number of points
+            */
+          FieldView (const uint8_t *data, size_t stride, size_t size)
+            : data_ (data), stride_ (stride), size_ (size) {}
+
+          /** \brief Get the value of the field for the point at the given index. */
+          inline T
+          operator[] (size_t index) const
+          {
+            T value;
+            memcpy (&value, data_ + index * stride_, sizeof (T));
+            return (value);
+          }
+
+          /** \brief Get the number of points in the view. */
+          inline size_t
+          size () const { return (size_); }
+
+          /** \brief Check whether the view refers to a field. */
+          inline bool
+          isValid () const { return (data_ != NULL); }
+
+        private:
+          const uint8_t *data_;
+          size_t stride_;
+          size_t size_;
+      };
+
+      /** \brief Empty constructor. */
+      PCDMappedCloud ();
+
+      /** \brief Destructor. Unmaps the file if it is still open. */
+      ~PCDMappedCloud ();
+
+      /** \brief Map a binary PCD file into memory.
+        * \param[in] file_name the name of the file to map
+        * \param[in] offset the offset of the PCD header in the file (e.g., for files embedded in archives)
+        *
+        * \return
+        *  * < 0 (-1) on error
+        *  * == 0 on success
+        */
+      int
+      open (const std::string &file_name, const int offset = 0);
+
+      /** \brief Unmap the file. All FieldView objects obtained so far become invalid. */
+      void
+      close ();
+
+      /** \brief Check whether a file is currently mapped. */
+      inline bool
+      isOpen () const { return (map_ != NULL); }
+
+      /** \brief Get the description of the mapped cloud: width, height, point_step, row_step
+        * and fields. The data member is empty; is_dense is false, as it is not stored in the file.
+        */
+      inline const pcl::PCLPointCloud2&
+      getInfo () const { return (info_); }
+
+      /** \brief Get the number of points in the mapped cloud. */
+      inline size_t
+      size () const { return (static_cast<size_t> (info_.width) * info_.height); }
+
+      /** \brief Get the sensor acquisition origin stored in the file. */
+      inline const Eigen::Vector4f&
+      getOrigin () const { return (origin_); }
+
+      /** \brief Get the sensor acquisition orientation stored in the file. */
+      inline const Eigen::Quaternionf&
+      getOrientation () const { return (orientation_); }
+
+      /** \brief Get a pointer to the (unaligned) raw data of a point.
+        * \param[in] index the index of the point, in row major order
+        */
+      inline const uint8_t*
+      getPointData (size_t index) const { return (data_ + index * info_.point_step); }
+
+      /** \brief Get a strided view of a field of the mapped cloud.
+        * \param[in] field_name the name of the field (e.g., "x", "intensity")
+        * \param[in] element the element to view, for fields with a count larger than 1
+        * \return an invalid view if the cloud has no such field, or if its datatype does not match T
+        */
+      template <typename T> FieldView<T>
+      getField (const std::string &field_name, unsigned int element = 0) const;
+
+      /** \brief Convert the whole mapped cloud into a pcl::PointCloud.
+        * \param[out] cloud the resultant point cloud
+        * \return 0 on success, -1 if no file is mapped
+        */
+      template <typename PointT> int
+      copyToPointCloud (pcl::PointCloud<PointT> &cloud) const;
+
+      /** \brief Convert a subset of the mapped cloud into an unorganized pcl::PointCloud.
+        * \param[in] indices the indices of the points to copy
+        * \param[out] cloud the resultant point cloud
+        * \return 0 on success, -1 if no file is mapped or an index is out of range
+        */
+      template <typename PointT> int
+      copyToPointCloud (const std::vector<int> &indices, pcl::PointCloud<PointT> &cloud) const;
+
+    private:
+      /** \brief Copy a point from the map into a point struct, according to a field mapping. */
+      template <typename PointT> inline void
+      copyPoint (const uint8_t *point_data, const MsgFieldMap &field_map, PointT &point) const
+      {
+        uint8_t *point_bytes = reinterpret_cast<uint8_t*> (&point);
+        for (size_t i = 0; i < field_map.size (); ++i)
+          memcpy (point_bytes + field_map[i].struct_offset, point_data + field_map[i].serialized_offset, field_map[i].size);
+      }
+
+      /** \brief Cloud description, without data. */
+      pcl::PCLPointCloud2 info_;
+
+      /** \brief Sensor acquisition origin. */
+      Eigen::Vector4f origin_;
+
+      /** \brief Sensor acquisition orientation. */
+      Eigen::Quaternionf orientation_;
+
+      /** \brief Start of the mapping (the start of the file). */
+      uint8_t *map_;
+
+      /** \brief Size of the mapping, in bytes. */
+      size_t map_size_;
+
+      /** \brief Start of the point data within the mapping. */
+      const uint8_t *data_;
+
+#ifdef _WIN32
+      /** \brief File mapping handle. */
+      void *file_mapping_;
+#endif
+
+    public:
       EIGEN_MAKE_ALIGNED_OPERATOR_NEW
   };
 
@@ -295,7 +498,7 @@ namespace pcl
   class PCL_EXPORTS PCDWriter : public FileWriter
   {
     public:
-      PCDWriter() : FileWriter(), map_synchronization_(false) {}
+      PCDWriter() : FileWriter(), map_synchronization_(false), compression_chunk_size_ (0), threads_ (0) {}
       ~PCDWriter() {}
 
       /** \brief Set whether mmap() synchornization via msync() is desired before munmap() calls. 
@@ -312,6 +515,28 @@ namespace pcl
         map_synchronization_ = sync;
       }
 
+      /** \brief Set the number of points per chunk in BINARY_COMPRESSED files.
+        *
+        * When non-zero, writeBinaryCompressed () stores each field in chunks of this many points,
+        * which are LZF compressed independently and in parallel, and marks the data as
+        * binary_compressed_chunked. Such files load in parallel as well, but cannot be read by
+        * PCL versions which predate the format. When zero (default), the whole cloud is
+        * compressed as a single block, as in the legacy binary_compressed format.
+        * \param[in] chunk_size the number of points per chunk, or 0 for the legacy format
+        */
+      inline void
+      setCompressionChunkSize (unsigned int chunk_size) { compression_chunk_size_ = chunk_size; }
+
+      /** \brief Get the number of points per chunk in BINARY_COMPRESSED files (0 = legacy format). */
+      inline unsigned int
+      getCompressionChunkSize () const { return (compression_chunk_size_); }
+
+      /** \brief Set the number of threads used to compress chunked BINARY_COMPRESSED files.
+        * \param[in] nr_threads the number of hardware threads to use (0 sets the value back to automatic)
+        */
+      inline void
+      setNumberOfThreads (unsigned int nr_threads = 0) { threads_ = nr_threads; }
+
       /** \brief Generate the header of a PCD file format
         * \param[in] cloud the point cloud data message
         * \param[in] origin the sensor acquisition origin
@@ -591,9 +816,40 @@ namespace pcl
       resetLockingPermissions (const std::string &file_name,
                                boost::interprocess::file_lock &lock);
 
+      /** \brief Compress the points of a cloud into the body of a binary_compressed_chunked PCD file.
+        *
+        * Each field (skipping "_" padding) is split into chunks of compression_chunk_size_
+        * points, which are LZF compressed in parallel. The chunk boundaries do not depend on the
+        * number of threads, so the output is always the same.
+        * \param[in] data pointer to the first point
+        * \param[in] point_step the size of a point, in bytes
+        * \param[in] nr_points the number of points
+        * \param[in] fields the fields of the points
+        * \param[out] body the resultant data, to be written after the DATA line
+        */
+      void
+      compressChunked (const uint8_t *data, size_t point_step, size_t nr_points,
+                       const std::vector<pcl::PCLPointField> &fields, std::vector<char> &body) const;
+
+      /** \brief Write a block of memory to a file through mmap, honoring the locking and
+        * synchronization settings.
+        * \param[in] file_name the output file name
+        * \param[in] buffer the data to write
+        * \param[in] size the size of the data, in bytes
+        * \return 0 on success, -1 on error
+        */
+      int
+      writeMapped (const std::string &file_name, const char *buffer, size_t size);
+
     private:
       /** \brief Set to true if msync() should be called before munmap(). Prevents data loss on NFS systems. */
       bool map_synchronization_;
+
+      /** \brief The number of points per compressed chunk, or 0 for the legacy single block format. */
+      unsigned int compression_chunk_size_;
+
+      /** \brief The number of threads used to compress chunks. */
+      unsigned int threads_;
   };
 
   namespace io
@@ -107,12 +107,18 @@ namespace pcl
       static const uint8_t VLP_MAX_NUM_LASERS = 16;
       static const uint8_t VLP_DUAL_MODE = 0x39;
 
+      /** \brief Converts the returns of a packet to cartesian coordinates. The azimuth of the second firing sequence of
+       *         each block is interpolated, and the second returns of a dual return packet follow their first return.
+       * \param[in] dataPacket the packet
+       * \param[out] decoded the returns of the packet
+       */
+      virtual void
+      decodePacket (const HDLDataPacket& dataPacket,
+                    HDLDecodedPacket& decoded) const;
+
     private:
       pcl::RGB laser_rgb_mapping_[VLP_MAX_NUM_LASERS];
 
-      virtual void
-      toPointClouds (HDLDataPacket *dataPacket);
-
       boost::asio::ip::address
       getDefaultNetworkAddress ();
 
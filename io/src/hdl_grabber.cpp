@@ -46,6 +46,13 @@
 #include <boost/array.hpp>
 #include <boost/bind.hpp>
 #include <boost/math/special_functions.hpp>
+#include <boost/enable_shared_from_this.hpp>
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <limits>
+#include <utility>
+#include <vector>
 #ifdef HAVE_PCAP
 #include <pcap.h>
 #endif // #ifdef HAVE_PCAP
@@ -55,6 +62,154 @@ double *pcl::HDLGrabber::sin_lookup_table_ = NULL;
 
 using boost::asio::ip::udp;
 
+/////////////////////////////////////////////////////////////////////////////
+/** \brief The point clouds handed out by acquire () are returned to the pool by their deleter, from whichever thread
+  * releases the last reference. The deleter only holds a weak reference, so that the clouds released after the
+  * grabber is destroyed are simply deleted.
+  */
+template <typename PointT>
+class pcl::HDLGrabber::CloudPool : public boost::enable_shared_from_this<CloudPool<PointT> >
+{
+  public:
+    typedef boost::shared_ptr<pcl::PointCloud<PointT> > CloudPtr;
+
+    CloudPool () : mutex_ (), free_clouds_ ()
+    {
+    }
+
+    ~CloudPool ()
+    {
+      for (size_t i = 0; i < free_clouds_.size (); ++i)
+        delete free_clouds_[i];
+    }
+
+    /** \brief Returns a released point cloud, or a new one if none is available. The content of a released point
+      * cloud is left as it was.
+      */
+    CloudPtr
+    acquire ()
+    {
+      pcl::PointCloud<PointT> *cloud = NULL;
+      {
+        boost::mutex::scoped_lock lock (mutex_);
+        if (!free_clouds_.empty ())
+        {
+          cloud = free_clouds_.back ();
+          free_clouds_.pop_back ();
+        }
+      }
+      if (cloud == NULL)
+        cloud = new pcl::PointCloud<PointT> ();
+      return (CloudPtr (cloud, Recycler (boost::weak_ptr<CloudPool> (this->shared_from_this ()))));
+    }
+
+  private:
+    /** \brief Deleter of the point clouds handed out by acquire () */
+    struct Recycler
+    {
+      Recycler (const boost::weak_ptr<CloudPool>& pool) : pool_ (pool)
+      {
+      }
+
+      void
+      operator () (pcl::PointCloud<PointT> *cloud) const
+      {
+        boost::shared_ptr<CloudPool> pool = pool_.lock ();
+        if (pool)
+          pool->release (cloud);
+        else
+          delete cloud;
+      }
+
+      boost::weak_ptr<CloudPool> pool_;
+    };
+
+    void
+    release (pcl::PointCloud<PointT> *cloud)
+    {
+      {
+        boost::mutex::scoped_lock lock (mutex_);
+        if (free_clouds_.size () < MAX_FREE_CLOUDS)
+        {
+          free_clouds_.push_back (cloud);
+          return;
+        }
+      }
+      delete cloud;
+    }
+
+    /** \brief Released point clouds kept for reuse, the others are deleted */
+    static const size_t MAX_FREE_CLOUDS = 2;
+
+    boost::mutex mutex_;
+    std::vector<pcl::PointCloud<PointT> *> free_clouds_;
+};
+
+namespace
+{
+  /** \brief Resizes a point cloud to the given organized layout, with NaN points in all the cells. */
+  template <typename PointT> void
+  resetOrganizedCloud (pcl::PointCloud<PointT>& cloud,
+                       const unsigned int width,
+                       const unsigned int height)
+  {
+    PointT invalid;
+    invalid.x = invalid.y = invalid.z = std::numeric_limits<float>::quiet_NaN ();
+    cloud.points.assign (width * height, invalid);
+    cloud.width = width;
+    cloud.height = height;
+  }
+
+  /** \brief Size of the payload of an HDL data packet */
+  const size_t HDL_DATA_PACKET_SIZE = 1206;
+
+  /** \brief A replay chunk ends at a sweep boundary, or after this many packets if the azimuth does not wrap around */
+  const size_t PCAP_REPLAY_MAX_CHUNK_PACKETS = 1024;
+
+  /** \brief Finds the IPv4 and UDP headers of an Ethernet frame, which may carry an 802.1Q VLAN tag.
+    * \param[in] frame the Ethernet frame
+    * \param[in] length the captured length of the frame
+    * \param[out] ip offset of the IPv4 header in the frame
+    * \param[out] udp offset of the UDP header in the frame
+    * \return false if the frame does not carry an unfragmented IPv4 UDP datagram
+    */
+  bool
+  findUdpHeader (const uint8_t *frame,
+                 const size_t length,
+                 size_t& ip,
+                 size_t& udp)
+  {
+    ip = 14;
+    if (length >= 18 && frame[12] == 0x81 && frame[13] == 0x00)
+      ip = 18;
+    if (length < ip + 20 || frame[ip - 2] != 0x08 || frame[ip - 1] != 0x00)
+      return (false);
+
+    // version 4 and the header length in 32 bit words, which is more than 5 with IP options
+    const size_t ip_header_size = (frame[ip] & 0x0f) * 4;
+    if ((frame[ip] >> 4) != 4 || ip_header_size < 20 || frame[ip + 9] != 17)
+      return (false);
+    // neither the more fragments flag nor a fragment offset
+    if ((frame[ip + 6] & 0x3f) != 0 || frame[ip + 7] != 0)
+      return (false);
+
+    udp = ip + ip_header_size;
+    return (length >= udp + 8);
+  }
+
+  /** \brief Reads an unsigned 32 bit integer from a PCAP header, in the byte order of the file */
+  uint32_t
+  readPcapUInt32 (const char *data,
+                  const bool swapped)
+  {
+    uint32_t value;
+    memcpy (&value, data, sizeof (value));
+    if (swapped)
+      value = ((value & 0xff) << 24) | ((value & 0xff00) << 8) | ((value >> 8) & 0xff00) | (value >> 24);
+    return (value);
+  }
+}
+
 /////////////////////////////////////////////////////////////////////////////
 pcl::HDLGrabber::HDLGrabber (const std::string& correctionsFile,
                              const std::string& pcapFile) :
@@ -65,6 +220,10 @@ pcl::HDLGrabber::HDLGrabber (const std::string& correctionsFile,
     current_sweep_xyzi_ (new pcl::PointCloud<pcl::PointXYZI> ()),
     current_scan_xyzrgba_ (new pcl::PointCloud<pcl::PointXYZRGBA> ()),
     current_sweep_xyzrgba_ (new pcl::PointCloud<pcl::PointXYZRGBA> ()),
+    current_sweep_size_ (0),
+    organized_output_ (false),
+    azimuth_bins_ (1800),
+    organized_rows_ (0),
     sweep_xyz_signal_ (),
     sweep_xyzrgba_signal_ (),
     sweep_xyzi_signal_ (),
@@ -80,6 +239,17 @@ pcl::HDLGrabber::HDLGrabber (const std::string& correctionsFile,
     pcap_file_name_ (pcapFile),
     queue_consumer_thread_ (NULL),
     hdl_read_packet_thread_ (NULL),
+    scan_pool_xyz_ (new CloudPool<pcl::PointXYZ> ()),
+    sweep_pool_xyz_ (new CloudPool<pcl::PointXYZ> ()),
+    scan_pool_xyzi_ (new CloudPool<pcl::PointXYZI> ()),
+    sweep_pool_xyzi_ (new CloudPool<pcl::PointXYZI> ()),
+    scan_pool_xyzrgba_ (new CloudPool<pcl::PointXYZRGBA> ()),
+    sweep_pool_xyzrgba_ (new CloudPool<pcl::PointXYZRGBA> ()),
+    decoded_packet_ (),
+    scan_counter_ (0),
+    sweep_counter_ (0),
+    fast_pcap_replay_ (false),
+    replay_threads_ (0),
     min_distance_threshold_ (0.0),
     max_distance_threshold_ (10000.0)
 {
@@ -97,6 +267,10 @@ pcl::HDLGrabber::HDLGrabber (const boost::asio::ip::address& ipAddress,
     current_sweep_xyzi_ (new pcl::PointCloud<pcl::PointXYZI> ()),
     current_scan_xyzrgba_ (new pcl::PointCloud<pcl::PointXYZRGBA> ()),
     current_sweep_xyzrgba_ (new pcl::PointCloud<pcl::PointXYZRGBA> ()),
+    current_sweep_size_ (0),
+    organized_output_ (false),
+    azimuth_bins_ (1800),
+    organized_rows_ (0),
     sweep_xyz_signal_ (),
     sweep_xyzrgba_signal_ (),
     sweep_xyzi_signal_ (),
@@ -112,6 +286,17 @@ pcl::HDLGrabber::HDLGrabber (const boost::asio::ip::address& ipAddress,
     pcap_file_name_ (),
     queue_consumer_thread_ (NULL),
     hdl_read_packet_thread_ (NULL),
+    scan_pool_xyz_ (new CloudPool<pcl::PointXYZ> ()),
+    sweep_pool_xyz_ (new CloudPool<pcl::PointXYZ> ()),
+    scan_pool_xyzi_ (new CloudPool<pcl::PointXYZI> ()),
+    sweep_pool_xyzi_ (new CloudPool<pcl::PointXYZI> ()),
+    scan_pool_xyzrgba_ (new CloudPool<pcl::PointXYZRGBA> ()),
+    sweep_pool_xyzrgba_ (new CloudPool<pcl::PointXYZRGBA> ()),
+    decoded_packet_ (),
+    scan_counter_ (0),
+    sweep_counter_ (0),
+    fast_pcap_replay_ (false),
+    replay_threads_ (0),
     min_distance_threshold_ (0.0),
     max_distance_threshold_ (10000.0)
 {
@@ -167,6 +352,9 @@ pcl::HDLGrabber::initialize (const std::string& correctionsFile)
   current_sweep_xyz_.reset (new pcl::PointCloud<pcl::PointXYZ>);
   current_sweep_xyzi_.reset (new pcl::PointCloud<pcl::PointXYZI>);
 
+  for (uint8_t i = 0; i < HDL_MAX_NUM_LASERS; i++)
+    laser_rows_[i] = i;
+
   for (uint8_t i = 0; i < HDL_MAX_NUM_LASERS; i++)
     laser_rgb_mapping_[i].r = laser_rgb_mapping_[i].g = laser_rgb_mapping_[i].b = 0;
 
@@ -314,93 +502,133 @@ pcl::HDLGrabber::processVelodynePackets ()
 void
 pcl::HDLGrabber::toPointClouds (HDLDataPacket *dataPacket)
 {
-  static uint32_t scan_counter = 0;
-  static uint32_t sweep_counter = 0;
   if (sizeof(HDLLaserReturn) != 3)
     return;
 
-  current_scan_xyz_.reset (new pcl::PointCloud<pcl::PointXYZ> ());
-  current_scan_xyzrgba_.reset (new pcl::PointCloud<pcl::PointXYZRGBA> ());
-  current_scan_xyzi_.reset (new pcl::PointCloud<pcl::PointXYZI> ());
-
-  time_t system_time;
-  time (&system_time);
-  time_t velodyne_time = (system_time & 0x00000000ffffffffl) << 32 | dataPacket->gpsTimestamp;
+  decodePacket (*dataPacket, decoded_packet_);
+  assemblePacket (decoded_packet_);
+}
 
-  current_scan_xyz_->header.stamp = velodyne_time;
-  current_scan_xyzrgba_->header.stamp = velodyne_time;
-  current_scan_xyzi_->header.stamp = velodyne_time;
-  current_scan_xyz_->header.seq = scan_counter;
-  current_scan_xyzrgba_->header.seq = scan_counter;
-  current_scan_xyzi_->header.seq = scan_counter;
-  scan_counter++;
+/////////////////////////////////////////////////////////////////////////////
+void
+pcl::HDLGrabber::decodePacket (const HDLDataPacket& dataPacket,
+                               HDLDecodedPacket& decoded) const
+{
+  decoded.returns.resize (HDL_FIRING_PER_PKT * HDL_LASER_PER_FIRING);
+  decoded.gpsTimestamp = dataPacket.gpsTimestamp;
+  decoded.startAngle = dataPacket.firingData[0].rotationalPosition;
+  decoded.endAngle = dataPacket.firingData[HDL_FIRING_PER_PKT - 1].rotationalPosition;
+  decoded.hasScan = true;
 
+  size_t r = 0;
   for (uint8_t i = 0; i < HDL_FIRING_PER_PKT; ++i)
   {
-    HDLFiringData firing_data = dataPacket->firingData[i];
+    const HDLFiringData& firing_data = dataPacket.firingData[i];
     uint8_t offset = (firing_data.blockIdentifier == BLOCK_0_TO_31) ? 0 : 32;
 
-    for (uint8_t j = 0; j < HDL_LASER_PER_FIRING; j++)
+    for (uint8_t j = 0; j < HDL_LASER_PER_FIRING; j++, r++)
     {
-      if (firing_data.rotationalPosition < last_azimuth_)
-      {
-        if (current_sweep_xyzrgba_->size () > 0)
-        {
-          current_sweep_xyz_->is_dense = current_sweep_xyzrgba_->is_dense = current_sweep_xyzi_->is_dense = false;
-          current_sweep_xyz_->header.stamp = velodyne_time;
-          current_sweep_xyzrgba_->header.stamp = velodyne_time;
-          current_sweep_xyzi_->header.stamp = velodyne_time;
-          current_sweep_xyz_->header.seq = sweep_counter;
-          current_sweep_xyzrgba_->header.seq = sweep_counter;
-          current_sweep_xyzi_->header.seq = sweep_counter;
+      HDLDecodedReturn& laser_return = decoded.returns[r];
+      PointXYZI xyzi;
 
-          sweep_counter++;
+      computeXYZI (xyzi, firing_data.rotationalPosition, firing_data.laserReturns[j], laser_corrections_[j + offset]);
 
-          fireCurrentSweep ();
-        }
-        current_sweep_xyz_.reset (new pcl::PointCloud<pcl::PointXYZ> ());
-        current_sweep_xyzrgba_.reset (new pcl::PointCloud<pcl::PointXYZRGBA> ());
-        current_sweep_xyzi_.reset (new pcl::PointCloud<pcl::PointXYZI> ());
-      }
+      laser_return.x = xyzi.x;
+      laser_return.y = xyzi.y;
+      laser_return.z = xyzi.z;
+      laser_return.intensity = xyzi.intensity;
+      laser_return.rgba = laser_rgb_mapping_[j + offset].rgba;
+      laser_return.azimuth = firing_data.rotationalPosition;
+      laser_return.laser = static_cast<uint8_t> (j + offset);
+      laser_return.valid = !(pcl_isnan (xyzi.x) || pcl_isnan (xyzi.y) || pcl_isnan (xyzi.z));
+      laser_return.dual = false;
+    }
+  }
+}
 
-      PointXYZ xyz;
-      PointXYZI xyzi;
-      PointXYZRGBA xyzrgba;
+/////////////////////////////////////////////////////////////////////////////
+void
+pcl::HDLGrabber::assemblePacket (const HDLDecodedPacket& decoded)
+{
+  time_t system_time;
+  time (&system_time);
+  time_t velodyne_time = (system_time & 0x00000000ffffffffl) << 32 | decoded.gpsTimestamp;
 
-      computeXYZI (xyzi, firing_data.rotationalPosition, firing_data.laserReturns[j], laser_corrections_[j + offset]);
+  if (decoded.hasScan)
+  {
+    resetCurrentScan ();
+
+    current_scan_xyz_->header.stamp = velodyne_time;
+    current_scan_xyzrgba_->header.stamp = velodyne_time;
+    current_scan_xyzi_->header.stamp = velodyne_time;
+    current_scan_xyz_->header.seq = scan_counter_;
+    current_scan_xyzrgba_->header.seq = scan_counter_;
+    current_scan_xyzi_->header.seq = scan_counter_;
+  }
+  scan_counter_++;
 
-      xyz.x = xyzrgba.x = xyzi.x;
-      xyz.y = xyzrgba.y = xyzi.y;
-      xyz.z = xyzrgba.z = xyzi.z;
+  for (size_t r = 0; r < decoded.returns.size (); r++)
+  {
+    const HDLDecodedReturn& laser_return = decoded.returns[r];
 
-      xyzrgba.rgba = laser_rgb_mapping_[j + offset].rgba;
-      if (pcl_isnan (xyz.x) || pcl_isnan (xyz.y) || pcl_isnan (xyz.z))
+    if (!laser_return.dual && laser_return.azimuth < last_azimuth_)
+    {
+      if (current_sweep_size_ > 0)
       {
-        continue;
+        current_sweep_xyz_->is_dense = current_sweep_xyzrgba_->is_dense = current_sweep_xyzi_->is_dense = false;
+        current_sweep_xyz_->header.stamp = velodyne_time;
+        current_sweep_xyzrgba_->header.stamp = velodyne_time;
+        current_sweep_xyzi_->header.stamp = velodyne_time;
+        current_sweep_xyz_->header.seq = sweep_counter_;
+        current_sweep_xyzrgba_->header.seq = sweep_counter_;
+        current_sweep_xyzi_->header.seq = sweep_counter_;
+
+        sweep_counter_++;
+
+        fireCurrentSweep ();
       }
+      resetCurrentSweep ();
+    }
+
+    if (!laser_return.valid)
+      continue;
+
+    PointXYZ xyz;
+    PointXYZI xyzi;
+    PointXYZRGBA xyzrgba;
 
+    xyz.x = xyzrgba.x = xyzi.x = laser_return.x;
+    xyz.y = xyzrgba.y = xyzi.y = laser_return.y;
+    xyz.z = xyzrgba.z = xyzi.z = laser_return.z;
+    xyzi.intensity = laser_return.intensity;
+    xyzrgba.rgba = laser_return.rgba;
+
+    if (decoded.hasScan)
+    {
       current_scan_xyz_->push_back (xyz);
       current_scan_xyzi_->push_back (xyzi);
       current_scan_xyzrgba_->push_back (xyzrgba);
+    }
 
-      current_sweep_xyz_->push_back (xyz);
-      current_sweep_xyzi_->push_back (xyzi);
-      current_sweep_xyzrgba_->push_back (xyzrgba);
+    addSweepPoint (xyz, xyzi, xyzrgba, laser_return.laser, laser_return.azimuth);
 
-      last_azimuth_ = firing_data.rotationalPosition;
-    }
+    if (!laser_return.dual)
+      last_azimuth_ = static_cast<uint16_t> (laser_return.azimuth);
   }
 
-  current_scan_xyz_->is_dense = current_scan_xyzrgba_->is_dense = current_scan_xyzi_->is_dense = true;
-  fireCurrentScan (dataPacket->firingData[0].rotationalPosition, dataPacket->firingData[11].rotationalPosition);
+  if (decoded.hasScan)
+  {
+    current_scan_xyz_->is_dense = current_scan_xyzrgba_->is_dense = current_scan_xyzi_->is_dense = true;
+    fireCurrentScan (decoded.startAngle, decoded.endAngle);
+  }
 }
 
 /////////////////////////////////////////////////////////////////////////////
 void
 pcl::HDLGrabber::computeXYZI (pcl::PointXYZI& point,
                               uint16_t azimuth,
-                              HDLLaserReturn laserReturn,
-                              HDLLaserCorrection correction)
+                              const HDLLaserReturn& laserReturn,
+                              const HDLLaserCorrection& correction) const
 {
   double cos_azimuth, sin_azimuth;
 
@@ -438,6 +666,73 @@ pcl::HDLGrabber::computeXYZI (pcl::PointXYZI& point,
   }
 }
 
+/////////////////////////////////////////////////////////////////////////////
+void
+pcl::HDLGrabber::resetCurrentScan ()
+{
+  current_scan_xyz_ = scan_pool_xyz_->acquire ();
+  current_scan_xyzi_ = scan_pool_xyzi_->acquire ();
+  current_scan_xyzrgba_ = scan_pool_xyzrgba_->acquire ();
+
+  current_scan_xyz_->clear ();
+  current_scan_xyzi_->clear ();
+  current_scan_xyzrgba_->clear ();
+}
+
+/////////////////////////////////////////////////////////////////////////////
+void
+pcl::HDLGrabber::resetCurrentSweep ()
+{
+  current_sweep_xyz_ = sweep_pool_xyz_->acquire ();
+  current_sweep_xyzi_ = sweep_pool_xyzi_->acquire ();
+  current_sweep_xyzrgba_ = sweep_pool_xyzrgba_->acquire ();
+
+  if (organized_output_)
+  {
+    resetOrganizedCloud (*current_sweep_xyz_, azimuth_bins_, organized_rows_);
+    resetOrganizedCloud (*current_sweep_xyzi_, azimuth_bins_, organized_rows_);
+    resetOrganizedCloud (*current_sweep_xyzrgba_, azimuth_bins_, organized_rows_);
+  }
+  else
+  {
+    // the point vectors keep their capacity, so that steady sweeps do not allocate
+    current_sweep_xyz_->clear ();
+    current_sweep_xyzi_->clear ();
+    current_sweep_xyzrgba_->clear ();
+  }
+  current_sweep_size_ = 0;
+}
+
+/////////////////////////////////////////////////////////////////////////////
+void
+pcl::HDLGrabber::addSweepPoint (const pcl::PointXYZ& xyz,
+                                const pcl::PointXYZI& xyzi,
+                                const pcl::PointXYZRGBA& xyzrgba,
+                                const uint8_t laser,
+                                const double azimuth)
+{
+  if (!organized_output_)
+  {
+    current_sweep_xyz_->push_back (xyz);
+    current_sweep_xyzi_->push_back (xyzi);
+    current_sweep_xyzrgba_->push_back (xyzrgba);
+    ++current_sweep_size_;
+    return;
+  }
+
+  if (laser >= organized_rows_)
+    return;
+
+  // azimuths are given in hundredths of degrees, 36000 wraps around to the first column
+  const unsigned int column = static_cast<unsigned int> (azimuth * azimuth_bins_ / 36000.0) % azimuth_bins_;
+  const size_t cell = static_cast<size_t> (laser_rows_[laser]) * azimuth_bins_ + column;
+
+  current_sweep_xyz_->points[cell] = xyz;
+  current_sweep_xyzi_->points[cell] = xyzi;
+  current_sweep_xyzrgba_->points[cell] = xyzrgba;
+  ++current_sweep_size_;
+}
+
 /////////////////////////////////////////////////////////////////////////////
 void
 pcl::HDLGrabber::fireCurrentSweep ()
@@ -493,6 +788,13 @@ pcl::HDLGrabber::start ()
   if (isRunning ())
     return;
 
+  if (!pcap_file_name_.empty () && fast_pcap_replay_)
+  {
+    // the replay thread decodes and emits the packets itself, the queue is not used
+    hdl_read_packet_thread_ = new boost::thread (boost::bind (&HDLGrabber::replayPcapFile, this));
+    return;
+  }
+
   queue_consumer_thread_ = new boost::thread (boost::bind (&HDLGrabber::processVelodynePackets, this));
 
   if (pcap_file_name_.empty ())
@@ -651,6 +953,54 @@ pcl::HDLGrabber::getMaximumNumberOfLasers () const
     return (HDL_MAX_NUM_LASERS);
 }
 
+/////////////////////////////////////////////////////////////////////////////
+void
+pcl::HDLGrabber::setOrganizedOutput (const bool organized,
+                                     const unsigned int azimuthBins)
+{
+  organized_output_ = organized;
+  azimuth_bins_ = std::max (azimuthBins, 1u);
+
+  // the HDL-32 corrections leave the second block of lasers empty, see initialize ()
+  organized_rows_ = getMaximumNumberOfLasers ();
+  if (organized_rows_ > HDL_LASER_PER_FIRING && laser_corrections_[HDL_LASER_PER_FIRING].distanceCorrection == 0.0)
+    organized_rows_ = HDL_LASER_PER_FIRING;
+
+  // the lasers are not fired in the order of their elevation, the rows are sorted from the top
+  std::vector<std::pair<double, unsigned int> > elevations (organized_rows_);
+  for (unsigned int i = 0; i < organized_rows_; i++)
+    elevations[i] = std::make_pair (-laser_corrections_[i].verticalCorrection, i);
+  std::sort (elevations.begin (), elevations.end ());
+
+  for (unsigned int row = 0; row < organized_rows_; row++)
+    laser_rows_[elevations[row].second] = row;
+
+  resetCurrentSweep ();
+}
+
+/////////////////////////////////////////////////////////////////////////////
+bool
+pcl::HDLGrabber::getOrganizedOutput () const
+{
+  return (organized_output_);
+}
+
+/////////////////////////////////////////////////////////////////////////////
+void
+pcl::HDLGrabber::setFastPcapReplay (const bool fast,
+                                    const unsigned int nrThreads)
+{
+  fast_pcap_replay_ = fast;
+  replay_threads_ = nrThreads;
+}
+
+/////////////////////////////////////////////////////////////////////////////
+bool
+pcl::HDLGrabber::getFastPcapReplay () const
+{
+  return (fast_pcap_replay_);
+}
+
 /////////////////////////////////////////////////////////////////////////////
 void
 pcl::HDLGrabber::readPacketsFromSocket ()
@@ -735,3 +1085,154 @@ pcl::HDLGrabber::readPacketsFromPcap ()
 }
 #endif //#ifdef HAVE_PCAP
 
+/////////////////////////////////////////////////////////////////////////////
+void
+pcl::HDLGrabber::replayPcapFile ()
+{
+  // the decoding threads work on data owned by this thread, which must not be interrupted while joining them
+  boost::this_thread::disable_interruption no_interruption;
+
+  boost::iostreams::mapped_file_source pcap;
+  try
+  {
+    pcap.open (pcap_file_name_);
+  }
+  catch (const std::exception& e)
+  {
+    PCL_ERROR ("[pcl::HDLGrabber::replayPcapFile] Unable to map %s! %s\n", pcap_file_name_.c_str (), e.what ());
+    return;
+  }
+
+  const char *begin = pcap.data ();
+  const char *end = begin + pcap.size ();
+  if (pcap.size () < 24)
+  {
+    PCL_ERROR ("[pcl::HDLGrabber::replayPcapFile] %s is not a PCAP file!\n", pcap_file_name_.c_str ());
+    return;
+  }
+
+  // the magic number gives the byte order, the microsecond and nanosecond variants share the record layout
+  const uint32_t magic = readPcapUInt32 (begin, false);
+  bool swapped;
+  if (magic == 0xa1b2c3d4 || magic == 0xa1b23c4d)
+    swapped = false;
+  else if (magic == 0xd4c3b2a1 || magic == 0x4d3cb2a1)
+    swapped = true;
+  else
+  {
+    PCL_ERROR ("[pcl::HDLGrabber::replayPcapFile] %s is not a PCAP file!\n", pcap_file_name_.c_str ());
+    return;
+  }
+  if (readPcapUInt32 (begin + 20, swapped) != 1)
+  {
+    PCL_ERROR ("[pcl::HDLGrabber::replayPcapFile] %s does not contain Ethernet frames!\n", pcap_file_name_.c_str ());
+    return;
+  }
+
+  const bool filter_source = !isAddressUnspecified (source_address_filter_) && source_address_filter_.is_v4 ();
+  boost::asio::ip::address_v4::bytes_type source_address;
+  if (filter_source)
+    source_address = source_address_filter_.to_v4 ().to_bytes ();
+
+  unsigned int threads = replay_threads_;
+  if (threads == 0)
+    threads = std::max (boost::thread::hardware_concurrency (), 1u);
+  const size_t batch_chunks = 2 * threads;
+
+  std::vector<const uint8_t *> packets;
+  std::vector<size_t> chunk_begin;
+  std::vector<HDLDecodedPacket> decoded;
+  uint16_t previous_azimuth = 0;
+
+  const char *record = begin + 24;
+  while (!terminate_read_packet_thread_ && record < end)
+  {
+    // gather the data packets of the next chunks, cutting them where the azimuth wraps around
+    packets.clear ();
+    chunk_begin.assign (1, 0);
+    while (record + 16 <= end)
+    {
+      const size_t length = readPcapUInt32 (record + 8, swapped);
+      const uint8_t *frame = reinterpret_cast<const uint8_t *> (record + 16);
+      if (length > static_cast<size_t> (end - record) - 16)
+      {
+        record = end;
+        break;
+      }
+      record += 16 + length;
+
+      // Ethernet frames carrying an IPv4 UDP datagram with the size of a data packet
+      size_t ip, udp;
+      if (!findUdpHeader (frame, length, ip, udp) || length != udp + 8 + HDL_DATA_PACKET_SIZE)
+        continue;
+      if (filter_source
+          && (!std::equal (source_address.begin (), source_address.end (), frame + ip + 12)
+              || ((frame[udp] << 8) | frame[udp + 1]) != source_port_filter_))
+        continue;
+
+      const uint8_t *payload = frame + udp + 8;
+      uint16_t azimuth;
+      memcpy (&azimuth, payload + offsetof (HDLFiringData, rotationalPosition), sizeof (azimuth));
+
+      const size_t chunk_size = packets.size () - chunk_begin.back ();
+      if (chunk_size > 0 && (azimuth < previous_azimuth || chunk_size >= PCAP_REPLAY_MAX_CHUNK_PACKETS))
+      {
+        chunk_begin.push_back (packets.size ());
+        if (chunk_begin.size () > batch_chunks)
+        {
+          // this packet starts the first chunk of the next batch
+          record = reinterpret_cast<const char *> (frame) - 16;
+          break;
+        }
+      }
+      packets.push_back (payload);
+      previous_azimuth = azimuth;
+    }
+    if (packets.empty ())
+      break;
+    if (chunk_begin.back () != packets.size ())
+      chunk_begin.push_back (packets.size ());
+
+    if (decoded.size () < packets.size ())
+      decoded.resize (packets.size ());
+
+    const size_t nr_chunks = chunk_begin.size () - 1;
+    const size_t nr_workers = std::min (static_cast<size_t> (threads), nr_chunks);
+    if (nr_workers <= 1)
+    {
+      decodePcapChunks (packets, chunk_begin, 0, 1, decoded);
+    }
+    else
+    {
+      boost::thread_group workers;
+      for (size_t t = 0; t < nr_workers; t++)
+        workers.create_thread (boost::bind (&HDLGrabber::decodePcapChunks, this, boost::cref (packets), boost::cref (chunk_begin),
+                                            t, nr_workers, boost::ref (decoded)));
+      workers.join_all ();
+    }
+
+    // the point clouds are assembled and emitted in the order of the file
+    for (size_t i = 0; i < packets.size () && !terminate_read_packet_thread_; i++)
+      assemblePacket (decoded[i]);
+  }
+}
+
+/////////////////////////////////////////////////////////////////////////////
+void
+pcl::HDLGrabber::decodePcapChunks (const std::vector<const uint8_t *>& packets,
+                                   const std::vector<size_t>& chunkBegin,
+                                   const size_t firstChunk,
+                                   const size_t chunkStep,
+                                   std::vector<HDLDecodedPacket>& decoded) const
+{
+  HDLDataPacket data_packet;
+  for (size_t chunk = firstChunk; chunk + 1 < chunkBegin.size (); chunk += chunkStep)
+  {
+    for (size_t i = chunkBegin[chunk]; i < chunkBegin[chunk + 1]; i++)
+    {
+      // the payloads are not aligned in the file
+      memcpy (&data_packet, packets[i], HDL_DATA_PACKET_SIZE);
+      decodePacket (data_packet, decoded[i]);
+    }
+  }
+}
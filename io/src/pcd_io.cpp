@@ -50,6 +50,10 @@
 #include <cstring>
 #include <cerrno>
 
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
 #ifdef _WIN32
 # include <io.h>
 # include <windows.h>
@@ -121,15 +125,18 @@ pcl::PCDWriter::resetLockingPermissions (const std::string &file_name,
 }
 
 ///////////////////////////////////////////////////////////////////////////////////////////
-int
-pcl::PCDReader::readHeader (std::istream &fs, pcl::PCLPointCloud2 &cloud,
-                            Eigen::Vector4f &origin, Eigen::Quaternionf &orientation, 
-                            int &pcd_version, int &data_type, unsigned int &data_idx)
+/** \brief Parse a PCD header from a stream. Shared by PCDReader and PCDMappedCloud, the
+  * latter of which does not want cloud.data to be allocated.
+  */
+static int
+parsePCDHeader (std::istream &fs, pcl::PCLPointCloud2 &cloud,
+                Eigen::Vector4f &origin, Eigen::Quaternionf &orientation,
+                int &pcd_version, int &data_type, unsigned int &data_idx, bool allocate_data)
 {
   // Default values
   data_idx = 0;
   data_type = 0;
-  pcd_version = PCD_V6;
+  pcd_version = pcl::PCDReader::PCD_V6;
   origin      = Eigen::Vector4f::Zero ();
   orientation = Eigen::Quaternionf::Identity ();
   cloud.width = cloud.height = cloud.point_step = cloud.row_step = 0;
@@ -248,7 +255,7 @@ pcl::PCDReader::readHeader (std::istream &fs, pcl::PCLPointCloud2 &cloud,
         for (int i = 0; i < specified_channel_count; ++i)
         {
           field_types[i] = st.at (i + 1).c_str ()[0];
-          cloud.fields[i].datatype = static_cast<uint8_t> (getFieldType (field_sizes[i], field_types[i]));
+          cloud.fields[i].datatype = static_cast<uint8_t> (pcl::getFieldType (field_sizes[i], field_types[i]));
         }
         continue;
       }
@@ -304,7 +311,7 @@ pcl::PCDReader::readHeader (std::istream &fs, pcl::PCLPointCloud2 &cloud,
       // Get the acquisition viewpoint
       if (line_type.substr (0, 9) == "VIEWPOINT")
       {
-        pcd_version = PCD_V7;
+        pcd_version = pcl::PCDReader::PCD_V7;
         if (st.size () < 8)
           throw "Not enough number of elements in <VIEWPOINT>! Need 7 values (tx ty tz qw qx qy qz).";
 
@@ -323,7 +330,8 @@ pcl::PCDReader::readHeader (std::istream &fs, pcl::PCLPointCloud2 &cloud,
           throw "Number of POINTS specified before COUNT in header!";
         sstream >> nr_points;
         // Need to allocate: N * point_step
-        cloud.data.resize (nr_points * cloud.point_step);
+        if (allocate_data)
+          cloud.data.resize (nr_points * cloud.point_step);
         continue;
       }
 
@@ -331,7 +339,9 @@ pcl::PCDReader::readHeader (std::istream &fs, pcl::PCLPointCloud2 &cloud,
       if (line_type.substr (0, 4) == "DATA")
       {
         data_idx = static_cast<int> (fs.tellg ());
-        if (st.at (1).substr (0, 17) == "binary_compressed")
+        if (st.at (1).substr (0, 25) == "binary_compressed_chunked")
+          data_type = 3;
+        else if (st.at (1).substr (0, 17) == "binary_compressed")
          data_type = 2;
         else
           if (st.at (1).substr (0, 6) == "binary")
@@ -389,6 +399,15 @@ pcl::PCDReader::readHeader (std::istream &fs, pcl::PCLPointCloud2 &cloud,
   return (0);
 }
 
+///////////////////////////////////////////////////////////////////////////////////////////
+int
+pcl::PCDReader::readHeader (std::istream &fs, pcl::PCLPointCloud2 &cloud,
+                            Eigen::Vector4f &origin, Eigen::Quaternionf &orientation, 
+                            int &pcd_version, int &data_type, unsigned int &data_idx)
+{
+  return (parsePCDHeader (fs, cloud, origin, orientation, pcd_version, data_type, data_idx, true));
+}
+
 ///////////////////////////////////////////////////////////////////////////////////////////
 int
 pcl::PCDReader::readHeader (const std::string &file_name, pcl::PCLPointCloud2 &cloud,
@@ -557,6 +576,107 @@ pcl::PCDReader::readBodyASCII (std::istream &fs, pcl::PCLPointCloud2 &cloud, int
   return (0);
 }
 
+///////////////////////////////////////////////////////////////////////////////////////////
+// Layout of the body of binary_compressed_chunked PCD files (all values are uint32):
+//   0                  a zero "compressed size", which makes readers of the legacy
+//                      binary_compressed format fail cleanly
+//   version            PCD_CHUNKED_FORMAT_VERSION
+//   points_per_chunk
+//   nr_chunks          nr_fields * ceil (nr_points / points_per_chunk), field major
+//   nr_chunks x { compressed_size, uncompressed_size }
+//   the chunks, back to back
+// Each chunk holds one field of consecutive points. A compressed_size of 0 marks a chunk
+// which LZF could not shrink, stored uncompressed.
+static const uint32_t PCD_CHUNKED_FORMAT_VERSION = 1;
+static const size_t PCD_CHUNKED_HEADER_SIZE = 16;
+
+/** \brief Get the fields which are stored in compressed PCD data (all but the "_" padding). */
+static void
+getCompressedFields (const std::vector<pcl::PCLPointField> &all_fields,
+                     std::vector<pcl::PCLPointField> &fields, std::vector<size_t> &fields_sizes)
+{
+  fields.clear ();
+  fields_sizes.clear ();
+  for (size_t i = 0; i < all_fields.size (); ++i)
+  {
+    if (all_fields[i].name == "_")
+      continue;
+    fields.push_back (all_fields[i]);
+    fields_sizes.push_back (all_fields[i].count * pcl::getFieldSize (all_fields[i].datatype));
+  }
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+/** \brief Go over each field of a binary cloud and set cloud.is_dense to false if any of
+  * them has NaN/Inf values.
+  */
+static void
+updateIsDense (pcl::PCLPointCloud2 &cloud)
+{
+  int point_size = static_cast<int> (cloud.data.size () / (cloud.height * cloud.width));
+  // Once copied, we need to go over each field and check if it has NaN/Inf values and assign cloud.is_dense to true or false
+  for (uint32_t i = 0; i < cloud.width * cloud.height; ++i)
+  {
+    for (unsigned int d = 0; d < static_cast<unsigned int> (cloud.fields.size ()); ++d)
+    {
+      for (uint32_t c = 0; c < cloud.fields[d].count; ++c)
+      {
+        switch (cloud.fields[d].datatype)
+        {
+          case pcl::PCLPointField::INT8:
+          {
+            if (!pcl::isValueFinite<pcl::traits::asType<pcl::PCLPointField::INT8>::type> (cloud, i, point_size, d, c))
+              cloud.is_dense = false;
+            break;
+          }
+          case pcl::PCLPointField::UINT8:
+          {
+            if (!pcl::isValueFinite<pcl::traits::asType<pcl::PCLPointField::UINT8>::type> (cloud, i, point_size, d, c))
+              cloud.is_dense = false;
+            break;
+          }
+          case pcl::PCLPointField::INT16:
+          {
+            if (!pcl::isValueFinite<pcl::traits::asType<pcl::PCLPointField::INT16>::type> (cloud, i, point_size, d, c))
+              cloud.is_dense = false;
+            break;
+          }
+          case pcl::PCLPointField::UINT16:
+          {
+            if (!pcl::isValueFinite<pcl::traits::asType<pcl::PCLPointField::UINT16>::type> (cloud, i, point_size, d, c))
+              cloud.is_dense = false;
+            break;
+          }
+          case pcl::PCLPointField::INT32:
+          {
+            if (!pcl::isValueFinite<pcl::traits::asType<pcl::PCLPointField::INT32>::type> (cloud, i, point_size, d, c))
+              cloud.is_dense = false;
+            break;
+          }
+          case pcl::PCLPointField::UINT32:
+          {
+            if (!pcl::isValueFinite<pcl::traits::asType<pcl::PCLPointField::UINT32>::type> (cloud, i, point_size, d, c))
+              cloud.is_dense = false;
+            break;
+          }
+          case pcl::PCLPointField::FLOAT32:
+          {
+            if (!pcl::isValueFinite<pcl::traits::asType<pcl::PCLPointField::FLOAT32>::type> (cloud, i, point_size, d, c))
+              cloud.is_dense = false;
+            break;
+          }
+          case pcl::PCLPointField::FLOAT64:
+          {
+            if (!pcl::isValueFinite<pcl::traits::asType<pcl::PCLPointField::FLOAT64>::type> (cloud, i, point_size, d, c))
+              cloud.is_dense = false;
+            break;
+          }
+        }
+      }
+    }
+  }
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 int
 pcl::PCDReader::readBodyBinary (const unsigned char *map, pcl::PCLPointCloud2 &cloud,
@@ -632,68 +752,122 @@ pcl::PCDReader::readBodyBinary (const unsigned char *map, pcl::PCLPointCloud2 &c
     memcpy (&cloud.data[0], &map[0] + data_idx, cloud.data.size ());
 
   // Extra checks (not needed for ASCII)
-  int point_size = static_cast<int> (cloud.data.size () / (cloud.height * cloud.width));
-  // Once copied, we need to go over each field and check if it has NaN/Inf values and assign cloud.is_dense to true or false
-  for (uint32_t i = 0; i < cloud.width * cloud.height; ++i)
+  updateIsDense (cloud);
+
+  return (0);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+int
+pcl::PCDReader::readBodyBinaryChunked (const unsigned char *map, size_t map_size,
+                                       pcl::PCLPointCloud2 &cloud, unsigned int data_idx)
+{
+  cloud.is_dense = true;
+
+  if (data_idx + PCD_CHUNKED_HEADER_SIZE > map_size)
   {
-    for (unsigned int d = 0; d < static_cast<unsigned int> (cloud.fields.size ()); ++d)
+    PCL_ERROR ("[pcl::PCDReader::readBodyBinaryChunked] The data is too small to hold a chunk table!\n");
+    return (-1);
+  }
+  uint32_t guard, version, points_per_chunk, nr_chunks;
+  memcpy (&guard, &map[data_idx + 0], 4);
+  memcpy (&version, &map[data_idx + 4], 4);
+  memcpy (&points_per_chunk, &map[data_idx + 8], 4);
+  memcpy (&nr_chunks, &map[data_idx + 12], 4);
+  if (guard != 0 || version != PCD_CHUNKED_FORMAT_VERSION)
+  {
+    PCL_ERROR ("[pcl::PCDReader::readBodyBinaryChunked] Unsupported chunked data version %u!\n", version);
+    return (-1);
+  }
+
+  std::vector<pcl::PCLPointField> fields;
+  std::vector<size_t> fields_sizes;
+  getCompressedFields (cloud.fields, fields, fields_sizes);
+
+  const size_t nr_points = static_cast<size_t> (cloud.width) * cloud.height;
+  const size_t chunks_per_field = (points_per_chunk == 0) ? 0 : (nr_points + points_per_chunk - 1) / points_per_chunk;
+  if (points_per_chunk == 0 || nr_chunks != fields.size () * chunks_per_field)
+  {
+    PCL_ERROR ("[pcl::PCDReader::readBodyBinaryChunked] The chunk table (%u chunks of %u points) does not match the header!\n",
+               nr_chunks, points_per_chunk);
+    return (-1);
+  }
+  const size_t table_idx = data_idx + PCD_CHUNKED_HEADER_SIZE;
+  if (table_idx + nr_chunks * 8 > map_size)
+  {
+    PCL_ERROR ("[pcl::PCDReader::readBodyBinaryChunked] The data is too small to hold the chunk table!\n");
+    return (-1);
+  }
+
+  // Locate the chunks, and check them against the header before touching any data
+  std::vector<size_t> chunk_offsets (nr_chunks);
+  std::vector<uint32_t> compressed_sizes (nr_chunks), uncompressed_sizes (nr_chunks);
+  size_t offset = table_idx + nr_chunks * 8;
+  for (size_t c = 0; c < nr_chunks; ++c)
+  {
+    memcpy (&compressed_sizes[c], &map[table_idx + c * 8 + 0], 4);
+    memcpy (&uncompressed_sizes[c], &map[table_idx + c * 8 + 4], 4);
+    const size_t field = c / chunks_per_field;
+    const size_t first = (c % chunks_per_field) * points_per_chunk;
+    const size_t count = std::min (nr_points - first, static_cast<size_t> (points_per_chunk));
+    if (uncompressed_sizes[c] != count * fields_sizes[field])
     {
-      for (uint32_t c = 0; c < cloud.fields[d].count; ++c)
+      PCL_ERROR ("[pcl::PCDReader::readBodyBinaryChunked] Chunk %u holds %u bytes instead of %u! Data corruption?\n",
+                 static_cast<unsigned int> (c), uncompressed_sizes[c], static_cast<unsigned int> (count * fields_sizes[field]));
+      return (-1);
+    }
+    chunk_offsets[c] = offset;
+    offset += (compressed_sizes[c] == 0) ? uncompressed_sizes[c] : compressed_sizes[c];
+  }
+  if (offset > map_size)
+  {
+    PCL_ERROR ("[pcl::PCDReader::readBodyBinaryChunked] Corrupted PCD file. The file is smaller than expected!\n");
+    return (-1);
+  }
+
+  cloud.data.resize (nr_points * cloud.point_step);
+
+  // Decompress the chunks in parallel, and scatter each one into its field of the points
+  int nr_errors = 0;
+#ifdef _OPENMP
+  const int nr_threads = threads_ == 0 ? omp_get_num_procs () : static_cast<int> (threads_);
+#pragma omp parallel num_threads (nr_threads) reduction (+:nr_errors)
+#endif
+  {
+    std::vector<unsigned char> buf;
+#ifdef _OPENMP
+#pragma omp for schedule (dynamic, 1)
+#endif
+    for (int c = 0; c < static_cast<int> (nr_chunks); ++c)
+    {
+      const unsigned char *chunk = &map[chunk_offsets[c]];
+      if (compressed_sizes[c] != 0)
       {
-        switch (cloud.fields[d].datatype)
+        buf.resize (uncompressed_sizes[c]);
+        if (pcl::lzfDecompress (chunk, compressed_sizes[c], &buf[0], uncompressed_sizes[c]) != uncompressed_sizes[c])
         {
-          case pcl::PCLPointField::INT8:
-          {
-            if (!isValueFinite<pcl::traits::asType<pcl::PCLPointField::INT8>::type> (cloud, i, point_size, d, c))
-              cloud.is_dense = false;
-            break;
-          }
-          case pcl::PCLPointField::UINT8:
-          {
-            if (!isValueFinite<pcl::traits::asType<pcl::PCLPointField::UINT8>::type> (cloud, i, point_size, d, c))
-              cloud.is_dense = false;
-            break;
-          }
-          case pcl::PCLPointField::INT16:
-          {
-            if (!isValueFinite<pcl::traits::asType<pcl::PCLPointField::INT16>::type> (cloud, i, point_size, d, c))
-              cloud.is_dense = false;
-            break;
-          }
-          case pcl::PCLPointField::UINT16:
-          {
-            if (!isValueFinite<pcl::traits::asType<pcl::PCLPointField::UINT16>::type> (cloud, i, point_size, d, c))
-              cloud.is_dense = false;
-            break;
-          }
-          case pcl::PCLPointField::INT32:
-          {
-            if (!isValueFinite<pcl::traits::asType<pcl::PCLPointField::INT32>::type> (cloud, i, point_size, d, c))
-              cloud.is_dense = false;
-            break;
-          }
-          case pcl::PCLPointField::UINT32:
-          {
-            if (!isValueFinite<pcl::traits::asType<pcl::PCLPointField::UINT32>::type> (cloud, i, point_size, d, c))
-              cloud.is_dense = false;
-            break;
-          }
-          case pcl::PCLPointField::FLOAT32:
-          {
-            if (!isValueFinite<pcl::traits::asType<pcl::PCLPointField::FLOAT32>::type> (cloud, i, point_size, d, c))
-              cloud.is_dense = false;
-            break;
-          }
-          case pcl::PCLPointField::FLOAT64:
-          {
-            if (!isValueFinite<pcl::traits::asType<pcl::PCLPointField::FLOAT64>::type> (cloud, i, point_size, d, c))
-              cloud.is_dense = false;
-            break;
-          }
+          ++nr_errors;
+          continue;
         }
+        chunk = &buf[0];
       }
+
+      const size_t field = c / chunks_per_field;
+      const size_t first = (c % chunks_per_field) * points_per_chunk;
+      const size_t field_size = fields_sizes[field];
+      const size_t count = uncompressed_sizes[c] / field_size;
+      uint8_t *out = &cloud.data[first * cloud.point_step + fields[field].offset];
+      for (size_t i = 0; i < count; ++i, out += cloud.point_step, chunk += field_size)
+        memcpy (out, chunk, field_size);
     }
   }
+  if (nr_errors > 0)
+  {
+    PCL_ERROR ("[pcl::PCDReader::readBodyBinaryChunked] Failed to decompress %d chunks! Errno: %d\n", nr_errors, errno);
+    return (-1);
+  }
+
+  updateIsDense (cloud);
 
   return (0);
 }
@@ -787,6 +961,11 @@ pcl::PCDReader::read (const std::string &file_name, pcl::PCLPointCloud2 &cloud,
       // Reset position
       pcl_lseek (fd, 0, SEEK_SET);
     }
+    else if (data_type == 3)
+    {
+      // The size of the chunks is only known from the chunk table, so map the whole file
+      mmap_size = file_size;
+    }
     else
     {
       mmap_size += cloud.data.size ();
@@ -824,7 +1003,10 @@ pcl::PCDReader::read (const std::string &file_name, pcl::PCLPointCloud2 &cloud,
     }
 #endif
 
-    res = readBodyBinary (map, cloud, pcd_version, data_type == 2, offset + data_idx);
+    if (data_type == 3)
+      res = readBodyBinaryChunked (map, mmap_size, cloud, offset + data_idx);
+    else
+      res = readBodyBinary (map, cloud, pcd_version, data_type == 2, offset + data_idx);
 
     // Unmap the pages of memory
 #ifdef _WIN32
@@ -1365,6 +1547,19 @@ pcl::PCDWriter::writeBinaryCompressed (std::ostream &os, const pcl::PCLPointClou
     return (-1);
   }
 
+  if (compression_chunk_size_ > 0)
+  {
+    std::vector<char> body;
+    compressChunked (&cloud.data[0], cloud.point_step, static_cast<size_t> (cloud.width) * cloud.height, cloud.fields, body);
+
+    os.imbue (std::locale::classic ());
+    os << "DATA binary_compressed_chunked\n";
+    os.write (&body[0], body.size ());
+    os.flush ();
+
+    return (os ? 0 : -1);
+  }
+
   size_t fsize = 0;
   size_t data_size = 0;
   size_t nri = 0;
@@ -1459,18 +1654,101 @@ pcl::PCDWriter::writeBinaryCompressed (const std::string &file_name, const pcl::
   }
   std::string ostr = oss.str ();
 
+  return (writeMapped (file_name, ostr.data (), ostr.size ()));
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+void
+pcl::PCDWriter::compressChunked (const uint8_t *data, size_t point_step, size_t nr_points,
+                                 const std::vector<pcl::PCLPointField> &all_fields, std::vector<char> &body) const
+{
+  std::vector<pcl::PCLPointField> fields;
+  std::vector<size_t> fields_sizes;
+  getCompressedFields (all_fields, fields, fields_sizes);
+
+  const size_t points_per_chunk = compression_chunk_size_;
+  const size_t chunks_per_field = (nr_points + points_per_chunk - 1) / points_per_chunk;
+  const int nr_chunks = static_cast<int> (fields.size () * chunks_per_field);
+
+  // Gather each chunk into a field plane (xxx, yyy, ...) to aid compression, and compress it
+  std::vector<std::vector<char> > chunks (nr_chunks);
+  std::vector<uint32_t> compressed_sizes (nr_chunks), uncompressed_sizes (nr_chunks);
+#ifdef _OPENMP
+  const int nr_threads = threads_ == 0 ? omp_get_num_procs () : static_cast<int> (threads_);
+#pragma omp parallel num_threads (nr_threads)
+#endif
+  {
+    std::vector<char> plane;
+#ifdef _OPENMP
+#pragma omp for schedule (dynamic, 1)
+#endif
+    for (int c = 0; c < nr_chunks; ++c)
+    {
+      const size_t field = c / chunks_per_field;
+      const size_t first = (c % chunks_per_field) * points_per_chunk;
+      const size_t count = std::min (nr_points - first, points_per_chunk);
+      const size_t field_size = fields_sizes[field];
+      const size_t plane_size = count * field_size;
+
+      plane.resize (plane_size);
+      const uint8_t *in = data + first * point_step + fields[field].offset;
+      for (size_t i = 0; i < count; ++i, in += point_step)
+        memcpy (&plane[i * field_size], in, field_size);
+
+      // Keep the compressed chunk only if LZF manages to shrink it. The output buffer leaves
+      // room for LZF's worst case expansion, so incompressible chunks do not trigger warnings.
+      chunks[c].resize (plane_size + plane_size / 16 + 64);
+      unsigned int compressed_size = 0;
+      if (plane_size > 1)
+        compressed_size = pcl::lzfCompress (&plane[0], static_cast<unsigned int> (plane_size),
+                                            &chunks[c][0], static_cast<unsigned int> (chunks[c].size ()));
+      if (compressed_size >= plane_size)
+        compressed_size = 0;
+      if (compressed_size == 0)
+        chunks[c].swap (plane);
+      else
+        chunks[c].resize (compressed_size);
+      compressed_sizes[c] = compressed_size;
+      uncompressed_sizes[c] = static_cast<uint32_t> (plane_size);
+    }
+  }
+
+  // Assemble the header, the chunk table and the chunks
+  size_t body_size = PCD_CHUNKED_HEADER_SIZE + nr_chunks * 8;
+  for (int c = 0; c < nr_chunks; ++c)
+    body_size += chunks[c].size ();
+  body.resize (body_size);
+
+  const uint32_t header[4] = { 0, PCD_CHUNKED_FORMAT_VERSION, static_cast<uint32_t> (points_per_chunk), static_cast<uint32_t> (nr_chunks) };
+  memcpy (&body[0], header, PCD_CHUNKED_HEADER_SIZE);
+  size_t offset = PCD_CHUNKED_HEADER_SIZE + nr_chunks * 8;
+  for (int c = 0; c < nr_chunks; ++c)
+  {
+    memcpy (&body[PCD_CHUNKED_HEADER_SIZE + c * 8 + 0], &compressed_sizes[c], 4);
+    memcpy (&body[PCD_CHUNKED_HEADER_SIZE + c * 8 + 4], &uncompressed_sizes[c], 4);
+    if (!chunks[c].empty ())
+      memcpy (&body[offset], &chunks[c][0], chunks[c].size ());
+    offset += chunks[c].size ();
+  }
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+int
+pcl::PCDWriter::writeMapped (const std::string &file_name, const char *buffer, size_t size)
+{
 #ifdef _WIN32
   HANDLE h_native_file = CreateFile (file_name.c_str (), GENERIC_READ | GENERIC_WRITE, 0, NULL, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
   if (h_native_file == INVALID_HANDLE_VALUE)
   {
-    PCL_ERROR ("[pcl::PCDWriter::writeBinaryCompressed] Error during CreateFile (%s)!\n", file_name.c_str ());
+    PCL_ERROR ("[pcl::PCDWriter::writeMapped] Error during CreateFile (%s)!\n", file_name.c_str ());
     return (-1);
   }
 #else
   int fd = pcl_open (file_name.c_str (), O_RDWR | O_CREAT | O_TRUNC, S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH);
   if (fd < 0)
   {
-    PCL_ERROR ("[pcl::PCDWriter::writeBinaryCompressed] Error during open (%s)!\n", file_name.c_str ());
+    PCL_ERROR ("[pcl::PCDWriter::writeMapped] Error during open (%s)!\n", file_name.c_str ());
     return (-1);
   }
 #endif
@@ -1481,15 +1759,15 @@ pcl::PCDWriter::writeBinaryCompressed (const std::string &file_name, const pcl::
 #ifndef _WIN32
   // Stretch the file size to the size of the data
   size_t page_size = getpagesize ();
-  size_t size_pages = ostr.size () / page_size;
-  size_t partial_pages = (size_pages * page_size < ostr.size ()) ? 1 : 0;
+  size_t size_pages = size / page_size;
+  size_t partial_pages = (size_pages * page_size < size) ? 1 : 0;
   off_t result = pcl_lseek (fd, (size_pages + partial_pages) * page_size - 1, SEEK_SET);
   if (result < 0)
   {
     pcl_close (fd);
     resetLockingPermissions (file_name, file_lock);
-    PCL_ERROR ("[pcl::PCDWriter::writeBinaryCompressed] lseek errno: %d strerror: %s\n", errno, strerror (errno));
-    PCL_ERROR ("[pcl::PCDWriter::writeBinaryCompressed] Error during lseek ()!\n");
+    PCL_ERROR ("[pcl::PCDWriter::writeMapped] lseek errno: %d strerror: %s\n", errno, strerror (errno));
+    PCL_ERROR ("[pcl::PCDWriter::writeMapped] Error during lseek ()!\n");
     return (-1);
   }
   // Write a bogus entry so that the new file size comes in effect
@@ -1498,46 +1776,46 @@ pcl::PCDWriter::writeBinaryCompressed (const std::string &file_name, const pcl::
   {
     pcl_close (fd);
     resetLockingPermissions (file_name, file_lock);
-    PCL_ERROR ("[pcl::PCDWriter::writeBinaryCompressed] Error during write ()!\n");
+    PCL_ERROR ("[pcl::PCDWriter::writeMapped] Error during write ()!\n");
     return (-1);
   }
 #endif
 
   // Prepare the map
 #ifdef _WIN32
-  HANDLE fm = CreateFileMapping (h_native_file, NULL, PAGE_READWRITE, 0, ostr.size (), NULL);
-  char *map = static_cast<char*> (MapViewOfFile (fm, FILE_MAP_READ | FILE_MAP_WRITE, 0, 0, ostr.size ()));
+  HANDLE fm = CreateFileMapping (h_native_file, NULL, PAGE_READWRITE, 0, size, NULL);
+  char *map = static_cast<char*> (MapViewOfFile (fm, FILE_MAP_READ | FILE_MAP_WRITE, 0, 0, size));
   CloseHandle (fm);
 
 #else
-  char *map = static_cast<char*> (mmap (0, ostr.size (), PROT_WRITE, MAP_SHARED, fd, 0));
+  char *map = static_cast<char*> (mmap (0, size, PROT_WRITE, MAP_SHARED, fd, 0));
   if (map == reinterpret_cast<char*> (-1))    // MAP_FAILED
   {
     pcl_close (fd);
     resetLockingPermissions (file_name, file_lock);
-    PCL_ERROR ("[pcl::PCDWriter::writeBinaryCompressed] Error during mmap ()!\n");
+    PCL_ERROR ("[pcl::PCDWriter::writeMapped] Error during mmap ()!\n");
     return (-1);
   }
 #endif
 
-  // copy header + compressed data
-  memcpy (map, ostr.data (), ostr.size ());
+  // Copy the data
+  memcpy (map, buffer, size);
 
 #ifndef _WIN32
   // If the user set the synchronization flag on, call msync
   if (map_synchronization_)
-    msync (map, ostr.size (), MS_SYNC);
+    msync (map, size, MS_SYNC);
 #endif
 
   // Unmap the pages of memory
 #ifdef _WIN32
     UnmapViewOfFile (map);
 #else
-  if (munmap (map, ostr.size ()) == -1)
+  if (munmap (map, size) == -1)
   {
     pcl_close (fd);
     resetLockingPermissions (file_name, file_lock);
-    PCL_ERROR ("[pcl::PCDWriter::writeBinaryCompressed] Error during munmap ()!\n");
+    PCL_ERROR ("[pcl::PCDWriter::writeMapped] Error during munmap ()!\n");
     return (-1);
   }
 #endif
@@ -1552,3 +1830,139 @@ pcl::PCDWriter::writeBinaryCompressed (const std::string &file_name, const pcl::
   return (0);
 }
 
+///////////////////////////////////////////////////////////////////////////////////////////
+pcl::PCDMappedCloud::PCDMappedCloud ()
+  : info_ ()
+  , origin_ (Eigen::Vector4f::Zero ())
+  , orientation_ (Eigen::Quaternionf::Identity ())
+  , map_ (NULL)
+  , map_size_ (0)
+  , data_ (NULL)
+#ifdef _WIN32
+  , file_mapping_ (NULL)
+#endif
+{
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+pcl::PCDMappedCloud::~PCDMappedCloud ()
+{
+  close ();
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+int
+pcl::PCDMappedCloud::open (const std::string &file_name, const int offset)
+{
+  close ();
+
+  if (file_name == "" || !boost::filesystem::exists (file_name))
+  {
+    PCL_ERROR ("[pcl::PCDMappedCloud::open] Could not find file '%s'.\n", file_name.c_str ());
+    return (-1);
+  }
+
+  // Parse the header, without allocating memory for the data
+  pcl::PCLPointCloud2 info;
+  Eigen::Vector4f origin;
+  Eigen::Quaternionf orientation;
+  int pcd_version, data_type;
+  unsigned int data_idx;
+  {
+    std::ifstream fs;
+    fs.open (file_name.c_str (), std::ios::binary);
+    if (!fs.is_open () || fs.fail ())
+    {
+      PCL_ERROR ("[pcl::PCDMappedCloud::open] Could not open file '%s'! Error : %s\n", file_name.c_str (), strerror (errno));
+      return (-1);
+    }
+    fs.seekg (offset, std::ios::beg);
+    int res = parsePCDHeader (fs, info, origin, orientation, pcd_version, data_type, data_idx, false);
+    fs.close ();
+    if (res < 0)
+      return (-1);
+  }
+
+  if (data_type != 1)
+  {
+    PCL_ERROR ("[pcl::PCDMappedCloud::open] File %s is not a binary PCD file! Use PCDReader to load %s data.\n",
+               file_name.c_str (), data_type == 0 ? "ASCII" : "binary_compressed");
+    return (-1);
+  }
+
+  // Qualified, as the unqualified names resolve to the open () and close () members
+  int fd = ::pcl_open (file_name.c_str (), O_RDONLY);
+  if (fd == -1)
+  {
+    PCL_ERROR ("[pcl::PCDMappedCloud::open] Failure to open file %s\n", file_name.c_str ());
+    return (-1);
+  }
+
+  // Make sure all the points are there, computing the size in size_t to support files larger than 4GB
+  const size_t file_size = pcl_lseek (fd, 0, SEEK_END);
+  pcl_lseek (fd, 0, SEEK_SET);
+  const size_t data_offset = static_cast<size_t> (offset) + data_idx;
+  if (data_offset + static_cast<size_t> (info.width) * info.height * info.point_step > file_size)
+  {
+    ::pcl_close (fd);
+    PCL_ERROR ("[pcl::PCDMappedCloud::open] Corrupted PCD file. The file is smaller than expected!\n");
+    return (-1);
+  }
+
+#ifdef _WIN32
+  HANDLE fm = CreateFileMapping ((HANDLE) _get_osfhandle (fd), NULL, PAGE_READONLY, 0, 0, NULL);
+  uint8_t *map = (fm == NULL) ? NULL : static_cast<uint8_t*> (MapViewOfFile (fm, FILE_MAP_READ, 0, 0, 0));
+  ::pcl_close (fd);
+  if (map == NULL)
+  {
+    if (fm != NULL)
+      CloseHandle (fm);
+    PCL_ERROR ("[pcl::PCDMappedCloud::open] Error mapping view of file, %s\n", file_name.c_str ());
+    return (-1);
+  }
+  file_mapping_ = fm;
+#else
+  uint8_t *map = static_cast<uint8_t*> (mmap (0, file_size, PROT_READ, MAP_SHARED, fd, 0));
+  // The mapping stays valid after the descriptor is closed
+  ::pcl_close (fd);
+  if (map == reinterpret_cast<uint8_t*> (-1))    // MAP_FAILED
+  {
+    PCL_ERROR ("[pcl::PCDMappedCloud::open] Error preparing mmap for binary PCD file %s.\n", file_name.c_str ());
+    return (-1);
+  }
+#endif
+
+  info_ = info;
+  info_.row_step = info_.point_step * info_.width;
+  info_.is_dense = false;
+  origin_ = origin;
+  orientation_ = orientation;
+  map_ = map;
+  map_size_ = file_size;
+  data_ = map_ + data_offset;
+  return (0);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+void
+pcl::PCDMappedCloud::close ()
+{
+  if (map_ == NULL)
+    return;
+
+#ifdef _WIN32
+  UnmapViewOfFile (map_);
+  CloseHandle (file_mapping_);
+  file_mapping_ = NULL;
+#else
+  if (munmap (map_, map_size_) == -1)
+    PCL_ERROR ("[pcl::PCDMappedCloud::close] Munmap failure\n");
+#endif
+
+  map_ = NULL;
+  map_size_ = 0;
+  data_ = NULL;
+  info_ = pcl::PCLPointCloud2 ();
+  origin_ = Eigen::Vector4f::Zero ();
+  orientation_ = Eigen::Quaternionf::Identity ();
+}
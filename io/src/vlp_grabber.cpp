@@ -99,38 +99,34 @@ pcl::VLPGrabber::getDefaultNetworkAddress ()
 
 /////////////////////////////////////////////////////////////////////////////
 void
-pcl::VLPGrabber::toPointClouds (HDLDataPacket *dataPacket)
+pcl::VLPGrabber::decodePacket (const HDLDataPacket& dataPacket,
+                               HDLDecodedPacket& decoded) const
 {
-  static uint32_t scan_counter = 0;
-  static uint32_t sweep_counter = 0;
-  if (sizeof(HDLLaserReturn) != 3)
-    return;
-
-  time_t system_time;
-  time (&system_time);
-  time_t velodyne_time = (system_time & 0x00000000ffffffffl) << 32 | dataPacket->gpsTimestamp;
-
-  scan_counter++;
+  decoded.returns.clear ();
+  decoded.gpsTimestamp = dataPacket.gpsTimestamp;
+  decoded.startAngle = dataPacket.firingData[0].rotationalPosition;
+  decoded.endAngle = dataPacket.firingData[HDL_FIRING_PER_PKT - 1].rotationalPosition;
+  decoded.hasScan = false;
 
   double interpolated_azimuth_delta;
 
   uint8_t index = 1;
-  if (dataPacket->mode == VLP_DUAL_MODE)
+  if (dataPacket.mode == VLP_DUAL_MODE)
   {
     index = 2;
   }
-  if (dataPacket->firingData[index].rotationalPosition < dataPacket->firingData[0].rotationalPosition)
+  if (dataPacket.firingData[index].rotationalPosition < dataPacket.firingData[0].rotationalPosition)
   {
-    interpolated_azimuth_delta = ((dataPacket->firingData[index].rotationalPosition + 36000) - dataPacket->firingData[0].rotationalPosition) / 2.0;
+    interpolated_azimuth_delta = ((dataPacket.firingData[index].rotationalPosition + 36000) - dataPacket.firingData[0].rotationalPosition) / 2.0;
   }
   else
   {
-    interpolated_azimuth_delta = (dataPacket->firingData[index].rotationalPosition - dataPacket->firingData[0].rotationalPosition) / 2.0;
+    interpolated_azimuth_delta = (dataPacket.firingData[index].rotationalPosition - dataPacket.firingData[0].rotationalPosition) / 2.0;
   }
 
   for (uint8_t i = 0; i < HDL_FIRING_PER_PKT; ++i)
   {
-    HDLFiringData firing_data = dataPacket->firingData[i];
+    const HDLFiringData& firing_data = dataPacket.firingData[i];
 
     for (uint8_t j = 0; j < HDL_LASER_PER_FIRING; j++)
     {
@@ -143,73 +139,45 @@ pcl::VLPGrabber::toPointClouds (HDLDataPacket *dataPacket)
       {
         current_azimuth -= 36000;
       }
-      if (current_azimuth < HDLGrabber::last_azimuth_)
-      {
-        if (current_sweep_xyz_->size () > 0)
-        {
-          current_sweep_xyz_->is_dense = current_sweep_xyzrgba_->is_dense = current_sweep_xyzi_->is_dense = false;
-          current_sweep_xyz_->header.stamp = velodyne_time;
-          current_sweep_xyzrgba_->header.stamp = velodyne_time;
-          current_sweep_xyzi_->header.stamp = velodyne_time;
-          current_sweep_xyz_->header.seq = sweep_counter;
-          current_sweep_xyzrgba_->header.seq = sweep_counter;
-          current_sweep_xyzi_->header.seq = sweep_counter;
-
-          sweep_counter++;
-
-          HDLGrabber::fireCurrentSweep ();
-        }
-        current_sweep_xyz_.reset (new pcl::PointCloud<pcl::PointXYZ> ());
-        current_sweep_xyzrgba_.reset (new pcl::PointCloud<pcl::PointXYZRGBA> ());
-        current_sweep_xyzi_.reset (new pcl::PointCloud<pcl::PointXYZI> ());
-      }
 
-      PointXYZ xyz;
+      const uint8_t laser = static_cast<uint8_t> (j % VLP_MAX_NUM_LASERS);
       PointXYZI xyzi;
-      PointXYZRGBA xyzrgba;
-      PointXYZ dual_xyz;
-      PointXYZI dual_xyzi;
-      PointXYZRGBA dual_xyzrgba;
 
-      HDLGrabber::computeXYZI (xyzi, current_azimuth, firing_data.laserReturns[j], laser_corrections_[j % VLP_MAX_NUM_LASERS]);
-
-      xyz.x = xyzrgba.x = xyzi.x;
-      xyz.y = xyzrgba.y = xyzi.y;
-      xyz.z = xyzrgba.z = xyzi.z;
-
-      xyzrgba.rgba = laser_rgb_mapping_[j % VLP_MAX_NUM_LASERS].rgba;
-
-      if (dataPacket->mode == VLP_DUAL_MODE)
+      HDLGrabber::computeXYZI (xyzi, static_cast<uint16_t> (current_azimuth), firing_data.laserReturns[j], laser_corrections_[laser]);
+
+      HDLDecodedReturn laser_return;
+      laser_return.x = xyzi.x;
+      laser_return.y = xyzi.y;
+      laser_return.z = xyzi.z;
+      laser_return.intensity = xyzi.intensity;
+      laser_return.rgba = laser_rgb_mapping_[laser].rgba;
+      laser_return.azimuth = current_azimuth;
+      laser_return.laser = laser;
+      laser_return.valid = !(pcl_isnan (xyzi.x) || pcl_isnan (xyzi.y) || pcl_isnan (xyzi.z));
+      laser_return.dual = false;
+      decoded.returns.push_back (laser_return);
+
+      if (dataPacket.mode == VLP_DUAL_MODE)
       {
-        HDLGrabber::computeXYZI (dual_xyzi, current_azimuth, dataPacket->firingData[i + 1].laserReturns[j], laser_corrections_[j % VLP_MAX_NUM_LASERS]);
+        PointXYZI dual_xyzi;
 
-        dual_xyz.x = dual_xyzrgba.x = dual_xyzi.x;
-        dual_xyz.y = dual_xyzrgba.y = dual_xyzi.y;
-        dual_xyz.z = dual_xyzrgba.z = dual_xyzi.z;
-
-        dual_xyzrgba.rgba = laser_rgb_mapping_[j % VLP_MAX_NUM_LASERS].rgba;
-      }
+        HDLGrabber::computeXYZI (dual_xyzi, static_cast<uint16_t> (current_azimuth), dataPacket.firingData[i + 1].laserReturns[j], laser_corrections_[laser]);
 
-      if (! (pcl_isnan (xyz.x) || pcl_isnan (xyz.y) || pcl_isnan (xyz.z)))
-      {
-        current_sweep_xyz_->push_back (xyz);
-        current_sweep_xyzrgba_->push_back (xyzrgba);
-        current_sweep_xyzi_->push_back (xyzi);
-
-        last_azimuth_ = current_azimuth;
-      }
-      if (dataPacket->mode == VLP_DUAL_MODE)
-      {
-        if ((dual_xyz.x != xyz.x || dual_xyz.y != xyz.y || dual_xyz.z != xyz.z)
-            && ! (pcl_isnan (dual_xyz.x) || pcl_isnan (dual_xyz.y) || pcl_isnan (dual_xyz.z)))
+        // the second return is only kept if it hit another target than the first one
+        if ((dual_xyzi.x != xyzi.x || dual_xyzi.y != xyzi.y || dual_xyzi.z != xyzi.z)
+            && ! (pcl_isnan (dual_xyzi.x) || pcl_isnan (dual_xyzi.y) || pcl_isnan (dual_xyzi.z)))
         {
-          current_sweep_xyz_->push_back (dual_xyz);
-          current_sweep_xyzrgba_->push_back (dual_xyzrgba);
-          current_sweep_xyzi_->push_back (dual_xyzi);
+          laser_return.x = dual_xyzi.x;
+          laser_return.y = dual_xyzi.y;
+          laser_return.z = dual_xyzi.z;
+          laser_return.intensity = dual_xyzi.intensity;
+          laser_return.valid = true;
+          laser_return.dual = true;
+          decoded.returns.push_back (laser_return);
         }
       }
     }
-    if (dataPacket->mode == VLP_DUAL_MODE)
+    if (dataPacket.mode == VLP_DUAL_MODE)
     {
       i++;
     }
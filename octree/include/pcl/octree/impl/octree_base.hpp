@@ -154,8 +154,8 @@ namespace pcl
         // generate key
         OctreeKey key (idx_x_arg, idx_y_arg, idx_z_arg);
 
-        // check if key exist in octree
-        deleteLeafRecursive (key, depth_mask_, root_node_);
+        // free voxel at key
+        this->removeLeaf (key);
       }
 
     //////////////////////////////////////////////////////////////////////////////////////////////
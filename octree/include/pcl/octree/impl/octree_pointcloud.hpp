@@ -40,16 +40,34 @@
 #define PCL_OCTREE_POINTCLOUD_HPP_
 
 #include <assert.h>
+#include <algorithm>
+#include <vector>
 
 #include <pcl/common/common.h>
 #include <pcl/octree/impl/octree_base.hpp>
 
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+namespace pcl
+{
+  namespace octree
+  {
+    namespace detail
+    {
+      /** \brief Number of bits of the Morton codes sorted in one pass of the radix sort of the bulk insertion. */
+      const int OCTREE_MORTON_RADIX_BITS = 11;
+    }
+  }
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////
 template<typename PointT, typename LeafContainerT, typename BranchContainerT, typename OctreeT>
 pcl::octree::OctreePointCloud<PointT, LeafContainerT, BranchContainerT, OctreeT>::OctreePointCloud (const double resolution) :
     OctreeT (), input_ (PointCloudConstPtr ()), indices_ (IndicesConstPtr ()),
     epsilon_ (0), resolution_ (resolution), min_x_ (0.0f), max_x_ (resolution), min_y_ (0.0f),
-    max_y_ (resolution), min_z_ (0.0f), max_z_ (resolution), bounding_box_defined_ (false), max_objs_per_leaf_(0)
+    max_y_ (resolution), min_z_ (0.0f), max_z_ (resolution), bounding_box_defined_ (false), max_objs_per_leaf_(0), threads_ (1)
 {
   assert (resolution > 0.0f);
 }
@@ -66,6 +84,12 @@ pcl::octree::OctreePointCloud<PointT, LeafContainerT, BranchContainerT, OctreeT>
 {
   size_t i;
 
+  if (threads_ != 1 && isBulkInsertionSupported ())
+  {
+    addPointsFromInputCloudInBulk ();
+    return;
+  }
+
   if (indices_)
   {
     for (std::vector<int>::const_iterator current = indices_->begin (); current != indices_->end (); ++current)
@@ -92,6 +116,179 @@ pcl::octree::OctreePointCloud<PointT, LeafContainerT, BranchContainerT, OctreeT>
   }
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////
+template<typename PointT, typename LeafContainerT, typename BranchContainerT, typename OctreeT> void
+pcl::octree::OctreePointCloud<PointT, LeafContainerT, BranchContainerT, OctreeT>::addPointsFromInputCloudInBulk ()
+{
+  const size_t nr_candidates = indices_ ? indices_->size () : input_->points.size ();
+
+  std::vector<int> point_indices;
+  point_indices.reserve (nr_candidates);
+
+  // grow the bounding box in insertion order and remember where its lower corner moves, since every point has
+  // to get the key it would have been given at its turn
+  std::vector<size_t> epoch_begin;
+  std::vector<double> epoch_min;
+
+  for (size_t i = 0; i < nr_candidates; ++i)
+  {
+    const int point_idx = indices_ ? (*indices_)[i] : static_cast<int> (i);
+    assert ((point_idx >= 0) && (point_idx < static_cast<int> (input_->points.size ())));
+
+    const PointT& point = input_->points[point_idx];
+    if (!isFinite (point))
+      continue;
+
+    adoptBoundingBoxToPoint (point);
+
+    if (epoch_begin.empty () || min_x_ != epoch_min[epoch_min.size () - 3]
+        || min_y_ != epoch_min[epoch_min.size () - 2] || min_z_ != epoch_min[epoch_min.size () - 1])
+    {
+      epoch_begin.push_back (point_indices.size ());
+      epoch_min.push_back (min_x_);
+      epoch_min.push_back (min_y_);
+      epoch_min.push_back (min_z_);
+    }
+    point_indices.push_back (point_idx);
+  }
+
+  const int nr_points = static_cast<int> (point_indices.size ());
+  if (nr_points == 0)
+    return;
+  epoch_begin.push_back (point_indices.size ());
+
+#ifdef _OPENMP
+  const int threads = threads_ == 0 ? omp_get_num_procs () : static_cast<int> (threads_);
+#endif
+
+  // every time the tree grows at the lower end of an axis, the keys generated before are moved by the old tree
+  // size along that axis
+  std::vector<OctreeKey> keys (point_indices.size ());
+  for (size_t epoch = 0; epoch + 1 < epoch_begin.size (); ++epoch)
+  {
+    const double epoch_min_x = epoch_min[3 * epoch];
+    const double epoch_min_y = epoch_min[3 * epoch + 1];
+    const double epoch_min_z = epoch_min[3 * epoch + 2];
+
+    const unsigned int shift_x = static_cast<unsigned int> ((epoch_min_x - min_x_) / resolution_ + 0.5);
+    const unsigned int shift_y = static_cast<unsigned int> ((epoch_min_y - min_y_) / resolution_ + 0.5);
+    const unsigned int shift_z = static_cast<unsigned int> ((epoch_min_z - min_z_) / resolution_ + 0.5);
+
+    const int begin = static_cast<int> (epoch_begin[epoch]);
+    const int end = static_cast<int> (epoch_begin[epoch + 1]);
+
+#ifdef _OPENMP
+#pragma omp parallel for schedule (static) num_threads (threads)
+#endif
+    for (int i = begin; i < end; ++i)
+    {
+      // same computation as genOctreeKeyforPoint with the bounding box of this epoch
+      const PointT& point = input_->points[point_indices[i]];
+      keys[i].x = static_cast<unsigned int> ((point.x - epoch_min_x) / resolution_) + shift_x;
+      keys[i].y = static_cast<unsigned int> ((point.y - epoch_min_y) / resolution_) + shift_y;
+      keys[i].z = static_cast<unsigned int> ((point.z - epoch_min_z) / resolution_) + shift_z;
+
+      assert (keys[i].x <= this->max_key_.x);
+      assert (keys[i].y <= this->max_key_.y);
+      assert (keys[i].z <= this->max_key_.z);
+    }
+  }
+
+  LeafNode* leaf_node;
+  BranchNode* parent_branch_of_leaf_node;
+
+  // Morton codes hold 21 bits per axis
+  if (this->octree_depth_ > 21)
+  {
+    for (int i = 0; i < nr_points; ++i)
+    {
+      this->createLeafRecursive (keys[i], this->depth_mask_, this->root_node_, leaf_node, parent_branch_of_leaf_node);
+      addPointToLeaf (**leaf_node, point_indices[i]);
+    }
+    return;
+  }
+
+  std::vector<uint64_t> codes (point_indices.size ());
+  std::vector<int> order (point_indices.size ());
+
+#ifdef _OPENMP
+#pragma omp parallel for schedule (static) num_threads (threads)
+#endif
+  for (int i = 0; i < nr_points; ++i)
+  {
+    codes[i] = keys[i].getMortonCode ();
+    order[i] = i;
+  }
+
+  // stable LSD radix sort, points falling into the same leaf keep their insertion order
+  const int radix_bits = detail::OCTREE_MORTON_RADIX_BITS;
+  const size_t radix_size = static_cast<size_t> (1) << radix_bits;
+  const uint64_t radix_mask = static_cast<uint64_t> (radix_size - 1);
+
+  std::vector<uint64_t> sorted_codes (point_indices.size ());
+  std::vector<int> sorted_order (point_indices.size ());
+  std::vector<size_t> bucket_begin (radix_size);
+
+  for (int shift = 0; shift < 3 * static_cast<int> (this->octree_depth_); shift += radix_bits)
+  {
+    std::fill (bucket_begin.begin (), bucket_begin.end (), 0);
+    for (int i = 0; i < nr_points; ++i)
+      ++bucket_begin[(codes[i] >> shift) & radix_mask];
+
+    size_t offset = 0;
+    for (size_t bucket = 0; bucket < radix_size; ++bucket)
+    {
+      const size_t bucket_size = bucket_begin[bucket];
+      bucket_begin[bucket] = offset;
+      offset += bucket_size;
+    }
+
+    for (int i = 0; i < nr_points; ++i)
+    {
+      const size_t target = bucket_begin[(codes[i] >> shift) & radix_mask]++;
+      sorted_codes[target] = codes[i];
+      sorted_order[target] = order[i];
+    }
+
+    codes.swap (sorted_codes);
+    order.swap (sorted_order);
+  }
+
+  // the leaves are created in depth first order. The branches on the path to the previous leaf are kept, so
+  // that a leaf is only created below the deepest branch it shares with its predecessor
+  const unsigned int depth = this->octree_depth_;
+  std::vector<BranchNode*> branch_path (depth);
+  branch_path[0] = this->root_node_;
+
+  for (int i = 0; i < nr_points; ++i)
+  {
+    if (i == 0 || codes[i] != codes[i - 1])
+    {
+      unsigned int level = 0;
+      if (i > 0)
+      {
+        // every level of the tree contributes three bits to the code, starting with the leaves
+        const uint64_t code_diff = codes[i] ^ codes[i - 1];
+        unsigned int diff_level = 0;
+        while (code_diff >> (3 * (diff_level + 1)))
+          ++diff_level;
+        level = depth - 1 - diff_level;
+      }
+
+      const OctreeKey& key = keys[order[i]];
+      this->createLeafRecursive (key, this->depth_mask_ >> level, branch_path[level], leaf_node, parent_branch_of_leaf_node);
+
+      for (unsigned int child_level = level + 1; child_level < depth; ++child_level)
+      {
+        const unsigned char child_idx = key.getChildIdxWithDepthMask (this->depth_mask_ >> (child_level - 1));
+        branch_path[child_level] = static_cast<BranchNode*> (this->getBranchChildPtr (*branch_path[child_level - 1], child_idx));
+      }
+    }
+
+    addPointToLeaf (**leaf_node, point_indices[order[i]]);
+  }
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////
 template<typename PointT, typename LeafContainerT, typename BranchContainerT, typename OctreeT> void
 pcl::octree::OctreePointCloud<PointT, LeafContainerT, BranchContainerT, OctreeT>::addPointFromCloud (const int point_idx_arg, IndicesPtr indices_arg)
@@ -604,7 +801,7 @@ pcl::octree::OctreePointCloud<PointT, LeafContainerT, BranchContainerT, OctreeT>
 
   }
 
-  (*leaf_node)->addPointIndex (point_idx_arg);
+  addPointToLeaf (**leaf_node, point_idx_arg);
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////////
@@ -40,6 +40,28 @@
 #define PCL_OCTREE_SEARCH_IMPL_H_
 
 #include <assert.h>
+#include <algorithm>
+#include <limits>
+#include <utility>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+namespace pcl
+{
+  namespace octree
+  {
+    namespace detail
+    {
+      /** \brief Number of points of a contiguous leaf whose distances to a query are computed at once. */
+      const int OCTREE_LEAF_SCAN_BLOCK_SIZE = 64;
+
+      /** \brief Number of queries traversing the contiguous leaves together in a batch radius search. */
+      const int OCTREE_QUERY_PACKET_SIZE = 32;
+    }
+  }
+}
 
 //////////////////////////////////////////////////////////////////////////////////////////////
 template<typename PointT, typename LeafContainerT, typename BranchContainerT> bool
@@ -100,7 +122,10 @@ pcl::octree::OctreePointCloudSearch<PointT, LeafContainerT, BranchContainerT>::n
   // initialize smallest point distance in search with high value
   double smallest_dist = std::numeric_limits<double>::max ();
 
-  getKNearestNeighborRecursive (p_q, k, this->root_node_, key, 1, smallest_dist, point_candidates);
+  if (hasContiguousLeaves ())
+    getKNearestNeighborContiguous (p_q, k, 0, key, 1, smallest_dist, point_candidates);
+  else
+    getKNearestNeighborRecursive (p_q, k, this->root_node_, key, 1, smallest_dist, point_candidates);
 
   result_count = static_cast<unsigned int> (point_candidates.size ());
 
@@ -167,8 +192,20 @@ pcl::octree::OctreePointCloudSearch<PointT, LeafContainerT, BranchContainerT>::r
   k_indices.clear ();
   k_sqr_distances.clear ();
 
-  getNeighborsWithinRadiusRecursive (p_q, radius * radius, this->root_node_, key, 1, k_indices, k_sqr_distances,
-                                     max_nn);
+  if (hasContiguousLeaves ())
+  {
+    // a packet holding a single query
+    const PointT* query = &p_q;
+    std::vector<int>* query_indices = &k_indices;
+    std::vector<float>* query_sqr_distances = &k_sqr_distances;
+    int active[OctreeKey::maxDepth + 1];
+    active[0] = 0;
+    getNeighborsWithinRadiusContiguous (&query, radius * radius, 0, key, 1, active, 1, 1, &query_indices,
+                                        &query_sqr_distances, max_nn);
+  }
+  else
+    getNeighborsWithinRadiusRecursive (p_q, radius * radius, this->root_node_, key, 1, k_indices, k_sqr_distances,
+                                       max_nn);
 
   return (static_cast<int> (k_indices.size ()));
 }
@@ -859,6 +896,491 @@ pcl::octree::OctreePointCloudSearch<PointT, LeafContainerT, BranchContainerT>::g
   return (voxel_count);
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////
+template<typename PointT, typename LeafContainerT, typename BranchContainerT> void
+pcl::octree::OctreePointCloudSearch<PointT, LeafContainerT, BranchContainerT>::nearestKSearch (
+    const PointCloud &cloud, const std::vector<int> &indices, int k, std::vector<size_t> &offsets,
+    std::vector<int> &k_indices, std::vector<float> &k_sqr_distances, unsigned int nr_threads) const
+{
+  const size_t nr_queries = indices.empty () ? cloud.points.size () : indices.size ();
+
+  offsets.assign (nr_queries + 1, 0);
+  k_indices.clear ();
+  k_sqr_distances.clear ();
+  if (k < 1)
+    return;
+
+  // results are first written with a fixed stride of k, then compacted
+  k_indices.resize (nr_queries * k);
+  k_sqr_distances.resize (nr_queries * k);
+
+  std::vector<int> order;
+  sortQueries (cloud, indices, order);
+
+#ifdef _OPENMP
+  const int threads = nr_threads == 0 ? omp_get_num_procs () : static_cast<int> (nr_threads);
+#else
+  (void) nr_threads;
+#endif
+  std::vector<prioPointQueueEntry> point_candidates;
+#ifdef _OPENMP
+#pragma omp parallel for firstprivate (point_candidates) schedule (dynamic, 256) num_threads (threads)
+#endif
+  for (int i = 0; i < static_cast<int> (order.size ()); ++i)
+  {
+    const int query = order[i];
+    const PointT& point = cloud.points[indices.empty () ? query : indices[query]];
+    const double smallest_dist = std::numeric_limits<double>::max ();
+    OctreeKey key;
+
+    point_candidates.clear ();
+    if (hasContiguousLeaves ())
+      getKNearestNeighborContiguous (point, k, 0, key, 1, smallest_dist, point_candidates);
+    else
+      getKNearestNeighborRecursive (point, k, this->root_node_, key, 1, smallest_dist, point_candidates);
+
+    const size_t stride_offset = static_cast<size_t> (query) * k;
+    for (size_t j = 0; j < point_candidates.size (); ++j)
+    {
+      k_indices[stride_offset + j] = point_candidates[j].point_idx_;
+      k_sqr_distances[stride_offset + j] = point_candidates[j].point_distance_;
+    }
+    offsets[query + 1] = point_candidates.size ();
+  }
+
+  // the neighbors are only ever moved towards the front, so copying in place is safe
+  size_t total = 0;
+  for (size_t i = 0; i < nr_queries; ++i)
+  {
+    const size_t found = offsets[i + 1];
+    const size_t stride_offset = i * k;
+    if (total != stride_offset)
+    {
+      std::copy (k_indices.begin () + stride_offset, k_indices.begin () + stride_offset + found,
+                 k_indices.begin () + total);
+      std::copy (k_sqr_distances.begin () + stride_offset, k_sqr_distances.begin () + stride_offset + found,
+                 k_sqr_distances.begin () + total);
+    }
+    total += found;
+    offsets[i + 1] = total;
+  }
+  k_indices.resize (total);
+  k_sqr_distances.resize (total);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template<typename PointT, typename LeafContainerT, typename BranchContainerT> void
+pcl::octree::OctreePointCloudSearch<PointT, LeafContainerT, BranchContainerT>::radiusSearch (
+    const PointCloud &cloud, const std::vector<int> &indices, double radius, std::vector<size_t> &offsets,
+    std::vector<int> &k_indices, std::vector<float> &k_sqr_distances, unsigned int max_nn,
+    unsigned int nr_threads) const
+{
+  const size_t nr_queries = indices.empty () ? cloud.points.size () : indices.size ();
+  const double radius_sqr = radius * radius;
+  const int packet_size = detail::OCTREE_QUERY_PACKET_SIZE;
+
+  offsets.assign (nr_queries + 1, 0);
+
+  std::vector<int> order;
+  sortQueries (cloud, indices, order);
+
+#ifdef _OPENMP
+  const int threads = nr_threads == 0 ? omp_get_num_procs () : static_cast<int> (nr_threads);
+#else
+  const int threads = 1;
+  (void) nr_threads;
+#endif
+  // a few chunks of consecutive packets per thread balance the load when the neighborhood sizes vary,
+  // each chunk gathering the neighbors of its queries in its own buffers
+  const int nr_queries_sorted = static_cast<int> (order.size ());
+  const int nr_packets = (nr_queries_sorted + packet_size - 1) / packet_size;
+  const int nr_chunks = std::min (nr_packets, threads * 8);
+  std::vector<std::vector<int> > chunk_indices (nr_chunks);
+  std::vector<std::vector<float> > chunk_sqr_distances (nr_chunks);
+  std::vector<size_t> chunk_begin (nr_queries, 0);
+
+#ifdef _OPENMP
+#pragma omp parallel for schedule (dynamic, 1) num_threads (threads)
+#endif
+  for (int c = 0; c < nr_chunks; ++c)
+  {
+    std::vector<const PointT*> queries (packet_size);
+    std::vector<std::vector<int> > packet_indices (packet_size);
+    std::vector<std::vector<float> > packet_sqr_distances (packet_size);
+    std::vector<std::vector<int>*> packet_indices_ptr (packet_size);
+    std::vector<std::vector<float>*> packet_sqr_distances_ptr (packet_size);
+    std::vector<int> active ((OctreeKey::maxDepth + 1) * packet_size);
+    for (int j = 0; j < packet_size; ++j)
+    {
+      packet_indices_ptr[j] = &packet_indices[j];
+      packet_sqr_distances_ptr[j] = &packet_sqr_distances[j];
+    }
+
+    const int packet_end = nr_packets * (c + 1) / nr_chunks;
+    for (int p = nr_packets * c / nr_chunks; p < packet_end; ++p)
+    {
+      const int first = p * packet_size;
+      const int size = std::min (packet_size, nr_queries_sorted - first);
+      for (int j = 0; j < size; ++j)
+      {
+        const int query = order[first + j];
+        queries[j] = &cloud.points[indices.empty () ? query : indices[query]];
+        packet_indices[j].clear ();
+        packet_sqr_distances[j].clear ();
+        active[j] = j;
+      }
+
+      OctreeKey key;
+      if (hasContiguousLeaves ())
+        getNeighborsWithinRadiusContiguous (&queries[0], radius_sqr, 0, key, 1, &active[0], size, packet_size,
+                                            &packet_indices_ptr[0], &packet_sqr_distances_ptr[0], max_nn);
+      else
+      {
+        for (int j = 0; j < size; ++j)
+          getNeighborsWithinRadiusRecursive (*queries[j], radius_sqr, this->root_node_, key, 1, packet_indices[j],
+                                             packet_sqr_distances[j], max_nn);
+      }
+
+      for (int j = 0; j < size; ++j)
+      {
+        const int query = order[first + j];
+        chunk_begin[query] = chunk_indices[c].size ();
+        // store the count for now, turned into offsets below
+        offsets[query + 1] = packet_indices[j].size ();
+        chunk_indices[c].insert (chunk_indices[c].end (), packet_indices[j].begin (), packet_indices[j].end ());
+        chunk_sqr_distances[c].insert (chunk_sqr_distances[c].end (), packet_sqr_distances[j].begin (),
+                                       packet_sqr_distances[j].end ());
+      }
+    }
+  }
+
+  for (size_t i = 0; i < nr_queries; ++i)
+    offsets[i + 1] += offsets[i];
+
+  k_indices.resize (offsets[nr_queries]);
+  k_sqr_distances.resize (offsets[nr_queries]);
+#ifdef _OPENMP
+#pragma omp parallel for schedule (dynamic, 1) num_threads (threads)
+#endif
+  for (int c = 0; c < nr_chunks; ++c)
+  {
+    const int end = std::min (nr_packets * (c + 1) / nr_chunks * packet_size, nr_queries_sorted);
+    for (int i = nr_packets * c / nr_chunks * packet_size; i < end; ++i)
+    {
+      const int query = order[i];
+      const size_t count = offsets[query + 1] - offsets[query];
+      std::copy (chunk_indices[c].begin () + chunk_begin[query], chunk_indices[c].begin () + chunk_begin[query] + count,
+                 k_indices.begin () + offsets[query]);
+      std::copy (chunk_sqr_distances[c].begin () + chunk_begin[query],
+                 chunk_sqr_distances[c].begin () + chunk_begin[query] + count,
+                 k_sqr_distances.begin () + offsets[query]);
+    }
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template<typename PointT, typename LeafContainerT, typename BranchContainerT> void
+pcl::octree::OctreePointCloudSearch<PointT, LeafContainerT, BranchContainerT>::buildContiguousLeaves ()
+{
+  clearContiguousLeaves ();
+
+  // the root is branch 0
+  branch_children_.assign (8, 0);
+  leaf_offsets_.push_back (0);
+  buildContiguousLeavesRecursive (this->root_node_, 0);
+
+  const int nr_points = static_cast<int> (leaf_point_indices_.size ());
+  leaf_x_.resize (nr_points);
+  leaf_y_.resize (nr_points);
+  leaf_z_.resize (nr_points);
+  for (int i = 0; i < nr_points; ++i)
+  {
+    const PointT& point = this->getPointByIndex (leaf_point_indices_[i]);
+    leaf_x_[i] = point.x;
+    leaf_y_[i] = point.y;
+    leaf_z_[i] = point.z;
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template<typename PointT, typename LeafContainerT, typename BranchContainerT> void
+pcl::octree::OctreePointCloudSearch<PointT, LeafContainerT, BranchContainerT>::clearContiguousLeaves ()
+{
+  // swap with empty vectors to release the memory
+  std::vector<int> ().swap (branch_children_);
+  std::vector<int> ().swap (leaf_offsets_);
+  std::vector<float> ().swap (leaf_x_);
+  std::vector<float> ().swap (leaf_y_);
+  std::vector<float> ().swap (leaf_z_);
+  std::vector<int> ().swap (leaf_point_indices_);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template<typename PointT, typename LeafContainerT, typename BranchContainerT> void
+pcl::octree::OctreePointCloudSearch<PointT, LeafContainerT, BranchContainerT>::buildContiguousLeavesRecursive (
+    const BranchNode* node, int branch)
+{
+  for (unsigned char child_idx = 0; child_idx < 8; child_idx++)
+  {
+    if (!this->branchHasChild (*node, child_idx))
+      continue;
+
+    const OctreeNode* child_node = this->getBranchChildPtr (*node, child_idx);
+
+    if (child_node->getNodeType () == BRANCH_NODE)
+    {
+      const int child_branch = static_cast<int> (branch_children_.size () / 8);
+      branch_children_[branch * 8 + child_idx] = child_branch;
+      branch_children_.resize (branch_children_.size () + 8, 0);
+      buildContiguousLeavesRecursive (static_cast<const BranchNode*> (child_node), child_branch);
+    }
+    else
+    {
+      const int leaf = static_cast<int> (leaf_offsets_.size ()) - 1;
+      branch_children_[branch * 8 + child_idx] = -1 - leaf;
+      (*static_cast<const LeafNode*> (child_node))->getPointIndices (leaf_point_indices_);
+      leaf_offsets_.push_back (static_cast<int> (leaf_point_indices_.size ()));
+    }
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template<typename PointT, typename LeafContainerT, typename BranchContainerT> void
+pcl::octree::OctreePointCloudSearch<PointT, LeafContainerT, BranchContainerT>::computeLeafSquaredDistances (
+    const PointT& point, int begin, int count, float* sqr_distances) const
+{
+  const float* x = &leaf_x_[begin];
+  const float* y = &leaf_y_[begin];
+  const float* z = &leaf_z_[begin];
+
+  // no dependencies between the iterations, so that the compiler vectorizes this loop
+  for (int i = 0; i < count; ++i)
+  {
+    const float dx = x[i] - point.x;
+    const float dy = y[i] - point.y;
+    const float dz = z[i] - point.z;
+    sqr_distances[i] = dx * dx + dy * dy + dz * dz;
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template<typename PointT, typename LeafContainerT, typename BranchContainerT> void
+pcl::octree::OctreePointCloudSearch<PointT, LeafContainerT, BranchContainerT>::getNeighborsWithinRadiusContiguous (
+    const PointT* const* queries, const double radiusSquared, int branch, const OctreeKey& key,
+    unsigned int tree_depth, int* active, int nr_active, int packet_size, std::vector<int>* const* k_indices,
+    std::vector<float>* const* k_sqr_distances, unsigned int max_nn) const
+{
+  float sqr_distances[detail::OCTREE_LEAF_SCAN_BLOCK_SIZE];
+  int* child_active = active + packet_size;
+
+  // get spatial voxel information
+  const double voxel_squared_diameter = this->getVoxelSquaredDiameter (tree_depth);
+  const double max_squared_dist = voxel_squared_diameter / 4.0 + radiusSquared + sqrt (voxel_squared_diameter * radiusSquared);
+
+  // iterate over all children
+  for (unsigned char child_idx = 0; child_idx < 8; child_idx++)
+  {
+    const int child = branch_children_[branch * 8 + child_idx];
+    if (child == 0)
+      continue;
+
+    OctreeKey new_key;
+    PointT voxel_center;
+
+    // generate new key for current branch voxel
+    new_key.x = (key.x << 1) + (!!(child_idx & (1 << 2)));
+    new_key.y = (key.y << 1) + (!!(child_idx & (1 << 1)));
+    new_key.z = (key.z << 1) + (!!(child_idx & (1 << 0)));
+
+    // generate voxel center point for voxel at key
+    this->genVoxelCenterFromOctreeKey (new_key, tree_depth, voxel_center);
+
+    // keep the queries which are not complete yet and whose sphere may intersect the voxel
+    int nr_child_active = 0;
+    for (int i = 0; i < nr_active; ++i)
+    {
+      const int query = active[i];
+      if (max_nn != 0 && k_indices[query]->size () == static_cast<unsigned int> (max_nn))
+        continue;
+      if (pointSquaredDist (voxel_center, *queries[query]) + this->epsilon_ <= max_squared_dist)
+        child_active[nr_child_active++] = query;
+    }
+    if (nr_child_active == 0)
+      continue;
+
+    if (child > 0)
+    {
+      getNeighborsWithinRadiusContiguous (queries, radiusSquared, child, new_key, tree_depth + 1, child_active,
+                                          nr_child_active, packet_size, k_indices, k_sqr_distances, max_nn);
+      continue;
+    }
+
+    // we reached leaf node level
+    const int leaf = -1 - child;
+    const int leaf_end = leaf_offsets_[leaf + 1];
+    for (int i = 0; i < nr_child_active; ++i)
+    {
+      const int query = child_active[i];
+      std::vector<int>& query_indices = *k_indices[query];
+      std::vector<float>& query_sqr_distances = *k_sqr_distances[query];
+
+      bool complete = false;
+      for (int begin = leaf_offsets_[leaf]; begin < leaf_end && !complete; begin += detail::OCTREE_LEAF_SCAN_BLOCK_SIZE)
+      {
+        const int count = std::min (detail::OCTREE_LEAF_SCAN_BLOCK_SIZE, leaf_end - begin);
+        computeLeafSquaredDistances (*queries[query], begin, count, sqr_distances);
+
+        for (int j = 0; j < count; ++j)
+        {
+          // check if a match is found
+          if (sqr_distances[j] > radiusSquared)
+            continue;
+
+          // add point to result vector
+          query_indices.push_back (leaf_point_indices_[begin + j]);
+          query_sqr_distances.push_back (sqr_distances[j]);
+
+          if (max_nn != 0 && query_indices.size () == static_cast<unsigned int> (max_nn))
+          {
+            complete = true;
+            break;
+          }
+        }
+      }
+    }
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template<typename PointT, typename LeafContainerT, typename BranchContainerT> double
+pcl::octree::OctreePointCloudSearch<PointT, LeafContainerT, BranchContainerT>::getKNearestNeighborContiguous (
+    const PointT& point, unsigned int K, int branch, const OctreeKey& key, unsigned int tree_depth,
+    const double squared_search_radius, std::vector<prioPointQueueEntry>& point_candidates) const
+{
+  float sqr_distances[detail::OCTREE_LEAF_SCAN_BLOCK_SIZE];
+
+  // children sorted by the distance of their center to the query point. Storing 7 - child_idx visits the
+  // children at the same distance in the order of getKNearestNeighborRecursive.
+  std::pair<float, int> search_heap[8];
+  int nr_children = 0;
+
+  double smallest_squared_dist = squared_search_radius;
+
+  // get spatial voxel information
+  double voxelSquaredDiameter = this->getVoxelSquaredDiameter (tree_depth);
+
+  // iterate over all children
+  for (unsigned char child_idx = 0; child_idx < 8; child_idx++)
+  {
+    if (branch_children_[branch * 8 + child_idx] == 0)
+      continue;
+
+    OctreeKey new_key;
+    PointT voxel_center;
+
+    new_key.x = (key.x << 1) + (!!(child_idx & (1 << 2)));
+    new_key.y = (key.y << 1) + (!!(child_idx & (1 << 1)));
+    new_key.z = (key.z << 1) + (!!(child_idx & (1 << 0)));
+
+    // generate voxel center point for voxel at key
+    this->genVoxelCenterFromOctreeKey (new_key, tree_depth, voxel_center);
+
+    search_heap[nr_children++] = std::make_pair (pointSquaredDist (voxel_center, point), 7 - child_idx);
+  }
+
+  // insertion sort, there are 8 children at most
+  for (int i = 1; i < nr_children; ++i)
+    for (int j = i; j > 0 && search_heap[j] < search_heap[j - 1]; --j)
+      std::swap (search_heap[j], search_heap[j - 1]);
+
+  // iterate over all children in priority order
+  // check if the distance to search candidate is smaller than the best point distance (smallest_squared_dist)
+  for (int c = 0; c < nr_children && search_heap[c].first <
+       smallest_squared_dist + voxelSquaredDiameter / 4.0 + sqrt (smallest_squared_dist * voxelSquaredDiameter) - this->epsilon_; ++c)
+  {
+    const unsigned char child_idx = static_cast<unsigned char> (7 - search_heap[c].second);
+    const int child = branch_children_[branch * 8 + child_idx];
+
+    if (child > 0)
+    {
+      OctreeKey new_key;
+      new_key.x = (key.x << 1) + (!!(child_idx & (1 << 2)));
+      new_key.y = (key.y << 1) + (!!(child_idx & (1 << 1)));
+      new_key.z = (key.z << 1) + (!!(child_idx & (1 << 0)));
+
+      // we have not reached maximum tree depth
+      smallest_squared_dist = getKNearestNeighborContiguous (point, K, child, new_key, tree_depth + 1,
+                                                             smallest_squared_dist, point_candidates);
+      continue;
+    }
+
+    // we reached leaf node level
+    const int leaf = -1 - child;
+    const int leaf_end = leaf_offsets_[leaf + 1];
+    for (int begin = leaf_offsets_[leaf]; begin < leaf_end; begin += detail::OCTREE_LEAF_SCAN_BLOCK_SIZE)
+    {
+      const int count = std::min (detail::OCTREE_LEAF_SCAN_BLOCK_SIZE, leaf_end - begin);
+      computeLeafSquaredDistances (point, begin, count, sqr_distances);
+
+      for (int j = 0; j < count; ++j)
+      {
+        // check if a closer match is found
+        if (sqr_distances[j] < smallest_squared_dist)
+        {
+          prioPointQueueEntry point_entry;
+
+          point_entry.point_distance_ = sqr_distances[j];
+          point_entry.point_idx_ = leaf_point_indices_[begin + j];
+          point_candidates.push_back (point_entry);
+        }
+      }
+    }
+
+    std::sort (point_candidates.begin (), point_candidates.end ());
+
+    if (point_candidates.size () > K)
+      point_candidates.resize (K);
+
+    if (point_candidates.size () == K)
+      smallest_squared_dist = point_candidates.back ().point_distance_;
+  }
+
+  return (smallest_squared_dist);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template<typename PointT, typename LeafContainerT, typename BranchContainerT> void
+pcl::octree::OctreePointCloudSearch<PointT, LeafContainerT, BranchContainerT>::sortQueries (
+    const PointCloud &cloud, const std::vector<int> &indices, std::vector<int> &order) const
+{
+  const size_t nr_queries = indices.empty () ? cloud.points.size () : indices.size ();
+  // Morton codes hold 21 bits per key index, coarser keys only lose some locality
+  const unsigned int shift = this->octree_depth_ > 21 ? this->octree_depth_ - 21 : 0;
+
+  std::vector<std::pair<uint64_t, int> > codes;
+  codes.reserve (nr_queries);
+  for (size_t i = 0; i < nr_queries; ++i)
+  {
+    const PointT& point = cloud.points[indices.empty () ? i : indices[i]];
+    if (!isFinite (point))
+      continue;
+
+    // queries outside of the bounding box are clamped onto it, the keys only order the queries
+    const double key_x = std::min (std::max ((point.x - this->min_x_) / this->resolution_, 0.0), static_cast<double> (this->max_key_.x));
+    const double key_y = std::min (std::max ((point.y - this->min_y_) / this->resolution_, 0.0), static_cast<double> (this->max_key_.y));
+    const double key_z = std::min (std::max ((point.z - this->min_z_) / this->resolution_, 0.0), static_cast<double> (this->max_key_.z));
+    const OctreeKey key (static_cast<unsigned int> (key_x) >> shift, static_cast<unsigned int> (key_y) >> shift,
+                         static_cast<unsigned int> (key_z) >> shift);
+    codes.push_back (std::make_pair (key.getMortonCode (), static_cast<int> (i)));
+  }
+
+  std::sort (codes.begin (), codes.end ());
+
+  order.resize (codes.size ());
+  for (size_t i = 0; i < codes.size (); ++i)
+    order[i] = codes[i].second;
+}
+
 #define PCL_INSTANTIATE_OctreePointCloudSearch(T) template class PCL_EXPORTS pcl::octree::OctreePointCloudSearch<T>;
 
 #endif    // PCL_OCTREE_SEARCH_IMPL_H_
@@ -377,7 +377,7 @@ namespace pcl
 
         /** \brief Delete the octree structure and its leaf nodes.
          * */
-        void
+        virtual void
         deleteTree ();
 
         /** \brief Delete octree structure of previous buffer. */
@@ -501,7 +501,7 @@ namespace pcl
         /** \brief Remove leaf node from octree
          *  \param key_arg: octree key addressing a leaf node.
          * */
-        inline void removeLeaf (const OctreeKey& key_arg)
+        virtual void removeLeaf (const OctreeKey& key_arg)
         {
           if (key_arg <= max_key_)
           {
@@ -287,7 +287,7 @@ namespace pcl
 
         /** \brief Delete the octree structure and its leaf nodes.
          * */
-        void
+        virtual void
         deleteTree ( );
 
         /** \brief Serialize octree into a binary output vector describing its branch node structure.
@@ -371,7 +371,7 @@ namespace pcl
         /** \brief Remove leaf node from octree
          *  \param key_arg: octree key addressing a leaf node.
          * */
-        void
+        virtual void
         removeLeaf (const OctreeKey& key_arg)
         {
           if (key_arg <= max_key_)
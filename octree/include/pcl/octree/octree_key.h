@@ -139,6 +139,17 @@ namespace pcl
                                          |  (!!(this->z & depthMask)));
       }
 
+      /** \brief Interleave the key indices into a Morton code, with the x bit highest in each bit triplet.
+       *  Sorting the codes of keys at the same depth orders them like a depth first traversal of the octree.
+       *  \note Only the lowest 21 bits of each index are used.
+       *  \return Morton code of the key
+       * */
+      inline uint64_t
+      getMortonCode () const
+      {
+        return ((spreadBits (this->x) << 2) | (spreadBits (this->y) << 1) | spreadBits (this->z));
+      }
+
       /* \brief maximum depth that can be addressed */
       static const unsigned char maxDepth = static_cast<const unsigned char>(sizeof(uint32_t)*8);
 
@@ -155,6 +166,20 @@ namespace pcl
         uint32_t key_[3];
       };
 
+    protected:
+
+      /** \brief Insert two zero bits between each of the lowest 21 bits of a key index. */
+      static inline uint64_t
+      spreadBits (uint32_t index)
+      {
+        uint64_t bits = index & 0x1fffff;
+        bits = (bits | (bits << 32)) & 0x1f00000000ffffULL;
+        bits = (bits | (bits << 16)) & 0x1f0000ff0000ffULL;
+        bits = (bits | (bits << 8)) & 0x100f00f00f00f00fULL;
+        bits = (bits | (bits << 4)) & 0x10c30c30c30c30c3ULL;
+        bits = (bits | (bits << 2)) & 0x1249249249249249ULL;
+        return (bits);
+      }
 
     };
   }
@@ -177,7 +177,12 @@ namespace pcl
           return this->octree_depth_;
         }
 
-        /** \brief Add points from input point cloud to octree. */
+        /** \brief Add points from input point cloud to octree.
+         * \note Unless a single thread is set (see \a setNumberOfThreads), the octree keys of all points are computed in
+         * parallel and sorted in Morton order, so that every leaf is created once and then filled with its points.
+         * The resulting octree is identical to the one built by adding the points one by one. Octrees with dynamic
+         * depth always add the points one by one.
+         */
         void
         addPointsFromInputCloud ();
 
@@ -212,7 +217,7 @@ namespace pcl
 
         /** \brief Delete the octree structure and its leaf nodes.
          * */
-        void deleteTree ()
+        virtual void deleteTree ()
         {
           // reset bounding box
           min_x_ = min_y_ = max_y_ = min_z_ = max_z_ = 0;
@@ -379,6 +384,15 @@ namespace pcl
           this->dynamic_depth_enabled_ = static_cast<bool> (max_objs_per_leaf_>0);
         }
 
+        /** \brief Set the number of threads used to add the points of the input cloud to the octree, and by the batch
+         * searches of OctreePointCloudSearch.
+         * \param[in] nr_threads the number of hardware threads to use (0 sets the value back to automatic)
+         */
+        inline void
+        setNumberOfThreads (unsigned int nr_threads = 0)
+        {
+          threads_ = nr_threads;
+        }
 
       protected:
 
@@ -388,6 +402,34 @@ namespace pcl
         virtual void
         addPointIdx (const int point_idx_arg);
 
+        /** \brief Add point at index from input pointcloud dataset to the container of the leaf node it falls into.
+         * \note This is the last step of \a addPointIdx and of the bulk insertion in \a addPointsFromInputCloud.
+         * \param[in] leaf_arg container of the leaf node
+         * \param[in] point_idx_arg the index representing the point in the dataset given by \a setInputCloud to be added
+         */
+        virtual void
+        addPointToLeaf (LeafContainerT& leaf_arg, const int point_idx_arg)
+        {
+          leaf_arg.addPointIndex (point_idx_arg);
+        }
+
+        /** \brief Check if \a addPointsFromInputCloud may add the points in bulk instead of calling \a addPointIdx for
+         * each of them.
+         * \return "true" if the octree does not have a dynamic depth
+         */
+        virtual bool
+        isBulkInsertionSupported () const
+        {
+          return (!this->dynamic_depth_enabled_);
+        }
+
+        /** \brief Add the points from the input point cloud by sorting their octree keys in Morton order.
+         * \note The bounding box grows exactly like with point by point insertion and every point gets the key it
+         * would have been given at its turn, so that leaf nodes and their contents are the same.
+         */
+        void
+        addPointsFromInputCloudInBulk ();
+
         /** \brief Add point at index from input pointcloud dataset to octree
          * \param[in] leaf_node to be expanded
          * \param[in] parent_branch parent of leaf node to be expanded
@@ -542,6 +584,9 @@ namespace pcl
          *  \note zero indicates a fixed/maximum depth octree structure
          * **/
         std::size_t max_objs_per_leaf_;
+
+        /** \brief The number of threads used to add the points of the input cloud. */
+        unsigned int threads_;
     };
 
   }
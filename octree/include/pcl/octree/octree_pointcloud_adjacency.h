@@ -179,6 +179,15 @@ namespace pcl
          virtual void
          addPointIdx (const int point_idx_arg);
 
+        /** \brief The points are always added one by one through addPointIdx(), which generates their keys.
+          *
+          * \return "false" */
+        virtual bool
+        isBulkInsertionSupported () const
+        {
+          return (false);
+        }
+
         /** \brief Fills in the neighbors fields for new voxels.
           *
           * \param[in] key_arg Key of the voxel to check neighbors for
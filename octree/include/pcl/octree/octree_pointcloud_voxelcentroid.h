@@ -187,6 +187,7 @@ namespace pcl
 
         }
 
+
         /** \brief Get centroid for a single voxel addressed by a PointT point.
           * \param[in] point_arg point addressing a voxel in octree
           * \param[out] voxel_centroid_arg centroid is written to this PointT reference
@@ -224,6 +225,16 @@ namespace pcl
                                     OctreeKey& key_arg, 
                                     typename OctreePointCloud<PointT, LeafContainerT, BranchContainerT>::AlignedPointTVector &voxel_centroid_list_arg) const;
 
+      protected:
+        /** \brief Add point at index from input pointcloud dataset to the centroid of its leaf node.
+          * \param[in] leaf_arg container of the leaf node
+          * \param[in] point_idx_arg the index representing the point in the dataset given by \a setInputCloud
+          */
+        virtual void
+        addPointToLeaf (LeafContainerT& leaf_arg, const int point_idx_arg)
+        {
+          leaf_arg.addPoint (this->input_->points[point_idx_arg]);
+        }
     };
   }
 }
@@ -80,7 +80,8 @@ namespace pcl
           * \param[in] resolution octree resolution at lowest octree level
           */
         OctreePointCloudSearch (const double resolution) :
-          OctreePointCloud<PointT, LeafContainerT, BranchContainerT> (resolution)
+          OctreePointCloud<PointT, LeafContainerT, BranchContainerT> (resolution),
+          branch_children_ (), leaf_offsets_ (), leaf_x_ (), leaf_y_ (), leaf_z_ (), leaf_point_indices_ ()
         {
         }
 
@@ -250,7 +251,137 @@ namespace pcl
         int
         boxSearch (const Eigen::Vector3f &min_pt, const Eigen::Vector3f &max_pt, std::vector<int> &k_indices) const;
 
+        /** \brief Search for the k-nearest neighbors of a batch of query points.
+          * The queries are run in Morton order of their voxels, so that consecutive queries touch the same
+          * parts of the tree, and in parallel (see \ref setNumberOfThreads). The results are the same as the ones
+          * of the single point nearestKSearch.
+          * \param[in] cloud the point cloud holding the query points
+          * \param[in] indices the indices of the query points in \a cloud. If empty, all the points are queried.
+          * \param[in] k the number of neighbors to search for
+          * \param[out] offsets the neighbors of the i-th query are stored at [offsets[i], offsets[i + 1]) of
+          * \a k_indices and \a k_sqr_distances
+          * \param[out] k_indices the resultant indices of the neighboring points of all the queries
+          * \param[out] k_sqr_distances the resultant squared distances to the neighboring points of all the queries
+          * \note Non-finite query points get no neighbors.
+          */
+        void
+        nearestKSearch (const PointCloud &cloud, const std::vector<int> &indices, int k,
+                        std::vector<size_t> &offsets, std::vector<int> &k_indices,
+                        std::vector<float> &k_sqr_distances) const
+        {
+          nearestKSearch (cloud, indices, k, offsets, k_indices, k_sqr_distances, this->threads_);
+        }
+
+        /** \brief Search for the k-nearest neighbors of a batch of query points with a given number of threads,
+          * instead of the one set through \ref setNumberOfThreads.
+          * \param[in] cloud the point cloud holding the query points
+          * \param[in] indices the indices of the query points in \a cloud. If empty, all the points are queried.
+          * \param[in] k the number of neighbors to search for
+          * \param[out] offsets the neighbors of the i-th query are stored at [offsets[i], offsets[i + 1]) of
+          * \a k_indices and \a k_sqr_distances
+          * \param[out] k_indices the resultant indices of the neighboring points of all the queries
+          * \param[out] k_sqr_distances the resultant squared distances to the neighboring points of all the queries
+          * \param[in] nr_threads the number of hardware threads to use (0 for automatic)
+          */
+        void
+        nearestKSearch (const PointCloud &cloud, const std::vector<int> &indices, int k,
+                        std::vector<size_t> &offsets, std::vector<int> &k_indices,
+                        std::vector<float> &k_sqr_distances, unsigned int nr_threads) const;
+
+        /** \brief Search for all the neighbors of a batch of query points within a given radius.
+          * The queries are sorted in Morton order of their voxels and split into packets of neighboring
+          * queries. With contiguous leaves (see \ref buildContiguousLeaves), each packet traverses the tree once,
+          * carrying the queries whose sphere may intersect the current voxel. Packets run in parallel (see
+          * \ref setNumberOfThreads). The results are the same as the ones of the single point radiusSearch.
+          * \param[in] cloud the point cloud holding the query points
+          * \param[in] indices the indices of the query points in \a cloud. If empty, all the points are queried.
+          * \param[in] radius the radius of the sphere bounding all of the neighbors
+          * \param[out] offsets the neighbors of the i-th query are stored at [offsets[i], offsets[i + 1]) of
+          * \a k_indices and \a k_sqr_distances
+          * \param[out] k_indices the resultant indices of the neighboring points of all the queries
+          * \param[out] k_sqr_distances the resultant squared distances to the neighboring points of all the queries
+          * \param[in] max_nn if given, bounds the maximum returned neighbors per query to this value
+          * \note Non-finite query points get no neighbors.
+          */
+        void
+        radiusSearch (const PointCloud &cloud, const std::vector<int> &indices, double radius,
+                      std::vector<size_t> &offsets, std::vector<int> &k_indices,
+                      std::vector<float> &k_sqr_distances, unsigned int max_nn = 0) const
+        {
+          radiusSearch (cloud, indices, radius, offsets, k_indices, k_sqr_distances, max_nn, this->threads_);
+        }
+
+        /** \brief Search for all the neighbors of a batch of query points within a given radius, with a given
+          * number of threads instead of the one set through \ref setNumberOfThreads.
+          * \param[in] cloud the point cloud holding the query points
+          * \param[in] indices the indices of the query points in \a cloud. If empty, all the points are queried.
+          * \param[in] radius the radius of the sphere bounding all of the neighbors
+          * \param[out] offsets the neighbors of the i-th query are stored at [offsets[i], offsets[i + 1]) of
+          * \a k_indices and \a k_sqr_distances
+          * \param[out] k_indices the resultant indices of the neighboring points of all the queries
+          * \param[out] k_sqr_distances the resultant squared distances to the neighboring points of all the queries
+          * \param[in] max_nn bounds the maximum returned neighbors per query to this value, if not 0
+          * \param[in] nr_threads the number of hardware threads to use (0 for automatic)
+          */
+        void
+        radiusSearch (const PointCloud &cloud, const std::vector<int> &indices, double radius,
+                      std::vector<size_t> &offsets, std::vector<int> &k_indices,
+                      std::vector<float> &k_sqr_distances, unsigned int max_nn, unsigned int nr_threads) const;
+
+        /** \brief Copy the structure of the octree into flat arrays, storing the points of each leaf
+          * contiguously as separate x, y and z arrays. radiusSearch and nearestKSearch then scan the leaves with
+          * vectorizable loops instead of going through the point indices into the input cloud.
+          * \note The copy is dropped when points are added to the octree, voxels are deleted or the tree is deleted.
+          * It has to be built again after that.
+          */
+        void
+        buildContiguousLeaves ();
+
+        /** \brief Release the contiguous copy of the leaves built by \ref buildContiguousLeaves. */
+        void
+        clearContiguousLeaves ();
+
+        /** \brief Check whether the searches use contiguous leaves (see \ref buildContiguousLeaves). */
+        inline bool
+        hasContiguousLeaves () const
+        {
+          return (!leaf_offsets_.empty ());
+        }
+
+        /** \brief Delete the octree structure, its leaf nodes and their contiguous copy. */
+        virtual void
+        deleteTree ()
+        {
+          clearContiguousLeaves ();
+          OctreeT::deleteTree ();
+        }
+
+        using OctreeT::removeLeaf;
+
       protected:
+        /** \brief Remove leaf node from octree, dropping the contiguous leaves.
+          * \param[in] key_arg octree key addressing a leaf node
+          */
+        virtual void
+        removeLeaf (const OctreeKey& key_arg)
+        {
+          if (!leaf_offsets_.empty ())
+            clearContiguousLeaves ();
+          OctreeT::removeLeaf (key_arg);
+        }
+
+        /** \brief Add point at index from input pointcloud dataset to a leaf node, dropping the contiguous leaves.
+          * \param[in] leaf_arg container of the leaf node
+          * \param[in] point_idx_arg the index representing the point in the dataset given by \a setInputCloud
+          */
+        virtual void
+        addPointToLeaf (LeafContainerT& leaf_arg, const int point_idx_arg)
+        {
+          if (!leaf_offsets_.empty ())
+            clearContiguousLeaves ();
+          OctreeT::addPointToLeaf (leaf_arg, point_idx_arg);
+        }
+
         //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
         // Octree-based search routines & helpers
         //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -450,6 +581,73 @@ namespace pcl
                                              std::vector<int> &k_indices,
                                              int max_voxel_count) const;
 
+        //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+        // Search routines on contiguous leaves
+        //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+        /** \brief Recursively copy the children of a branch into \ref branch_children_, gathering the point indices
+          * of the leaves in depth first order.
+          * \param[in] node the branch node to copy
+          * \param[in] branch the index of the branch in \ref branch_children_
+          */
+        void
+        buildContiguousLeavesRecursive (const BranchNode* node, int branch);
+
+        /** \brief Compute the squared distances from a query point to a run of points of the contiguous leaves.
+          * \param[in] point query point
+          * \param[in] begin position of the first point in the contiguous leaf arrays
+          * \param[in] count number of points to process
+          * \param[out] sqr_distances the resultant squared distances
+          */
+        void
+        computeLeafSquaredDistances (const PointT& point, int begin, int count, float* sqr_distances) const;
+
+        /** \brief Recursive search method that explores the contiguous leaves and finds the neighbors within a
+          * given radius of a packet of query points. The voxels are visited in the order of
+          * getNeighborsWithinRadiusRecursive, each one carrying the queries whose sphere may intersect it.
+          * \param[in] queries the query points of the packet
+          * \param[in] radiusSquared squared search radius
+          * \param[in] branch index of the current branch in \ref branch_children_
+          * \param[in] key octree key addressing the current branch
+          * \param[in] tree_depth depth/level of the children of the current branch
+          * \param[in,out] active the positions in the packet of the queries reaching the current branch, followed
+          * by the storage for the ones of the deeper levels, \a packet_size entries per level
+          * \param[in] nr_active the number of queries reaching the current branch
+          * \param[in] packet_size the number of queries in the packet
+          * \param[out] k_indices vectors of indices found to be neighbors of each query point
+          * \param[out] k_sqr_distances vectors of squared distances of the neighbors to each query point
+          * \param[in] max_nn maximum of neighbors to be found per query point
+          */
+        void
+        getNeighborsWithinRadiusContiguous (const PointT* const* queries, const double radiusSquared, int branch,
+                                            const OctreeKey& key, unsigned int tree_depth, int* active,
+                                            int nr_active, int packet_size, std::vector<int>* const* k_indices,
+                                            std::vector<float>* const* k_sqr_distances, unsigned int max_nn) const;
+
+        /** \brief Recursive search method that explores the contiguous leaves and finds the K nearest neighbors,
+          * visiting the voxels in the order of getKNearestNeighborRecursive.
+          * \param[in] point query point
+          * \param[in] K amount of nearest neighbors to be found
+          * \param[in] branch index of the current branch in \ref branch_children_
+          * \param[in] key octree key addressing the current branch
+          * \param[in] tree_depth depth/level of the children of the current branch
+          * \param[in] squared_search_radius squared search radius distance
+          * \param[out] point_candidates priority queue of nearest neigbor point candidates
+          * \return squared search radius based on current point candidate set found
+          */
+        double
+        getKNearestNeighborContiguous (const PointT& point, unsigned int K, int branch, const OctreeKey& key,
+                                       unsigned int tree_depth, const double squared_search_radius,
+                                       std::vector<prioPointQueueEntry>& point_candidates) const;
+
+        /** \brief Sort the finite points of a batch of queries in Morton order of their voxels.
+          * \param[in] cloud the point cloud holding the query points
+          * \param[in] indices the indices of the query points in \a cloud, or empty for all the points
+          * \param[out] order the positions of the finite query points in the batch, in Morton order
+          */
+        void
+        sortQueries (const PointCloud &cloud, const std::vector<int> &indices, std::vector<int> &order) const;
+
         /** \brief Initialize raytracing algorithm
           * \param origin
           * \param direction
@@ -595,6 +793,26 @@ namespace pcl
           return 0;
         }
 
+        /** \brief Children of the branches copied by buildContiguousLeaves, eight per branch in child order:
+          * 0 for no child, the branch index for a branch child (the root is branch 0) and -1 - the leaf index
+          * for a leaf child.
+          */
+        std::vector<int> branch_children_;
+
+        /** \brief Start of the points of each contiguous leaf, followed by the total number of points. */
+        std::vector<int> leaf_offsets_;
+
+        /** \brief X coordinates of the points of the contiguous leaves. */
+        std::vector<float> leaf_x_;
+
+        /** \brief Y coordinates of the points of the contiguous leaves. */
+        std::vector<float> leaf_y_;
+
+        /** \brief Z coordinates of the points of the contiguous leaves. */
+        std::vector<float> leaf_z_;
+
+        /** \brief Indices of the points of the contiguous leaves in the dataset given by \a setInputCloud. */
+        std::vector<int> leaf_point_indices_;
       };
   }
 }
@@ -4,6 +4,7 @@
 
 #include <cassert>
 #include <list>
+#include <map>
 
 template<typename T>
 class LRUCacheItem
@@ -90,6 +91,12 @@ public:
 
     while (size + item_size >= capacity_)
     {
+      // The item does not fit, even in an empty cache
+      if (key_it == key_index_.end ())
+      {
+        return false;
+      }
+
       const CacheIterator cache_it = cache_.find (*key_it);
 
       // Get tail item (Least Recently Used)
@@ -140,6 +147,20 @@ public:
     return value.sizeOf ();
   }
 
+  // Remove an item from the cache, whatever its position in the LRU order
+  bool
+  erase (const KeyT& key)
+  {
+    const CacheIterator it = cache_.find (key);
+    if (it == cache_.end ())
+      return false;
+
+    size_ -= it->second.first.sizeOf ();
+    key_index_.erase (it->second.second);
+    cache_.erase (it);
+    return true;
+  }
+
   // Evict the least-recently-used item from the cache
   bool
   evict (int item_count=1)
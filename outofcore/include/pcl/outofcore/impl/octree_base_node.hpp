@@ -1184,6 +1184,8 @@ namespace pcl
       //if (payload_->getDataSize () > 0)
       {
         file_names.push_back (this->node_metadata_->getMetadataFilename ().string ());
+        //the caller is about to read the returned nodes, start loading them
+        payload_->prefetch ();
       }
 
       if (hasUnloadedChildren ())
@@ -1304,6 +1306,7 @@ namespace pcl
       //if (payload_->getDataSize () > 0)
       {
         file_names.push_back (this->node_metadata_->getMetadataFilename ().string ());
+        payload_->prefetch ();
       }
 
       //if (coverage <= 0.075)
@@ -1408,6 +1411,9 @@ namespace pcl
           //if this node has children
           if (num_children_ > 0)
           {
+            //start loading the payloads of the children while the first ones are processed
+            prefetchChildren (min_bb, max_bb, query_depth);
+
             //recursively store any points that fall into the queried bounding box into v and return
             for (size_t i = 0; i < 8; i++)
             {
@@ -1513,6 +1519,22 @@ namespace pcl
       PCL_DEBUG ("[pcl::outofcore::OutofcoreOctreeBaseNode::%s] Points added by function call: %ul\n", __FUNCTION__, dst_blob->width*dst_blob->height - startingSize );
     }
 
+    template<typename ContainerT, typename PointT> void
+    OutofcoreOctreeBaseNode<ContainerT, PointT>::prefetchChildren (const Eigen::Vector3d& min_bb, const Eigen::Vector3d& max_bb, const boost::uint64_t query_depth)
+    {
+      //only the nodes at the query depth read their payload
+      if (this->depth_ + 1 != query_depth)
+        return;
+
+      for (size_t i = 0; i < 8; i++)
+      {
+        if (children_[i] && children_[i]->intersectsWithBoundingBox (min_bb, max_bb))
+          children_[i]->payload_->prefetch ();
+      }
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////
+
     template<typename ContainerT, typename PointT> void
     OutofcoreOctreeBaseNode<ContainerT, PointT>::queryBBIncludes (const Eigen::Vector3d& min_bb, const Eigen::Vector3d& max_bb, size_t query_depth, AlignedPointTVector& v)
     {
@@ -1535,6 +1557,9 @@ namespace pcl
             if(hasUnloadedChildren ())
               loadChildren (false);
 
+            //start loading the payloads of the children while the first ones are processed
+            prefetchChildren (min_bb, max_bb, query_depth);
+
             //recursively store any points that fall into the queried bounding box into v and return
             for (size_t i = 0; i < 8; i++)
             {
@@ -1599,6 +1624,8 @@ namespace pcl
 
             if (this->getNumChildren () > 0)
             {
+              prefetchChildren (min_bb, max_bb, query_depth);
+
               for (size_t i=0; i<8; i++)
               {
                 //recursively traverse (depth first)
@@ -1672,6 +1699,8 @@ namespace pcl
           //if we do have children
           if (num_children_ > 0)
           {
+            prefetchChildren (min_bb, max_bb, query_depth);
+
             //recursively add their valid points within the queried bounding box to the list v
             for (size_t i = 0; i < 8; i++)
             {
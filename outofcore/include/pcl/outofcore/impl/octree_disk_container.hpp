@@ -55,6 +55,7 @@
 
 // PCL (Urban Robotics)
 #include <pcl/outofcore/octree_disk_container.h>
+#include <pcl/outofcore/outofcore_node_cache.h>
 
 //allows operation on POSIX
 #if !defined WIN32
@@ -186,6 +187,7 @@ namespace pcl
         int res = writer.writeBinaryCompressed (*disk_storage_filename_, *cloud);
         (void)res;
         assert (res == 0);
+        OutofcoreNodeCache::getInstance ().invalidate (*disk_storage_filename_);
         if (force_cache_dealloc)
         {
           writebuff_.resize (0);
@@ -249,16 +251,37 @@ namespace pcl
         PCL_THROW_EXCEPTION (PCLException, "[pcl::outofcore::OutofcoreOctreeDiskContainer] Outofcore Octree Exception: Read indices exceed range");
       }
 
-      pcl::PCDReader reader;
-      typename pcl::PointCloud<PointT>::Ptr cloud (new pcl::PointCloud<PointT> ());
-      
-      int res = reader.read (*disk_storage_filename_, *cloud);
+      pcl::PointCloud<PointT> cloud;
+      bool res = readPayload (cloud);
       (void)res;
-      assert (res == 0);
-      
-      for (size_t i=0; i < cloud->points.size (); i++)
-        dst.push_back (cloud->points[i]);
+      assert (res);
       
+      dst.insert (dst.end (), cloud.points.begin (), cloud.points.end ());
+    }
+    ////////////////////////////////////////////////////////////////////////////////
+
+    template<typename PointT> bool
+    OutofcoreOctreeDiskContainer<PointT>::readPayload (pcl::PointCloud<PointT> &cloud) const
+    {
+      if (!OutofcoreNodeCache::getInstance ().isEnabled ())
+      {
+        pcl::PCDReader reader;
+        return (reader.read (*disk_storage_filename_, cloud) == 0);
+      }
+
+      pcl::PCLPointCloud2::ConstPtr payload = OutofcoreNodeCache::getInstance ().load (*disk_storage_filename_);
+      if (!payload)
+        return (false);
+
+      pcl::fromPCLPointCloud2 (*payload, cloud);
+      return (true);
+    }
+    ////////////////////////////////////////////////////////////////////////////////
+
+    template<typename PointT> void
+    OutofcoreOctreeDiskContainer<PointT>::prefetch () const
+    {
+      OutofcoreNodeCache::getInstance ().prefetch (*disk_storage_filename_);
     }
     ////////////////////////////////////////////////////////////////////////////////
 
@@ -331,25 +354,15 @@ namespace pcl
         }
         std::sort (offsets.begin (), offsets.end ());
 
-        FILE* f = fopen (disk_storage_filename_->c_str (), "rb");
-        assert (f != NULL);
-        PointT p;
-        char* loc = reinterpret_cast<char*> (&p);
+        //the node file is compressed, so the samples are taken from its decoded payload
+        pcl::PointCloud<PointT> cloud;
+        readPayload (cloud);
         
         uint64_t filesamp = offsets.size ();
-        for (uint64_t i = 0; i < filesamp; i++)
+        for (uint64_t i = 0; i < filesamp && offsets[i] < cloud.points.size (); i++)
         {
-          int seekret = _fseeki64 (f, offsets[i] * static_cast<uint64_t> (sizeof(PointT)), SEEK_SET);
-          (void)seekret;
-          assert (seekret == 0);
-          size_t readlen = fread (loc, sizeof(PointT), 1, f);
-          (void)readlen;
-          assert (readlen == 1);
-
-          dst.push_back (p);
+          dst.push_back (cloud.points[offsets[i]]);
         }
-
-        fclose (f);
       }
     }
     ////////////////////////////////////////////////////////////////////////////////
@@ -430,24 +443,14 @@ namespace pcl
         }
         std::sort (offsets.begin (), offsets.end ());
 
-        FILE* f = fopen (disk_storage_filename_->c_str (), "rb");
-        assert (f != NULL);
-        PointT p;
-        char* loc = reinterpret_cast<char*> (&p);
-        for (uint64_t i = 0; i < filesamp; i++)
+        //the node file is compressed, so the samples are taken from its decoded payload
+        pcl::PointCloud<PointT> cloud;
+        readPayload (cloud);
+
+        for (uint64_t i = 0; i < filesamp && offsets[i] < cloud.points.size (); i++)
         {
-          int seekret = _fseeki64 (f, offsets[i] * static_cast<uint64_t> (sizeof(PointT)), SEEK_SET);
-          (void)seekret;
-          assert (seekret == 0);
-          size_t readlen = fread (loc, sizeof(PointT), 1, f);
-          (void)readlen;
-          assert (readlen == 1);
-
-          dst.push_back (p);
+          dst.push_back (cloud.points[offsets[i]]);
         }
-        int res = fclose (f);
-        (void)res;
-        assert (res == 0);
       }
     }
     ////////////////////////////////////////////////////////////////////////////////
@@ -504,6 +507,7 @@ namespace pcl
       int res = writer.writeBinaryCompressed (*disk_storage_filename_, *tmp_cloud);
       (void)res;
       assert (res == 0);
+      OutofcoreNodeCache::getInstance ().invalidate (*disk_storage_filename_);
     }
   
     ////////////////////////////////////////////////////////////////////////////////
@@ -544,6 +548,7 @@ namespace pcl
         (void)res;
         assert (res == 0);
       }            
+      OutofcoreNodeCache::getInstance ().invalidate (*disk_storage_filename_);
 
     }
 
@@ -552,18 +557,25 @@ namespace pcl
     template<typename PointT> void
     OutofcoreOctreeDiskContainer<PointT>::readRange (const uint64_t, const uint64_t, pcl::PCLPointCloud2::Ptr& dst)
     {
-      pcl::PCDReader reader;
-
-      Eigen::Vector4f  origin;
-      Eigen::Quaternionf  orientation;
-      int  pcd_version;
-          
       if (boost::filesystem::exists (*disk_storage_filename_))
       {
 //            PCL_INFO ("[pcl::outofcore::OutofcoreOctreeDiskContainer::%s] Reading points from disk from %s.\n", __FUNCTION__ , disk_storage_filename_->c_str ());
-        int res = reader.read (*disk_storage_filename_, *dst, origin, orientation, pcd_version);
-        (void)res;
-        assert (res != -1);
+        if (!OutofcoreNodeCache::getInstance ().isEnabled ())
+        {
+          pcl::PCDReader reader;
+          Eigen::Vector4f origin;
+          Eigen::Quaternionf orientation;
+          int pcd_version;
+          int res = reader.read (*disk_storage_filename_, *dst, origin, orientation, pcd_version);
+          (void)res;
+          assert (res != -1);
+          return;
+        }
+
+        pcl::PCLPointCloud2::ConstPtr payload = OutofcoreNodeCache::getInstance ().load (*disk_storage_filename_);
+        assert (payload);
+        if (payload)
+          *dst = *payload;
       }
       else
       {
@@ -576,15 +588,30 @@ namespace pcl
     template<typename PointT> int
     OutofcoreOctreeDiskContainer<PointT>::read (pcl::PCLPointCloud2::Ptr& output_cloud)
     {
-      pcl::PCLPointCloud2::Ptr temp_output_cloud (new pcl::PCLPointCloud2 ());
+      pcl::PCLPointCloud2::ConstPtr temp_output_cloud;
 
       if (boost::filesystem::exists (*disk_storage_filename_))
       {
 //            PCL_INFO ("[pcl::outofcore::OutofcoreOctreeDiskContainer::%s] Reading points from disk from %s.\n", __FUNCTION__ , disk_storage_filename_->c_str ());
-        int res = pcl::io::loadPCDFile (*disk_storage_filename_, *temp_output_cloud);
-        (void)res;
-        assert (res != -1);
-        if(res == -1)
+        if (!OutofcoreNodeCache::getInstance ().isEnabled ())
+        {
+          // Without the cache, the freshly read cloud is handed over rather than copied
+          pcl::PCLPointCloud2::Ptr read_cloud (new pcl::PCLPointCloud2 ());
+          int res = pcl::io::loadPCDFile (*disk_storage_filename_, *read_cloud);
+          (void)res;
+          assert (res != -1);
+          if (res == -1)
+            return (-1);
+          if (output_cloud.get () != 0)
+            pcl::concatenatePointCloud (*output_cloud, *read_cloud, *output_cloud);
+          else
+            output_cloud = read_cloud;
+          return (0);
+        }
+
+        temp_output_cloud = OutofcoreNodeCache::getInstance ().load (*disk_storage_filename_);
+        assert (temp_output_cloud);
+        if (!temp_output_cloud)
           return (-1);
       }
       else
@@ -599,7 +626,7 @@ namespace pcl
       }
       else
       {
-        output_cloud = temp_output_cloud;
+        output_cloud.reset (new pcl::PCLPointCloud2 (*temp_output_cloud));
       }
       return (0);
     }
@@ -666,6 +693,7 @@ namespace pcl
       int res = writer.writeBinaryCompressed (*disk_storage_filename_, *tmp_cloud);
       (void)res;
       assert (res == 0);
+      OutofcoreNodeCache::getInstance ().invalidate (*disk_storage_filename_);
     }
     ////////////////////////////////////////////////////////////////////////////////
 
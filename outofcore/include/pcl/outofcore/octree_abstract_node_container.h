@@ -91,6 +91,12 @@ namespace pcl
         virtual PointT
         operator[] (uint64_t idx) const=0;
 
+        /** \brief Hints that the data of the container is about to be read, so that it can be loaded in the
+         * background. Does nothing by default.
+         */
+        virtual void
+        prefetch () const {}
+
       protected:
         OutofcoreAbstractNodeContainer (const OutofcoreAbstractNodeContainer& rval);
 
@@ -503,6 +503,12 @@ namespace pcl
         virtual void
         loadChildren (bool recursive);
 
+        /** \brief Queues the payloads of the children intersecting a bounding box to be loaded in the
+         * background, when the children are at the depth of a query which is about to read them.
+         */
+        void
+        prefetchChildren (const Eigen::Vector3d &min_bb, const Eigen::Vector3d &max_bb, const boost::uint64_t query_depth);
+
         /** \brief Gets a vector of occupied voxel centers
          * \param[out] voxel_centers
          * \param[in] query_depth
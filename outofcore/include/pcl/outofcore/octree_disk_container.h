@@ -46,6 +46,7 @@
 
 #include <pcl/outofcore/boost.h>
 #include <pcl/outofcore/octree_abstract_node_container.h>
+#include <pcl/outofcore/outofcore_node_cache.h>
 #include <pcl/io/pcd_io.h>
 #include <pcl/PCLPointCloud2.h>
 
@@ -144,6 +145,12 @@ namespace pcl
         int
         read (pcl::PCLPointCloud2::Ptr &output_cloud);
 
+        /** \brief Queues the point data of this container to be loaded in the background by the shared
+         *  OutofcoreNodeCache, which the reads go through. Does nothing when the cache is disabled.
+         */
+        void
+        prefetch () const;
+
         /** \brief  grab percent*count random points. points are \b not guaranteed to be
          * unique (could have multiple identical points!)
          *
@@ -209,6 +216,7 @@ namespace pcl
           //remove the binary data in the directory
           PCL_DEBUG ("[Octree Disk Container] Removing the point data from disk, in file %s\n",disk_storage_filename_->c_str ());
           boost::filesystem::remove (boost::filesystem::path (disk_storage_filename_->c_str ()));
+          OutofcoreNodeCache::getInstance ().invalidate (*disk_storage_filename_);
           //reset the size-of-file counter
           filelen_ = 0;
         }
@@ -278,6 +286,12 @@ namespace pcl
 
         void
         flushWritebuff (const bool force_cache_dealloc);
+
+        /** \brief Reads the points stored on disk, through the shared OutofcoreNodeCache
+         *  \return false if the file could not be read
+         */
+        bool
+        readPayload (pcl::PointCloud<PointT> &cloud) const;
     
         /** \brief Name of the storage file on disk (i.e., the PCD file) */
         boost::shared_ptr<std::string> disk_storage_filename_;
@@ -0,0 +1,211 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2010-2012, Willow Garage, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage, Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ *  $Id$
+ */
+
+#ifndef PCL_OUTOFCORE_NODE_CACHE_H_
+#define PCL_OUTOFCORE_NODE_CACHE_H_
+
+#include <pcl/pcl_macros.h>
+#include <pcl/outofcore/boost.h>
+#include <pcl/outofcore/impl/lru_cache.hpp>
+#include <pcl/PCLPointCloud2.h>
+
+#include <ctime>
+#include <deque>
+#include <set>
+#include <string>
+
+namespace pcl
+{
+  namespace outofcore
+  {
+    /** \class OutofcoreNodeCache
+     *
+     *  \brief Byte budgeted LRU cache of the decoded point data of the
+     *  nodes, shared by all the out-of-core octrees of the process.
+     *
+     *  The node data is stored in binary compressed PCD files, which
+     *  are mapped and decompressed by pcl::PCDReader on every read.
+     *  With a capacity set, OutofcoreOctreeDiskContainer reads through
+     *  this cache instead, so that the nodes visited again by
+     *  interactive queries are decoded once. Entries are checked
+     *  against the size and modification time of their file, and the
+     *  containers drop the entries of the files they write.
+     *
+     *  The cache can also load files ahead of the queries, on a
+     *  background thread: the octree queries ask for the nodes they
+     *  are about to read with prefetch (), and the reads which follow
+     *  find them decoded, or wait for their load in progress.
+     *
+     *  The cache is disabled, with a capacity of 0, by default.
+     *  All the methods are thread safe.
+     *
+     *  \ingroup outofcore
+     */
+    class PCL_EXPORTS OutofcoreNodeCache : boost::noncopyable
+    {
+      public:
+        /** \brief The cache shared by all the octrees. */
+        static OutofcoreNodeCache&
+        getInstance ();
+
+        /** \brief Set the number of bytes of decoded point data the cache can hold. Least recently used
+         * files are evicted to stay below it, and 0 disables and empties the cache.
+         */
+        void
+        setCapacity (size_t capacity_bytes);
+
+        /** \brief Get the number of bytes of decoded point data the cache can hold. */
+        size_t
+        getCapacity () const;
+
+        /** \brief Returns true if a capacity is set. When it is not, the readers should read the files
+         * themselves, straight into their destination, rather than through load ().
+         */
+        bool
+        isEnabled () const;
+
+        /** \brief Get the number of bytes of decoded point data held by the cache. */
+        size_t
+        getSize () const;
+
+        /** \brief Returns true if the data of the file is in the cache. */
+        bool
+        contains (const std::string &path) const;
+
+        /** \brief Returns the point data of a PCD file, from the cache if it is there, otherwise from the
+         * disk, in which case it is added to the cache.
+         * \param[in] path the PCD file
+         * \return the point data, or a null pointer if the file could not be read
+         */
+        pcl::PCLPointCloud2::ConstPtr
+        load (const std::string &path);
+
+        /** \brief Queues a PCD file to be loaded into the cache in the background. Does nothing when the
+         * cache is disabled or already holds the file. When more than getMaxPendingPrefetches () files
+         * are waiting, the oldest requests are dropped, as they are the least likely to still be needed.
+         */
+        void
+        prefetch (const std::string &path);
+
+        /** \brief Blocks until all the queued prefetches are done. */
+        void
+        waitForPrefetches ();
+
+        /** \brief Set how many files can wait to be prefetched (default: 64). */
+        void
+        setMaxPendingPrefetches (size_t max_pending);
+
+        /** \brief Get how many files can wait to be prefetched. */
+        size_t
+        getMaxPendingPrefetches () const;
+
+        /** \brief Drops the cached data of a file, to be called when the file is written. */
+        void
+        invalidate (const std::string &path);
+
+        /** \brief Drops all the cached data. */
+        void
+        clear ();
+
+        ~OutofcoreNodeCache ();
+
+      private:
+        /** \brief The decoded data of a file, with the state of the file it was read from. */
+        class NodeCacheItem : public LRUCacheItem<pcl::PCLPointCloud2::ConstPtr>
+        {
+          public:
+            NodeCacheItem () : file_size (0), write_time (0) {}
+
+            virtual size_t
+            sizeOf () const
+            {
+              return (sizeof (pcl::PCLPointCloud2) + (item ? item->data.size () : 0));
+            }
+
+            boost::uintmax_t file_size;
+            std::time_t write_time;
+        };
+
+        typedef LRUCache<std::string, NodeCacheItem> Cache;
+
+        OutofcoreNodeCache ();
+
+        /** \brief Reads a file and adds it to the cache, unless it was invalidated meanwhile. */
+        pcl::PCLPointCloud2::ConstPtr
+        loadFromDisk (const std::string &path);
+
+        /** \brief Returns the cached data of a file if it is still up to date, must be called with mutex_ held. */
+        pcl::PCLPointCloud2::ConstPtr
+        lookup (const std::string &path, boost::uintmax_t file_size, std::time_t write_time);
+
+        /** \brief Body of the prefetch thread. */
+        void
+        prefetchLoop ();
+
+        mutable boost::mutex mutex_;
+
+        /** \brief Signaled when a load completes or a prefetch request is queued. */
+        boost::condition_variable changed_;
+
+        Cache cache_;
+
+        /** \brief The cache is disabled when 0, as LRUCache needs a capacity. */
+        size_t capacity_;
+
+        /** \brief Incremented for every item inserted, LRUCache uses it as the timestamp of the items. */
+        size_t timestamp_;
+
+        /** \brief Incremented for every invalidation, so that the loads started before do not insert stale data. */
+        size_t generation_;
+
+        /** \brief Files being read, by prefetch or by load (). */
+        std::set<std::string> loading_;
+
+        /** \brief Files waiting to be prefetched, oldest first. */
+        std::deque<std::string> pending_;
+
+        size_t max_pending_;
+
+        boost::thread prefetch_thread_;
+
+        bool stop_;
+    };
+  }
+}
+
+#endif // PCL_OUTOFCORE_NODE_CACHE_H_
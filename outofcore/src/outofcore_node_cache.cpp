@@ -0,0 +1,338 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2010-2012, Willow Garage, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage, Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ *  $Id$
+ *
+ */
+
+#include <pcl/outofcore/outofcore_node_cache.h>
+
+#include <pcl/io/pcd_io.h>
+
+#include <algorithm>
+
+namespace pcl
+{
+  namespace outofcore
+  {
+
+    OutofcoreNodeCache&
+    OutofcoreNodeCache::getInstance ()
+    {
+      static OutofcoreNodeCache instance;
+      return (instance);
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////
+
+    OutofcoreNodeCache::OutofcoreNodeCache ()
+      : mutex_ ()
+      , changed_ ()
+      , cache_ (1)
+      , capacity_ (0)
+      , timestamp_ (0)
+      , generation_ (0)
+      , loading_ ()
+      , pending_ ()
+      , max_pending_ (64)
+      , prefetch_thread_ ()
+      , stop_ (false)
+    {
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////
+
+    OutofcoreNodeCache::~OutofcoreNodeCache ()
+    {
+      {
+        boost::mutex::scoped_lock lock (mutex_);
+        stop_ = true;
+        pending_.clear ();
+      }
+      changed_.notify_all ();
+      if (prefetch_thread_.joinable ())
+        prefetch_thread_.join ();
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////
+
+    void
+    OutofcoreNodeCache::setCapacity (size_t capacity_bytes)
+    {
+      boost::mutex::scoped_lock lock (mutex_);
+      capacity_ = capacity_bytes;
+      if (capacity_ == 0)
+      {
+        cache_.evict (static_cast<int> (cache_.key_index_.size ()));
+        pending_.clear ();
+        return;
+      }
+
+      cache_.setCapacity (capacity_);
+      while (cache_.size_ >= capacity_ && cache_.evict ())
+        ;
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////
+
+    size_t
+    OutofcoreNodeCache::getCapacity () const
+    {
+      boost::mutex::scoped_lock lock (mutex_);
+      return (capacity_);
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////
+
+    bool
+    OutofcoreNodeCache::isEnabled () const
+    {
+      boost::mutex::scoped_lock lock (mutex_);
+      return (capacity_ > 0);
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////
+
+    size_t
+    OutofcoreNodeCache::getSize () const
+    {
+      boost::mutex::scoped_lock lock (mutex_);
+      return (cache_.size_);
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////
+
+    bool
+    OutofcoreNodeCache::contains (const std::string &path) const
+    {
+      boost::mutex::scoped_lock lock (mutex_);
+      return (cache_.cache_.find (path) != cache_.cache_.end ());
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////
+
+    pcl::PCLPointCloud2::ConstPtr
+    OutofcoreNodeCache::lookup (const std::string &path, boost::uintmax_t file_size, std::time_t write_time)
+    {
+      if (!cache_.hasKey (path))
+        return (pcl::PCLPointCloud2::ConstPtr ());
+
+      const NodeCacheItem &cached = cache_.get (path);
+      if (cached.file_size == file_size && cached.write_time == write_time)
+        return (cached.item);
+
+      // The file changed since it was read
+      cache_.erase (path);
+      return (pcl::PCLPointCloud2::ConstPtr ());
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////
+
+    pcl::PCLPointCloud2::ConstPtr
+    OutofcoreNodeCache::load (const std::string &path)
+    {
+      {
+        boost::mutex::scoped_lock lock (mutex_);
+        if (capacity_ > 0)
+        {
+          // A load of the same file is in progress, most likely a prefetch: wait for it rather than reading twice
+          while (loading_.count (path) != 0)
+            changed_.wait (lock);
+        }
+      }
+      return (loadFromDisk (path));
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////
+
+    pcl::PCLPointCloud2::ConstPtr
+    OutofcoreNodeCache::loadFromDisk (const std::string &path)
+    {
+      boost::system::error_code error;
+      const boost::uintmax_t file_size = boost::filesystem::file_size (path, error);
+      if (error)
+        return (pcl::PCLPointCloud2::ConstPtr ());
+      const std::time_t write_time = boost::filesystem::last_write_time (path, error);
+      if (error)
+        return (pcl::PCLPointCloud2::ConstPtr ());
+
+      size_t generation;
+      {
+        boost::mutex::scoped_lock lock (mutex_);
+        if (capacity_ > 0)
+        {
+          pcl::PCLPointCloud2::ConstPtr cached = lookup (path, file_size, write_time);
+          if (cached)
+            return (cached);
+        }
+        loading_.insert (path);
+        generation = generation_;
+      }
+
+      // Read outside of the lock, pcl::PCDReader maps the file and decompresses it
+      pcl::PCLPointCloud2::Ptr cloud (new pcl::PCLPointCloud2 ());
+      Eigen::Vector4f origin;
+      Eigen::Quaternionf orientation;
+      int pcd_version;
+      pcl::PCDReader reader;
+      if (reader.read (path, *cloud, origin, orientation, pcd_version) < 0)
+        cloud.reset ();
+
+      {
+        boost::mutex::scoped_lock lock (mutex_);
+        loading_.erase (path);
+        if (cloud && capacity_ > 0 && generation == generation_)
+        {
+          NodeCacheItem item;
+          item.item = cloud;
+          item.timestamp = ++timestamp_;
+          item.file_size = file_size;
+          item.write_time = write_time;
+          cache_.erase (path);
+          cache_.insert (path, item);
+        }
+      }
+      changed_.notify_all ();
+
+      return (cloud);
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////
+
+    void
+    OutofcoreNodeCache::prefetch (const std::string &path)
+    {
+      {
+        boost::mutex::scoped_lock lock (mutex_);
+        if (capacity_ == 0 || stop_ || cache_.hasKey (path) || loading_.count (path) != 0 ||
+            std::find (pending_.begin (), pending_.end (), path) != pending_.end ())
+          return;
+
+        pending_.push_back (path);
+        while (pending_.size () > max_pending_)
+          pending_.pop_front ();
+
+        if (!prefetch_thread_.joinable ())
+          prefetch_thread_ = boost::thread (&OutofcoreNodeCache::prefetchLoop, this);
+      }
+      changed_.notify_all ();
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////
+
+    void
+    OutofcoreNodeCache::prefetchLoop ()
+    {
+      while (true)
+      {
+        std::string path;
+        {
+          boost::mutex::scoped_lock lock (mutex_);
+          while (!stop_ && pending_.empty ())
+            changed_.wait (lock);
+          if (stop_)
+            return;
+
+          // Most recent request first, the older ones are more likely to be out of view already
+          path = pending_.back ();
+          pending_.pop_back ();
+
+          // Reserve the file before releasing the lock, so that load () waits for it
+          loading_.insert (path);
+        }
+
+        loadFromDisk (path);
+
+        // loadFromDisk () returns early, without releasing the file, when it can not be read or is cached already
+        {
+          boost::mutex::scoped_lock lock (mutex_);
+          loading_.erase (path);
+        }
+        changed_.notify_all ();
+      }
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////
+
+    void
+    OutofcoreNodeCache::waitForPrefetches ()
+    {
+      boost::mutex::scoped_lock lock (mutex_);
+      while (!pending_.empty () || !loading_.empty ())
+        changed_.wait (lock);
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////
+
+    void
+    OutofcoreNodeCache::setMaxPendingPrefetches (size_t max_pending)
+    {
+      boost::mutex::scoped_lock lock (mutex_);
+      max_pending_ = max_pending;
+      while (pending_.size () > max_pending_)
+        pending_.pop_front ();
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////
+
+    size_t
+    OutofcoreNodeCache::getMaxPendingPrefetches () const
+    {
+      boost::mutex::scoped_lock lock (mutex_);
+      return (max_pending_);
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////
+
+    void
+    OutofcoreNodeCache::invalidate (const std::string &path)
+    {
+      boost::mutex::scoped_lock lock (mutex_);
+      ++generation_;
+      cache_.erase (path);
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////
+
+    void
+    OutofcoreNodeCache::clear ()
+    {
+      boost::mutex::scoped_lock lock (mutex_);
+      ++generation_;
+      cache_.evict (static_cast<int> (cache_.key_index_.size ()));
+    }
+
+  }//namespace outofcore
+}//namespace pcl
@@ -102,12 +102,24 @@ namespace pcl
           , source_cloud_updated_ (true)
           , force_no_recompute_ (false)
           , force_no_recompute_reciprocal_ (false)
+          , threads_ (1)
         {
         }
       
         /** \brief Empty destructor */
         virtual ~CorrespondenceEstimationBase () {}
 
+        /** \brief Set the number of threads used to determine the correspondences.
+          * The results do not depend on the number of threads.
+          * \param[in] nr_threads the number of hardware threads to use (0 sets the value back to automatic)
+          */
+        inline void
+        setNumberOfThreads (unsigned int nr_threads = 0) { threads_ = nr_threads; }
+
+        /** \brief Get the number of threads used to determine the correspondences (0 means automatic). */
+        inline unsigned int
+        getNumberOfThreads () const { return (threads_); }
+
         /** \brief Provide a pointer to the input source 
           * (e.g., the point cloud that we want to align to the target)
           *
@@ -337,6 +349,9 @@ namespace pcl
          * will never be recomputed*/
         bool force_no_recompute_reciprocal_;
 
+        /** \brief The number of threads the scheduler should use. */
+        unsigned int threads_;
+
      };
 
     /** \brief @b CorrespondenceEstimation represents the base class for
@@ -375,6 +390,7 @@ namespace pcl
         using CorrespondenceEstimationBase<PointSource, PointTarget, Scalar>::corr_name_;
         using CorrespondenceEstimationBase<PointSource, PointTarget, Scalar>::target_indices_;
         using CorrespondenceEstimationBase<PointSource, PointTarget, Scalar>::getClassName;
+        using CorrespondenceEstimationBase<PointSource, PointTarget, Scalar>::threads_;
         using CorrespondenceEstimationBase<PointSource, PointTarget, Scalar>::initCompute;
         using CorrespondenceEstimationBase<PointSource, PointTarget, Scalar>::initComputeReciprocal;
         using CorrespondenceEstimationBase<PointSource, PointTarget, Scalar>::input_;
@@ -78,6 +78,7 @@ namespace pcl
       using IterativeClosestPoint<PointSource, PointTarget>::inlier_threshold_;
       using IterativeClosestPoint<PointSource, PointTarget>::min_number_correspondences_;
       using IterativeClosestPoint<PointSource, PointTarget>::update_visualizer_;
+      using IterativeClosestPoint<PointSource, PointTarget>::threads_;
 
       typedef pcl::PointCloud<PointSource> PointCloudSource;
       typedef typename PointCloudSource::Ptr PointCloudSourcePtr;
@@ -110,6 +111,7 @@ namespace pcl
         , rotation_epsilon_(2e-3)
         , mahalanobis_(0)
         , max_inner_iterations_(20)
+        , use_closed_form_eigen_solver_ (false)
       {
         min_number_correspondences_ = 4;
         reg_name_ = "GeneralizedIterativeClosestPoint";
@@ -153,7 +155,19 @@ namespace pcl
         input_covariances_ = covariances;
       }
       
+      /** \brief Get the covariances of the input source, as set with setSourceCovariances () or computed by the
+        * last call to align (). Returns an empty pointer if neither happened since the input source was set.
+        */
+      inline MatricesVectorPtr
+      getSourceCovariances () const
+      {
+        return (input_covariances_);
+      }
+
       /** \brief Provide a pointer to the input target (e.g., the point cloud that we want to align the input source to)
+        * The target covariances are kept across calls to align () until the input target is set again. To register
+        * many scans against a fixed map, either keep the target set, or save the covariances returned by
+        * getTargetCovariances () and pass them to setTargetCovariances () after setting the target again.
         * \param[in] target the input point cloud target
         */
       inline void 
@@ -173,6 +187,15 @@ namespace pcl
       {
         target_covariances_ = covariances;
       }
+
+      /** \brief Get the covariances of the input target, as set with setTargetCovariances () or computed by the
+        * last call to align (). Returns an empty pointer if neither happened since the input target was set.
+        */
+      inline MatricesVectorPtr
+      getTargetCovariances () const
+      {
+        return (target_covariances_);
+      }
       
       /** \brief Estimate a rigid rotation transformation between a source and a target point cloud using an iterative
         * non-linear Levenberg-Marquardt approach.
@@ -245,6 +268,18 @@ namespace pcl
       int
       getMaximumOptimizerIterations () { return (max_inner_iterations_); }
 
+      /** \brief Set whether the covariances are regularized with the closed form eigen solver of
+        * pcl::eigen33 instead of a Jacobi SVD. The closed form solver is several times faster but
+        * slightly less accurate for nearly degenerate neighborhoods.
+        * \param[in] use_closed_form true to use the closed form solver (default: false)
+        */
+      inline void
+      setUseClosedFormEigenSolver (bool use_closed_form) { use_closed_form_eigen_solver_ = use_closed_form; }
+
+      /** \brief Get whether the covariances are regularized with the closed form eigen solver. */
+      inline bool
+      getUseClosedFormEigenSolver () const { return (use_closed_form_eigen_solver_); }
+
     protected:
 
       /** \brief The number of neighbors used for covariances computation. 
@@ -292,6 +327,9 @@ namespace pcl
       /** \brief maximum number of optimizations */
       int max_inner_iterations_;
 
+      /** \brief Whether the covariances are regularized with the closed form eigen solver. */
+      bool use_closed_form_eigen_solver_;
+
       /** \brief compute points covariances matrices according to the K nearest 
         * neighbors. K is set via setCorrespondenceRandomness() method.
         * \param cloud pointer to point cloud
@@ -145,6 +145,8 @@ namespace pcl
         , use_reciprocal_correspondence_ (false)
         , source_has_normals_ (false)
         , target_has_normals_ (false)
+        , threads_ (1)
+        , threads_set_ (false)
       {
         reg_name_ = "IterativeClosestPoint";
         transformation_estimation_.reset (new pcl::registration::TransformationEstimationSVD<PointSource, PointTarget, Scalar> ());
@@ -243,6 +245,21 @@ namespace pcl
         return (use_reciprocal_correspondence_);
       }
 
+      /** \brief Set the number of threads used by the correspondence estimation step.
+        * Once set, the value is passed on to the correspondence estimator at the beginning
+        * of every alignment. Until then, the estimator keeps its own setting, e.g. the one of
+        * an estimator given to setCorrespondenceEstimation (). GeneralizedIterativeClosestPoint
+        * also uses it to compute the covariances. The results do not depend on the number of
+        * threads.
+        * \param[in] nr_threads the number of hardware threads to use (0 sets the value back to automatic)
+        */
+      inline void
+      setNumberOfThreads (unsigned int nr_threads = 0)
+      {
+        threads_ = nr_threads;
+        threads_set_ = true;
+      }
+
     protected:
 
       /** \brief Apply a rigid transform to a given dataset. Here we check whether whether
@@ -284,6 +301,12 @@ namespace pcl
 
       /** \brief Checks for whether estimators and rejectors need various data */
       bool need_source_blob_, need_target_blob_;
+
+      /** \brief The number of threads used for correspondence estimation. */
+      unsigned int threads_;
+
+      /** \brief Whether setNumberOfThreads () was called, so that threads_ overrides the setting of the estimator. */
+      bool threads_set_;
   };
 
   /** \brief @b IterativeClosestPointWithNormals is a special case of
@@ -42,6 +42,64 @@
 
 #include <pcl/common/io.h>
 #include <pcl/common/copy_point.h>
+#include <algorithm>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+namespace pcl
+{
+  namespace registration
+  {
+    namespace detail
+    {
+      /** \brief Resolve the number of threads requested by the user (0 means automatic). */
+      inline int
+      getCorrespondenceEstimationThreads (unsigned int threads)
+      {
+#ifdef _OPENMP
+        return (threads == 0 ? omp_get_num_procs () : static_cast<int> (threads));
+#else
+        (void) threads;
+        return (1);
+#endif
+      }
+
+      /** \brief Number of contiguous chunks the source indices are split into. A few
+        * chunks per thread keep the dynamic schedule balanced.
+        */
+      inline int
+      getCorrespondenceEstimationChunks (int nr_indices, int nr_threads)
+      {
+        if (nr_indices <= 0)
+          return (0);
+        if (nr_threads <= 1)
+          return (1);
+        return (std::min (nr_indices, nr_threads * 4));
+      }
+
+      /** \brief Concatenate per-chunk correspondences in chunk order. */
+      inline void
+      concatenateCorrespondences (std::vector<pcl::Correspondences> &chunks,
+                                  pcl::Correspondences &correspondences)
+      {
+        if (chunks.size () == 1)
+        {
+          correspondences.swap (chunks[0]);
+          return;
+        }
+        size_t total = 0;
+        for (size_t c = 0; c < chunks.size (); ++c)
+          total += chunks[c].size ();
+        correspondences.clear ();
+        correspondences.reserve (total);
+        for (size_t c = 0; c < chunks.size (); ++c)
+          correspondences.insert (correspondences.end (), chunks[c].begin (), chunks[c].end ());
+      }
+    }
+  }
+}
 
 ///////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointSource, typename PointTarget, typename Scalar> void
@@ -118,51 +176,71 @@ pcl::registration::CorrespondenceEstimation<PointSource, PointTarget, Scalar>::d
 
   double max_dist_sqr = max_distance * max_distance;
 
-  correspondences.resize (indices_->size ());
-
-  std::vector<int> index (1);
-  std::vector<float> distance (1);
-  pcl::Correspondence corr;
-  unsigned int nr_valid_correspondences = 0;
-  
-  // Check if the template types are the same. If true, avoid a copy.
-  // Both point types MUST be registered using the POINT_CLOUD_REGISTER_POINT_STRUCT macro!
-  if (isSamePointType<PointSource, PointTarget> ())
+  // The source indices are split into contiguous chunks which are processed
+  // independently and concatenated in order, so the result does not depend on
+  // the number of threads
+  const int nr_indices = static_cast<int> (indices_->size ());
+  const int nr_threads = pcl::registration::detail::getCorrespondenceEstimationThreads (threads_);
+  const int nr_chunks = pcl::registration::detail::getCorrespondenceEstimationChunks (nr_indices, nr_threads);
+  std::vector<pcl::Correspondences> chunk_correspondences (nr_chunks);
+
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic, 1) num_threads(nr_threads)
+#endif
+  for (int chunk = 0; chunk < nr_chunks; ++chunk)
   {
-    // Iterate over the input set of source indices
-    for (std::vector<int>::const_iterator idx = indices_->begin (); idx != indices_->end (); ++idx)
+    const int begin = static_cast<int> (static_cast<long long> (nr_indices) * chunk / nr_chunks);
+    const int end = static_cast<int> (static_cast<long long> (nr_indices) * (chunk + 1) / nr_chunks);
+
+    pcl::Correspondences &chunk_corr = chunk_correspondences[chunk];
+    chunk_corr.reserve (end - begin);
+
+    std::vector<int> index (1);
+    std::vector<float> distance (1);
+    pcl::Correspondence corr;
+
+    // Check if the template types are the same. If true, avoid a copy.
+    // Both point types MUST be registered using the POINT_CLOUD_REGISTER_POINT_STRUCT macro!
+    if (isSamePointType<PointSource, PointTarget> ())
     {
-      tree_->nearestKSearch (input_->points[*idx], 1, index, distance);
-      if (distance[0] > max_dist_sqr)
-        continue;
-
-      corr.index_query = *idx;
-      corr.index_match = index[0];
-      corr.distance = distance[0];
-      correspondences[nr_valid_correspondences++] = corr;
+      // Iterate over the input set of source indices
+      for (int i = begin; i < end; ++i)
+      {
+        const int idx = (*indices_)[i];
+        tree_->nearestKSearch (input_->points[idx], 1, index, distance);
+        if (distance[0] > max_dist_sqr)
+          continue;
+
+        corr.index_query = idx;
+        corr.index_match = index[0];
+        corr.distance = distance[0];
+        chunk_corr.push_back (corr);
+      }
     }
-  }
-  else
-  {
-    PointTarget pt;
-    
-    // Iterate over the input set of source indices
-    for (std::vector<int>::const_iterator idx = indices_->begin (); idx != indices_->end (); ++idx)
+    else
     {
-      // Copy the source data to a target PointTarget format so we can search in the tree
-      copyPoint (input_->points[*idx], pt);
-
-      tree_->nearestKSearch (pt, 1, index, distance);
-      if (distance[0] > max_dist_sqr)
-        continue;
-
-      corr.index_query = *idx;
-      corr.index_match = index[0];
-      corr.distance = distance[0];
-      correspondences[nr_valid_correspondences++] = corr;
+      PointTarget pt;
+
+      // Iterate over the input set of source indices
+      for (int i = begin; i < end; ++i)
+      {
+        const int idx = (*indices_)[i];
+        // Copy the source data to a target PointTarget format so we can search in the tree
+        copyPoint (input_->points[idx], pt);
+
+        tree_->nearestKSearch (pt, 1, index, distance);
+        if (distance[0] > max_dist_sqr)
+          continue;
+
+        corr.index_query = idx;
+        corr.index_match = index[0];
+        corr.distance = distance[0];
+        chunk_corr.push_back (corr);
+      }
     }
   }
-  correspondences.resize (nr_valid_correspondences);
+
+  pcl::registration::detail::concatenateCorrespondences (chunk_correspondences, correspondences);
   deinitCompute ();
 }
 
@@ -180,69 +258,87 @@ pcl::registration::CorrespondenceEstimation<PointSource, PointTarget, Scalar>::d
     return;
   double max_dist_sqr = max_distance * max_distance;
 
-  correspondences.resize (indices_->size());
-  std::vector<int> index (1);
-  std::vector<float> distance (1);
-  std::vector<int> index_reciprocal (1);
-  std::vector<float> distance_reciprocal (1);
-  pcl::Correspondence corr;
-  unsigned int nr_valid_correspondences = 0;
-  int target_idx = 0;
-
-  // Check if the template types are the same. If true, avoid a copy.
-  // Both point types MUST be registered using the POINT_CLOUD_REGISTER_POINT_STRUCT macro!
-  if (isSamePointType<PointSource, PointTarget> ())
+  const int nr_indices = static_cast<int> (indices_->size ());
+  const int nr_threads = pcl::registration::detail::getCorrespondenceEstimationThreads (threads_);
+  const int nr_chunks = pcl::registration::detail::getCorrespondenceEstimationChunks (nr_indices, nr_threads);
+  std::vector<pcl::Correspondences> chunk_correspondences (nr_chunks);
+
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic, 1) num_threads(nr_threads)
+#endif
+  for (int chunk = 0; chunk < nr_chunks; ++chunk)
   {
-    // Iterate over the input set of source indices
-    for (std::vector<int>::const_iterator idx = indices_->begin (); idx != indices_->end (); ++idx)
+    const int begin = static_cast<int> (static_cast<long long> (nr_indices) * chunk / nr_chunks);
+    const int end = static_cast<int> (static_cast<long long> (nr_indices) * (chunk + 1) / nr_chunks);
+
+    pcl::Correspondences &chunk_corr = chunk_correspondences[chunk];
+    chunk_corr.reserve (end - begin);
+
+    std::vector<int> index (1);
+    std::vector<float> distance (1);
+    std::vector<int> index_reciprocal (1);
+    std::vector<float> distance_reciprocal (1);
+    pcl::Correspondence corr;
+    int target_idx = 0;
+
+    // Check if the template types are the same. If true, avoid a copy.
+    // Both point types MUST be registered using the POINT_CLOUD_REGISTER_POINT_STRUCT macro!
+    if (isSamePointType<PointSource, PointTarget> ())
     {
-      tree_->nearestKSearch (input_->points[*idx], 1, index, distance);
-      if (distance[0] > max_dist_sqr)
-        continue;
-
-      target_idx = index[0];
-
-      tree_reciprocal_->nearestKSearch (target_->points[target_idx], 1, index_reciprocal, distance_reciprocal);
-      if (distance_reciprocal[0] > max_dist_sqr || *idx != index_reciprocal[0])
-        continue;
-
-      corr.index_query = *idx;
-      corr.index_match = index[0];
-      corr.distance = distance[0];
-      correspondences[nr_valid_correspondences++] = corr;
+      // Iterate over the input set of source indices
+      for (int i = begin; i < end; ++i)
+      {
+        const int idx = (*indices_)[i];
+        tree_->nearestKSearch (input_->points[idx], 1, index, distance);
+        if (distance[0] > max_dist_sqr)
+          continue;
+
+        target_idx = index[0];
+
+        tree_reciprocal_->nearestKSearch (target_->points[target_idx], 1, index_reciprocal, distance_reciprocal);
+        if (distance_reciprocal[0] > max_dist_sqr || idx != index_reciprocal[0])
+          continue;
+
+        corr.index_query = idx;
+        corr.index_match = index[0];
+        corr.distance = distance[0];
+        chunk_corr.push_back (corr);
+      }
     }
-  }
-  else
-  {
-    PointTarget pt_src;
-    PointSource pt_tgt;
-   
-    // Iterate over the input set of source indices
-    for (std::vector<int>::const_iterator idx = indices_->begin (); idx != indices_->end (); ++idx)
+    else
     {
-      // Copy the source data to a target PointTarget format so we can search in the tree
-      copyPoint (input_->points[*idx], pt_src);
-
-      tree_->nearestKSearch (pt_src, 1, index, distance);
-      if (distance[0] > max_dist_sqr)
-        continue;
-
-      target_idx = index[0];
-
-      // Copy the target data to a target PointSource format so we can search in the tree_reciprocal
-      copyPoint (target_->points[target_idx], pt_tgt);
-
-      tree_reciprocal_->nearestKSearch (pt_tgt, 1, index_reciprocal, distance_reciprocal);
-      if (distance_reciprocal[0] > max_dist_sqr || *idx != index_reciprocal[0])
-        continue;
-
-      corr.index_query = *idx;
-      corr.index_match = index[0];
-      corr.distance = distance[0];
-      correspondences[nr_valid_correspondences++] = corr;
+      PointTarget pt_src;
+      PointSource pt_tgt;
+
+      // Iterate over the input set of source indices
+      for (int i = begin; i < end; ++i)
+      {
+        const int idx = (*indices_)[i];
+        // Copy the source data to a target PointTarget format so we can search in the tree
+        copyPoint (input_->points[idx], pt_src);
+
+        tree_->nearestKSearch (pt_src, 1, index, distance);
+        if (distance[0] > max_dist_sqr)
+          continue;
+
+        target_idx = index[0];
+
+        // Copy the target data to a target PointSource format so we can search in the tree_reciprocal
+        copyPoint (target_->points[target_idx], pt_tgt);
+
+        tree_reciprocal_->nearestKSearch (pt_tgt, 1, index_reciprocal, distance_reciprocal);
+        if (distance_reciprocal[0] > max_dist_sqr || idx != index_reciprocal[0])
+          continue;
+
+        corr.index_query = idx;
+        corr.index_match = index[0];
+        corr.distance = distance[0];
+        chunk_corr.push_back (corr);
+      }
     }
   }
-  correspondences.resize (nr_valid_correspondences);
+
+  pcl::registration::detail::concatenateCorrespondences (chunk_correspondences, correspondences);
   deinitCompute ();
 }
 
@@ -42,6 +42,11 @@
 
 #include <pcl/registration/boost.h>
 #include <pcl/registration/exceptions.h>
+#include <pcl/common/eigen.h>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 
 ////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointSource, typename PointTarget>
@@ -56,68 +61,88 @@ pcl::GeneralizedIterativeClosestPoint<PointSource, PointTarget>::computeCovarian
     return;
   }
 
-  Eigen::Vector3d mean;
-  std::vector<int> nn_indecies; nn_indecies.reserve (k_correspondences_);
-  std::vector<float> nn_dist_sq; nn_dist_sq.reserve (k_correspondences_);
-
   // We should never get there but who knows
   if(cloud_covariances.size () < cloud->size ())
     cloud_covariances.resize (cloud->size ());
 
-  typename pcl::PointCloud<PointT>::const_iterator points_iterator = cloud->begin ();
-  MatricesVector::iterator matrices_iterator = cloud_covariances.begin ();
-  for(;
-      points_iterator != cloud->end ();
-      ++points_iterator, ++matrices_iterator)
+#ifdef _OPENMP
+  const int nr_threads = threads_ == 0 ? omp_get_num_procs () : static_cast<int> (threads_);
+#endif
+  const int nr_points = static_cast<int> (cloud->size ());
+
+#ifdef _OPENMP
+#pragma omp parallel num_threads(nr_threads)
+#endif
   {
-    const PointT &query_point = *points_iterator;
-    Eigen::Matrix3d &cov = *matrices_iterator;
-    // Zero out the cov and mean
-    cov.setZero ();
-    mean.setZero ();
+    Eigen::Vector3d mean;
+    std::vector<int> nn_indecies; nn_indecies.reserve (k_correspondences_);
+    std::vector<float> nn_dist_sq; nn_dist_sq.reserve (k_correspondences_);
+
+#ifdef _OPENMP
+#pragma omp for schedule(dynamic, 256)
+#endif
+    for (int i = 0; i < nr_points; ++i)
+    {
+      const PointT &query_point = (*cloud)[i];
+      Eigen::Matrix3d &cov = cloud_covariances[i];
+      // Zero out the cov and mean
+      cov.setZero ();
+      mean.setZero ();
 
-    // Search for the K nearest neighbours
-    kdtree->nearestKSearch(query_point, k_correspondences_, nn_indecies, nn_dist_sq);
+      // Search for the K nearest neighbours
+      kdtree->nearestKSearch(query_point, k_correspondences_, nn_indecies, nn_dist_sq);
 
-    // Find the covariance matrix
-    for(int j = 0; j < k_correspondences_; j++) {
-      const PointT &pt = (*cloud)[nn_indecies[j]];
+      // Find the covariance matrix
+      for(int j = 0; j < k_correspondences_; j++) {
+        const PointT &pt = (*cloud)[nn_indecies[j]];
 
-      mean[0] += pt.x;
-      mean[1] += pt.y;
-      mean[2] += pt.z;
+        mean[0] += pt.x;
+        mean[1] += pt.y;
+        mean[2] += pt.z;
 
-      cov(0,0) += pt.x*pt.x;
+        cov(0,0) += pt.x*pt.x;
 
-      cov(1,0) += pt.y*pt.x;
-      cov(1,1) += pt.y*pt.y;
+        cov(1,0) += pt.y*pt.x;
+        cov(1,1) += pt.y*pt.y;
 
-      cov(2,0) += pt.z*pt.x;
-      cov(2,1) += pt.z*pt.y;
-      cov(2,2) += pt.z*pt.z;
-    }
+        cov(2,0) += pt.z*pt.x;
+        cov(2,1) += pt.z*pt.y;
+        cov(2,2) += pt.z*pt.z;
+      }
 
-    mean /= static_cast<double> (k_correspondences_);
-    // Get the actual covariance
-    for (int k = 0; k < 3; k++)
-      for (int l = 0; l <= k; l++)
+      mean /= static_cast<double> (k_correspondences_);
+      // Get the actual covariance
+      for (int k = 0; k < 3; k++)
+        for (int l = 0; l <= k; l++)
+        {
+          cov(k,l) /= static_cast<double> (k_correspondences_);
+          cov(k,l) -= mean[k]*mean[l];
+          cov(l,k) = cov(k,l);
+        }
+
+      if (use_closed_form_eigen_solver_)
       {
-        cov(k,l) /= static_cast<double> (k_correspondences_);
-        cov(k,l) -= mean[k]*mean[l];
-        cov(l,k) = cov(k,l);
+        // The eigenvectors form an orthonormal basis, so replacing the two biggest eigenvalues by 1 and the
+        // smallest one by gicp_epsilon gives I - (1 - gicp_epsilon) * v * v', v being the smallest eigenvector
+        double eigen_value;
+        Eigen::Vector3d eigen_vector;
+        pcl::eigen33 (cov, eigen_value, eigen_vector);
+        cov = Eigen::Matrix3d::Identity () - (1. - gicp_epsilon_) * eigen_vector * eigen_vector.transpose ();
+        continue;
       }
 
-    // Compute the SVD (covariance matrix is symmetric so U = V')
-    Eigen::JacobiSVD<Eigen::Matrix3d> svd(cov, Eigen::ComputeFullU);
-    cov.setZero ();
-    Eigen::Matrix3d U = svd.matrixU ();
-    // Reconstitute the covariance matrix with modified singular values using the column     // vectors in V.
-    for(int k = 0; k < 3; k++) {
-      Eigen::Vector3d col = U.col(k);
-      double v = 1.; // biggest 2 singular values replaced by 1
-      if(k == 2)   // smallest singular value replaced by gicp_epsilon
-        v = gicp_epsilon_;
-      cov+= v * col * col.transpose();
+      // Compute the SVD (covariance matrix is symmetric so U = V')
+      Eigen::JacobiSVD<Eigen::Matrix3d> svd(cov, Eigen::ComputeFullU);
+      cov.setZero ();
+      Eigen::Matrix3d U = svd.matrixU ();
+      // Reconstitute the covariance matrix with modified singular values using the column     // vectors in V.
+      for(int k = 0; k < 3; k++) {
+        Eigen::Vector3d col = U.col(k);
+        double v = 1.; // biggest 2 singular values replaced by 1
+        if(k == 2)   // smallest singular value replaced by gicp_epsilon
+          v = gicp_epsilon_;
+        cov+= v * col * col.transpose();
+      }
     }
   }
 }
@@ -353,6 +378,12 @@ pcl::GeneralizedIterativeClosestPoint<PointSource, PointTarget>::computeTransfor
   // Set the mahalanobis matrices to identity
   mahalanobis_.resize (N, Eigen::Matrix3d::Identity ());
   // Compute target cloud covariance matrices
+  if (target_covariances_ && !target_covariances_->empty () && target_covariances_->size () != target_->size ())
+  {
+    PCL_WARN ("[pcl::%s::computeTransformation] The number of target covariances (%lu) differs from the number of target points (%lu), recomputing them!\n",
+              getClassName ().c_str (), target_covariances_->size (), target_->size ());
+    target_covariances_.reset ();
+  }
   if ((!target_covariances_) || (target_covariances_->empty ()))
   {
     target_covariances_.reset (new MatricesVector);  
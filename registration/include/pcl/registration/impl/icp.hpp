@@ -148,6 +148,8 @@ pcl::IterativeClosestPoint<PointSource, PointTarget, Scalar>::computeTransformat
 
   // Pass in the default target for the Correspondence Estimation/Rejection code
   correspondence_estimation_->setInputTarget (target_);
+  if (threads_set_)
+    correspondence_estimation_->setNumberOfThreads (threads_);
   if (correspondence_estimation_->requiresTargetNormals ())
     correspondence_estimation_->setTargetNormals (target_blob);
   // Correspondence Rejectors need a binary blob
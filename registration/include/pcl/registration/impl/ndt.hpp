@@ -41,6 +41,25 @@
 #ifndef PCL_REGISTRATION_NDT_IMPL_H_
 #define PCL_REGISTRATION_NDT_IMPL_H_
 
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+namespace pcl
+{
+  namespace registration
+  {
+    namespace detail
+    {
+      /** \brief Number of consecutive source points whose contributions to the NDT score and derivatives
+        * are summed up together. Blocks are summed in order afterwards, so that the result does not
+        * depend on the number of threads.
+        */
+      const int NDT_BLOCK_SIZE = 256;
+    }
+  }
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 template<typename PointSource, typename PointTarget>
 pcl::NormalDistributionsTransform<PointSource, PointTarget>::NormalDistributionsTransform () 
@@ -56,6 +75,8 @@ pcl::NormalDistributionsTransform<PointSource, PointTarget>::NormalDistributions
   , h_ang_d3_ (), h_ang_e1_ (), h_ang_e2_ (), h_ang_e3_ (), h_ang_f1_ (), h_ang_f2_ (), h_ang_f3_ ()
   , point_gradient_ ()
   , point_hessian_ ()
+  , search_method_ (KDTREE)
+  , threads_ (1)
 {
   reg_name_ = "NormalDistributionsTransform";
 
@@ -185,14 +206,7 @@ pcl::NormalDistributionsTransform<PointSource, PointTarget>::computeDerivatives
                                                                                  Eigen::Matrix<double, 6, 1> &p,
                                                                                  bool compute_hessian)
 {
-  // Original Point and Transformed Point
-  PointSource x_pt, x_trans_pt;
-  // Original Point and Transformed Point (for math)
-  Eigen::Vector3d x, x_trans;
-  // Occupied Voxel
-  TargetGridLeafConstPtr cell;
-  // Inverse Covariance of Occupied Voxel
-  Eigen::Matrix3d c_inv;
+  using pcl::registration::detail::NDT_BLOCK_SIZE;
 
   score_gradient.setZero ();
   hessian.setZero ();
@@ -201,36 +215,70 @@ pcl::NormalDistributionsTransform<PointSource, PointTarget>::computeDerivatives
   // Precompute Angular Derivatives (eq. 6.19 and 6.21)[Magnusson 2009]
   computeAngleDerivatives (p);
 
-  // Update gradient and hessian for each point, line 17 in Algorithm 2 [Magnusson 2009]
-  for (size_t idx = 0; idx < input_->points.size (); idx++)
+  // Partial sums of each block of points
+  const int nr_points = static_cast<int> (input_->points.size ());
+  const int nr_blocks = (nr_points + NDT_BLOCK_SIZE - 1) / NDT_BLOCK_SIZE;
+  std::vector<double> block_scores (nr_blocks, 0.0);
+  std::vector<Eigen::Matrix<double, 6, 1>, Eigen::aligned_allocator<Eigen::Matrix<double, 6, 1> > >
+    block_gradients (nr_blocks, Eigen::Matrix<double, 6, 1>::Zero ());
+  std::vector<Eigen::Matrix<double, 6, 6>, Eigen::aligned_allocator<Eigen::Matrix<double, 6, 6> > >
+    block_hessians (nr_blocks, Eigen::Matrix<double, 6, 6>::Zero ());
+
+#ifdef _OPENMP
+  const int nr_threads = threads_ == 0 ? omp_get_num_procs () : static_cast<int> (threads_);
+#pragma omp parallel num_threads(nr_threads)
+#endif
   {
-    x_trans_pt = trans_cloud.points[idx];
-
-    // Find nieghbors (Radius search has been experimentally faster than direct neighbor checking.
+    // Each thread works on its own copy of the point derivatives, which hold the constant parts set up in computeTransformation
+    Eigen::Matrix<double, 3, 6> point_gradient = point_gradient_;
+    Eigen::Matrix<double, 18, 6> point_hessian = point_hessian_;
     std::vector<TargetGridLeafConstPtr> neighborhood;
     std::vector<float> distances;
-    target_cells_.radiusSearch (x_trans_pt, resolution_, neighborhood, distances);
 
-    for (typename std::vector<TargetGridLeafConstPtr>::iterator neighborhood_it = neighborhood.begin (); neighborhood_it != neighborhood.end (); neighborhood_it++)
+#ifdef _OPENMP
+#pragma omp for schedule(dynamic, 1)
+#endif
+    for (int b = 0; b < nr_blocks; ++b)
     {
-      cell = *neighborhood_it;
-      x_pt = input_->points[idx];
-      x = Eigen::Vector3d (x_pt.x, x_pt.y, x_pt.z);
+      const int end = std::min (nr_points, (b + 1) * NDT_BLOCK_SIZE);
+      for (int idx = b * NDT_BLOCK_SIZE; idx < end; ++idx)
+      {
+        const PointSource &x_trans_pt = trans_cloud.points[idx];
 
-      x_trans = Eigen::Vector3d (x_trans_pt.x, x_trans_pt.y, x_trans_pt.z);
+        // Find neighbors (Radius search has been experimentally faster than direct neighbor checking.
+        findNeighborhood (x_trans_pt, neighborhood, distances);
+        if (neighborhood.empty ())
+          continue;
 
-      // Denorm point, x_k' in Equations 6.12 and 6.13 [Magnusson 2009]
-      x_trans -= cell->getMean ();
-      // Uses precomputed covariance for speed.
-      c_inv = cell->getInverseCov ();
+        // Original Point and Transformed Point (for math)
+        const PointSource &x_pt = input_->points[idx];
+        const Eigen::Vector3d x (x_pt.x, x_pt.y, x_pt.z);
 
-      // Compute derivative of transform function w.r.t. transform vector, J_E and H_E in Equations 6.18 and 6.20 [Magnusson 2009]
-      computePointDerivatives (x);
-      // Update score, gradient and hessian, lines 19-21 in Algorithm 2, according to Equations 6.10, 6.12 and 6.13, respectively [Magnusson 2009]
-      score += updateDerivatives (score_gradient, hessian, x_trans, c_inv, compute_hessian);
+        // Compute derivative of transform function w.r.t. transform vector, J_E and H_E in Equations 6.18 and 6.20 [Magnusson 2009]
+        computePointDerivatives (x, point_gradient, point_hessian);
 
+        for (typename std::vector<TargetGridLeafConstPtr>::const_iterator neighborhood_it = neighborhood.begin (); neighborhood_it != neighborhood.end (); ++neighborhood_it)
+        {
+          TargetGridLeafConstPtr cell = *neighborhood_it;
+
+          // Denorm point, x_k' in Equations 6.12 and 6.13 [Magnusson 2009]
+          const Eigen::Vector3d x_trans = Eigen::Vector3d (x_trans_pt.x, x_trans_pt.y, x_trans_pt.z) - cell->getMean ();
+
+          // Update score, gradient and hessian, lines 19-21 in Algorithm 2, according to Equations 6.10, 6.12 and 6.13, respectively [Magnusson 2009]
+          // Uses precomputed covariance for speed.
+          block_scores[b] += updateDerivatives (block_gradients[b], block_hessians[b], point_gradient, point_hessian,
+                                                x_trans, cell->getInverseCov (), compute_hessian);
+        }
+      }
     }
   }
+
+  for (int b = 0; b < nr_blocks; ++b)
+  {
+    score += block_scores[b];
+    score_gradient += block_gradients[b];
+    hessian += block_hessians[b];
+  }
   return (score);
 }
 
@@ -314,17 +362,27 @@ pcl::NormalDistributionsTransform<PointSource, PointTarget>::computeAngleDerivat
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 template<typename PointSource, typename PointTarget> void
 pcl::NormalDistributionsTransform<PointSource, PointTarget>::computePointDerivatives (Eigen::Vector3d &x, bool compute_hessian)
+{
+  computePointDerivatives (x, point_gradient_, point_hessian_, compute_hessian);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template<typename PointSource, typename PointTarget> void
+pcl::NormalDistributionsTransform<PointSource, PointTarget>::computePointDerivatives (const Eigen::Vector3d &x,
+                                                                                      Eigen::Matrix<double, 3, 6> &point_gradient,
+                                                                                      Eigen::Matrix<double, 18, 6> &point_hessian,
+                                                                                      bool compute_hessian) const
 {
   // Calculate first derivative of Transformation Equation 6.17 w.r.t. transform vector p.
   // Derivative w.r.t. ith element of transform vector corresponds to column i, Equation 6.18 and 6.19 [Magnusson 2009]
-  point_gradient_ (1, 3) = x.dot (j_ang_a_);
-  point_gradient_ (2, 3) = x.dot (j_ang_b_);
-  point_gradient_ (0, 4) = x.dot (j_ang_c_);
-  point_gradient_ (1, 4) = x.dot (j_ang_d_);
-  point_gradient_ (2, 4) = x.dot (j_ang_e_);
-  point_gradient_ (0, 5) = x.dot (j_ang_f_);
-  point_gradient_ (1, 5) = x.dot (j_ang_g_);
-  point_gradient_ (2, 5) = x.dot (j_ang_h_);
+  point_gradient (1, 3) = x.dot (j_ang_a_);
+  point_gradient (2, 3) = x.dot (j_ang_b_);
+  point_gradient (0, 4) = x.dot (j_ang_c_);
+  point_gradient (1, 4) = x.dot (j_ang_d_);
+  point_gradient (2, 4) = x.dot (j_ang_e_);
+  point_gradient (0, 5) = x.dot (j_ang_f_);
+  point_gradient (1, 5) = x.dot (j_ang_g_);
+  point_gradient (2, 5) = x.dot (j_ang_h_);
 
   if (compute_hessian)
   {
@@ -340,15 +398,15 @@ pcl::NormalDistributionsTransform<PointSource, PointTarget>::computePointDerivat
 
     // Calculate second derivative of Transformation Equation 6.17 w.r.t. transform vector p.
     // Derivative w.r.t. ith and jth elements of transform vector corresponds to the 3x1 block matrix starting at (3i,j), Equation 6.20 and 6.21 [Magnusson 2009]
-    point_hessian_.block<3, 1>(9, 3) = a;
-    point_hessian_.block<3, 1>(12, 3) = b;
-    point_hessian_.block<3, 1>(15, 3) = c;
-    point_hessian_.block<3, 1>(9, 4) = b;
-    point_hessian_.block<3, 1>(12, 4) = d;
-    point_hessian_.block<3, 1>(15, 4) = e;
-    point_hessian_.block<3, 1>(9, 5) = c;
-    point_hessian_.block<3, 1>(12, 5) = e;
-    point_hessian_.block<3, 1>(15, 5) = f;
+    point_hessian.block<3, 1>(9, 3) = a;
+    point_hessian.block<3, 1>(12, 3) = b;
+    point_hessian.block<3, 1>(15, 3) = c;
+    point_hessian.block<3, 1>(9, 4) = b;
+    point_hessian.block<3, 1>(12, 4) = d;
+    point_hessian.block<3, 1>(15, 4) = e;
+    point_hessian.block<3, 1>(9, 5) = c;
+    point_hessian.block<3, 1>(12, 5) = e;
+    point_hessian.block<3, 1>(15, 5) = f;
   }
 }
 
@@ -358,6 +416,18 @@ pcl::NormalDistributionsTransform<PointSource, PointTarget>::updateDerivatives (
                                                                                 Eigen::Matrix<double, 6, 6> &hessian,
                                                                                 Eigen::Vector3d &x_trans, Eigen::Matrix3d &c_inv,
                                                                                 bool compute_hessian)
+{
+  return (updateDerivatives (score_gradient, hessian, point_gradient_, point_hessian_, x_trans, c_inv, compute_hessian));
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template<typename PointSource, typename PointTarget> double
+pcl::NormalDistributionsTransform<PointSource, PointTarget>::updateDerivatives (Eigen::Matrix<double, 6, 1> &score_gradient,
+                                                                                Eigen::Matrix<double, 6, 6> &hessian,
+                                                                                const Eigen::Matrix<double, 3, 6> &point_gradient,
+                                                                                const Eigen::Matrix<double, 18, 6> &point_hessian,
+                                                                                const Eigen::Vector3d &x_trans, const Eigen::Matrix3d &c_inv,
+                                                                                bool compute_hessian) const
 {
   Eigen::Vector3d cov_dxd_pi;
   // e^(-d_2/2 * (x_k - mu_k)^T Sigma_k^-1 (x_k - mu_k)) Equation 6.9 [Magnusson 2009]
@@ -378,7 +448,7 @@ pcl::NormalDistributionsTransform<PointSource, PointTarget>::updateDerivatives (
   for (int i = 0; i < 6; i++)
   {
     // Sigma_k^-1 d(T(x,p))/dpi, Reusable portion of Equation 6.12 and 6.13 [Magnusson 2009]
-    cov_dxd_pi = c_inv * point_gradient_.col (i);
+    cov_dxd_pi = c_inv * point_gradient.col (i);
 
     // Update gradient, Equation 6.12 [Magnusson 2009]
     score_gradient (i) += x_trans.dot (cov_dxd_pi) * e_x_cov_x;
@@ -388,9 +458,9 @@ pcl::NormalDistributionsTransform<PointSource, PointTarget>::updateDerivatives (
       for (int j = 0; j < hessian.cols (); j++)
       {
         // Update hessian, Equation 6.13 [Magnusson 2009]
-        hessian (i, j) += e_x_cov_x * (-gauss_d2_ * x_trans.dot (cov_dxd_pi) * x_trans.dot (c_inv * point_gradient_.col (j)) +
-                                    x_trans.dot (c_inv * point_hessian_.block<3, 1>(3 * i, j)) +
-                                    point_gradient_.col (j).dot (cov_dxd_pi) );
+        hessian (i, j) += e_x_cov_x * (-gauss_d2_ * x_trans.dot (cov_dxd_pi) * x_trans.dot (c_inv * point_gradient.col (j)) +
+                                    x_trans.dot (c_inv * point_hessian.block<3, 1>(3 * i, j)) +
+                                    point_gradient.col (j).dot (cov_dxd_pi) );
       }
     }
   }
@@ -403,56 +473,81 @@ template<typename PointSource, typename PointTarget> void
 pcl::NormalDistributionsTransform<PointSource, PointTarget>::computeHessian (Eigen::Matrix<double, 6, 6> &hessian,
                                                                              PointCloudSource &trans_cloud, Eigen::Matrix<double, 6, 1> &)
 {
-  // Original Point and Transformed Point
-  PointSource x_pt, x_trans_pt;
-  // Original Point and Transformed Point (for math)
-  Eigen::Vector3d x, x_trans;
-  // Occupied Voxel
-  TargetGridLeafConstPtr cell;
-  // Inverse Covariance of Occupied Voxel
-  Eigen::Matrix3d c_inv;
+  using pcl::registration::detail::NDT_BLOCK_SIZE;
 
   hessian.setZero ();
 
   // Precompute Angular Derivatives unessisary because only used after regular derivative calculation
 
+  // Partial sums of each block of points
+  const int nr_points = static_cast<int> (input_->points.size ());
+  const int nr_blocks = (nr_points + NDT_BLOCK_SIZE - 1) / NDT_BLOCK_SIZE;
+  std::vector<Eigen::Matrix<double, 6, 6>, Eigen::aligned_allocator<Eigen::Matrix<double, 6, 6> > >
+    block_hessians (nr_blocks, Eigen::Matrix<double, 6, 6>::Zero ());
+
   // Update hessian for each point, line 17 in Algorithm 2 [Magnusson 2009]
-  for (size_t idx = 0; idx < input_->points.size (); idx++)
+#ifdef _OPENMP
+  const int nr_threads = threads_ == 0 ? omp_get_num_procs () : static_cast<int> (threads_);
+#pragma omp parallel num_threads(nr_threads)
+#endif
   {
-    x_trans_pt = trans_cloud.points[idx];
-
-    // Find nieghbors (Radius search has been experimentally faster than direct neighbor checking.
+    Eigen::Matrix<double, 3, 6> point_gradient = point_gradient_;
+    Eigen::Matrix<double, 18, 6> point_hessian = point_hessian_;
     std::vector<TargetGridLeafConstPtr> neighborhood;
     std::vector<float> distances;
-    target_cells_.radiusSearch (x_trans_pt, resolution_, neighborhood, distances);
 
-    for (typename std::vector<TargetGridLeafConstPtr>::iterator neighborhood_it = neighborhood.begin (); neighborhood_it != neighborhood.end (); neighborhood_it++)
+#ifdef _OPENMP
+#pragma omp for schedule(dynamic, 1)
+#endif
+    for (int b = 0; b < nr_blocks; ++b)
     {
-      cell = *neighborhood_it;
-
+      const int end = std::min (nr_points, (b + 1) * NDT_BLOCK_SIZE);
+      for (int idx = b * NDT_BLOCK_SIZE; idx < end; ++idx)
       {
-        x_pt = input_->points[idx];
-        x = Eigen::Vector3d (x_pt.x, x_pt.y, x_pt.z);
+        const PointSource &x_trans_pt = trans_cloud.points[idx];
 
-        x_trans = Eigen::Vector3d (x_trans_pt.x, x_trans_pt.y, x_trans_pt.z);
+        // Find neighbors (Radius search has been experimentally faster than direct neighbor checking.
+        findNeighborhood (x_trans_pt, neighborhood, distances);
+        if (neighborhood.empty ())
+          continue;
 
-        // Denorm point, x_k' in Equations 6.12 and 6.13 [Magnusson 2009]
-        x_trans -= cell->getMean ();
-        // Uses precomputed covariance for speed.
-        c_inv = cell->getInverseCov ();
+        const PointSource &x_pt = input_->points[idx];
+        const Eigen::Vector3d x (x_pt.x, x_pt.y, x_pt.z);
 
         // Compute derivative of transform function w.r.t. transform vector, J_E and H_E in Equations 6.18 and 6.20 [Magnusson 2009]
-        computePointDerivatives (x);
-        // Update hessian, lines 21 in Algorithm 2, according to Equations 6.10, 6.12 and 6.13, respectively [Magnusson 2009]
-        updateHessian (hessian, x_trans, c_inv);
+        computePointDerivatives (x, point_gradient, point_hessian);
+
+        for (typename std::vector<TargetGridLeafConstPtr>::const_iterator neighborhood_it = neighborhood.begin (); neighborhood_it != neighborhood.end (); ++neighborhood_it)
+        {
+          TargetGridLeafConstPtr cell = *neighborhood_it;
+
+          // Denorm point, x_k' in Equations 6.12 and 6.13 [Magnusson 2009]
+          const Eigen::Vector3d x_trans = Eigen::Vector3d (x_trans_pt.x, x_trans_pt.y, x_trans_pt.z) - cell->getMean ();
+
+          // Update hessian, lines 21 in Algorithm 2, according to Equations 6.10, 6.12 and 6.13, respectively [Magnusson 2009]
+          updateHessian (block_hessians[b], point_gradient, point_hessian, x_trans, cell->getInverseCov ());
+        }
       }
     }
   }
+
+  for (int b = 0; b < nr_blocks; ++b)
+    hessian += block_hessians[b];
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 template<typename PointSource, typename PointTarget> void
 pcl::NormalDistributionsTransform<PointSource, PointTarget>::updateHessian (Eigen::Matrix<double, 6, 6> &hessian, Eigen::Vector3d &x_trans, Eigen::Matrix3d &c_inv)
+{
+  updateHessian (hessian, point_gradient_, point_hessian_, x_trans, c_inv);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template<typename PointSource, typename PointTarget> void
+pcl::NormalDistributionsTransform<PointSource, PointTarget>::updateHessian (Eigen::Matrix<double, 6, 6> &hessian,
+                                                                            const Eigen::Matrix<double, 3, 6> &point_gradient,
+                                                                            const Eigen::Matrix<double, 18, 6> &point_hessian,
+                                                                            const Eigen::Vector3d &x_trans, const Eigen::Matrix3d &c_inv) const
 {
   Eigen::Vector3d cov_dxd_pi;
   // e^(-d_2/2 * (x_k - mu_k)^T Sigma_k^-1 (x_k - mu_k)) Equation 6.9 [Magnusson 2009]
@@ -468,14 +563,14 @@ pcl::NormalDistributionsTransform<PointSource, PointTarget>::updateHessian (Eige
   for (int i = 0; i < 6; i++)
   {
     // Sigma_k^-1 d(T(x,p))/dpi, Reusable portion of Equation 6.12 and 6.13 [Magnusson 2009]
-    cov_dxd_pi = c_inv * point_gradient_.col (i);
+    cov_dxd_pi = c_inv * point_gradient.col (i);
 
     for (int j = 0; j < hessian.cols (); j++)
     {
       // Update hessian, Equation 6.13 [Magnusson 2009]
-      hessian (i, j) += e_x_cov_x * (-gauss_d2_ * x_trans.dot (cov_dxd_pi) * x_trans.dot (c_inv * point_gradient_.col (j)) +
-                                  x_trans.dot (c_inv * point_hessian_.block<3, 1>(3 * i, j)) +
-                                  point_gradient_.col (j).dot (cov_dxd_pi) );
+      hessian (i, j) += e_x_cov_x * (-gauss_d2_ * x_trans.dot (cov_dxd_pi) * x_trans.dot (c_inv * point_gradient.col (j)) +
+                                  x_trans.dot (c_inv * point_hessian.block<3, 1>(3 * i, j)) +
+                                  point_gradient.col (j).dot (cov_dxd_pi) );
     }
   }
 
@@ -90,6 +90,19 @@ namespace pcl
       typedef boost::shared_ptr< NormalDistributionsTransform<PointSource, PointTarget> > Ptr;
       typedef boost::shared_ptr< const NormalDistributionsTransform<PointSource, PointTarget> > ConstPtr;
 
+      /** \brief Methods to find the target voxels a transformed source point is scored against. */
+      enum NeighborSearchMethod
+      {
+        /** \brief Voxels whose centroid lies within one resolution, found with a kd-tree over the centroids (default). */
+        KDTREE,
+        /** \brief The voxel containing the point and its 26 neighbors, looked up directly. */
+        DIRECT26,
+        /** \brief The voxel containing the point and its 6 face neighbors, looked up directly. */
+        DIRECT7,
+        /** \brief Only the voxel containing the point. */
+        DIRECT1
+      };
+
 
       /** \brief Constructor.
         * Sets \ref outlier_ratio_ to 0.35, \ref step_size_ to 0.05 and \ref resolution_ to 1.0
@@ -169,6 +182,60 @@ namespace pcl
         outlier_ratio_ = outlier_ratio;
       }
 
+      /** \brief Set the method used to find the target voxels a transformed source point is scored against.
+        * The direct methods look the voxels up in constant time instead of searching a kd-tree, DIRECT7 and
+        * DIRECT1 are much faster but need a closer initial guess.
+        * \param[in] method the neighbor search method (default: KDTREE)
+        */
+      inline void
+      setNeighborSearchMethod (NeighborSearchMethod method)
+      {
+        search_method_ = method;
+      }
+
+      /** \brief Get the method used to find the target voxels a transformed source point is scored against. */
+      inline NeighborSearchMethod
+      getNeighborSearchMethod () const
+      {
+        return (search_method_);
+      }
+
+      /** \brief Set the number of threads used to build the target voxels and to evaluate the score and its derivatives.
+        * The results do not depend on the number of threads.
+        * \param[in] nr_threads the number of hardware threads to use (0 sets the value back to automatic)
+        */
+      inline void
+      setNumberOfThreads (unsigned int nr_threads = 0)
+      {
+        threads_ = nr_threads;
+        target_cells_.setNumberOfThreads (nr_threads);
+      }
+
+      /** \brief Save the voxel structure built from the input target, so that it can be reused with loadTargetCells ().
+        * \param[in] file_name the name of the file to write
+        * \return true if the file was written successfully
+        */
+      inline bool
+      saveTargetCells (const std::string &file_name) const
+      {
+        return (target_cells_.saveLeaves (file_name));
+      }
+
+      /** \brief Use a voxel structure saved with saveTargetCells () as the target instead of building it from a cloud.
+        * The resolution is taken from the file and the voxel centroids become the input target.
+        * \param[in] file_name the name of the file to read
+        * \return true if the file was read successfully
+        */
+      inline bool
+      loadTargetCells (const std::string &file_name)
+      {
+        if (!target_cells_.loadLeaves (file_name, true))
+          return (false);
+        resolution_ = target_cells_.getLeafSize ()[0];
+        Registration<PointSource, PointTarget>::setInputTarget (target_cells_.getCentroids ());
+        return (true);
+      }
+
       /** \brief Get the registration alignment probability.
         * \return transformation probability
         */
@@ -287,6 +354,24 @@ namespace pcl
                          Eigen::Vector3d &x_trans, Eigen::Matrix3d &c_inv,
                          bool compute_hessian = true);
 
+      /** \brief Compute individual point contirbutions to derivatives of probability function w.r.t. the transformation
+        * vector, using the given point derivatives instead of \ref point_gradient_ and \ref point_hessian_.
+        * \param[in,out] score_gradient the gradient vector of the probability function w.r.t. the transformation vector
+        * \param[in,out] hessian the hessian matrix of the probability function w.r.t. the transformation vector
+        * \param[in] point_gradient the first order derivative of the transformation of the point
+        * \param[in] point_hessian the second order derivative of the transformation of the point
+        * \param[in] x_trans transformed point minus mean of occupied covariance voxel
+        * \param[in] c_inv covariance of occupied covariance voxel
+        * \param[in] compute_hessian flag to calculate hessian, unnessissary for step calculation.
+        */
+      double
+      updateDerivatives (Eigen::Matrix<double, 6, 1> &score_gradient,
+                         Eigen::Matrix<double, 6, 6> &hessian,
+                         const Eigen::Matrix<double, 3, 6> &point_gradient,
+                         const Eigen::Matrix<double, 18, 6> &point_hessian,
+                         const Eigen::Vector3d &x_trans, const Eigen::Matrix3d &c_inv,
+                         bool compute_hessian = true) const;
+
       /** \brief Precompute anglular components of derivatives.
         * \note Equation 6.19 and 6.21 [Magnusson 2009].
         * \param[in] p the current transform vector
@@ -303,6 +388,19 @@ namespace pcl
       void
       computePointDerivatives (Eigen::Vector3d &x, bool compute_hessian = true);
 
+      /** \brief Compute point derivatives into the given matrices instead of \ref point_gradient_ and \ref point_hessian_.
+        * \note Equation 6.18-21 [Magnusson 2009].
+        * \param[in] x point from the input cloud
+        * \param[in,out] point_gradient the first order derivative of the transformation of the point
+        * \param[in,out] point_hessian the second order derivative of the transformation of the point
+        * \param[in] compute_hessian flag to calculate hessian, unnessissary for step calculation.
+        */
+      void
+      computePointDerivatives (const Eigen::Vector3d &x,
+                               Eigen::Matrix<double, 3, 6> &point_gradient,
+                               Eigen::Matrix<double, 18, 6> &point_hessian,
+                               bool compute_hessian = true) const;
+
       /** \brief Compute hessian of probability function w.r.t. the transformation vector.
         * \note Equation 6.13 [Magnusson 2009].
         * \param[out] hessian the hessian matrix of the probability function w.r.t. the transformation vector
@@ -324,6 +422,47 @@ namespace pcl
       updateHessian (Eigen::Matrix<double, 6, 6> &hessian,
                      Eigen::Vector3d &x_trans, Eigen::Matrix3d &c_inv);
 
+      /** \brief Compute individual point contirbutions to hessian of probability function w.r.t. the transformation vector,
+        * using the given point derivatives instead of \ref point_gradient_ and \ref point_hessian_.
+        * \note Equation 6.13 [Magnusson 2009].
+        * \param[in,out] hessian the hessian matrix of the probability function w.r.t. the transformation vector
+        * \param[in] point_gradient the first order derivative of the transformation of the point
+        * \param[in] point_hessian the second order derivative of the transformation of the point
+        * \param[in] x_trans transformed point minus mean of occupied covariance voxel
+        * \param[in] c_inv covariance of occupied covariance voxel
+        */
+      void
+      updateHessian (Eigen::Matrix<double, 6, 6> &hessian,
+                     const Eigen::Matrix<double, 3, 6> &point_gradient,
+                     const Eigen::Matrix<double, 18, 6> &point_hessian,
+                     const Eigen::Vector3d &x_trans, const Eigen::Matrix3d &c_inv) const;
+
+      /** \brief Find the target voxels a transformed source point is scored against, see setNeighborSearchMethod ().
+        * \param[in] x_trans_pt the transformed source point
+        * \param[out] neighborhood the voxels found
+        * \param[out] distances scratch space for the kd-tree search
+        */
+      inline void
+      findNeighborhood (const PointSource &x_trans_pt, std::vector<TargetGridLeafConstPtr> &neighborhood,
+                        std::vector<float> &distances)
+      {
+        switch (search_method_)
+        {
+          case DIRECT26:
+            target_cells_.getAllNeighborsAtPoint (x_trans_pt, neighborhood);
+            break;
+          case DIRECT7:
+            target_cells_.getFaceNeighborsAtPoint (x_trans_pt, neighborhood);
+            break;
+          case DIRECT1:
+            target_cells_.getVoxelAtPoint (x_trans_pt, neighborhood);
+            break;
+          default:
+            target_cells_.radiusSearch (x_trans_pt, resolution_, neighborhood, distances);
+            break;
+        }
+      }
+
       /** \brief Compute line search step length and update transform and probability derivatives using More-Thuente method.
         * \note Search Algorithm [More, Thuente 1994]
         * \param[in] x initial transformation vector, \f$ x \f$ in Equation 1.3 (Moore, Thuente 1994) and \f$ \vec{p} \f$ in Algorithm 2 [Magnusson 2009]
@@ -458,6 +597,12 @@ namespace pcl
       /** \brief The second order derivative of the transformation of a point w.r.t. the transform vector, \f$ H_E \f$ in Equation 6.20 [Magnusson 2009]. */
       Eigen::Matrix<double, 18, 6> point_hessian_;
 
+      /** \brief The method used to find the target voxels of a transformed source point. */
+      NeighborSearchMethod search_method_;
+
+      /** \brief The number of threads used to evaluate the score and its derivatives. */
+      unsigned int threads_;
+
     public:
       EIGEN_MAKE_ALIGNED_OPERATOR_NEW
 
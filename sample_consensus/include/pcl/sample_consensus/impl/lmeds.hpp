@@ -69,64 +69,72 @@ pcl::LeastMedianSquares<PointT>::computeModel (int debug_verbosity_level)
   const unsigned max_skip = max_iterations_ * 10;
   
   // Iterate
-  while (iterations_ < max_iterations_ && skipped_count < max_skip)
+  const int nr_threads = this->getNumberOfThreadsToUse ();
+  if (nr_threads > 1)
   {
-    // Get X samples which satisfy the model criteria
-    sac_model_->getSamples (iterations_, selection);
+    computeModelParallel (nr_threads, debug_verbosity_level);
+  }
+  else
+  {
+    while (iterations_ < max_iterations_ && skipped_count < max_skip)
+    {
+      // Get X samples which satisfy the model criteria
+      sac_model_->getSamples (iterations_, selection);
 
-    if (selection.empty ()) break;
+      if (selection.empty ()) break;
 
-    // Search for inliers in the point cloud for the current plane model M
-    if (!sac_model_->computeModelCoefficients (selection, model_coefficients))
-    {
-      //iterations_++;
-      ++skipped_count;
-      continue;
-    }
+      // Search for inliers in the point cloud for the current plane model M
+      if (!sac_model_->computeModelCoefficients (selection, model_coefficients))
+      {
+        //iterations_++;
+        ++skipped_count;
+        continue;
+      }
 
-    double d_cur_penalty = 0;
-    // d_cur_penalty = sum (min (dist, threshold))
+      double d_cur_penalty = 0;
+      // d_cur_penalty = sum (min (dist, threshold))
 
-    // Iterate through the 3d points and calculate the distances from them to the model
-    sac_model_->getDistancesToModel (model_coefficients, distances);
+      // Iterate through the 3d points and calculate the distances from them to the model
+      sac_model_->getDistancesToModel (model_coefficients, distances);
     
-    // No distances? The model must not respect the user given constraints
-    if (distances.empty ())
-    {
-      //iterations_++;
-      ++skipped_count;
-      continue;
-    }
+      // No distances? The model must not respect the user given constraints
+      if (distances.empty ())
+      {
+        //iterations_++;
+        ++skipped_count;
+        continue;
+      }
 
-    std::sort (distances.begin (), distances.end ());
-    // d_cur_penalty = median (distances)
-    size_t mid = sac_model_->getIndices ()->size () / 2;
-    if (mid >= distances.size ())
-    {
-      //iterations_++;
-      ++skipped_count;
-      continue;
-    }
+      std::sort (distances.begin (), distances.end ());
+      // d_cur_penalty = median (distances)
+      size_t mid = sac_model_->getIndices ()->size () / 2;
+      if (mid >= distances.size ())
+      {
+        //iterations_++;
+        ++skipped_count;
+        continue;
+      }
 
-    // Do we have a "middle" point or should we "estimate" one ?
-    if (sac_model_->getIndices ()->size () % 2 == 0)
-      d_cur_penalty = (sqrt (distances[mid-1]) + sqrt (distances[mid])) / 2;
-    else
-      d_cur_penalty = sqrt (distances[mid]);
+      // Do we have a "middle" point or should we "estimate" one ?
+      if (sac_model_->getIndices ()->size () % 2 == 0)
+        d_cur_penalty = (sqrt (distances[mid-1]) + sqrt (distances[mid])) / 2;
+      else
+        d_cur_penalty = sqrt (distances[mid]);
 
-    // Better match ?
-    if (d_cur_penalty < d_best_penalty)
-    {
-      d_best_penalty = d_cur_penalty;
+      // Better match ?
+      if (d_cur_penalty < d_best_penalty)
+      {
+        d_best_penalty = d_cur_penalty;
 
-      // Save the current model/coefficients selection as being the best so far
-      model_              = selection;
-      model_coefficients_ = model_coefficients;
-    }
+        // Save the current model/coefficients selection as being the best so far
+        model_              = selection;
+        model_coefficients_ = model_coefficients;
+      }
 
-    ++iterations_;
-    if (debug_verbosity_level > 1)
-      PCL_DEBUG ("[pcl::LeastMedianSquares::computeModel] Trial %d out of %d. Best penalty is %f.\n", iterations_, max_iterations_, d_best_penalty);
+      ++iterations_;
+      if (debug_verbosity_level > 1)
+        PCL_DEBUG ("[pcl::LeastMedianSquares::computeModel] Trial %d out of %d. Best penalty is %f.\n", iterations_, max_iterations_, d_best_penalty);
+    }
   }
 
   if (model_.empty ())
@@ -175,6 +183,93 @@ pcl::LeastMedianSquares<PointT>::computeModel (int debug_verbosity_level)
   return (true);
 }
 
+//////////////////////////////////////////////////////////////////////////
+template <typename PointT> void
+pcl::LeastMedianSquares<PointT>::computeModelParallel (int nr_threads, int debug_verbosity_level)
+{
+  double d_best_penalty = std::numeric_limits<double>::max();
+
+  unsigned skipped_count = 0;
+  // suppress infinite loops by just allowing 10 x maximum allowed iterations for invalid model parameters!
+  const unsigned max_skip = max_iterations_ * 10;
+
+  const size_t nr_indices = sac_model_->getIndices ()->size ();
+
+  // Every thread draws its samples from its own random stream
+  std::vector<boost::mt19937> rngs;
+  std::vector<std::vector<int> > shuffled_indices;
+  this->initRandomStreams (nr_threads, rngs, shuffled_indices);
+
+  std::vector<std::vector<int> > selections (nr_threads);
+  std::vector<Eigen::VectorXf> coefficients (nr_threads);
+  std::vector<char> valid (nr_threads);
+  std::vector<double> penalties (nr_threads);
+
+  bool stop = false;
+  while (!stop && iterations_ < max_iterations_ && skipped_count < max_skip)
+  {
+    // Draw and evaluate one hypothesis per thread
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static, 1) num_threads(nr_threads)
+#endif
+    for (int t = 0; t < nr_threads; ++t)
+    {
+      std::vector<double> distances;
+      valid[t] = false;
+      sac_model_->getSamples (rngs[t], shuffled_indices[t], selections[t]);
+      if (selections[t].empty () || !sac_model_->computeModelCoefficients (selections[t], coefficients[t]))
+        continue;
+
+      // Iterate through the 3d points and calculate the distances from them to the model
+      sac_model_->getDistancesToModel (coefficients[t], distances);
+
+      // No distances? The model must not respect the user given constraints
+      size_t mid = nr_indices / 2;
+      if (distances.empty () || mid >= distances.size ())
+        continue;
+
+      // d_cur_penalty = median (distances)
+      std::sort (distances.begin (), distances.end ());
+      // Do we have a "middle" point or should we "estimate" one ?
+      if (nr_indices % 2 == 0)
+        penalties[t] = (sqrt (distances[mid-1]) + sqrt (distances[mid])) / 2;
+      else
+        penalties[t] = sqrt (distances[mid]);
+      valid[t] = true;
+    }
+
+    // Merge the hypotheses in stream order, so that the result does not depend on the scheduling
+    for (int t = 0; t < nr_threads && iterations_ < max_iterations_ && skipped_count < max_skip; ++t)
+    {
+      if (selections[t].empty ())
+      {
+        stop = true;
+        break;
+      }
+
+      if (!valid[t])
+      {
+        ++skipped_count;
+        continue;
+      }
+
+      // Better match ?
+      if (penalties[t] < d_best_penalty)
+      {
+        d_best_penalty = penalties[t];
+
+        // Save the current model/coefficients selection as being the best so far
+        model_              = selections[t];
+        model_coefficients_ = coefficients[t];
+      }
+
+      ++iterations_;
+      if (debug_verbosity_level > 1)
+        PCL_DEBUG ("[pcl::LeastMedianSquares::computeModel] Trial %d out of %d. Best penalty is %f.\n", iterations_, max_iterations_, d_best_penalty);
+    }
+  }
+}
+
 #define PCL_INSTANTIATE_LeastMedianSquares(T) template class PCL_EXPORTS pcl::LeastMedianSquares<T>;
 
 #endif    // PCL_SAMPLE_CONSENSUS_IMPL_LMEDS_H_
@@ -82,91 +82,99 @@ pcl::MaximumLikelihoodSampleConsensus<PointT>::computeModel (int debug_verbosity
   const unsigned max_skip = max_iterations_ * 10;
   
   // Iterate
-  while (iterations_ < k && skipped_count < max_skip)
+  const int nr_threads = this->getNumberOfThreadsToUse ();
+  if (nr_threads > 1)
   {
-    // Get X samples which satisfy the model criteria
-    sac_model_->getSamples (iterations_, selection);
-
-    if (selection.empty ()) break;
-
-    // Search for inliers in the point cloud for the current plane model M
-    if (!sac_model_->computeModelCoefficients (selection, model_coefficients))
-    {
-      //iterations_++;
-      ++ skipped_count;
-      continue;
-    }
-
-    // Iterate through the 3d points and calculate the distances from them to the model
-    sac_model_->getDistancesToModel (model_coefficients, distances);
-
-    if (distances.empty ())
+    computeModelParallel (nr_threads, v, debug_verbosity_level);
+  }
+  else
+  {
+    while (iterations_ < k && skipped_count < max_skip)
     {
-      //iterations_++;
-      ++skipped_count;
-      continue;
-    }
+      // Get X samples which satisfy the model criteria
+      sac_model_->getSamples (iterations_, selection);
+
+      if (selection.empty ()) break;
+
+      // Search for inliers in the point cloud for the current plane model M
+      if (!sac_model_->computeModelCoefficients (selection, model_coefficients))
+      {
+        //iterations_++;
+        ++ skipped_count;
+        continue;
+      }
+
+      // Iterate through the 3d points and calculate the distances from them to the model
+      sac_model_->getDistancesToModel (model_coefficients, distances);
+
+      if (distances.empty ())
+      {
+        //iterations_++;
+        ++skipped_count;
+        continue;
+      }
     
-    // Use Expectiation-Maximization to find out the right value for d_cur_penalty
-    // ---[ Initial estimate for the gamma mixing parameter = 1/2
-    double gamma = 0.5;
-    double p_outlier_prob = 0;
-
-    indices_size = sac_model_->getIndices ()->size ();
-    std::vector<double> p_inlier_prob (indices_size);
-    for (int j = 0; j < iterations_EM_; ++j)
-    {
-      // Likelihood of a datum given that it is an inlier
-      for (size_t i = 0; i < indices_size; ++i)
-        p_inlier_prob[i] = gamma * exp (- (distances[i] * distances[i] ) / 2 * (sigma_ * sigma_) ) /
-                           (sqrt (2 * M_PI) * sigma_);
-
-      // Likelihood of a datum given that it is an outlier
-      p_outlier_prob = (1 - gamma) / v;
-
-      gamma = 0;
+      // Use Expectiation-Maximization to find out the right value for d_cur_penalty
+      // ---[ Initial estimate for the gamma mixing parameter = 1/2
+      double gamma = 0.5;
+      double p_outlier_prob = 0;
+
+      indices_size = sac_model_->getIndices ()->size ();
+      std::vector<double> p_inlier_prob (indices_size);
+      for (int j = 0; j < iterations_EM_; ++j)
+      {
+        // Likelihood of a datum given that it is an inlier
+        for (size_t i = 0; i < indices_size; ++i)
+          p_inlier_prob[i] = gamma * exp (- (distances[i] * distances[i] ) / 2 * (sigma_ * sigma_) ) /
+                             (sqrt (2 * M_PI) * sigma_);
+
+        // Likelihood of a datum given that it is an outlier
+        p_outlier_prob = (1 - gamma) / v;
+
+        gamma = 0;
+        for (size_t i = 0; i < indices_size; ++i)
+          gamma += p_inlier_prob [i] / (p_inlier_prob[i] + p_outlier_prob);
+        gamma /= static_cast<double>(sac_model_->getIndices ()->size ());
+      }
+
+      // Find the log likelihood of the model -L = -sum [log (pInlierProb + pOutlierProb)]
+      double d_cur_penalty = 0;
       for (size_t i = 0; i < indices_size; ++i)
-        gamma += p_inlier_prob [i] / (p_inlier_prob[i] + p_outlier_prob);
-      gamma /= static_cast<double>(sac_model_->getIndices ()->size ());
-    }
-
-    // Find the log likelihood of the model -L = -sum [log (pInlierProb + pOutlierProb)]
-    double d_cur_penalty = 0;
-    for (size_t i = 0; i < indices_size; ++i)
-      d_cur_penalty += log (p_inlier_prob[i] + p_outlier_prob);
-    d_cur_penalty = - d_cur_penalty;
-
-    // Better match ?
-    if (d_cur_penalty < d_best_penalty)
-    {
-      d_best_penalty = d_cur_penalty;
-
-      // Save the current model/coefficients selection as being the best so far
-      model_              = selection;
-      model_coefficients_ = model_coefficients;
-
-      n_inliers_count = 0;
-      // Need to compute the number of inliers for this model to adapt k
-      for (size_t i = 0; i < distances.size (); ++i)
-        if (distances[i] <= 2 * sigma_)
-          n_inliers_count++;
-
-      // Compute the k parameter (k=log(z)/log(1-w^n))
-      double w = static_cast<double> (n_inliers_count) / static_cast<double> (sac_model_->getIndices ()->size ());
-      double p_no_outliers = 1 - pow (w, static_cast<double> (selection.size ()));
-      p_no_outliers = (std::max) (std::numeric_limits<double>::epsilon (), p_no_outliers);       // Avoid division by -Inf
-      p_no_outliers = (std::min) (1 - std::numeric_limits<double>::epsilon (), p_no_outliers);   // Avoid division by 0.
-      k = log (1 - probability_) / log (p_no_outliers);
-    }
-
-    ++iterations_;
-    if (debug_verbosity_level > 1)
-      PCL_DEBUG ("[pcl::MaximumLikelihoodSampleConsensus::computeModel] Trial %d out of %d. Best penalty is %f.\n", iterations_, static_cast<int> (ceil (k)), d_best_penalty);
-    if (iterations_ > max_iterations_)
-    {
-      if (debug_verbosity_level > 0)
-        PCL_DEBUG ("[pcl::MaximumLikelihoodSampleConsensus::computeModel] MLESAC reached the maximum number of trials.\n");
-      break;
+        d_cur_penalty += log (p_inlier_prob[i] + p_outlier_prob);
+      d_cur_penalty = - d_cur_penalty;
+
+      // Better match ?
+      if (d_cur_penalty < d_best_penalty)
+      {
+        d_best_penalty = d_cur_penalty;
+
+        // Save the current model/coefficients selection as being the best so far
+        model_              = selection;
+        model_coefficients_ = model_coefficients;
+
+        n_inliers_count = 0;
+        // Need to compute the number of inliers for this model to adapt k
+        for (size_t i = 0; i < distances.size (); ++i)
+          if (distances[i] <= 2 * sigma_)
+            n_inliers_count++;
+
+        // Compute the k parameter (k=log(z)/log(1-w^n))
+        double w = static_cast<double> (n_inliers_count) / static_cast<double> (sac_model_->getIndices ()->size ());
+        double p_no_outliers = 1 - pow (w, static_cast<double> (selection.size ()));
+        p_no_outliers = (std::max) (std::numeric_limits<double>::epsilon (), p_no_outliers);       // Avoid division by -Inf
+        p_no_outliers = (std::min) (1 - std::numeric_limits<double>::epsilon (), p_no_outliers);   // Avoid division by 0.
+        k = log (1 - probability_) / log (p_no_outliers);
+      }
+
+      ++iterations_;
+      if (debug_verbosity_level > 1)
+        PCL_DEBUG ("[pcl::MaximumLikelihoodSampleConsensus::computeModel] Trial %d out of %d. Best penalty is %f.\n", iterations_, static_cast<int> (ceil (k)), d_best_penalty);
+      if (iterations_ > max_iterations_)
+      {
+        if (debug_verbosity_level > 0)
+          PCL_DEBUG ("[pcl::MaximumLikelihoodSampleConsensus::computeModel] MLESAC reached the maximum number of trials.\n");
+        break;
+      }
     }
   }
 
@@ -296,6 +304,132 @@ pcl::MaximumLikelihoodSampleConsensus<PointT>::computeMedian (
   median[3] = 0;
 }
 
+//////////////////////////////////////////////////////////////////////////
+template <typename PointT> void
+pcl::MaximumLikelihoodSampleConsensus<PointT>::computeModelParallel (int nr_threads, double v, int debug_verbosity_level)
+{
+  double d_best_penalty = std::numeric_limits<double>::max();
+  double k = 1.0;
+
+  unsigned skipped_count = 0;
+  // suppress infinite loops by just allowing 10 x maximum allowed iterations for invalid model parameters!
+  const unsigned max_skip = max_iterations_ * 10;
+
+  const size_t indices_size = sac_model_->getIndices ()->size ();
+
+  // Every thread draws its samples from its own random stream
+  std::vector<boost::mt19937> rngs;
+  std::vector<std::vector<int> > shuffled_indices;
+  this->initRandomStreams (nr_threads, rngs, shuffled_indices);
+
+  std::vector<std::vector<int> > selections (nr_threads);
+  std::vector<Eigen::VectorXf> coefficients (nr_threads);
+  std::vector<char> valid (nr_threads);
+  std::vector<double> penalties (nr_threads);
+  std::vector<int> inliers_counts (nr_threads);
+
+  bool stop = false;
+  while (!stop && iterations_ < k && skipped_count < max_skip)
+  {
+    // Draw and evaluate one hypothesis per thread
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static, 1) num_threads(nr_threads)
+#endif
+    for (int t = 0; t < nr_threads; ++t)
+    {
+      std::vector<double> distances;
+      valid[t] = false;
+      sac_model_->getSamples (rngs[t], shuffled_indices[t], selections[t]);
+      if (selections[t].empty () || !sac_model_->computeModelCoefficients (selections[t], coefficients[t]))
+        continue;
+
+      // Iterate through the 3d points and calculate the distances from them to the model
+      sac_model_->getDistancesToModel (coefficients[t], distances);
+      if (distances.empty ())
+        continue;
+      valid[t] = true;
+
+      // Use Expectiation-Maximization to find out the right value for d_cur_penalty
+      // ---[ Initial estimate for the gamma mixing parameter = 1/2
+      double gamma = 0.5;
+      double p_outlier_prob = 0;
+
+      std::vector<double> p_inlier_prob (indices_size);
+      for (int j = 0; j < iterations_EM_; ++j)
+      {
+        // Likelihood of a datum given that it is an inlier
+        for (size_t i = 0; i < indices_size; ++i)
+          p_inlier_prob[i] = gamma * exp (- (distances[i] * distances[i] ) / 2 * (sigma_ * sigma_) ) /
+                             (sqrt (2 * M_PI) * sigma_);
+
+        // Likelihood of a datum given that it is an outlier
+        p_outlier_prob = (1 - gamma) / v;
+
+        gamma = 0;
+        for (size_t i = 0; i < indices_size; ++i)
+          gamma += p_inlier_prob [i] / (p_inlier_prob[i] + p_outlier_prob);
+        gamma /= static_cast<double> (indices_size);
+      }
+
+      // Find the log likelihood of the model -L = -sum [log (pInlierProb + pOutlierProb)]
+      double d_cur_penalty = 0;
+      for (size_t i = 0; i < indices_size; ++i)
+        d_cur_penalty += log (p_inlier_prob[i] + p_outlier_prob);
+      penalties[t] = - d_cur_penalty;
+
+      int n_inliers_count = 0;
+      for (size_t i = 0; i < distances.size (); ++i)
+        if (distances[i] <= 2 * sigma_)
+          n_inliers_count++;
+      inliers_counts[t] = n_inliers_count;
+    }
+
+    // Merge the hypotheses in stream order, so that the result does not depend on the scheduling
+    for (int t = 0; t < nr_threads && iterations_ < k && skipped_count < max_skip; ++t)
+    {
+      if (selections[t].empty ())
+      {
+        stop = true;
+        break;
+      }
+
+      if (!valid[t])
+      {
+        ++skipped_count;
+        continue;
+      }
+
+      // Better match ?
+      if (penalties[t] < d_best_penalty)
+      {
+        d_best_penalty = penalties[t];
+
+        // Save the current model/coefficients selection as being the best so far
+        model_              = selections[t];
+        model_coefficients_ = coefficients[t];
+
+        // Compute the k parameter (k=log(z)/log(1-w^n))
+        double w = static_cast<double> (inliers_counts[t]) / static_cast<double> (indices_size);
+        double p_no_outliers = 1 - pow (w, static_cast<double> (selections[t].size ()));
+        p_no_outliers = (std::max) (std::numeric_limits<double>::epsilon (), p_no_outliers);       // Avoid division by -Inf
+        p_no_outliers = (std::min) (1 - std::numeric_limits<double>::epsilon (), p_no_outliers);   // Avoid division by 0.
+        k = log (1 - probability_) / log (p_no_outliers);
+      }
+
+      ++iterations_;
+      if (debug_verbosity_level > 1)
+        PCL_DEBUG ("[pcl::MaximumLikelihoodSampleConsensus::computeModel] Trial %d out of %d. Best penalty is %f.\n", iterations_, static_cast<int> (ceil (k)), d_best_penalty);
+      if (iterations_ > max_iterations_)
+      {
+        if (debug_verbosity_level > 0)
+          PCL_DEBUG ("[pcl::MaximumLikelihoodSampleConsensus::computeModel] MLESAC reached the maximum number of trials.\n");
+        stop = true;
+        break;
+      }
+    }
+  }
+}
+
 #define PCL_INSTANTIATE_MaximumLikelihoodSampleConsensus(T) template class PCL_EXPORTS pcl::MaximumLikelihoodSampleConsensus<T>;
 
 #endif    // PCL_SAMPLE_CONSENSUS_IMPL_MLESAC_H_
@@ -45,7 +45,7 @@
 
 //////////////////////////////////////////////////////////////////////////
 template <typename PointT> bool
-pcl::RandomSampleConsensus<PointT>::computeModel (int)
+pcl::RandomSampleConsensus<PointT>::computeModel (int debug_verbosity_level)
 {
   // Warn and exit if no threshold was set
   if (threshold_ == std::numeric_limits<double>::max())
@@ -70,55 +70,63 @@ pcl::RandomSampleConsensus<PointT>::computeModel (int)
   const unsigned max_skip = max_iterations_ * 10;
   
   // Iterate
-  while (iterations_ < k && skipped_count < max_skip)
+  const int nr_threads = this->getNumberOfThreadsToUse ();
+  if (nr_threads > 1)
   {
-    // Get X samples which satisfy the model criteria
-    sac_model_->getSamples (iterations_, selection);
-
-    if (selection.empty ()) 
-    {
-      PCL_ERROR ("[pcl::RandomSampleConsensus::computeModel] No samples could be selected!\n");
-      break;
-    }
-
-    // Search for inliers in the point cloud for the current plane model M
-    if (!sac_model_->computeModelCoefficients (selection, model_coefficients))
-    {
-      //++iterations_;
-      ++skipped_count;
-      continue;
-    }
-
-    // Select the inliers that are within threshold_ from the model
-    //sac_model_->selectWithinDistance (model_coefficients, threshold_, inliers);
-    //if (inliers.empty () && k > 1.0)
-    //  continue;
-
-    n_inliers_count = sac_model_->countWithinDistance (model_coefficients, threshold_);
-
-    // Better match ?
-    if (n_inliers_count > n_best_inliers_count)
-    {
-      n_best_inliers_count = n_inliers_count;
-
-      // Save the current model/inlier/coefficients selection as being the best so far
-      model_              = selection;
-      model_coefficients_ = model_coefficients;
-
-      // Compute the k parameter (k=log(z)/log(1-w^n))
-      double w = static_cast<double> (n_best_inliers_count) * one_over_indices;
-      double p_no_outliers = 1.0 - pow (w, static_cast<double> (selection.size ()));
-      p_no_outliers = (std::max) (std::numeric_limits<double>::epsilon (), p_no_outliers);       // Avoid division by -Inf
-      p_no_outliers = (std::min) (1.0 - std::numeric_limits<double>::epsilon (), p_no_outliers);   // Avoid division by 0.
-      k = log_probability / log (p_no_outliers);
-    }
-
-    ++iterations_;
-    PCL_DEBUG ("[pcl::RandomSampleConsensus::computeModel] Trial %d out of %f: %d inliers (best is: %d so far).\n", iterations_, k, n_inliers_count, n_best_inliers_count);
-    if (iterations_ > max_iterations_)
+    n_best_inliers_count = computeModelParallel (nr_threads, debug_verbosity_level);
+  }
+  else
+  {
+    while (iterations_ < k && skipped_count < max_skip)
     {
-      PCL_DEBUG ("[pcl::RandomSampleConsensus::computeModel] RANSAC reached the maximum number of trials.\n");
-      break;
+      // Get X samples which satisfy the model criteria
+      sac_model_->getSamples (iterations_, selection);
+
+      if (selection.empty ()) 
+      {
+        PCL_ERROR ("[pcl::RandomSampleConsensus::computeModel] No samples could be selected!\n");
+        break;
+      }
+
+      // Search for inliers in the point cloud for the current plane model M
+      if (!sac_model_->computeModelCoefficients (selection, model_coefficients))
+      {
+        //++iterations_;
+        ++skipped_count;
+        continue;
+      }
+
+      // Select the inliers that are within threshold_ from the model
+      //sac_model_->selectWithinDistance (model_coefficients, threshold_, inliers);
+      //if (inliers.empty () && k > 1.0)
+      //  continue;
+
+      n_inliers_count = sac_model_->countWithinDistance (model_coefficients, threshold_);
+
+      // Better match ?
+      if (n_inliers_count > n_best_inliers_count)
+      {
+        n_best_inliers_count = n_inliers_count;
+
+        // Save the current model/inlier/coefficients selection as being the best so far
+        model_              = selection;
+        model_coefficients_ = model_coefficients;
+
+        // Compute the k parameter (k=log(z)/log(1-w^n))
+        double w = static_cast<double> (n_best_inliers_count) * one_over_indices;
+        double p_no_outliers = 1.0 - pow (w, static_cast<double> (selection.size ()));
+        p_no_outliers = (std::max) (std::numeric_limits<double>::epsilon (), p_no_outliers);       // Avoid division by -Inf
+        p_no_outliers = (std::min) (1.0 - std::numeric_limits<double>::epsilon (), p_no_outliers);   // Avoid division by 0.
+        k = log_probability / log (p_no_outliers);
+      }
+
+      ++iterations_;
+      PCL_DEBUG ("[pcl::RandomSampleConsensus::computeModel] Trial %d out of %f: %d inliers (best is: %d so far).\n", iterations_, k, n_inliers_count, n_best_inliers_count);
+      if (iterations_ > max_iterations_)
+      {
+        PCL_DEBUG ("[pcl::RandomSampleConsensus::computeModel] RANSAC reached the maximum number of trials.\n");
+        break;
+      }
     }
   }
 
@@ -135,6 +143,91 @@ pcl::RandomSampleConsensus<PointT>::computeModel (int)
   return (true);
 }
 
+//////////////////////////////////////////////////////////////////////////
+template <typename PointT> int
+pcl::RandomSampleConsensus<PointT>::computeModelParallel (int nr_threads, int)
+{
+  int n_best_inliers_count = -INT_MAX;
+  double k = 1.0;
+
+  double log_probability  = log (1.0 - probability_);
+  double one_over_indices = 1.0 / static_cast<double> (sac_model_->getIndices ()->size ());
+
+  unsigned skipped_count = 0;
+  // suppress infinite loops by just allowing 10 x maximum allowed iterations for invalid model parameters!
+  const unsigned max_skip = max_iterations_ * 10;
+
+  // Every thread draws its samples from its own random stream
+  std::vector<boost::mt19937> rngs;
+  std::vector<std::vector<int> > shuffled_indices;
+  this->initRandomStreams (nr_threads, rngs, shuffled_indices);
+
+  std::vector<std::vector<int> > selections (nr_threads);
+  std::vector<Eigen::VectorXf> coefficients (nr_threads);
+  std::vector<int> inliers_counts (nr_threads);
+
+  bool stop = false;
+  while (!stop && iterations_ < k && skipped_count < max_skip)
+  {
+    // Draw and evaluate one hypothesis per thread
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static, 1) num_threads(nr_threads)
+#endif
+    for (int t = 0; t < nr_threads; ++t)
+    {
+      inliers_counts[t] = -1;
+      sac_model_->getSamples (rngs[t], shuffled_indices[t], selections[t]);
+      if (selections[t].empty () || !sac_model_->computeModelCoefficients (selections[t], coefficients[t]))
+        continue;
+      inliers_counts[t] = sac_model_->countWithinDistance (coefficients[t], threshold_);
+    }
+
+    // Merge the hypotheses in stream order, so that the result does not depend on the scheduling
+    for (int t = 0; t < nr_threads && iterations_ < k && skipped_count < max_skip; ++t)
+    {
+      if (selections[t].empty ())
+      {
+        PCL_ERROR ("[pcl::RandomSampleConsensus::computeModel] No samples could be selected!\n");
+        stop = true;
+        break;
+      }
+
+      if (inliers_counts[t] < 0)
+      {
+        ++skipped_count;
+        continue;
+      }
+
+      // Better match ?
+      if (inliers_counts[t] > n_best_inliers_count)
+      {
+        n_best_inliers_count = inliers_counts[t];
+
+        // Save the current model/inlier/coefficients selection as being the best so far
+        model_              = selections[t];
+        model_coefficients_ = coefficients[t];
+
+        // Compute the k parameter (k=log(z)/log(1-w^n))
+        double w = static_cast<double> (n_best_inliers_count) * one_over_indices;
+        double p_no_outliers = 1.0 - pow (w, static_cast<double> (selections[t].size ()));
+        p_no_outliers = (std::max) (std::numeric_limits<double>::epsilon (), p_no_outliers);       // Avoid division by -Inf
+        p_no_outliers = (std::min) (1.0 - std::numeric_limits<double>::epsilon (), p_no_outliers);   // Avoid division by 0.
+        k = log_probability / log (p_no_outliers);
+      }
+
+      ++iterations_;
+      PCL_DEBUG ("[pcl::RandomSampleConsensus::computeModel] Trial %d out of %f: %d inliers (best is: %d so far).\n", iterations_, k, inliers_counts[t], n_best_inliers_count);
+      if (iterations_ > max_iterations_)
+      {
+        PCL_DEBUG ("[pcl::RandomSampleConsensus::computeModel] RANSAC reached the maximum number of trials.\n");
+        stop = true;
+        break;
+      }
+    }
+  }
+  return (n_best_inliers_count);
+}
+
 #define PCL_INSTANTIATE_RandomSampleConsensus(T) template class PCL_EXPORTS pcl::RandomSampleConsensus<T>;
 
 #endif    // PCL_SAMPLE_CONSENSUS_IMPL_RANSAC_H_
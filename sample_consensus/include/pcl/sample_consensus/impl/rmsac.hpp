@@ -73,76 +73,84 @@ pcl::RandomizedMEstimatorSampleConsensus<PointT>::computeModel (int debug_verbos
   size_t fraction_nr_points = pcl_lrint (static_cast<double>(sac_model_->getIndices ()->size ()) * fraction_nr_pretest_ / 100.0);
 
   // Iterate
-  while (iterations_ < k && skipped_count < max_skip)
+  const int nr_threads = this->getNumberOfThreadsToUse ();
+  if (nr_threads > 1)
   {
-    // Get X samples which satisfy the model criteria
-    sac_model_->getSamples (iterations_, selection);
-
-    if (selection.empty ()) break;
-
-    // Search for inliers in the point cloud for the current plane model M
-    if (!sac_model_->computeModelCoefficients (selection, model_coefficients))
+    computeModelParallel (nr_threads, debug_verbosity_level);
+  }
+  else
+  {
+    while (iterations_ < k && skipped_count < max_skip)
     {
-      //iterations_++;
-      ++ skipped_count;
-      continue;
-    }
+      // Get X samples which satisfy the model criteria
+      sac_model_->getSamples (iterations_, selection);
 
-    // RMSAC addon: verify a random fraction of the data
-    // Get X random samples which satisfy the model criterion
-    this->getRandomSamples (sac_model_->getIndices (), fraction_nr_points, indices_subset);
+      if (selection.empty ()) break;
 
-    if (!sac_model_->doSamplesVerifyModel (indices_subset, model_coefficients, threshold_))
-    {
-      // Unfortunately we cannot "continue" after the first iteration, because k might not be set, while iterations gets incremented
-      if (k != 1.0)
+      // Search for inliers in the point cloud for the current plane model M
+      if (!sac_model_->computeModelCoefficients (selection, model_coefficients))
       {
-        ++iterations_;
+        //iterations_++;
+        ++ skipped_count;
         continue;
       }
-    }
 
-    double d_cur_penalty = 0;
-    // Iterate through the 3d points and calculate the distances from them to the model
-    sac_model_->getDistancesToModel (model_coefficients, distances);
+      // RMSAC addon: verify a random fraction of the data
+      // Get X random samples which satisfy the model criterion
+      this->getRandomSamples (sac_model_->getIndices (), fraction_nr_points, indices_subset);
 
-    if (distances.empty () && k > 1.0)
-      continue;
-
-    for (size_t i = 0; i < distances.size (); ++i)
-      d_cur_penalty += (std::min) (distances[i], threshold_);
+      if (!sac_model_->doSamplesVerifyModel (indices_subset, model_coefficients, threshold_))
+      {
+        // Unfortunately we cannot "continue" after the first iteration, because k might not be set, while iterations gets incremented
+        if (k != 1.0)
+        {
+          ++iterations_;
+          continue;
+        }
+      }
 
-    // Better match ?
-    if (d_cur_penalty < d_best_penalty)
-    {
-      d_best_penalty = d_cur_penalty;
+      double d_cur_penalty = 0;
+      // Iterate through the 3d points and calculate the distances from them to the model
+      sac_model_->getDistancesToModel (model_coefficients, distances);
 
-      // Save the current model/coefficients selection as being the best so far
-      model_              = selection;
-      model_coefficients_ = model_coefficients;
+      if (distances.empty () && k > 1.0)
+        continue;
 
-      n_inliers_count = 0;
-      // Need to compute the number of inliers for this model to adapt k
       for (size_t i = 0; i < distances.size (); ++i)
-        if (distances[i] <= threshold_)
-          n_inliers_count++;
-
-      // Compute the k parameter (k=log(z)/log(1-w^n))
-      double w = static_cast<double> (n_inliers_count) / static_cast<double>(sac_model_->getIndices ()->size ());
-      double p_no_outliers = 1 - pow (w, static_cast<double> (selection.size ()));
-      p_no_outliers = (std::max) (std::numeric_limits<double>::epsilon (), p_no_outliers);       // Avoid division by -Inf
-      p_no_outliers = (std::min) (1 - std::numeric_limits<double>::epsilon (), p_no_outliers);   // Avoid division by 0.
-      k = log (1 - probability_) / log (p_no_outliers);
-    }
+        d_cur_penalty += (std::min) (distances[i], threshold_);
 
-    ++iterations_;
-    if (debug_verbosity_level > 1)
-      PCL_DEBUG ("[pcl::RandomizedMEstimatorSampleConsensus::computeModel] Trial %d out of %d. Best penalty is %f.\n", iterations_, static_cast<int> (ceil (k)), d_best_penalty);
-    if (iterations_ > max_iterations_)
-    {
-      if (debug_verbosity_level > 0)
-        PCL_DEBUG ("[pcl::RandomizedMEstimatorSampleConsensus::computeModel] MSAC reached the maximum number of trials.\n");
-      break;
+      // Better match ?
+      if (d_cur_penalty < d_best_penalty)
+      {
+        d_best_penalty = d_cur_penalty;
+
+        // Save the current model/coefficients selection as being the best so far
+        model_              = selection;
+        model_coefficients_ = model_coefficients;
+
+        n_inliers_count = 0;
+        // Need to compute the number of inliers for this model to adapt k
+        for (size_t i = 0; i < distances.size (); ++i)
+          if (distances[i] <= threshold_)
+            n_inliers_count++;
+
+        // Compute the k parameter (k=log(z)/log(1-w^n))
+        double w = static_cast<double> (n_inliers_count) / static_cast<double>(sac_model_->getIndices ()->size ());
+        double p_no_outliers = 1 - pow (w, static_cast<double> (selection.size ()));
+        p_no_outliers = (std::max) (std::numeric_limits<double>::epsilon (), p_no_outliers);       // Avoid division by -Inf
+        p_no_outliers = (std::min) (1 - std::numeric_limits<double>::epsilon (), p_no_outliers);   // Avoid division by 0.
+        k = log (1 - probability_) / log (p_no_outliers);
+      }
+
+      ++iterations_;
+      if (debug_verbosity_level > 1)
+        PCL_DEBUG ("[pcl::RandomizedMEstimatorSampleConsensus::computeModel] Trial %d out of %d. Best penalty is %f.\n", iterations_, static_cast<int> (ceil (k)), d_best_penalty);
+      if (iterations_ > max_iterations_)
+      {
+        if (debug_verbosity_level > 0)
+          PCL_DEBUG ("[pcl::RandomizedMEstimatorSampleConsensus::computeModel] MSAC reached the maximum number of trials.\n");
+        break;
+      }
     }
   }
 
@@ -178,6 +186,129 @@ pcl::RandomizedMEstimatorSampleConsensus<PointT>::computeModel (int debug_verbos
   return (true);
 }
 
+//////////////////////////////////////////////////////////////////////////
+template <typename PointT> void
+pcl::RandomizedMEstimatorSampleConsensus<PointT>::computeModelParallel (int nr_threads, int debug_verbosity_level)
+{
+  double d_best_penalty = std::numeric_limits<double>::max();
+  double k = 1.0;
+
+  unsigned skipped_count = 0;
+  // suppress infinite loops by just allowing 10 x maximum allowed iterations for invalid model parameters!
+  const unsigned max_skip = max_iterations_ * 10;
+
+  // Number of samples to try randomly
+  size_t fraction_nr_points = pcl_lrint (static_cast<double>(sac_model_->getIndices ()->size ()) * fraction_nr_pretest_ / 100.0);
+
+  // Every thread draws its samples from its own random stream
+  std::vector<boost::mt19937> rngs;
+  std::vector<std::vector<int> > shuffled_indices;
+  this->initRandomStreams (nr_threads, rngs, shuffled_indices);
+
+  std::vector<std::vector<int> > selections (nr_threads);
+  std::vector<Eigen::VectorXf> coefficients (nr_threads);
+  std::vector<char> valid (nr_threads), verified (nr_threads), evaluated (nr_threads), has_distances (nr_threads);
+  std::vector<double> penalties (nr_threads);
+  std::vector<int> inliers_counts (nr_threads);
+
+  bool stop = false;
+  while (!stop && iterations_ < k && skipped_count < max_skip)
+  {
+    // The full evaluation of a hypothesis failing the pre-test is only needed as long as no model was found
+    const bool evaluate_unverified = (k == 1.0);
+
+    // Draw and evaluate one hypothesis per thread
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static, 1) num_threads(nr_threads)
+#endif
+    for (int t = 0; t < nr_threads; ++t)
+    {
+      std::set<int> indices_subset;
+      std::vector<double> distances;
+      valid[t] = verified[t] = evaluated[t] = false;
+      sac_model_->getSamples (rngs[t], shuffled_indices[t], selections[t]);
+      if (selections[t].empty () || !sac_model_->computeModelCoefficients (selections[t], coefficients[t]))
+        continue;
+      valid[t] = true;
+
+      // RMSAC addon: verify a random fraction of the data
+      this->getRandomSamples (sac_model_->getIndices (), fraction_nr_points, indices_subset, rngs[t]);
+      verified[t] = sac_model_->doSamplesVerifyModel (indices_subset, coefficients[t], threshold_);
+      if (!verified[t] && !evaluate_unverified)
+        continue;
+      evaluated[t] = true;
+
+      // Iterate through the 3d points and calculate the distances from them to the model
+      sac_model_->getDistancesToModel (coefficients[t], distances);
+      has_distances[t] = !distances.empty ();
+
+      double d_cur_penalty = 0;
+      int n_inliers_count = 0;
+      for (size_t i = 0; i < distances.size (); ++i)
+      {
+        d_cur_penalty += (std::min) (distances[i], threshold_);
+        if (distances[i] <= threshold_)
+          ++n_inliers_count;
+      }
+      penalties[t] = d_cur_penalty;
+      inliers_counts[t] = n_inliers_count;
+    }
+
+    // Merge the hypotheses in stream order, so that the result does not depend on the scheduling
+    for (int t = 0; t < nr_threads && iterations_ < k && skipped_count < max_skip; ++t)
+    {
+      if (selections[t].empty ())
+      {
+        stop = true;
+        break;
+      }
+
+      if (!valid[t])
+      {
+        ++skipped_count;
+        continue;
+      }
+
+      if (!verified[t] && (k != 1.0 || !evaluated[t]))
+      {
+        ++iterations_;
+        continue;
+      }
+
+      if (!has_distances[t] && k > 1.0)
+        continue;
+
+      // Better match ?
+      if (penalties[t] < d_best_penalty)
+      {
+        d_best_penalty = penalties[t];
+
+        // Save the current model/coefficients selection as being the best so far
+        model_              = selections[t];
+        model_coefficients_ = coefficients[t];
+
+        // Compute the k parameter (k=log(z)/log(1-w^n))
+        double w = static_cast<double> (inliers_counts[t]) / static_cast<double>(sac_model_->getIndices ()->size ());
+        double p_no_outliers = 1 - pow (w, static_cast<double> (selections[t].size ()));
+        p_no_outliers = (std::max) (std::numeric_limits<double>::epsilon (), p_no_outliers);       // Avoid division by -Inf
+        p_no_outliers = (std::min) (1 - std::numeric_limits<double>::epsilon (), p_no_outliers);   // Avoid division by 0.
+        k = log (1 - probability_) / log (p_no_outliers);
+      }
+
+      ++iterations_;
+      if (debug_verbosity_level > 1)
+        PCL_DEBUG ("[pcl::RandomizedMEstimatorSampleConsensus::computeModel] Trial %d out of %d. Best penalty is %f.\n", iterations_, static_cast<int> (ceil (k)), d_best_penalty);
+      if (iterations_ > max_iterations_)
+      {
+        if (debug_verbosity_level > 0)
+          PCL_DEBUG ("[pcl::RandomizedMEstimatorSampleConsensus::computeModel] MSAC reached the maximum number of trials.\n");
+        stop = true;
+        break;
+      }
+    }
+  }
+}
+
 #define PCL_INSTANTIATE_RandomizedMEstimatorSampleConsensus(T) template class PCL_EXPORTS pcl::RandomizedMEstimatorSampleConsensus<T>;
 
 #endif    // PCL_SAMPLE_CONSENSUS_IMPL_RMSAC_H_
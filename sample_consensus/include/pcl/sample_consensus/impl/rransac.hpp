@@ -71,63 +71,71 @@ pcl::RandomizedRandomSampleConsensus<PointT>::computeModel (int debug_verbosity_
   size_t fraction_nr_points = pcl_lrint (static_cast<double>(sac_model_->getIndices ()->size ()) * fraction_nr_pretest_ / 100.0);
 
   // Iterate
-  while (iterations_ < k && skipped_count < max_skip)
+  const int nr_threads = this->getNumberOfThreadsToUse ();
+  if (nr_threads > 1)
   {
-    // Get X samples which satisfy the model criteria
-    sac_model_->getSamples (iterations_, selection);
-
-    if (selection.empty ()) break;
-
-    // Search for inliers in the point cloud for the current plane model M
-    if (!sac_model_->computeModelCoefficients (selection, model_coefficients))
+    n_best_inliers_count = computeModelParallel (nr_threads, debug_verbosity_level);
+  }
+  else
+  {
+    while (iterations_ < k && skipped_count < max_skip)
     {
-      //iterations_++;
-      ++ skipped_count;
-      continue;
-    }
+      // Get X samples which satisfy the model criteria
+      sac_model_->getSamples (iterations_, selection);
 
-    // RRANSAC addon: verify a random fraction of the data
-    // Get X random samples which satisfy the model criterion
-    this->getRandomSamples (sac_model_->getIndices (), fraction_nr_points, indices_subset);
-    if (!sac_model_->doSamplesVerifyModel (indices_subset, model_coefficients, threshold_))
-    {
-      // Unfortunately we cannot "continue" after the first iteration, because k might not be set, while iterations gets incremented
-      if (k > 1.0)
+      if (selection.empty ()) break;
+
+      // Search for inliers in the point cloud for the current plane model M
+      if (!sac_model_->computeModelCoefficients (selection, model_coefficients))
       {
-        ++iterations_;
+        //iterations_++;
+        ++ skipped_count;
         continue;
       }
-    }
 
-    // Select the inliers that are within threshold_ from the model
-    n_inliers_count = sac_model_->countWithinDistance (model_coefficients, threshold_);
+      // RRANSAC addon: verify a random fraction of the data
+      // Get X random samples which satisfy the model criterion
+      this->getRandomSamples (sac_model_->getIndices (), fraction_nr_points, indices_subset);
+      if (!sac_model_->doSamplesVerifyModel (indices_subset, model_coefficients, threshold_))
+      {
+        // Unfortunately we cannot "continue" after the first iteration, because k might not be set, while iterations gets incremented
+        if (k > 1.0)
+        {
+          ++iterations_;
+          continue;
+        }
+      }
 
-    // Better match ?
-    if (n_inliers_count > n_best_inliers_count)
-    {
-      n_best_inliers_count = n_inliers_count;
-
-      // Save the current model/inlier/coefficients selection as being the best so far
-      model_              = selection;
-      model_coefficients_ = model_coefficients;
-
-      // Compute the k parameter (k=log(z)/log(1-w^n))
-      double w = static_cast<double> (n_inliers_count) / static_cast<double> (sac_model_->getIndices ()->size ());
-      double p_no_outliers = 1 - pow (w, static_cast<double> (selection.size ()));
-      p_no_outliers = (std::max) (std::numeric_limits<double>::epsilon (), p_no_outliers);       // Avoid division by -Inf
-      p_no_outliers = (std::min) (1 - std::numeric_limits<double>::epsilon (), p_no_outliers);   // Avoid division by 0.
-      k = log (1 - probability_) / log (p_no_outliers);
-    }
+      // Select the inliers that are within threshold_ from the model
+      n_inliers_count = sac_model_->countWithinDistance (model_coefficients, threshold_);
 
-    ++iterations_;
+      // Better match ?
+      if (n_inliers_count > n_best_inliers_count)
+      {
+        n_best_inliers_count = n_inliers_count;
 
-    if (debug_verbosity_level > 1)
-      PCL_DEBUG ("[pcl::RandomizedRandomSampleConsensus::computeModel] Trial %d out of %d: %d inliers (best is: %d so far).\n", iterations_, static_cast<int> (ceil (k)), n_inliers_count, n_best_inliers_count);
-    if (iterations_ > max_iterations_)
-    {
-      if (debug_verbosity_level > 0)
-        PCL_DEBUG ("[pcl::RandomizedRandomSampleConsensus::computeModel] RRANSAC reached the maximum number of trials.\n");
-      break;
+        // Save the current model/inlier/coefficients selection as being the best so far
+        model_              = selection;
+        model_coefficients_ = model_coefficients;
+
+        // Compute the k parameter (k=log(z)/log(1-w^n))
+        double w = static_cast<double> (n_inliers_count) / static_cast<double> (sac_model_->getIndices ()->size ());
+        double p_no_outliers = 1 - pow (w, static_cast<double> (selection.size ()));
+        p_no_outliers = (std::max) (std::numeric_limits<double>::epsilon (), p_no_outliers);       // Avoid division by -Inf
+        p_no_outliers = (std::min) (1 - std::numeric_limits<double>::epsilon (), p_no_outliers);   // Avoid division by 0.
+        k = log (1 - probability_) / log (p_no_outliers);
+      }
+
+      ++iterations_;
+
+      if (debug_verbosity_level > 1)
+        PCL_DEBUG ("[pcl::RandomizedRandomSampleConsensus::computeModel] Trial %d out of %d: %d inliers (best is: %d so far).\n", iterations_, static_cast<int> (ceil (k)), n_inliers_count, n_best_inliers_count);
+      if (iterations_ > max_iterations_)
+      {
+        if (debug_verbosity_level > 0)
+          PCL_DEBUG ("[pcl::RandomizedRandomSampleConsensus::computeModel] RRANSAC reached the maximum number of trials.\n");
+        break;
+      }
     }
   }
 
@@ -145,6 +153,112 @@ pcl::RandomizedRandomSampleConsensus<PointT>::computeModel (int debug_verbosity_
   return (true);
 }
 
+//////////////////////////////////////////////////////////////////////////
+template <typename PointT> int
+pcl::RandomizedRandomSampleConsensus<PointT>::computeModelParallel (int nr_threads, int debug_verbosity_level)
+{
+  int n_best_inliers_count = -INT_MAX;
+  double k = 1.0;
+
+  unsigned skipped_count = 0;
+  // suppress infinite loops by just allowing 10 x maximum allowed iterations for invalid model parameters!
+  const unsigned max_skip = max_iterations_ * 10;
+
+  // Number of samples to try randomly
+  size_t fraction_nr_points = pcl_lrint (static_cast<double>(sac_model_->getIndices ()->size ()) * fraction_nr_pretest_ / 100.0);
+
+  // Every thread draws its samples from its own random stream
+  std::vector<boost::mt19937> rngs;
+  std::vector<std::vector<int> > shuffled_indices;
+  this->initRandomStreams (nr_threads, rngs, shuffled_indices);
+
+  std::vector<std::vector<int> > selections (nr_threads);
+  std::vector<Eigen::VectorXf> coefficients (nr_threads);
+  std::vector<char> verified (nr_threads);
+  std::vector<int> inliers_counts (nr_threads);
+
+  bool stop = false;
+  while (!stop && iterations_ < k && skipped_count < max_skip)
+  {
+    // The full evaluation of a hypothesis failing the pre-test is only needed as long as no model was found
+    const bool evaluate_unverified = !(k > 1.0);
+
+    // Draw and evaluate one hypothesis per thread
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static, 1) num_threads(nr_threads)
+#endif
+    for (int t = 0; t < nr_threads; ++t)
+    {
+      std::set<int> indices_subset;
+      inliers_counts[t] = -1;
+      verified[t] = false;
+      sac_model_->getSamples (rngs[t], shuffled_indices[t], selections[t]);
+      if (selections[t].empty () || !sac_model_->computeModelCoefficients (selections[t], coefficients[t]))
+        continue;
+
+      // RRANSAC addon: verify a random fraction of the data
+      this->getRandomSamples (sac_model_->getIndices (), fraction_nr_points, indices_subset, rngs[t]);
+      verified[t] = sac_model_->doSamplesVerifyModel (indices_subset, coefficients[t], threshold_);
+      if (verified[t] || evaluate_unverified)
+        inliers_counts[t] = sac_model_->countWithinDistance (coefficients[t], threshold_);
+      else
+        inliers_counts[t] = 0;
+    }
+
+    // Merge the hypotheses in stream order, so that the result does not depend on the scheduling
+    for (int t = 0; t < nr_threads && iterations_ < k && skipped_count < max_skip; ++t)
+    {
+      if (selections[t].empty ())
+      {
+        stop = true;
+        break;
+      }
+
+      if (inliers_counts[t] < 0)
+      {
+        ++skipped_count;
+        continue;
+      }
+
+      if (!verified[t] && (k > 1.0 || !evaluate_unverified))
+      {
+        ++iterations_;
+        continue;
+      }
+
+      // Better match ?
+      if (inliers_counts[t] > n_best_inliers_count)
+      {
+        n_best_inliers_count = inliers_counts[t];
+
+        // Save the current model/inlier/coefficients selection as being the best so far
+        model_              = selections[t];
+        model_coefficients_ = coefficients[t];
+
+        // Compute the k parameter (k=log(z)/log(1-w^n))
+        double w = static_cast<double> (inliers_counts[t]) / static_cast<double> (sac_model_->getIndices ()->size ());
+        double p_no_outliers = 1 - pow (w, static_cast<double> (selections[t].size ()));
+        p_no_outliers = (std::max) (std::numeric_limits<double>::epsilon (), p_no_outliers);       // Avoid division by -Inf
+        p_no_outliers = (std::min) (1 - std::numeric_limits<double>::epsilon (), p_no_outliers);   // Avoid division by 0.
+        k = log (1 - probability_) / log (p_no_outliers);
+      }
+
+      ++iterations_;
+
+      if (debug_verbosity_level > 1)
+        PCL_DEBUG ("[pcl::RandomizedRandomSampleConsensus::computeModel] Trial %d out of %d: %d inliers (best is: %d so far).\n", iterations_, static_cast<int> (ceil (k)), inliers_counts[t], n_best_inliers_count);
+      if (iterations_ > max_iterations_)
+      {
+        if (debug_verbosity_level > 0)
+          PCL_DEBUG ("[pcl::RandomizedRandomSampleConsensus::computeModel] RRANSAC reached the maximum number of trials.\n");
+        stop = true;
+        break;
+      }
+    }
+  }
+  return (n_best_inliers_count);
+}
+
 #define PCL_INSTANTIATE_RandomizedRandomSampleConsensus(T) template class PCL_EXPORTS pcl::RandomizedRandomSampleConsensus<T>;
 
 #endif    // PCL_SAMPLE_CONSENSUS_IMPL_RRANSAC_H_
@@ -140,32 +140,11 @@ pcl::SampleConsensusModelCylinder<PointT, PointNT>::getDistancesToModel (
 
   distances.resize (indices_->size ());
 
-  Eigen::Vector4f line_pt  (model_coefficients[0], model_coefficients[1], model_coefficients[2], 0);
-  Eigen::Vector4f line_dir (model_coefficients[3], model_coefficients[4], model_coefficients[5], 0);
-  float ptdotdir = line_pt.dot (line_dir);
-  float dirdotdir = 1.0f / line_dir.dot (line_dir);
-  // Iterate through the 3d points and calculate the distances from them to the sphere
-  for (size_t i = 0; i < indices_->size (); ++i)
+  // Iterate through the 3d points in blocks and calculate the distances from them to the cylinder
+  for (size_t i = 0; i < indices_->size (); i += pcl::detail::SAC_KERNEL_BLOCK_SIZE)
   {
-    // Approximate the distance from the point to the cylinder as the difference between
-    // dist(point,cylinder_axis) and cylinder radius
-    // @note need to revise this.
-    Eigen::Vector4f pt (input_->points[(*indices_)[i]].x, input_->points[(*indices_)[i]].y, input_->points[(*indices_)[i]].z, 0);
-    Eigen::Vector4f n  (normals_->points[(*indices_)[i]].normal[0], normals_->points[(*indices_)[i]].normal[1], normals_->points[(*indices_)[i]].normal[2], 0);
-
-    double d_euclid = fabs (pointToLineDistance (pt, model_coefficients) - model_coefficients[6]);
-
-    // Calculate the point's projection on the cylinder axis
-    float k = (pt.dot (line_dir) - ptdotdir) * dirdotdir;
-    Eigen::Vector4f pt_proj = line_pt + k * line_dir;
-    Eigen::Vector4f dir = pt - pt_proj;
-    dir.normalize ();
-
-    // Calculate the angular distance between the point normal and the (dir=pt_proj->pt) vector
-    double d_normal = fabs (getAngle3D (n, dir));
-    d_normal = (std::min) (d_normal, M_PI - d_normal);
-
-    distances[i] = fabs (normal_distance_weight_ * d_normal + (1 - normal_distance_weight_) * d_euclid);
+    const size_t nr_block = (std::min) (pcl::detail::SAC_KERNEL_BLOCK_SIZE, indices_->size () - i);
+    computeBlockDistances (model_coefficients, &(*indices_)[i], nr_block, &distances[i]);
   }
 }
 
@@ -185,36 +164,22 @@ pcl::SampleConsensusModelCylinder<PointT, PointNT>::selectWithinDistance (
   inliers.resize (indices_->size ());
   error_sqr_dists_.resize (indices_->size ());
 
-  Eigen::Vector4f line_pt  (model_coefficients[0], model_coefficients[1], model_coefficients[2], 0);
-  Eigen::Vector4f line_dir (model_coefficients[3], model_coefficients[4], model_coefficients[5], 0);
-  float ptdotdir = line_pt.dot (line_dir);
-  float dirdotdir = 1.0f / line_dir.dot (line_dir);
-  // Iterate through the 3d points and calculate the distances from them to the sphere
-  for (size_t i = 0; i < indices_->size (); ++i)
+  double block_distances[pcl::detail::SAC_KERNEL_BLOCK_SIZE];
+
+  // Iterate through the 3d points in blocks and calculate the distances from them to the cylinder
+  for (size_t i = 0; i < indices_->size (); i += pcl::detail::SAC_KERNEL_BLOCK_SIZE)
   {
-    // Approximate the distance from the point to the cylinder as the difference between
-    // dist(point,cylinder_axis) and cylinder radius
-    Eigen::Vector4f pt (input_->points[(*indices_)[i]].x, input_->points[(*indices_)[i]].y, input_->points[(*indices_)[i]].z, 0);
-    Eigen::Vector4f n  (normals_->points[(*indices_)[i]].normal[0], normals_->points[(*indices_)[i]].normal[1], normals_->points[(*indices_)[i]].normal[2], 0);
-    double d_euclid = fabs (pointToLineDistance (pt, model_coefficients) - model_coefficients[6]);
-
-    // Calculate the point's projection on the cylinder axis
-    float k = (pt.dot (line_dir) - ptdotdir) * dirdotdir;
-    Eigen::Vector4f pt_proj = line_pt + k * line_dir;
-    Eigen::Vector4f dir = pt - pt_proj;
-    dir.normalize ();
-
-    // Calculate the angular distance between the point normal and the (dir=pt_proj->pt) vector
-    double d_normal = fabs (getAngle3D (n, dir));
-    d_normal = (std::min) (d_normal, M_PI - d_normal);
-
-    double distance = fabs (normal_distance_weight_ * d_normal + (1 - normal_distance_weight_) * d_euclid); 
-    if (distance < threshold)
+    const size_t nr_block = (std::min) (pcl::detail::SAC_KERNEL_BLOCK_SIZE, indices_->size () - i);
+    computeBlockDistances (model_coefficients, &(*indices_)[i], nr_block, block_distances);
+    for (size_t j = 0; j < nr_block; ++j)
     {
-      // Returns the indices of the points whose distances are smaller than the threshold
-      inliers[nr_p] = (*indices_)[i];
-      error_sqr_dists_[nr_p] = distance;
-      ++nr_p;
+      if (block_distances[j] < threshold)
+      {
+        // Returns the indices of the points whose distances are smaller than the threshold
+        inliers[nr_p] = (*indices_)[i + j];
+        error_sqr_dists_[nr_p] = block_distances[j];
+        ++nr_p;
+      }
     }
   }
   inliers.resize (nr_p);
@@ -232,35 +197,54 @@ pcl::SampleConsensusModelCylinder<PointT, PointNT>::countWithinDistance (
 
   int nr_p = 0;
 
-  Eigen::Vector4f line_pt  (model_coefficients[0], model_coefficients[1], model_coefficients[2], 0);
-  Eigen::Vector4f line_dir (model_coefficients[3], model_coefficients[4], model_coefficients[5], 0);
-  float ptdotdir = line_pt.dot (line_dir);
-  float dirdotdir = 1.0f / line_dir.dot (line_dir);
-  // Iterate through the 3d points and calculate the distances from them to the sphere
-  for (size_t i = 0; i < indices_->size (); ++i)
+  double block_distances[pcl::detail::SAC_KERNEL_BLOCK_SIZE];
+
+  // Iterate through the 3d points in blocks and calculate the distances from them to the cylinder
+  for (size_t i = 0; i < indices_->size (); i += pcl::detail::SAC_KERNEL_BLOCK_SIZE)
   {
-    // Approximate the distance from the point to the cylinder as the difference between
-    // dist(point,cylinder_axis) and cylinder radius
-    Eigen::Vector4f pt (input_->points[(*indices_)[i]].x, input_->points[(*indices_)[i]].y, input_->points[(*indices_)[i]].z, 0);
-    Eigen::Vector4f n  (normals_->points[(*indices_)[i]].normal[0], normals_->points[(*indices_)[i]].normal[1], normals_->points[(*indices_)[i]].normal[2], 0);
-    double d_euclid = fabs (pointToLineDistance (pt, model_coefficients) - model_coefficients[6]);
-
-    // Calculate the point's projection on the cylinder axis
-    float k = (pt.dot (line_dir) - ptdotdir) * dirdotdir;
-    Eigen::Vector4f pt_proj = line_pt + k * line_dir;
-    Eigen::Vector4f dir = pt - pt_proj;
-    dir.normalize ();
-
-    // Calculate the angular distance between the point normal and the (dir=pt_proj->pt) vector
-    double d_normal = fabs (getAngle3D (n, dir));
-    d_normal = (std::min) (d_normal, M_PI - d_normal);
-
-    if (fabs (normal_distance_weight_ * d_normal + (1 - normal_distance_weight_) * d_euclid) < threshold)
-      nr_p++;
+    const size_t nr_block = (std::min) (pcl::detail::SAC_KERNEL_BLOCK_SIZE, indices_->size () - i);
+    computeBlockDistances (model_coefficients, &(*indices_)[i], nr_block, block_distances);
+    for (size_t j = 0; j < nr_block; ++j)
+      if (block_distances[j] < threshold)
+        nr_p++;
   }
   return (nr_p);
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT, typename PointNT> void
+pcl::SampleConsensusModelCylinder<PointT, PointNT>::computeBlockDistances (
+      const Eigen::VectorXf &model_coefficients, const int *indices, size_t nr_indices, double *distances) const
+{
+  const float line_pt[3]  = {model_coefficients[0], model_coefficients[1], model_coefficients[2]};
+  const float line_dir[3] = {model_coefficients[3], model_coefficients[4], model_coefficients[5]};
+  const float radius = model_coefficients[6];
+
+  float euclidean_distances[pcl::detail::SAC_KERNEL_BLOCK_SIZE];
+  float normal_cosines[pcl::detail::SAC_KERNEL_BLOCK_SIZE];
+
+  // The points and normals are laid out by PCL_ADD_POINT4D and PCL_ADD_NORMAL4D, which the kernels rely on
+  pcl::detail::computeCylinderDistances (&input_->points[0].x, sizeof (PointT) / sizeof (float),
+                                         &normals_->points[0].normal[0], sizeof (PointNT) / sizeof (float),
+                                         (std::max) (input_->points.size (), normals_->points.size ()),
+                                         indices, nr_indices, line_pt, line_dir, radius,
+                                         euclidean_distances, normal_cosines);
+
+  for (size_t i = 0; i < nr_indices; ++i)
+  {
+    double cosine = normal_cosines[i];
+    if (cosine < -1.0)
+      cosine = -1.0;
+    else if (cosine > 1.0)
+      cosine = 1.0;
+    // Calculate the angular distance between the point normal and the (dir=pt_proj->pt) vector,
+    // regardless of the orientation of the normal: min (angle, M_PI - angle) = acos (|cos (angle)|)
+    double d_normal = acos (fabs (cosine));
+
+    distances[i] = fabs (normal_distance_weight_ * d_normal + (1 - normal_distance_weight_) * euclidean_distances[i]);
+  }
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointT, typename PointNT> void
 pcl::SampleConsensusModelCylinder<PointT, PointNT>::optimizeModelCoefficients (
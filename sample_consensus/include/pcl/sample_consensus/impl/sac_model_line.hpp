@@ -104,17 +104,20 @@ pcl::SampleConsensusModelLine<PointT>::getDistancesToModel (
   distances.resize (indices_->size ());
 
   // Obtain the line point and direction
-  Eigen::Vector4f line_pt  (model_coefficients[0], model_coefficients[1], model_coefficients[2], 0);
   Eigen::Vector4f line_dir (model_coefficients[3], model_coefficients[4], model_coefficients[5], 0);
   line_dir.normalize ();
+  const float line_pt[3] = {model_coefficients[0], model_coefficients[1], model_coefficients[2]};
+  const float line_direction[3] = {line_dir[0], line_dir[1], line_dir[2]};
+  float block_sqr_distances[pcl::detail::SAC_KERNEL_BLOCK_SIZE];
 
-  // Iterate through the 3d points and calculate the distances from them to the line
-  for (size_t i = 0; i < indices_->size (); ++i)
+  // Iterate through the 3d points in blocks and calculate the distances from them to the line
+  for (size_t i = 0; i < indices_->size (); i += pcl::detail::SAC_KERNEL_BLOCK_SIZE)
   {
-    // Calculate the distance from the point to the line
-    // D = ||(P2-P1) x (P1-P0)|| / ||P2-P1|| = norm (cross (p2-p1, p2-p0)) / norm(p2-p1)
+    const size_t nr_block = (std::min) (pcl::detail::SAC_KERNEL_BLOCK_SIZE, indices_->size () - i);
+    computeBlockSqrDistances (line_pt, line_direction, &(*indices_)[i], nr_block, block_sqr_distances);
     // Need to estimate sqrt here to keep MSAC and friends general
-    distances[i] = sqrt ((line_pt - input_->points[(*indices_)[i]].getVector4fMap ()).cross3 (line_dir).squaredNorm ());
+    for (size_t j = 0; j < nr_block; ++j)
+      distances[i + j] = sqrt (block_sqr_distances[j]);
   }
 }
 
@@ -134,23 +137,26 @@ pcl::SampleConsensusModelLine<PointT>::selectWithinDistance (
   error_sqr_dists_.resize (indices_->size ());
 
   // Obtain the line point and direction
-  Eigen::Vector4f line_pt  (model_coefficients[0], model_coefficients[1], model_coefficients[2], 0);
   Eigen::Vector4f line_dir (model_coefficients[3], model_coefficients[4], model_coefficients[5], 0);
   line_dir.normalize ();
+  const float line_pt[3] = {model_coefficients[0], model_coefficients[1], model_coefficients[2]};
+  const float line_direction[3] = {line_dir[0], line_dir[1], line_dir[2]};
+  float block_sqr_distances[pcl::detail::SAC_KERNEL_BLOCK_SIZE];
 
-  // Iterate through the 3d points and calculate the distances from them to the line
-  for (size_t i = 0; i < indices_->size (); ++i)
+  // Iterate through the 3d points in blocks and calculate the distances from them to the line
+  for (size_t i = 0; i < indices_->size (); i += pcl::detail::SAC_KERNEL_BLOCK_SIZE)
   {
-    // Calculate the distance from the point to the line
-    // D = ||(P2-P1) x (P1-P0)|| / ||P2-P1|| = norm (cross (p2-p1, p2-p0)) / norm(p2-p1)
-    double sqr_distance = (line_pt - input_->points[(*indices_)[i]].getVector4fMap ()).cross3 (line_dir).squaredNorm ();
-
-    if (sqr_distance < sqr_threshold)
+    const size_t nr_block = (std::min) (pcl::detail::SAC_KERNEL_BLOCK_SIZE, indices_->size () - i);
+    computeBlockSqrDistances (line_pt, line_direction, &(*indices_)[i], nr_block, block_sqr_distances);
+    for (size_t j = 0; j < nr_block; ++j)
     {
-      // Returns the indices of the points whose squared distances are smaller than the threshold
-      inliers[nr_p] = (*indices_)[i];
-      error_sqr_dists_[nr_p] = sqr_distance;
-      ++nr_p;
+      if (block_sqr_distances[j] < sqr_threshold)
+      {
+        // Returns the indices of the points whose squared distances are smaller than the threshold
+        inliers[nr_p] = (*indices_)[i + j];
+        error_sqr_dists_[nr_p] = block_sqr_distances[j];
+        ++nr_p;
+      }
     }
   }
   inliers.resize (nr_p);
@@ -171,23 +177,34 @@ pcl::SampleConsensusModelLine<PointT>::countWithinDistance (
   int nr_p = 0;
 
   // Obtain the line point and direction
-  Eigen::Vector4f line_pt  (model_coefficients[0], model_coefficients[1], model_coefficients[2], 0);
   Eigen::Vector4f line_dir (model_coefficients[3], model_coefficients[4], model_coefficients[5], 0);
   line_dir.normalize ();
+  const float line_pt[3] = {model_coefficients[0], model_coefficients[1], model_coefficients[2]};
+  const float line_direction[3] = {line_dir[0], line_dir[1], line_dir[2]};
+  float block_sqr_distances[pcl::detail::SAC_KERNEL_BLOCK_SIZE];
 
-  // Iterate through the 3d points and calculate the distances from them to the line
-  for (size_t i = 0; i < indices_->size (); ++i)
+  // Iterate through the 3d points in blocks and calculate the distances from them to the line
+  for (size_t i = 0; i < indices_->size (); i += pcl::detail::SAC_KERNEL_BLOCK_SIZE)
   {
-    // Calculate the distance from the point to the line
-    // D = ||(P2-P1) x (P1-P0)|| / ||P2-P1|| = norm (cross (p2-p1, p2-p0)) / norm(p2-p1)
-    double sqr_distance = (line_pt - input_->points[(*indices_)[i]].getVector4fMap ()).cross3 (line_dir).squaredNorm ();
-
-    if (sqr_distance < sqr_threshold)
-      nr_p++;
+    const size_t nr_block = (std::min) (pcl::detail::SAC_KERNEL_BLOCK_SIZE, indices_->size () - i);
+    computeBlockSqrDistances (line_pt, line_direction, &(*indices_)[i], nr_block, block_sqr_distances);
+    for (size_t j = 0; j < nr_block; ++j)
+      if (block_sqr_distances[j] < sqr_threshold)
+        nr_p++;
   }
   return (nr_p);
 }
 
+//////////////////////////////////////////////////////////////////////////
+template <typename PointT> void
+pcl::SampleConsensusModelLine<PointT>::computeBlockSqrDistances (
+      const float line_pt[3], const float line_dir[3], const int *indices, size_t nr_indices, float *sqr_distances) const
+{
+  // The points are laid out by PCL_ADD_POINT4D, which the kernels rely on
+  pcl::detail::computeLineSqrDistances (&input_->points[0].x, sizeof (PointT) / sizeof (float), input_->points.size (),
+                                        indices, nr_indices, line_pt, line_dir, sqr_distances);
+}
+
 //////////////////////////////////////////////////////////////////////////
 template <typename PointT> void
 pcl::SampleConsensusModelLine<PointT>::optimizeModelCoefficients (
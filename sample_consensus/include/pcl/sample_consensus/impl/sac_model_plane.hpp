@@ -121,20 +121,16 @@ pcl::SampleConsensusModelPlane<PointT>::getDistancesToModel (
 
   distances.resize (indices_->size ());
 
-  // Iterate through the 3d points and calculate the distances from them to the plane
-  for (size_t i = 0; i < indices_->size (); ++i)
+  const float coefficients[4] = {model_coefficients[0], model_coefficients[1], model_coefficients[2], model_coefficients[3]};
+  float block_distances[pcl::detail::SAC_KERNEL_BLOCK_SIZE];
+
+  // Iterate through the 3d points in blocks and calculate the distances from them to the plane
+  for (size_t i = 0; i < indices_->size (); i += pcl::detail::SAC_KERNEL_BLOCK_SIZE)
   {
-    // Calculate the distance from the point to the plane normal as the dot product
-    // D = (P-A).N/|N|
-    /*distances[i] = fabs (model_coefficients[0] * input_->points[(*indices_)[i]].x +
-                         model_coefficients[1] * input_->points[(*indices_)[i]].y +
-                         model_coefficients[2] * input_->points[(*indices_)[i]].z +
-                         model_coefficients[3]);*/
-    Eigen::Vector4f pt (input_->points[(*indices_)[i]].x,
-                        input_->points[(*indices_)[i]].y,
-                        input_->points[(*indices_)[i]].z,
-                        1);
-    distances[i] = fabs (model_coefficients.dot (pt));
+    const size_t nr_block = (std::min) (pcl::detail::SAC_KERNEL_BLOCK_SIZE, indices_->size () - i);
+    computeBlockDistances (coefficients, &(*indices_)[i], nr_block, block_distances);
+    for (size_t j = 0; j < nr_block; ++j)
+      distances[i + j] = block_distances[j];
   }
 }
 
@@ -154,24 +150,23 @@ pcl::SampleConsensusModelPlane<PointT>::selectWithinDistance (
   inliers.resize (indices_->size ());
   error_sqr_dists_.resize (indices_->size ());
 
-  // Iterate through the 3d points and calculate the distances from them to the plane
-  for (size_t i = 0; i < indices_->size (); ++i)
+  const float coefficients[4] = {model_coefficients[0], model_coefficients[1], model_coefficients[2], model_coefficients[3]};
+  float block_distances[pcl::detail::SAC_KERNEL_BLOCK_SIZE];
+
+  // Iterate through the 3d points in blocks and calculate the distances from them to the plane
+  for (size_t i = 0; i < indices_->size (); i += pcl::detail::SAC_KERNEL_BLOCK_SIZE)
   {
-    // Calculate the distance from the point to the plane normal as the dot product
-    // D = (P-A).N/|N|
-    Eigen::Vector4f pt (input_->points[(*indices_)[i]].x,
-                        input_->points[(*indices_)[i]].y,
-                        input_->points[(*indices_)[i]].z,
-                        1);
-    
-    float distance = fabsf (model_coefficients.dot (pt));
-    
-    if (distance < threshold)
+    const size_t nr_block = (std::min) (pcl::detail::SAC_KERNEL_BLOCK_SIZE, indices_->size () - i);
+    computeBlockDistances (coefficients, &(*indices_)[i], nr_block, block_distances);
+    for (size_t j = 0; j < nr_block; ++j)
     {
-      // Returns the indices of the points whose distances are smaller than the threshold
-      inliers[nr_p] = (*indices_)[i];
-      error_sqr_dists_[nr_p] = static_cast<double> (distance);
-      ++nr_p;
+      if (block_distances[j] < threshold)
+      {
+        // Returns the indices of the points whose distances are smaller than the threshold
+        inliers[nr_p] = (*indices_)[i + j];
+        error_sqr_dists_[nr_p] = static_cast<double> (block_distances[j]);
+        ++nr_p;
+      }
     }
   }
   inliers.resize (nr_p);
@@ -192,21 +187,31 @@ pcl::SampleConsensusModelPlane<PointT>::countWithinDistance (
 
   int nr_p = 0;
 
-  // Iterate through the 3d points and calculate the distances from them to the plane
-  for (size_t i = 0; i < indices_->size (); ++i)
+  const float coefficients[4] = {model_coefficients[0], model_coefficients[1], model_coefficients[2], model_coefficients[3]};
+  float block_distances[pcl::detail::SAC_KERNEL_BLOCK_SIZE];
+
+  // Iterate through the 3d points in blocks and calculate the distances from them to the plane
+  for (size_t i = 0; i < indices_->size (); i += pcl::detail::SAC_KERNEL_BLOCK_SIZE)
   {
-    // Calculate the distance from the point to the plane normal as the dot product
-    // D = (P-A).N/|N|
-    Eigen::Vector4f pt (input_->points[(*indices_)[i]].x,
-                        input_->points[(*indices_)[i]].y,
-                        input_->points[(*indices_)[i]].z,
-                        1);
-    if (fabs (model_coefficients.dot (pt)) < threshold)
-      nr_p++;
+    const size_t nr_block = (std::min) (pcl::detail::SAC_KERNEL_BLOCK_SIZE, indices_->size () - i);
+    computeBlockDistances (coefficients, &(*indices_)[i], nr_block, block_distances);
+    for (size_t j = 0; j < nr_block; ++j)
+      if (block_distances[j] < threshold)
+        nr_p++;
   }
   return (nr_p);
 }
 
+//////////////////////////////////////////////////////////////////////////
+template <typename PointT> void
+pcl::SampleConsensusModelPlane<PointT>::computeBlockDistances (
+      const float coefficients[4], const int *indices, size_t nr_indices, float *distances) const
+{
+  // The points are laid out by PCL_ADD_POINT4D, which the kernels rely on
+  pcl::detail::computePlaneDistances (&input_->points[0].x, sizeof (PointT) / sizeof (float), input_->points.size (),
+                                      indices, nr_indices, coefficients, distances);
+}
+
 //////////////////////////////////////////////////////////////////////////
 template <typename PointT> void
 pcl::SampleConsensusModelPlane<PointT>::optimizeModelCoefficients (
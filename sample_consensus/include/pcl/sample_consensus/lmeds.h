@@ -96,6 +96,15 @@ namespace pcl
         */
       bool 
       computeModel (int debug_verbosity_level = 0);
+
+    protected:
+      /** \brief Search for the best model using several threads, see SampleConsensus::setNumberOfThreads ().
+        * Sets model_, model_coefficients_ and iterations_.
+        * \param[in] nr_threads the number of threads (and random streams) to use
+        * \param[in] debug_verbosity_level enable/disable on-screen debug information and set the verbosity level
+        */
+      void
+      computeModelParallel (int nr_threads, int debug_verbosity_level);
   };
 }
 
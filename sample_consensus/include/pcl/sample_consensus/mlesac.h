@@ -113,6 +113,15 @@ namespace pcl
 
 
     protected:
+      /** \brief Search for the best model using several threads, see SampleConsensus::setNumberOfThreads ().
+        * Sets model_, model_coefficients_ and iterations_.
+        * \param[in] nr_threads the number of threads (and random streams) to use
+        * \param[in] v the length of the bounding box diagonal of the data
+        * \param[in] debug_verbosity_level enable/disable on-screen debug information and set the verbosity level
+        */
+      void
+      computeModelParallel (int nr_threads, double v, int debug_verbosity_level);
+
       /** \brief Compute the median absolute deviation:
         * \f[
         * MAD = \sigma * median_i (| Xi - median_j(Xj) |)
@@ -110,6 +110,16 @@ namespace pcl
       inline double 
       getFractionNrPretest () { return (fraction_nr_pretest_); }
 
+    protected:
+      /** \brief Search for the best model using several threads, see SampleConsensus::setNumberOfThreads ().
+        * Sets model_, model_coefficients_ and iterations_.
+        * \param[in] nr_threads the number of threads (and random streams) to use
+        * \param[in] debug_verbosity_level enable/disable on-screen debug information and set the verbosity level
+        * \return the number of inliers of the best model
+        */
+      int
+      computeModelParallel (int nr_threads, int debug_verbosity_level);
+
     private:
       /** \brief Number of samples to randomly pre-test, in percents. */
       double fraction_nr_pretest_;
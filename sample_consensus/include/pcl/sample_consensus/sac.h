@@ -46,6 +46,10 @@
 #include <ctime>
 #include <set>
 
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
 namespace pcl
 {
   /** \brief SampleConsensus represents the base class. All sample consensus methods must inherit from this class.
@@ -80,6 +84,7 @@ namespace pcl
         , max_iterations_ (1000)
         , rng_alg_ ()
         , rng_ (new boost::uniform_01<boost::mt19937> (rng_alg_))
+        , threads_ (1)
       {
          // Create a random number generator object
          if (random)
@@ -106,6 +111,7 @@ namespace pcl
         , max_iterations_ (1000)
         , rng_alg_ ()
         , rng_ (new boost::uniform_01<boost::mt19937> (rng_alg_))
+        , threads_ (1)
       {
          // Create a random number generator object
          if (random)
@@ -164,6 +170,23 @@ namespace pcl
       inline double 
       getProbability () { return (probability_); }
 
+      /** \brief Set the number of threads used to generate and evaluate model hypotheses.
+        * With more than one thread, hypotheses are drawn in rounds of one hypothesis per
+        * thread, each thread using its own random stream seeded from the generator of this
+        * object. The results are reproducible for a given seed and number of threads, but
+        * differ from the single threaded ones.
+        * \param[in] nr_threads the number of hardware threads to use (0 sets the value back to automatic)
+        * \note Only supported by RandomSampleConsensus, RandomizedRandomSampleConsensus,
+        * MEstimatorSampleConsensus, RandomizedMEstimatorSampleConsensus, LeastMedianSquares
+        * and MaximumLikelihoodSampleConsensus. The other methods always run on a single thread.
+        */
+      inline void
+      setNumberOfThreads (unsigned int nr_threads = 0) { threads_ = nr_threads; }
+
+      /** \brief Get the number of threads, as set by the user. */
+      inline unsigned int
+      getNumberOfThreads () const { return (threads_); }
+
       /** \brief Compute the actual model. Pure virtual. */
       virtual bool 
       computeModel (int debug_verbosity_level = 0) = 0;
@@ -287,6 +310,24 @@ namespace pcl
           indices_subset.insert ((*indices)[static_cast<int> (static_cast<double>(indices->size ()) * rnd ())]);
       }
 
+      /** \brief Get a set of randomly selected indices, drawing from the given random number generator.
+        * \param[in] indices the input indices vector
+        * \param[in] nr_samples the desired number of point indices to randomly select
+        * \param[out] indices_subset the resultant output set of randomly selected indices
+        * \param[in,out] rng the random number generator to draw from
+        */
+      inline void
+      getRandomSamples (const boost::shared_ptr <std::vector<int> > &indices,
+                        size_t nr_samples,
+                        std::set<int> &indices_subset,
+                        boost::mt19937 &rng) const
+      {
+        boost::uniform_int<size_t> dist (0, indices->size () - 1);
+        indices_subset.clear ();
+        while (indices_subset.size () < nr_samples)
+          indices_subset.insert ((*indices)[dist (rng)]);
+      }
+
       /** \brief Return the best model found so far. 
         * \param[out] model the resultant model
         */
@@ -336,12 +377,44 @@ namespace pcl
       /** \brief Boost-based random number generator distribution. */
       boost::shared_ptr<boost::uniform_01<boost::mt19937> > rng_;
 
+      /** \brief The number of threads the scheduler should use. */
+      unsigned int threads_;
+
       /** \brief Boost-based random number generator. */
       inline double
       rnd ()
       {
         return ((*rng_) ());
       }
+
+      /** \brief Get the number of threads to use for the next computeModel () call. */
+      inline int
+      getNumberOfThreadsToUse () const
+      {
+#ifdef _OPENMP
+        return (threads_ == 0 ? omp_get_num_procs () : static_cast<int> (threads_));
+#else
+        return (1);
+#endif
+      }
+
+      /** \brief Initialize independent random streams for the parallel hypothesis generation.
+        * The streams are seeded from the generator of this object, so their sequences only
+        * depend on its seed.
+        * \param[in] nr_streams the number of streams to initialize
+        * \param[out] rngs one random number generator per stream
+        * \param[out] shuffled_indices one copy of the model indices per stream
+        */
+      inline void
+      initRandomStreams (int nr_streams,
+                         std::vector<boost::mt19937> &rngs,
+                         std::vector<std::vector<int> > &shuffled_indices)
+      {
+        rngs.resize (nr_streams);
+        shuffled_indices.assign (nr_streams, *sac_model_->getIndices ());
+        for (int i = 0; i < nr_streams; ++i)
+          rngs[i].seed (static_cast<boost::uint32_t> (rng_->base () ()));
+      }
    };
 }
 
@@ -209,6 +209,41 @@ namespace pcl
         samples.clear ();
       }
 
+      /** \brief Get a set of random data samples and return them as point
+        * indices, using an external random number generator and shuffled
+        * copy of the indices instead of the internal ones. The model itself
+        * is not modified, so several threads can draw samples concurrently as
+        * long as each of them owns its generator and shuffled indices.
+        * \param[in,out] rng the random number generator to draw from
+        * \param[in,out] shuffled_indices a copy of getIndices () owned by the caller
+        * \param[out] samples the resultant model samples (empty if no valid sample could be drawn)
+        */
+      void
+      getSamples (boost::mt19937 &rng, std::vector<int> &shuffled_indices, std::vector<int> &samples) const
+      {
+        if (shuffled_indices.size () < getSampleSize ())
+        {
+          PCL_ERROR ("[pcl::SampleConsensusModel::getSamples] Can not select %lu unique points out of %lu!\n",
+                     samples.size (), shuffled_indices.size ());
+          samples.clear ();
+          return;
+        }
+
+        samples.resize (getSampleSize ());
+        for (unsigned int iter = 0; iter < max_sample_checks_; ++iter)
+        {
+          if (samples_radius_ < std::numeric_limits<double>::epsilon ())
+            drawIndexSample (rng, shuffled_indices, samples);
+          else
+            drawIndexSampleRadius (rng, shuffled_indices, samples);
+
+          if (isSampleGood (samples))
+            return;
+        }
+        PCL_DEBUG ("[pcl::SampleConsensusModel::getSamples] WARNING: Could not select %d sample points in %d iterations!\n", getSampleSize (), max_sample_checks_);
+        samples.clear ();
+      }
+
       /** \brief Check whether the given index samples can form a valid model,
         * compute the model coefficients from these samples and store them
         * in model_coefficients. Pure virtual.
@@ -505,6 +540,59 @@ namespace pcl
         std::copy (shuffled_indices_.begin (), shuffled_indices_.begin () + sample_size, sample.begin ());
       }
 
+      /** \brief Fills a sample array with random samples from a caller-owned copy of the indices.
+        * \param[in,out] rng the random number generator to draw from
+        * \param[in,out] shuffled_indices the indices to draw from, partially shuffled in place
+        * \param[out] sample the set of indices of target_ to analyze
+        */
+      inline void
+      drawIndexSample (boost::mt19937 &rng, std::vector<int> &shuffled_indices, std::vector<int> &sample) const
+      {
+        size_t sample_size = sample.size ();
+        size_t index_size = shuffled_indices.size ();
+        boost::uniform_int<> dist (0, std::numeric_limits<int>::max ());
+        for (unsigned int i = 0; i < sample_size; ++i)
+          std::swap (shuffled_indices[i], shuffled_indices[i + (dist (rng) % (index_size - i))]);
+        std::copy (shuffled_indices.begin (), shuffled_indices.begin () + sample_size, sample.begin ());
+      }
+
+      /** \brief Fills a sample array with one random sample from a caller-owned copy of the indices
+        * and other random samples that are closer than samples_radius_
+        * \param[in,out] rng the random number generator to draw from
+        * \param[in,out] shuffled_indices the indices to draw from, partially shuffled in place
+        * \param[out] sample the set of indices of target_ to analyze
+        */
+      inline void
+      drawIndexSampleRadius (boost::mt19937 &rng, std::vector<int> &shuffled_indices, std::vector<int> &sample) const
+      {
+        size_t sample_size = sample.size ();
+        size_t index_size = shuffled_indices.size ();
+        boost::uniform_int<> dist (0, std::numeric_limits<int>::max ());
+
+        std::swap (shuffled_indices[0], shuffled_indices[0 + (dist (rng) % (index_size - 0))]);
+
+        std::vector<int> indices;
+        std::vector<float> sqr_dists;
+        samples_radius_search_->radiusSearch (input_->at (shuffled_indices[0]),
+                                              samples_radius_, indices, sqr_dists);
+
+        if (indices.size () < sample_size - 1)
+        {
+          // radius search failed, make an invalid model
+          for (unsigned int i = 1; i < sample_size; ++i)
+            shuffled_indices[i] = shuffled_indices[0];
+        }
+        else
+        {
+          for (unsigned int i = 0; i < sample_size-1; ++i)
+            std::swap (indices[i], indices[i + (dist (rng) % (indices.size () - i))]);
+          for (unsigned int i = 1; i < sample_size; ++i)
+            shuffled_indices[i] = indices[i-1];
+        }
+
+        std::copy (shuffled_indices.begin (), shuffled_indices.begin () + sample_size, sample.begin ());
+      }
+
       /** \brief Check whether a model is valid given the user constraints.
         *
         * Default implementation verifies that the number of coefficients in the supplied model is as expected for this
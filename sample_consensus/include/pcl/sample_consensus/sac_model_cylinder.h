@@ -43,6 +43,7 @@
 
 #include <pcl/sample_consensus/sac_model.h>
 #include <pcl/sample_consensus/model_types.h>
+#include <pcl/sample_consensus/sac_model_kernels.h>
 #include <pcl/common/common.h>
 #include <pcl/common/distances.h>
 
@@ -294,6 +295,19 @@ namespace pcl
       bool
       isSampleGood (const std::vector<int> &samples) const;
 
+      /** \brief Compute the distances from a block of points with normals to a cylinder with
+        * the vectorized kernels. The distance is the weighted sum of
+        * the angular distance between the point normal and the cylinder normal, and the
+        * euclidean distance to the cylinder surface.
+        * \param[in] model_coefficients the coefficients of the cylinder
+        * \param[in] indices the indices of the points
+        * \param[in] nr_indices the number of indices, at most pcl::detail::SAC_KERNEL_BLOCK_SIZE
+        * \param[out] distances the resultant distances, one per index
+        */
+      void
+      computeBlockDistances (const Eigen::VectorXf &model_coefficients,
+                             const int *indices, size_t nr_indices, double *distances) const;
+
     private:
       /** \brief The axis along which we need to search for a plane perpendicular to. */
       Eigen::Vector3f axis_;
@@ -0,0 +1,149 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2012-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#ifndef PCL_SAMPLE_CONSENSUS_SAC_MODEL_KERNELS_H_
+#define PCL_SAMPLE_CONSENSUS_SAC_MODEL_KERNELS_H_
+
+#include <pcl/pcl_macros.h>
+#include <cstddef>
+
+namespace pcl
+{
+  namespace detail
+  {
+    /** \brief Number of indices the sample consensus models hand to the distance kernels
+      * at once. The per-block distance buffers live on the stack.
+      */
+    const size_t SAC_KERNEL_BLOCK_SIZE = 256;
+
+    /** \brief Instruction sets the sample consensus distance kernels are implemented for. */
+    enum SacKernelInstructionSet
+    {
+      SAC_KERNEL_SCALAR = 0,
+      SAC_KERNEL_SSE2 = 1,
+      SAC_KERNEL_AVX2 = 2
+    };
+
+    /** \brief Get the instruction set used by the sample consensus distance kernels. This
+      * is the best one supported by both the build and the CPU, unless it was limited with
+      * setSacKernelInstructionSet ().
+      */
+    PCL_EXPORTS SacKernelInstructionSet
+    getSacKernelInstructionSet ();
+
+    /** \brief Limit the instruction set used by the sample consensus distance kernels, e.g.
+      * to compare against the scalar fallback. Instruction sets which are not supported
+      * fall back to the best supported one below them.
+      * \note The limit is read without locking, so call this before running any sample
+      * consensus model, not while models are being evaluated in other threads.
+      * \param[in] isa the highest instruction set to use
+      */
+    PCL_EXPORTS void
+    setSacKernelInstructionSet (SacKernelInstructionSet isa);
+
+    /** \brief Compute the absolute distances |a*x + b*y + c*z + d| from a set of points to a plane.
+      *
+      * All kernels read the points through an index vector from an array of structures in
+      * which x, y and z are the first three of four consecutive floats (PCL_ADD_POINT4D).
+      * \param[in] points pointer to the x coordinate of the first point of the cloud
+      * \param[in] stride the size of a point, in floats
+      * \param[in] nr_points the number of points in the cloud
+      * \param[in] indices the indices of the points to process
+      * \param[in] nr_indices the number of indices
+      * \param[in] coefficients the plane coefficients a, b, c, d
+      * \param[out] distances the resultant distances, one per index
+      */
+    PCL_EXPORTS void
+    computePlaneDistances (const float *points, size_t stride, size_t nr_points,
+                           const int *indices, size_t nr_indices,
+                           const float coefficients[4], float *distances);
+
+    /** \brief Compute the absolute distances | ||p - c|| - r | from a set of points to a sphere.
+      * \param[in] points pointer to the x coordinate of the first point of the cloud
+      * \param[in] stride the size of a point, in floats
+      * \param[in] nr_points the number of points in the cloud
+      * \param[in] indices the indices of the points to process
+      * \param[in] nr_indices the number of indices
+      * \param[in] coefficients the sphere center x, y, z and radius
+      * \param[out] distances the resultant distances, one per index
+      */
+    PCL_EXPORTS void
+    computeSphereDistances (const float *points, size_t stride, size_t nr_points,
+                            const int *indices, size_t nr_indices,
+                            const float coefficients[4], float *distances);
+
+    /** \brief Compute the squared distances ||(line_pt - p) x line_dir||^2 from a set of points to a line.
+      * \param[in] points pointer to the x coordinate of the first point of the cloud
+      * \param[in] stride the size of a point, in floats
+      * \param[in] nr_points the number of points in the cloud
+      * \param[in] indices the indices of the points to process
+      * \param[in] nr_indices the number of indices
+      * \param[in] line_pt a point on the line
+      * \param[in] line_dir the normalized direction of the line
+      * \param[out] sqr_distances the resultant squared distances, one per index
+      */
+    PCL_EXPORTS void
+    computeLineSqrDistances (const float *points, size_t stride, size_t nr_points,
+                             const int *indices, size_t nr_indices,
+                             const float line_pt[3], const float line_dir[3], float *sqr_distances);
+
+    /** \brief Compute the two terms of the cylinder distance for a set of points with normals:
+      * the absolute difference between the distance to the axis and the radius, and the cosine
+      * of the angle between the point normal and the direction from the axis to the point.
+      * \param[in] points pointer to the x coordinate of the first point of the cloud
+      * \param[in] stride the size of a point, in floats
+      * \param[in] normals pointer to the normal x coordinate of the first normal of the cloud
+      * \param[in] normal_stride the size of a normal, in floats
+      * \param[in] nr_points the number of points (and normals) in the cloud
+      * \param[in] indices the indices of the points to process
+      * \param[in] nr_indices the number of indices
+      * \param[in] line_pt a point on the cylinder axis
+      * \param[in] line_dir the direction of the cylinder axis
+      * \param[in] radius the cylinder radius
+      * \param[out] euclidean_distances the resultant distances to the cylinder surface, one per index
+      * \param[out] normal_cosines the resultant cosines, unclamped, one per index
+      */
+    PCL_EXPORTS void
+    computeCylinderDistances (const float *points, size_t stride,
+                              const float *normals, size_t normal_stride, size_t nr_points,
+                              const int *indices, size_t nr_indices,
+                              const float line_pt[3], const float line_dir[3], float radius,
+                              float *euclidean_distances, float *normal_cosines);
+  }
+}
+
+#endif  //#ifndef PCL_SAMPLE_CONSENSUS_SAC_MODEL_KERNELS_H_
@@ -43,6 +43,7 @@
 
 #include <pcl/sample_consensus/sac_model.h>
 #include <pcl/sample_consensus/model_types.h>
+#include <pcl/sample_consensus/sac_model_kernels.h>
 #include <pcl/common/eigen.h>
 
 namespace pcl
@@ -190,6 +191,18 @@ namespace pcl
         */
       bool
       isSampleGood (const std::vector<int> &samples) const;
+
+      /** \brief Compute the squared distances from a block of points to a line with the
+        * vectorized kernels.
+        * \param[in] line_pt a point on the line
+        * \param[in] line_dir the normalized direction of the line
+        * \param[in] indices the indices of the points
+        * \param[in] nr_indices the number of indices
+        * \param[out] sqr_distances the resultant squared distances, one per index
+        */
+      void
+      computeBlockSqrDistances (const float line_pt[3], const float line_dir[3],
+                                const int *indices, size_t nr_indices, float *sqr_distances) const;
   };
 }
 
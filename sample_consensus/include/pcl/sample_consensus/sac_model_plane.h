@@ -43,6 +43,7 @@
 
 #include <pcl/sample_consensus/sac_model.h>
 #include <pcl/sample_consensus/model_types.h>
+#include <pcl/sample_consensus/sac_model_kernels.h>
 
 namespace pcl
 {
@@ -257,6 +258,16 @@ namespace pcl
       using SampleConsensusModel<PointT>::sample_size_;
       using SampleConsensusModel<PointT>::model_size_;
 
+      /** \brief Compute the distances from a block of points to a plane with the
+        * vectorized kernels.
+        * \param[in] coefficients the plane coefficients a, b, c, d
+        * \param[in] indices the indices of the points
+        * \param[in] nr_indices the number of indices
+        * \param[out] distances the resultant absolute distances, one per index
+        */
+      void
+      computeBlockDistances (const float coefficients[4], const int *indices, size_t nr_indices, float *distances) const;
+
     private:
       /** \brief Check if a sample of indices results in a good sample of points
         * indices.
@@ -43,6 +43,7 @@
 
 #include <pcl/sample_consensus/sac_model.h>
 #include <pcl/sample_consensus/model_types.h>
+#include <pcl/sample_consensus/sac_model_kernels.h>
 
 namespace pcl
 {
@@ -228,6 +229,16 @@ namespace pcl
       bool
       isSampleGood(const std::vector<int> &samples) const;
 
+      /** \brief Compute the distances from a block of points to a sphere with the
+        * vectorized kernels.
+        * \param[in] coefficients the sphere center x, y, z and radius
+        * \param[in] indices the indices of the points
+        * \param[in] nr_indices the number of indices
+        * \param[out] distances the resultant absolute distances, one per index
+        */
+      void
+      computeBlockDistances (const float coefficients[4], const int *indices, size_t nr_indices, float *distances) const;
+
     private:
       /** \brief Temporary pointer to a list of given indices for optimizeModelCoefficients () */
       const std::vector<int> *tmp_inliers_;
@@ -0,0 +1,563 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2012-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#include <pcl/sample_consensus/sac_model_kernels.h>
+#include <climits>
+#include <cmath>
+
+#if defined (__SSE2__) || defined (_M_X64) || (defined (_M_IX86_FP) && _M_IX86_FP >= 2)
+#  define PCL_SAC_KERNELS_SSE2
+#  include <emmintrin.h>
+#endif
+
+// The AVX2 kernels are compiled for a specific target and only called after checking
+// the CPU at runtime, so a single binary runs on CPUs with and without AVX2
+#if defined (__x86_64__) || defined (__i386__) || defined (_M_X64) || defined (_M_IX86)
+#  if defined (__clang__)
+#    if (__clang_major__ > 3) || (__clang_major__ == 3 && __clang_minor__ >= 8)
+#      define PCL_SAC_KERNELS_AVX2
+#      define PCL_SAC_TARGET_AVX2 __attribute__ ((target ("avx2")))
+#    endif
+#  elif defined (__GNUC__)
+#    if (__GNUC__ > 4) || (__GNUC__ == 4 && __GNUC_MINOR__ >= 9)
+#      define PCL_SAC_KERNELS_AVX2
+#      define PCL_SAC_TARGET_AVX2 __attribute__ ((target ("avx2")))
+#    endif
+#  elif defined (_MSC_VER) && (_MSC_VER >= 1700)
+#    define PCL_SAC_KERNELS_AVX2
+#    define PCL_SAC_TARGET_AVX2
+#    include <intrin.h>
+#  endif
+#endif
+
+#ifdef PCL_SAC_KERNELS_AVX2
+#  include <immintrin.h>
+#endif
+
+namespace
+{
+  /** \brief The highest instruction set allowed by setSacKernelInstructionSet (). It is only
+    * written by setSacKernelInstructionSet (), which must not run concurrently with the kernels,
+    * so the kernels read it without locking.
+    */
+  int max_instruction_set = pcl::detail::SAC_KERNEL_AVX2;
+
+#ifdef PCL_SAC_KERNELS_AVX2
+  bool
+  cpuSupportsAVX2 ()
+  {
+#  if defined (_MSC_VER)
+    int info[4];
+    __cpuid (info, 0);
+    if (info[0] < 7)
+      return (false);
+    __cpuid (info, 1);
+    // The OS has to save the AVX registers on context switches
+    if ((info[2] & (1 << 27)) == 0 || (info[2] & (1 << 28)) == 0)
+      return (false);
+    if ((_xgetbv (0) & 0x6) != 0x6)
+      return (false);
+    __cpuidex (info, 7, 0);
+    return ((info[1] & (1 << 5)) != 0);
+#  else
+    __builtin_cpu_init ();
+    return (__builtin_cpu_supports ("avx2") != 0);
+#  endif
+  }
+#endif
+
+  int
+  detectInstructionSet ()
+  {
+    int isa = pcl::detail::SAC_KERNEL_SCALAR;
+#ifdef PCL_SAC_KERNELS_SSE2
+    isa = pcl::detail::SAC_KERNEL_SSE2;
+#endif
+#ifdef PCL_SAC_KERNELS_AVX2
+    if (cpuSupportsAVX2 ())
+      isa = pcl::detail::SAC_KERNEL_AVX2;
+#endif
+    return (isa);
+  }
+
+  /** \brief Get the instruction set to use for a cloud of the given size. The AVX2
+    * gathers use 32 bit offsets, so they are only used if all the offsets fit.
+    */
+  inline int
+  getInstructionSet (size_t stride, size_t nr_points)
+  {
+    int isa = pcl::detail::getSacKernelInstructionSet ();
+    if (isa == pcl::detail::SAC_KERNEL_AVX2 && nr_points > static_cast<size_t> (INT_MAX - 4) / stride)
+      isa = pcl::detail::SAC_KERNEL_SSE2;
+    return (isa);
+  }
+
+  ///////////////////////////////////////////////////////////////////////////////////////////
+  // Scalar kernels. They use the same order of operations as the SIMD kernels.
+  ///////////////////////////////////////////////////////////////////////////////////////////
+  void
+  planeDistancesScalar (const float *points, size_t stride, const int *indices, size_t nr_indices,
+                        const float c[4], float *distances)
+  {
+    for (size_t i = 0; i < nr_indices; ++i)
+    {
+      const float *p = points + static_cast<size_t> (indices[i]) * stride;
+      distances[i] = fabsf (((c[0] * p[0] + c[1] * p[1]) + c[2] * p[2]) + c[3]);
+    }
+  }
+
+  void
+  sphereDistancesScalar (const float *points, size_t stride, const int *indices, size_t nr_indices,
+                         const float c[4], float *distances)
+  {
+    for (size_t i = 0; i < nr_indices; ++i)
+    {
+      const float *p = points + static_cast<size_t> (indices[i]) * stride;
+      const float dx = p[0] - c[0], dy = p[1] - c[1], dz = p[2] - c[2];
+      distances[i] = fabsf (sqrtf ((dx * dx + dy * dy) + dz * dz) - c[3]);
+    }
+  }
+
+  void
+  lineSqrDistancesScalar (const float *points, size_t stride, const int *indices, size_t nr_indices,
+                          const float lp[3], const float ld[3], float *sqr_distances)
+  {
+    for (size_t i = 0; i < nr_indices; ++i)
+    {
+      const float *p = points + static_cast<size_t> (indices[i]) * stride;
+      const float vx = lp[0] - p[0], vy = lp[1] - p[1], vz = lp[2] - p[2];
+      const float cx = vy * ld[2] - vz * ld[1];
+      const float cy = vz * ld[0] - vx * ld[2];
+      const float cz = vx * ld[1] - vy * ld[0];
+      sqr_distances[i] = (cx * cx + cy * cy) + cz * cz;
+    }
+  }
+
+  void
+  cylinderDistancesScalar (const float *points, size_t stride, const float *normals, size_t normal_stride,
+                           const int *indices, size_t nr_indices,
+                           const float lp[3], const float ld[3], float radius,
+                           float *euclidean_distances, float *normal_cosines)
+  {
+    const float dir_sqr_norm = (ld[0] * ld[0] + ld[1] * ld[1]) + ld[2] * ld[2];
+    const float inv_dir_sqr_norm = 1.0f / dir_sqr_norm;
+    const float pt_dot_dir = (lp[0] * ld[0] + lp[1] * ld[1]) + lp[2] * ld[2];
+    for (size_t i = 0; i < nr_indices; ++i)
+    {
+      const float *p = points + static_cast<size_t> (indices[i]) * stride;
+      const float *n = normals + static_cast<size_t> (indices[i]) * normal_stride;
+
+      // Distance to the axis
+      const float vx = lp[0] - p[0], vy = lp[1] - p[1], vz = lp[2] - p[2];
+      const float cx = vy * ld[2] - vz * ld[1];
+      const float cy = vz * ld[0] - vx * ld[2];
+      const float cz = vx * ld[1] - vy * ld[0];
+      euclidean_distances[i] = fabsf (sqrtf (((cx * cx + cy * cy) + cz * cz) * inv_dir_sqr_norm) - radius);
+
+      // Direction from the projection on the axis to the point
+      const float k = (((p[0] * ld[0] + p[1] * ld[1]) + p[2] * ld[2]) - pt_dot_dir) * inv_dir_sqr_norm;
+      const float wx = p[0] - (lp[0] + k * ld[0]);
+      const float wy = p[1] - (lp[1] + k * ld[1]);
+      const float wz = p[2] - (lp[2] + k * ld[2]);
+      const float n_dot_w = (n[0] * wx + n[1] * wy) + n[2] * wz;
+      const float n_sqr_norm = (n[0] * n[0] + n[1] * n[1]) + n[2] * n[2];
+      const float w_sqr_norm = (wx * wx + wy * wy) + wz * wz;
+      normal_cosines[i] = n_dot_w / sqrtf (n_sqr_norm * w_sqr_norm);
+    }
+  }
+
+#ifdef PCL_SAC_KERNELS_SSE2
+  ///////////////////////////////////////////////////////////////////////////////////////////
+  // SSE2 kernels, processing four points at a time. The points are loaded as four floats
+  // each and transposed into x, y and z registers.
+  ///////////////////////////////////////////////////////////////////////////////////////////
+  inline void
+  loadXYZ4 (const float *points, size_t stride, const int *indices, __m128 &x, __m128 &y, __m128 &z)
+  {
+    __m128 p0 = _mm_loadu_ps (points + static_cast<size_t> (indices[0]) * stride);
+    __m128 p1 = _mm_loadu_ps (points + static_cast<size_t> (indices[1]) * stride);
+    __m128 p2 = _mm_loadu_ps (points + static_cast<size_t> (indices[2]) * stride);
+    __m128 p3 = _mm_loadu_ps (points + static_cast<size_t> (indices[3]) * stride);
+    _MM_TRANSPOSE4_PS (p0, p1, p2, p3);
+    x = p0;
+    y = p1;
+    z = p2;
+  }
+
+  inline __m128
+  abs4 (const __m128 &v)
+  {
+    return (_mm_andnot_ps (_mm_set1_ps (-0.0f), v));
+  }
+
+  void
+  planeDistancesSSE2 (const float *points, size_t stride, const int *indices, size_t nr_indices,
+                      const float c[4], float *distances)
+  {
+    const __m128 a = _mm_set1_ps (c[0]), b = _mm_set1_ps (c[1]), cc = _mm_set1_ps (c[2]), d = _mm_set1_ps (c[3]);
+    size_t i = 0;
+    for (; i + 4 <= nr_indices; i += 4)
+    {
+      __m128 x, y, z;
+      loadXYZ4 (points, stride, indices + i, x, y, z);
+      __m128 dist = _mm_add_ps (_mm_add_ps (_mm_add_ps (_mm_mul_ps (a, x), _mm_mul_ps (b, y)), _mm_mul_ps (cc, z)), d);
+      _mm_storeu_ps (distances + i, abs4 (dist));
+    }
+    planeDistancesScalar (points, stride, indices + i, nr_indices - i, c, distances + i);
+  }
+
+  void
+  sphereDistancesSSE2 (const float *points, size_t stride, const int *indices, size_t nr_indices,
+                       const float c[4], float *distances)
+  {
+    const __m128 cx = _mm_set1_ps (c[0]), cy = _mm_set1_ps (c[1]), cz = _mm_set1_ps (c[2]), r = _mm_set1_ps (c[3]);
+    size_t i = 0;
+    for (; i + 4 <= nr_indices; i += 4)
+    {
+      __m128 x, y, z;
+      loadXYZ4 (points, stride, indices + i, x, y, z);
+      const __m128 dx = _mm_sub_ps (x, cx), dy = _mm_sub_ps (y, cy), dz = _mm_sub_ps (z, cz);
+      const __m128 sqr_norm = _mm_add_ps (_mm_add_ps (_mm_mul_ps (dx, dx), _mm_mul_ps (dy, dy)), _mm_mul_ps (dz, dz));
+      _mm_storeu_ps (distances + i, abs4 (_mm_sub_ps (_mm_sqrt_ps (sqr_norm), r)));
+    }
+    sphereDistancesScalar (points, stride, indices + i, nr_indices - i, c, distances + i);
+  }
+
+  inline __m128
+  crossSqrNorm4 (const __m128 &vx, const __m128 &vy, const __m128 &vz,
+                 const __m128 &dx, const __m128 &dy, const __m128 &dz)
+  {
+    const __m128 cx = _mm_sub_ps (_mm_mul_ps (vy, dz), _mm_mul_ps (vz, dy));
+    const __m128 cy = _mm_sub_ps (_mm_mul_ps (vz, dx), _mm_mul_ps (vx, dz));
+    const __m128 cz = _mm_sub_ps (_mm_mul_ps (vx, dy), _mm_mul_ps (vy, dx));
+    return (_mm_add_ps (_mm_add_ps (_mm_mul_ps (cx, cx), _mm_mul_ps (cy, cy)), _mm_mul_ps (cz, cz)));
+  }
+
+  void
+  lineSqrDistancesSSE2 (const float *points, size_t stride, const int *indices, size_t nr_indices,
+                        const float lp[3], const float ld[3], float *sqr_distances)
+  {
+    const __m128 px = _mm_set1_ps (lp[0]), py = _mm_set1_ps (lp[1]), pz = _mm_set1_ps (lp[2]);
+    const __m128 dx = _mm_set1_ps (ld[0]), dy = _mm_set1_ps (ld[1]), dz = _mm_set1_ps (ld[2]);
+    size_t i = 0;
+    for (; i + 4 <= nr_indices; i += 4)
+    {
+      __m128 x, y, z;
+      loadXYZ4 (points, stride, indices + i, x, y, z);
+      _mm_storeu_ps (sqr_distances + i, crossSqrNorm4 (_mm_sub_ps (px, x), _mm_sub_ps (py, y), _mm_sub_ps (pz, z), dx, dy, dz));
+    }
+    lineSqrDistancesScalar (points, stride, indices + i, nr_indices - i, lp, ld, sqr_distances + i);
+  }
+
+  void
+  cylinderDistancesSSE2 (const float *points, size_t stride, const float *normals, size_t normal_stride,
+                         const int *indices, size_t nr_indices,
+                         const float lp[3], const float ld[3], float radius,
+                         float *euclidean_distances, float *normal_cosines)
+  {
+    const float dir_sqr_norm = (ld[0] * ld[0] + ld[1] * ld[1]) + ld[2] * ld[2];
+    const float pt_dot_dir = (lp[0] * ld[0] + lp[1] * ld[1]) + lp[2] * ld[2];
+    const __m128 px = _mm_set1_ps (lp[0]), py = _mm_set1_ps (lp[1]), pz = _mm_set1_ps (lp[2]);
+    const __m128 dx = _mm_set1_ps (ld[0]), dy = _mm_set1_ps (ld[1]), dz = _mm_set1_ps (ld[2]);
+    const __m128 inv_dir_sqr_norm = _mm_set1_ps (1.0f / dir_sqr_norm);
+    const __m128 ptdotdir = _mm_set1_ps (pt_dot_dir);
+    const __m128 r = _mm_set1_ps (radius);
+    size_t i = 0;
+    for (; i + 4 <= nr_indices; i += 4)
+    {
+      __m128 x, y, z, nx, ny, nz;
+      loadXYZ4 (points, stride, indices + i, x, y, z);
+      loadXYZ4 (normals, normal_stride, indices + i, nx, ny, nz);
+
+      const __m128 sqr_dist = _mm_mul_ps (crossSqrNorm4 (_mm_sub_ps (px, x), _mm_sub_ps (py, y), _mm_sub_ps (pz, z), dx, dy, dz), inv_dir_sqr_norm);
+      _mm_storeu_ps (euclidean_distances + i, abs4 (_mm_sub_ps (_mm_sqrt_ps (sqr_dist), r)));
+
+      const __m128 pdotd = _mm_add_ps (_mm_add_ps (_mm_mul_ps (x, dx), _mm_mul_ps (y, dy)), _mm_mul_ps (z, dz));
+      const __m128 k = _mm_mul_ps (_mm_sub_ps (pdotd, ptdotdir), inv_dir_sqr_norm);
+      const __m128 wx = _mm_sub_ps (x, _mm_add_ps (px, _mm_mul_ps (k, dx)));
+      const __m128 wy = _mm_sub_ps (y, _mm_add_ps (py, _mm_mul_ps (k, dy)));
+      const __m128 wz = _mm_sub_ps (z, _mm_add_ps (pz, _mm_mul_ps (k, dz)));
+      const __m128 n_dot_w = _mm_add_ps (_mm_add_ps (_mm_mul_ps (nx, wx), _mm_mul_ps (ny, wy)), _mm_mul_ps (nz, wz));
+      const __m128 n_sqr_norm = _mm_add_ps (_mm_add_ps (_mm_mul_ps (nx, nx), _mm_mul_ps (ny, ny)), _mm_mul_ps (nz, nz));
+      const __m128 w_sqr_norm = _mm_add_ps (_mm_add_ps (_mm_mul_ps (wx, wx), _mm_mul_ps (wy, wy)), _mm_mul_ps (wz, wz));
+      _mm_storeu_ps (normal_cosines + i, _mm_div_ps (n_dot_w, _mm_sqrt_ps (_mm_mul_ps (n_sqr_norm, w_sqr_norm))));
+    }
+    cylinderDistancesScalar (points, stride, normals, normal_stride, indices + i, nr_indices - i,
+                             lp, ld, radius, euclidean_distances + i, normal_cosines + i);
+  }
+#endif
+
+#ifdef PCL_SAC_KERNELS_AVX2
+  ///////////////////////////////////////////////////////////////////////////////////////////
+  // AVX2 kernels, processing eight points at a time. The coordinates are gathered directly
+  // through the index vector.
+  ///////////////////////////////////////////////////////////////////////////////////////////
+  PCL_SAC_TARGET_AVX2 inline __m256i
+  loadOffsets8 (const int *indices, const __m256i &stride)
+  {
+    return (_mm256_mullo_epi32 (_mm256_loadu_si256 (reinterpret_cast<const __m256i*> (indices)), stride));
+  }
+
+  PCL_SAC_TARGET_AVX2 inline void
+  gatherXYZ8 (const float *points, const __m256i &offsets, __m256 &x, __m256 &y, __m256 &z)
+  {
+    x = _mm256_i32gather_ps (points, offsets, 4);
+    y = _mm256_i32gather_ps (points + 1, offsets, 4);
+    z = _mm256_i32gather_ps (points + 2, offsets, 4);
+  }
+
+  PCL_SAC_TARGET_AVX2 inline __m256
+  abs8 (const __m256 &v)
+  {
+    return (_mm256_andnot_ps (_mm256_set1_ps (-0.0f), v));
+  }
+
+  PCL_SAC_TARGET_AVX2 inline __m256
+  crossSqrNorm8 (const __m256 &vx, const __m256 &vy, const __m256 &vz,
+                 const __m256 &dx, const __m256 &dy, const __m256 &dz)
+  {
+    const __m256 cx = _mm256_sub_ps (_mm256_mul_ps (vy, dz), _mm256_mul_ps (vz, dy));
+    const __m256 cy = _mm256_sub_ps (_mm256_mul_ps (vz, dx), _mm256_mul_ps (vx, dz));
+    const __m256 cz = _mm256_sub_ps (_mm256_mul_ps (vx, dy), _mm256_mul_ps (vy, dx));
+    return (_mm256_add_ps (_mm256_add_ps (_mm256_mul_ps (cx, cx), _mm256_mul_ps (cy, cy)), _mm256_mul_ps (cz, cz)));
+  }
+
+  PCL_SAC_TARGET_AVX2 void
+  planeDistancesAVX2 (const float *points, size_t stride, const int *indices, size_t nr_indices,
+                      const float c[4], float *distances)
+  {
+    const __m256i vstride = _mm256_set1_epi32 (static_cast<int> (stride));
+    const __m256 a = _mm256_set1_ps (c[0]), b = _mm256_set1_ps (c[1]), cc = _mm256_set1_ps (c[2]), d = _mm256_set1_ps (c[3]);
+    size_t i = 0;
+    for (; i + 8 <= nr_indices; i += 8)
+    {
+      __m256 x, y, z;
+      gatherXYZ8 (points, loadOffsets8 (indices + i, vstride), x, y, z);
+      __m256 dist = _mm256_add_ps (_mm256_add_ps (_mm256_add_ps (_mm256_mul_ps (a, x), _mm256_mul_ps (b, y)), _mm256_mul_ps (cc, z)), d);
+      _mm256_storeu_ps (distances + i, abs8 (dist));
+    }
+    planeDistancesScalar (points, stride, indices + i, nr_indices - i, c, distances + i);
+  }
+
+  PCL_SAC_TARGET_AVX2 void
+  sphereDistancesAVX2 (const float *points, size_t stride, const int *indices, size_t nr_indices,
+                       const float c[4], float *distances)
+  {
+    const __m256i vstride = _mm256_set1_epi32 (static_cast<int> (stride));
+    const __m256 cx = _mm256_set1_ps (c[0]), cy = _mm256_set1_ps (c[1]), cz = _mm256_set1_ps (c[2]), r = _mm256_set1_ps (c[3]);
+    size_t i = 0;
+    for (; i + 8 <= nr_indices; i += 8)
+    {
+      __m256 x, y, z;
+      gatherXYZ8 (points, loadOffsets8 (indices + i, vstride), x, y, z);
+      const __m256 dx = _mm256_sub_ps (x, cx), dy = _mm256_sub_ps (y, cy), dz = _mm256_sub_ps (z, cz);
+      const __m256 sqr_norm = _mm256_add_ps (_mm256_add_ps (_mm256_mul_ps (dx, dx), _mm256_mul_ps (dy, dy)), _mm256_mul_ps (dz, dz));
+      _mm256_storeu_ps (distances + i, abs8 (_mm256_sub_ps (_mm256_sqrt_ps (sqr_norm), r)));
+    }
+    sphereDistancesScalar (points, stride, indices + i, nr_indices - i, c, distances + i);
+  }
+
+  PCL_SAC_TARGET_AVX2 void
+  lineSqrDistancesAVX2 (const float *points, size_t stride, const int *indices, size_t nr_indices,
+                        const float lp[3], const float ld[3], float *sqr_distances)
+  {
+    const __m256i vstride = _mm256_set1_epi32 (static_cast<int> (stride));
+    const __m256 px = _mm256_set1_ps (lp[0]), py = _mm256_set1_ps (lp[1]), pz = _mm256_set1_ps (lp[2]);
+    const __m256 dx = _mm256_set1_ps (ld[0]), dy = _mm256_set1_ps (ld[1]), dz = _mm256_set1_ps (ld[2]);
+    size_t i = 0;
+    for (; i + 8 <= nr_indices; i += 8)
+    {
+      __m256 x, y, z;
+      gatherXYZ8 (points, loadOffsets8 (indices + i, vstride), x, y, z);
+      _mm256_storeu_ps (sqr_distances + i, crossSqrNorm8 (_mm256_sub_ps (px, x), _mm256_sub_ps (py, y), _mm256_sub_ps (pz, z), dx, dy, dz));
+    }
+    lineSqrDistancesScalar (points, stride, indices + i, nr_indices - i, lp, ld, sqr_distances + i);
+  }
+
+  PCL_SAC_TARGET_AVX2 void
+  cylinderDistancesAVX2 (const float *points, size_t stride, const float *normals, size_t normal_stride,
+                         const int *indices, size_t nr_indices,
+                         const float lp[3], const float ld[3], float radius,
+                         float *euclidean_distances, float *normal_cosines)
+  {
+    const float dir_sqr_norm = (ld[0] * ld[0] + ld[1] * ld[1]) + ld[2] * ld[2];
+    const float pt_dot_dir = (lp[0] * ld[0] + lp[1] * ld[1]) + lp[2] * ld[2];
+    const __m256i vstride = _mm256_set1_epi32 (static_cast<int> (stride));
+    const __m256i vnormal_stride = _mm256_set1_epi32 (static_cast<int> (normal_stride));
+    const __m256 px = _mm256_set1_ps (lp[0]), py = _mm256_set1_ps (lp[1]), pz = _mm256_set1_ps (lp[2]);
+    const __m256 dx = _mm256_set1_ps (ld[0]), dy = _mm256_set1_ps (ld[1]), dz = _mm256_set1_ps (ld[2]);
+    const __m256 inv_dir_sqr_norm = _mm256_set1_ps (1.0f / dir_sqr_norm);
+    const __m256 ptdotdir = _mm256_set1_ps (pt_dot_dir);
+    const __m256 r = _mm256_set1_ps (radius);
+    size_t i = 0;
+    for (; i + 8 <= nr_indices; i += 8)
+    {
+      __m256 x, y, z, nx, ny, nz;
+      gatherXYZ8 (points, loadOffsets8 (indices + i, vstride), x, y, z);
+      gatherXYZ8 (normals, loadOffsets8 (indices + i, vnormal_stride), nx, ny, nz);
+
+      const __m256 sqr_dist = _mm256_mul_ps (crossSqrNorm8 (_mm256_sub_ps (px, x), _mm256_sub_ps (py, y), _mm256_sub_ps (pz, z), dx, dy, dz), inv_dir_sqr_norm);
+      _mm256_storeu_ps (euclidean_distances + i, abs8 (_mm256_sub_ps (_mm256_sqrt_ps (sqr_dist), r)));
+
+      const __m256 pdotd = _mm256_add_ps (_mm256_add_ps (_mm256_mul_ps (x, dx), _mm256_mul_ps (y, dy)), _mm256_mul_ps (z, dz));
+      const __m256 k = _mm256_mul_ps (_mm256_sub_ps (pdotd, ptdotdir), inv_dir_sqr_norm);
+      const __m256 wx = _mm256_sub_ps (x, _mm256_add_ps (px, _mm256_mul_ps (k, dx)));
+      const __m256 wy = _mm256_sub_ps (y, _mm256_add_ps (py, _mm256_mul_ps (k, dy)));
+      const __m256 wz = _mm256_sub_ps (z, _mm256_add_ps (pz, _mm256_mul_ps (k, dz)));
+      const __m256 n_dot_w = _mm256_add_ps (_mm256_add_ps (_mm256_mul_ps (nx, wx), _mm256_mul_ps (ny, wy)), _mm256_mul_ps (nz, wz));
+      const __m256 n_sqr_norm = _mm256_add_ps (_mm256_add_ps (_mm256_mul_ps (nx, nx), _mm256_mul_ps (ny, ny)), _mm256_mul_ps (nz, nz));
+      const __m256 w_sqr_norm = _mm256_add_ps (_mm256_add_ps (_mm256_mul_ps (wx, wx), _mm256_mul_ps (wy, wy)), _mm256_mul_ps (wz, wz));
+      _mm256_storeu_ps (normal_cosines + i, _mm256_div_ps (n_dot_w, _mm256_sqrt_ps (_mm256_mul_ps (n_sqr_norm, w_sqr_norm))));
+    }
+    cylinderDistancesScalar (points, stride, normals, normal_stride, indices + i, nr_indices - i,
+                             lp, ld, radius, euclidean_distances + i, normal_cosines + i);
+  }
+#endif
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+pcl::detail::SacKernelInstructionSet
+pcl::detail::getSacKernelInstructionSet ()
+{
+  static const int supported_instruction_set = detectInstructionSet ();
+  return (static_cast<SacKernelInstructionSet> (supported_instruction_set < max_instruction_set ? supported_instruction_set : max_instruction_set));
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+void
+pcl::detail::setSacKernelInstructionSet (SacKernelInstructionSet isa)
+{
+  max_instruction_set = isa;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+void
+pcl::detail::computePlaneDistances (const float *points, size_t stride, size_t nr_points,
+                                    const int *indices, size_t nr_indices,
+                                    const float coefficients[4], float *distances)
+{
+  switch (getInstructionSet (stride, nr_points))
+  {
+#ifdef PCL_SAC_KERNELS_AVX2
+    case SAC_KERNEL_AVX2:
+      planeDistancesAVX2 (points, stride, indices, nr_indices, coefficients, distances);
+      return;
+#endif
+#ifdef PCL_SAC_KERNELS_SSE2
+    case SAC_KERNEL_SSE2:
+      planeDistancesSSE2 (points, stride, indices, nr_indices, coefficients, distances);
+      return;
+#endif
+    default:
+      planeDistancesScalar (points, stride, indices, nr_indices, coefficients, distances);
+  }
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+void
+pcl::detail::computeSphereDistances (const float *points, size_t stride, size_t nr_points,
+                                     const int *indices, size_t nr_indices,
+                                     const float coefficients[4], float *distances)
+{
+  switch (getInstructionSet (stride, nr_points))
+  {
+#ifdef PCL_SAC_KERNELS_AVX2
+    case SAC_KERNEL_AVX2:
+      sphereDistancesAVX2 (points, stride, indices, nr_indices, coefficients, distances);
+      return;
+#endif
+#ifdef PCL_SAC_KERNELS_SSE2
+    case SAC_KERNEL_SSE2:
+      sphereDistancesSSE2 (points, stride, indices, nr_indices, coefficients, distances);
+      return;
+#endif
+    default:
+      sphereDistancesScalar (points, stride, indices, nr_indices, coefficients, distances);
+  }
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+void
+pcl::detail::computeLineSqrDistances (const float *points, size_t stride, size_t nr_points,
+                                      const int *indices, size_t nr_indices,
+                                      const float line_pt[3], const float line_dir[3], float *sqr_distances)
+{
+  switch (getInstructionSet (stride, nr_points))
+  {
+#ifdef PCL_SAC_KERNELS_AVX2
+    case SAC_KERNEL_AVX2:
+      lineSqrDistancesAVX2 (points, stride, indices, nr_indices, line_pt, line_dir, sqr_distances);
+      return;
+#endif
+#ifdef PCL_SAC_KERNELS_SSE2
+    case SAC_KERNEL_SSE2:
+      lineSqrDistancesSSE2 (points, stride, indices, nr_indices, line_pt, line_dir, sqr_distances);
+      return;
+#endif
+    default:
+      lineSqrDistancesScalar (points, stride, indices, nr_indices, line_pt, line_dir, sqr_distances);
+  }
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+void
+pcl::detail::computeCylinderDistances (const float *points, size_t stride,
+                                       const float *normals, size_t normal_stride, size_t nr_points,
+                                       const int *indices, size_t nr_indices,
+                                       const float line_pt[3], const float line_dir[3], float radius,
+                                       float *euclidean_distances, float *normal_cosines)
+{
+  const size_t max_stride = stride > normal_stride ? stride : normal_stride;
+  switch (getInstructionSet (max_stride, nr_points))
+  {
+#ifdef PCL_SAC_KERNELS_AVX2
+    case SAC_KERNEL_AVX2:
+      cylinderDistancesAVX2 (points, stride, normals, normal_stride, indices, nr_indices,
+                             line_pt, line_dir, radius, euclidean_distances, normal_cosines);
+      return;
+#endif
+#ifdef PCL_SAC_KERNELS_SSE2
+    case SAC_KERNEL_SSE2:
+      cylinderDistancesSSE2 (points, stride, normals, normal_stride, indices, nr_indices,
+                             line_pt, line_dir, radius, euclidean_distances, normal_cosines);
+      return;
+#endif
+    default:
+      cylinderDistancesScalar (points, stride, normals, normal_stride, indices, nr_indices,
+                               line_pt, line_dir, radius, euclidean_distances, normal_cosines);
+  }
+}
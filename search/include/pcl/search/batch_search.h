@@ -0,0 +1,338 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2012-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#ifndef PCL_SEARCH_BATCH_SEARCH_H_
+#define PCL_SEARCH_BATCH_SEARCH_H_
+
+#include <vector>
+#include <cstddef>
+#include <algorithm>
+#include <utility>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+namespace pcl
+{
+  namespace search
+  {
+    /** \brief Results of a batch of neighbor queries, stored contiguously in a CSR-like layout.
+      *
+      * The neighbors of the i-th query are stored at positions [offsets[i], offsets[i+1]) of
+      * \a indices and \a sqr_distances, so that no memory is allocated per query.
+      *
+      * \ingroup search
+      */
+    struct BatchSearchResult
+    {
+      /** \brief Start of the neighbors of each query, followed by the total number of neighbors. */
+      std::vector<size_t> offsets;
+
+      /** \brief The indices of the neighbors of all the queries. */
+      std::vector<int> indices;
+
+      /** \brief The squared distances to the neighbors of all the queries. */
+      std::vector<float> sqr_distances;
+
+      /** \brief Get the number of queries stored. */
+      inline size_t
+      size () const
+      {
+        return (offsets.empty () ? 0 : offsets.size () - 1);
+      }
+
+      /** \brief Get the number of neighbors found for a query.
+        * \param[in] query the index of the query in the batch
+        */
+      inline int
+      getNumberOfNeighbors (size_t query) const
+      {
+        return (static_cast<int> (offsets[query + 1] - offsets[query]));
+      }
+
+      /** \brief Remove all the stored results, keeping the allocated memory for reuse. */
+      inline void
+      clear ()
+      {
+        offsets.clear ();
+        indices.clear ();
+        sqr_distances.clear ();
+      }
+    };
+
+    namespace detail
+    {
+      /** \brief Get the number of threads to use for a batch of queries.
+        * \param[in] nr_threads the requested number of threads (0 for automatic)
+        */
+      inline int
+      getBatchNumberOfThreads (unsigned int nr_threads)
+      {
+#ifdef _OPENMP
+        return (nr_threads == 0 ? omp_get_num_procs () : static_cast<int> (nr_threads));
+#else
+        (void) nr_threads;
+        return (1);
+#endif
+      }
+
+      /** \brief Remove the unused slots of a batch of k-nearest neighbor queries stored with a fixed stride
+        * of \a k, where \a result.offsets[i + 1] holds the number of neighbors found for the query i.
+        * \param[in] k the stride of the stored neighbors
+        * \param[in,out] result the results to compact
+        */
+      inline void
+      compactBatchNearestKSearch (int k, BatchSearchResult &result)
+      {
+        const size_t nr_queries = result.size ();
+        size_t total = 0;
+        result.offsets[0] = 0;
+        for (size_t i = 0; i < nr_queries; ++i)
+        {
+          const size_t found = std::min (result.offsets[i + 1], static_cast<size_t> (k));
+          const size_t stride_offset = i * static_cast<size_t> (k);
+          // Slots are only ever moved towards the front, so copying in place is safe
+          if (total != stride_offset)
+          {
+            std::copy (result.indices.begin () + stride_offset, result.indices.begin () + stride_offset + found,
+                       result.indices.begin () + total);
+            std::copy (result.sqr_distances.begin () + stride_offset, result.sqr_distances.begin () + stride_offset + found,
+                       result.sqr_distances.begin () + total);
+          }
+          total += found;
+          result.offsets[i + 1] = total;
+        }
+        result.indices.resize (total);
+        result.sqr_distances.resize (total);
+      }
+
+      /** \brief Run a batch of k-nearest neighbor queries in parallel.
+        * \param[in] query the functor running the i-th query, as
+        * <tt>int query (size_t i, std::vector<int> &k_indices, std::vector<float> &k_sqr_distances)</tt>
+        * \param[in] nr_queries the number of queries in the batch
+        * \param[in] k the number of neighbors to search for
+        * \param[in] nr_threads the number of threads to use (0 for automatic)
+        * \param[out] result the neighbors of all the queries
+        */
+      template <typename QueryFunctor> void
+      batchNearestKSearch (const QueryFunctor &query, size_t nr_queries, int k, unsigned int nr_threads,
+                           BatchSearchResult &result)
+      {
+        result.offsets.assign (nr_queries + 1, 0);
+        if (k <= 0)
+        {
+          result.indices.clear ();
+          result.sqr_distances.clear ();
+          return;
+        }
+        result.indices.resize (nr_queries * k);
+        result.sqr_distances.resize (nr_queries * k);
+
+        const int threads = getBatchNumberOfThreads (nr_threads);
+        // Scratch buffers are reused by all the queries of a thread
+        std::vector<int> k_indices (k);
+        std::vector<float> k_sqr_distances (k);
+        bool complete = true;
+#ifdef _OPENMP
+#pragma omp parallel for firstprivate (k_indices, k_sqr_distances) reduction (&& : complete) schedule (dynamic, 256) num_threads (threads)
+#endif
+        for (int i = 0; i < static_cast<int> (nr_queries); ++i)
+        {
+          const int nr_found = query (static_cast<size_t> (i), k_indices, k_sqr_distances);
+          const int found = std::min (std::min (nr_found, k), static_cast<int> (k_indices.size ()));
+          const size_t stride_offset = static_cast<size_t> (i) * k;
+          if (found > 0)
+          {
+            std::copy (k_indices.begin (), k_indices.begin () + found, result.indices.begin () + stride_offset);
+            std::copy (k_sqr_distances.begin (), k_sqr_distances.begin () + found, result.sqr_distances.begin () + stride_offset);
+          }
+          result.offsets[i + 1] = found > 0 ? found : 0;
+          if (found != k)
+            complete = false;
+        }
+
+        if (complete)
+        {
+          for (size_t i = 0; i <= nr_queries; ++i)
+            result.offsets[i] = i * k;
+        }
+        else
+          compactBatchNearestKSearch (k, result);
+      }
+
+      /** \brief Run a batch of radius queries in parallel.
+        *
+        * The queries are split into contiguous chunks, each of them gathering its neighbors in its own flat
+        * buffers, which are concatenated in order at the end.
+        *
+        * \param[in] query the functor running the i-th query, as
+        * <tt>int query (size_t i, std::vector<int> &k_indices, std::vector<float> &k_sqr_distances)</tt>
+        * \param[in] nr_queries the number of queries in the batch
+        * \param[in] nr_threads the number of threads to use (0 for automatic)
+        * \param[out] result the neighbors of all the queries
+        */
+      template <typename QueryFunctor> void
+      batchRadiusSearch (const QueryFunctor &query, size_t nr_queries, unsigned int nr_threads,
+                         BatchSearchResult &result)
+      {
+        const int threads = getBatchNumberOfThreads (nr_threads);
+        // A few chunks per thread balance the load when the neighborhood sizes vary
+        const int nr_chunks = static_cast<int> (std::min (nr_queries, static_cast<size_t> (threads) * 8));
+
+        result.offsets.assign (nr_queries + 1, 0);
+        std::vector<std::vector<int> > chunk_indices (nr_chunks);
+        std::vector<std::vector<float> > chunk_sqr_distances (nr_chunks);
+#ifdef _OPENMP
+#pragma omp parallel for schedule (dynamic, 1) num_threads (threads)
+#endif
+        for (int c = 0; c < nr_chunks; ++c)
+        {
+          std::vector<int> k_indices;
+          std::vector<float> k_sqr_distances;
+          const size_t end = nr_queries * (c + 1) / nr_chunks;
+          for (size_t i = nr_queries * c / nr_chunks; i < end; ++i)
+          {
+            const int found = query (i, k_indices, k_sqr_distances);
+            const size_t nr_neighbors = found > 0 ? std::min (static_cast<size_t> (found), k_indices.size ()) : 0;
+            chunk_indices[c].insert (chunk_indices[c].end (), k_indices.begin (), k_indices.begin () + nr_neighbors);
+            chunk_sqr_distances[c].insert (chunk_sqr_distances[c].end (), k_sqr_distances.begin (), k_sqr_distances.begin () + nr_neighbors);
+            // Store the count for now, turned into offsets below
+            result.offsets[i + 1] = nr_neighbors;
+          }
+        }
+
+        std::vector<size_t> chunk_offsets (nr_chunks + 1, 0);
+        for (int c = 0; c < nr_chunks; ++c)
+          chunk_offsets[c + 1] = chunk_offsets[c] + chunk_indices[c].size ();
+        for (size_t i = 0; i < nr_queries; ++i)
+          result.offsets[i + 1] += result.offsets[i];
+
+        result.indices.resize (chunk_offsets[nr_chunks]);
+        result.sqr_distances.resize (chunk_offsets[nr_chunks]);
+#ifdef _OPENMP
+#pragma omp parallel for num_threads (threads)
+#endif
+        for (int c = 0; c < nr_chunks; ++c)
+        {
+          std::copy (chunk_indices[c].begin (), chunk_indices[c].end (), result.indices.begin () + chunk_offsets[c]);
+          std::copy (chunk_sqr_distances[c].begin (), chunk_sqr_distances[c].end (), result.sqr_distances.begin () + chunk_offsets[c]);
+        }
+      }
+
+      /** \brief Sort the neighbors of each query of a batch in ascending order of their distance.
+        * \param[in,out] result the results to sort
+        * \param[in] nr_threads the number of threads to use (0 for automatic)
+        */
+      inline void
+      sortBatchSearchResult (BatchSearchResult &result, unsigned int nr_threads)
+      {
+        const int threads = getBatchNumberOfThreads (nr_threads);
+        std::vector<std::pair<float, int> > neighbors;
+#ifdef _OPENMP
+#pragma omp parallel for firstprivate (neighbors) schedule (dynamic, 256) num_threads (threads)
+#endif
+        for (int i = 0; i < static_cast<int> (result.size ()); ++i)
+        {
+          const size_t begin = result.offsets[i];
+          const size_t end = result.offsets[i + 1];
+          neighbors.resize (end - begin);
+          for (size_t j = begin; j < end; ++j)
+            neighbors[j - begin] = std::make_pair (result.sqr_distances[j], result.indices[j]);
+          std::sort (neighbors.begin (), neighbors.end ());
+          for (size_t j = begin; j < end; ++j)
+          {
+            result.sqr_distances[j] = neighbors[j - begin].first;
+            result.indices[j] = neighbors[j - begin].second;
+          }
+        }
+      }
+
+      /** \brief Functor running a k-nearest neighbor query for the i-th point of a batch through \a Searcher,
+        * which must provide <tt>nearestKSearch (cloud, index, k, k_indices, k_sqr_distances)</tt>.
+        */
+      template <typename Searcher, typename PointCloudT>
+      struct NearestKSearchQuery
+      {
+        NearestKSearchQuery (Searcher &searcher, const PointCloudT &cloud, const std::vector<int> &indices, int k)
+          : searcher_ (searcher), cloud_ (cloud), indices_ (indices), k_ (k)
+        {
+        }
+
+        inline int
+        operator () (size_t i, std::vector<int> &k_indices, std::vector<float> &k_sqr_distances) const
+        {
+          const int index = indices_.empty () ? static_cast<int> (i) : indices_[i];
+          return (searcher_.nearestKSearch (cloud_, index, k_, k_indices, k_sqr_distances));
+        }
+
+        Searcher &searcher_;
+        const PointCloudT &cloud_;
+        const std::vector<int> &indices_;
+        int k_;
+      };
+
+      /** \brief Functor running a radius query for the i-th point of a batch through \a Searcher,
+        * which must provide <tt>radiusSearch (cloud, index, radius, k_indices, k_sqr_distances, max_nn)</tt>.
+        */
+      template <typename Searcher, typename PointCloudT>
+      struct RadiusSearchQuery
+      {
+        RadiusSearchQuery (Searcher &searcher, const PointCloudT &cloud, const std::vector<int> &indices,
+                           double radius, unsigned int max_nn)
+          : searcher_ (searcher), cloud_ (cloud), indices_ (indices), radius_ (radius), max_nn_ (max_nn)
+        {
+        }
+
+        inline int
+        operator () (size_t i, std::vector<int> &k_indices, std::vector<float> &k_sqr_distances) const
+        {
+          const int index = indices_.empty () ? static_cast<int> (i) : indices_[i];
+          return (searcher_.radiusSearch (cloud_, index, radius_, k_indices, k_sqr_distances, max_nn_));
+        }
+
+        Searcher &searcher_;
+        const PointCloudT &cloud_;
+        const std::vector<int> &indices_;
+        double radius_;
+        unsigned int max_nn_;
+      };
+    }
+  }
+}
+
+#endif  //#ifndef PCL_SEARCH_BATCH_SEARCH_H_
@@ -103,6 +103,7 @@ namespace pcl
       using Search<PointT>::input_;
       using Search<PointT>::indices_;
       using Search<PointT>::sorted_results_;
+      using Search<PointT>::threads_;
 
       public:
         typedef boost::shared_ptr<FlannSearch<PointT, FlannDistance> > Ptr;
@@ -124,6 +125,8 @@ namespace pcl
         typedef boost::shared_ptr<PointRepresentation> PointRepresentationPtr;
         typedef boost::shared_ptr<const PointRepresentation> PointRepresentationConstPtr;
 
+        using Search<PointT>::radiusSearch;
+
         /** \brief Helper class that creates a FLANN index from a given FLANN matrix. To
           * use a FLANN index type with FlannSearch, implement this interface and
           * pass an object of the new type to the FlannSearch constructor.
@@ -284,6 +287,17 @@ namespace pcl
         nearestKSearch (const PointCloud& cloud, const std::vector<int>& indices, int k, 
                         std::vector< std::vector<int> >& k_indices, std::vector< std::vector<float> >& k_sqr_distances) const;
 
+        /** \brief Search for the k-nearest neighbors of a batch of query points, in parallel.
+          * The whole batch is handed to FLANN in one block per thread, which writes straight into \a result.
+          * \param[in] cloud the point cloud data
+          * \param[in] indices a vector of point cloud indices to query for nearest neighbors. If indices is empty,
+          * neighbors will be searched for all points.
+          * \param[in] k the number of neighbors to search for
+          * \param[out] result the neighbors of all the query points, the i-th query point corresponding to indices[i]
+          */
+        virtual void
+        nearestKSearch (const PointCloud& cloud, const std::vector<int>& indices, int k, BatchSearchResult& result) const;
+
         /** \brief Search for all the nearest neighbors of the query point in a given radius.
           * \param[in] point the given query point
           * \param[in] radius the radius of the sphere bounding all of p_q's neighbors
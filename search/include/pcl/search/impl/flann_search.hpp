@@ -225,6 +225,97 @@ pcl::search::FlannSearch<PointT, FlannDistance>::nearestKSearch (
   }
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT, typename FlannDistance> void
+pcl::search::FlannSearch<PointT, FlannDistance>::nearestKSearch (
+    const PointCloud& cloud, const std::vector<int>& indices, int k, BatchSearchResult& result) const
+{
+  const size_t nr_queries = indices.empty () ? cloud.size () : indices.size ();
+  // FLANN cannot return more neighbors than there are points in the index
+  k = std::min (k, static_cast<int> (index_->size ()));
+  result.offsets.assign (nr_queries + 1, 0);
+  if (k <= 0 || nr_queries == 0)
+  {
+    result.indices.clear ();
+    result.sqr_distances.clear ();
+    return;
+  }
+  // Slots FLANN does not fill stay marked as unused
+  result.indices.assign (nr_queries * k, -1);
+  result.sqr_distances.resize (nr_queries * k);
+
+  // full point cloud + trivial copy operation = no need to do any conversion/copying to the flann matrix!
+  const bool can_cast = indices.empty () && point_representation_->isTrivial ();
+  float* data = 0;
+  if (!can_cast)
+  {
+    data = new float [dim_ * nr_queries];
+    for (size_t i = 0; i < nr_queries; ++i)
+    {
+      const PointT& point = indices.empty () ? cloud[i] : cloud[indices[i]];
+      assert (point_representation_->isValid (point) && "Invalid (NaN, Inf) point coordinates given to nearestKSearch!");
+      float* out = data + i * dim_;
+      point_representation_->vectorize (point, out);
+    }
+  }
+  // const cast is evil, but the matrix constructor won't change the data, and the
+  // search won't change the matrix
+  const char* cdata = can_cast ? reinterpret_cast<const char*> (&cloud[0]) : reinterpret_cast<const char*> (data);
+  const size_t stride = can_cast ? sizeof (PointT) : dim_ * sizeof (float);
+
+  flann::SearchParams p;
+  p.sorted = sorted_results_;
+  p.eps = eps_;
+  p.checks = checks_;
+
+  // Each thread hands a contiguous block of queries to FLANN, writing its results in place
+  const int threads = detail::getBatchNumberOfThreads (threads_);
+  const int nr_blocks = static_cast<int> (std::min (nr_queries, static_cast<size_t> (threads)));
+#ifdef _OPENMP
+#pragma omp parallel for num_threads (threads)
+#endif
+  for (int b = 0; b < nr_blocks; ++b)
+  {
+    const size_t begin = nr_queries * b / nr_blocks;
+    const size_t end = nr_queries * (b + 1) / nr_blocks;
+    if (begin == end)
+      continue;
+    const flann::Matrix<float> m (const_cast<float*> (reinterpret_cast<const float*> (cdata + begin * stride)),
+                                  end - begin, dim_, stride);
+    flann::Matrix<int> i (&result.indices[begin * k], end - begin, k);
+    flann::Matrix<float> d (&result.sqr_distances[begin * k], end - begin, k);
+    index_->knnSearch (m, i, d, k, p);
+  }
+  delete [] data;
+
+  // Count the neighbors found (unused slots are marked with -1) and map them back to the input indices
+  bool complete = true;
+  for (size_t q = 0; q < nr_queries; ++q)
+  {
+    size_t found = 0;
+    for (size_t j = q * k; j < (q + 1) * k; ++j)
+    {
+      int& neighbor_index = result.indices[j];
+      if (neighbor_index < 0)
+        continue;
+      if (!identity_mapping_)
+        neighbor_index = index_mapping_[neighbor_index];
+      ++found;
+    }
+    result.offsets[q + 1] = found;
+    if (found != static_cast<size_t> (k))
+      complete = false;
+  }
+
+  if (complete)
+  {
+    for (size_t q = 0; q <= nr_queries; ++q)
+      result.offsets[q] = q * k;
+  }
+  else
+    detail::compactBatchNearestKSearch (k, result);
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointT, typename FlannDistance> int
 pcl::search::FlannSearch<PointT, FlannDistance>::radiusSearch (const PointT& point, double radius,
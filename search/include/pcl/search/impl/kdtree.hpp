@@ -102,6 +102,28 @@ pcl::search::KdTree<PointT,Tree>::radiusSearch (
   return (tree_->radiusSearch (point, radius, k_indices, k_sqr_distances, max_nn));
 }
 
+///////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT, class Tree> void
+pcl::search::KdTree<PointT,Tree>::nearestKSearch (
+    const PointCloud& cloud, const std::vector<int>& indices,
+    int k, BatchSearchResult& result) const
+{
+  const size_t nr_queries = indices.empty () ? cloud.size () : indices.size ();
+  detail::NearestKSearchQuery<const Tree, PointCloud> query (*tree_, cloud, indices, k);
+  detail::batchNearestKSearch (query, nr_queries, k, threads_, result);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT, class Tree> void
+pcl::search::KdTree<PointT,Tree>::radiusSearch (
+    const PointCloud& cloud, const std::vector<int>& indices, double radius,
+    BatchSearchResult& result, unsigned int max_nn) const
+{
+  const size_t nr_queries = indices.empty () ? cloud.size () : indices.size ();
+  detail::RadiusSearchQuery<const Tree, PointCloud> query (*tree_, cloud, indices, radius, max_nn);
+  detail::batchRadiusSearch (query, nr_queries, threads_, result);
+}
+
 #define PCL_INSTANTIATE_KdTree(T) template class PCL_EXPORTS pcl::search::KdTree<T>;
 
 #endif  //#ifndef _PCL_SEARCH_KDTREE_IMPL_HPP_
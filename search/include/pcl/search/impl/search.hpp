@@ -47,6 +47,7 @@ pcl::search::Search<PointT>::Search (const std::string& name, bool sorted)
   , indices_ ()
   , sorted_results_ (sorted)
   , name_ (name)
+  , threads_ (0)
 {
 }
 
@@ -135,6 +136,17 @@ pcl::search::Search<PointT>::nearestKSearch (
   }
 }
 
+///////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> void
+pcl::search::Search<PointT>::nearestKSearch (
+    const PointCloud& cloud, const std::vector<int>& indices,
+    int k, BatchSearchResult& result) const
+{
+  const size_t nr_queries = indices.empty () ? cloud.size () : indices.size ();
+  detail::NearestKSearchQuery<const Search<PointT>, PointCloud> query (*this, cloud, indices, k);
+  detail::batchNearestKSearch (query, nr_queries, k, threads_, result);
+}
+
 ///////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointT> int
 pcl::search::Search<PointT>::radiusSearch (
@@ -190,6 +202,20 @@ pcl::search::Search<PointT>::radiusSearch (
   }
 }
 
+///////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> void
+pcl::search::Search<PointT>::radiusSearch (
+    const PointCloud& cloud,
+    const std::vector<int>& indices,
+    double radius,
+    BatchSearchResult& result,
+    unsigned int max_nn) const
+{
+  const size_t nr_queries = indices.empty () ? cloud.size () : indices.size ();
+  detail::RadiusSearchQuery<const Search<PointT>, PointCloud> query (*this, cloud, indices, radius, max_nn);
+  detail::batchRadiusSearch (query, nr_queries, threads_, result);
+}
+
 ///////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointT> void
 pcl::search::Search<PointT>::sortResults (
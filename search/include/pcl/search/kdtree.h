@@ -75,6 +75,7 @@ namespace pcl
         using pcl::search::Search<PointT>::nearestKSearch;
         using pcl::search::Search<PointT>::radiusSearch;
         using pcl::search::Search<PointT>::sorted_results_;
+        using pcl::search::Search<PointT>::threads_;
 
         typedef boost::shared_ptr<KdTree<PointT, Tree> > Ptr;
         typedef boost::shared_ptr<const KdTree<PointT, Tree> > ConstPtr;
@@ -166,6 +167,33 @@ namespace pcl
                       std::vector<int> &k_indices, 
                       std::vector<float> &k_sqr_distances,
                       unsigned int max_nn = 0) const;
+
+        /** \brief Search for the k-nearest neighbors of a batch of query points, in parallel.
+          * The queries are sent straight to the underlying tree.
+          * \param[in] cloud the point cloud data
+          * \param[in] indices a vector of point cloud indices to query for nearest neighbors. If indices is empty,
+          * neighbors will be searched for all points.
+          * \param[in] k the number of neighbors to search for
+          * \param[out] result the neighbors of all the query points, the i-th query point corresponding to indices[i]
+          */
+        void
+        nearestKSearch (const PointCloud& cloud, const std::vector<int>& indices,
+                        int k, BatchSearchResult& result) const;
+
+        /** \brief Search for all the nearest neighbors of a batch of query points in a given radius, in parallel.
+          * The queries are sent straight to the underlying tree.
+          * \param[in] cloud the point cloud data
+          * \param[in] indices the indices in \a cloud. If indices is empty, neighbors will be searched for all points.
+          * \param[in] radius the radius of the sphere bounding all of p_q's neighbors
+          * \param[out] result the neighbors of all the query points, the i-th query point corresponding to indices[i]
+          * \param[in] max_nn if given, bounds the maximum returned neighbors to this value. If \a max_nn is set to
+          * 0 or to a number higher than the number of points in the input cloud, all neighbors in \a radius will be
+          * returned.
+          */
+        void
+        radiusSearch (const PointCloud& cloud, const std::vector<int>& indices, double radius,
+                      BatchSearchResult& result, unsigned int max_nn = 0) const;
+
       protected:
         /** \brief A pointer to the internal KdTree object. */
         KdTreePtr tree_;
@@ -95,6 +95,7 @@ namespace pcl
         Octree (const double resolution)
           : Search<PointT> ("Octree")
           , tree_ (new pcl::octree::OctreePointCloudSearch<PointT, LeafTWrap, BranchTWrap> (resolution))
+          , contiguous_leaves_ (false)
         {
         }
 
@@ -104,6 +105,27 @@ namespace pcl
         {
         }
 
+        /** \brief Store the points of each octree leaf contiguously, so that the searches scan the leaves with
+          * vectorizable loops. See pcl::octree::OctreePointCloudSearch::buildContiguousLeaves.
+          * \param[in] enabled whether to build the contiguous leaves along with the octree
+          */
+        inline void
+        setContiguousLeaves (bool enabled)
+        {
+          contiguous_leaves_ = enabled;
+          if (!enabled)
+            tree_->clearContiguousLeaves ();
+          else if (input_)
+            tree_->buildContiguousLeaves ();
+        }
+
+        /** \brief Check whether the points of each octree leaf are stored contiguously. */
+        inline bool
+        getContiguousLeaves () const
+        {
+          return (contiguous_leaves_);
+        }
+
         /** \brief Provide a pointer to the input dataset.
           * \param[in] cloud the const boost shared pointer to a PointCloud message
           */
@@ -113,6 +135,8 @@ namespace pcl
           tree_->deleteTree ();
           tree_->setInputCloud (cloud);
           tree_->addPointsFromInputCloud ();
+          if (contiguous_leaves_)
+            tree_->buildContiguousLeaves ();
           input_ = cloud;
         }
 
@@ -126,6 +150,8 @@ namespace pcl
           tree_->deleteTree ();
           tree_->setInputCloud (cloud, indices);
           tree_->addPointsFromInputCloud ();
+          if (contiguous_leaves_)
+            tree_->buildContiguousLeaves ();
           input_ = cloud;
           indices_ = indices;
         }
@@ -242,6 +268,40 @@ namespace pcl
         }
 
 
+        /** \brief Search for the k-nearest neighbors of a batch of query points, in parallel.
+          * The queries are run by the underlying octree in Morton order of their voxels.
+          * \param[in] cloud the point cloud data
+          * \param[in] indices a vector of point cloud indices to query for nearest neighbors. If indices is empty,
+          * neighbors will be searched for all points.
+          * \param[in] k the number of neighbors to search for
+          * \param[out] result the neighbors of all the query points, the i-th query point corresponding to indices[i]
+          */
+        inline void
+        nearestKSearch (const PointCloud &cloud, const std::vector<int> &indices, int k,
+                        BatchSearchResult &result) const
+        {
+          tree_->nearestKSearch (cloud, indices, k, result.offsets, result.indices, result.sqr_distances,
+                                 this->threads_);
+        }
+
+        /** \brief Search for all the nearest neighbors of a batch of query points in a given radius, in parallel.
+          * The queries are run by the underlying octree in packets of neighboring queries.
+          * \param[in] cloud the point cloud data
+          * \param[in] indices the indices in \a cloud. If indices is empty, neighbors will be searched for all points.
+          * \param[in] radius the radius of the sphere bounding all of p_q's neighbors
+          * \param[out] result the neighbors of all the query points, the i-th query point corresponding to indices[i]
+          * \param[in] max_nn if given, bounds the maximum returned neighbors to this value
+          */
+        inline void
+        radiusSearch (const PointCloud &cloud, const std::vector<int> &indices, double radius,
+                      BatchSearchResult &result, unsigned int max_nn = 0) const
+        {
+          tree_->radiusSearch (cloud, indices, radius, result.offsets, result.indices, result.sqr_distances,
+                               max_nn, this->threads_);
+          if (sorted_results_)
+            detail::sortBatchSearchResult (result, this->threads_);
+        }
+
         /** \brief Search for approximate nearest neighbor at the query point.
           * \param[in] cloud the point cloud data
           * \param[in] query_index the index in \a cloud representing the query point
@@ -280,6 +340,9 @@ namespace pcl
           return (tree_->approxNearestSearch (query_index, result_index, sqr_distance));
         }
 
+      protected:
+        /** \brief Whether the points of each octree leaf are stored contiguously. */
+        bool contiguous_leaves_;
     };
   }
 }
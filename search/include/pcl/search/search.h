@@ -43,6 +43,7 @@
 #include <pcl/for_each_type.h>
 #include <pcl/common/concatenate.h>
 #include <pcl/common/copy_point.h>
+#include <pcl/search/batch_search.h>
 
 namespace pcl
 {
@@ -134,6 +135,15 @@ namespace pcl
           return (indices_);
         }
 
+        /** \brief Set the number of threads used by the batch queries writing into a \ref BatchSearchResult.
+          * \param[in] nr_threads the number of hardware threads to use (0 sets the value back to automatic)
+          */
+        inline void
+        setNumberOfThreads (unsigned int nr_threads = 0)
+        {
+          threads_ = nr_threads;
+        }
+
         /** \brief Search for the k-nearest neighbors for the given query point.
           * \param[in] point the given query point
           * \param[in] k the number of neighbors to search for
@@ -219,6 +229,19 @@ namespace pcl
                         int k, std::vector< std::vector<int> >& k_indices,
                         std::vector< std::vector<float> >& k_sqr_distances) const;
 
+        /** \brief Search for the k-nearest neighbors of a batch of query points, in parallel.
+          * \param[in] cloud the point cloud data
+          * \param[in] indices a vector of point cloud indices to query for nearest neighbors. If indices is empty,
+          * neighbors will be searched for all points.
+          * \param[in] k the number of neighbors to search for
+          * \param[out] result the neighbors of all the query points, the i-th query point corresponding to indices[i]
+          * \note The scratch buffers are reused across the queries of a thread, so no memory is allocated per query.
+          * The number of threads is set through \ref setNumberOfThreads.
+          */
+        virtual void
+        nearestKSearch (const PointCloud& cloud, const std::vector<int>& indices,
+                        int k, BatchSearchResult& result) const;
+
         /** \brief Search for the k-nearest neighbors for the given query point. Use this method if the query points are of a different type than the points in the data set (e.g. PointXYZRGBA instead of PointXYZ).
           * \param[in] cloud the point cloud data
           * \param[in] indices a vector of point cloud indices to query for nearest neighbors
@@ -355,6 +378,23 @@ namespace pcl
                       std::vector< std::vector<float> > &k_sqr_distances,
                       unsigned int max_nn = 0) const;
 
+        /** \brief Search for all the nearest neighbors of a batch of query points in a given radius, in parallel.
+          * \param[in] cloud the point cloud data
+          * \param[in] indices the indices in \a cloud. If indices is empty, neighbors will be searched for all points.
+          * \param[in] radius the radius of the sphere bounding all of p_q's neighbors
+          * \param[out] result the neighbors of all the query points, the i-th query point corresponding to indices[i]
+          * \param[in] max_nn if given, bounds the maximum returned neighbors to this value. If \a max_nn is set to
+          * 0 or to a number higher than the number of points in the input cloud, all neighbors in \a radius will be
+          * returned.
+          * \note The number of threads is set through \ref setNumberOfThreads.
+          */
+        virtual void
+        radiusSearch (const PointCloud& cloud,
+                      const std::vector<int>& indices,
+                      double radius,
+                      BatchSearchResult& result,
+                      unsigned int max_nn = 0) const;
+
         /** \brief Search for all the nearest neighbors of the query points in a given radius.
           * \param[in] cloud the point cloud data
           * \param[in] indices a vector of point cloud indices to query for nearest neighbors
@@ -404,6 +444,9 @@ namespace pcl
         IndicesConstPtr indices_;
         bool sorted_results_;
         std::string name_;
+
+        /** \brief The number of threads used by the batch queries. */
+        unsigned int threads_;
         
       private:
         struct Compare
@@ -81,6 +81,55 @@ namespace pcl
       const boost::shared_ptr<search::Search<PointT> > &tree, float tolerance, std::vector<PointIndices> &clusters, 
       unsigned int min_pts_per_cluster = 1, unsigned int max_pts_per_cluster = (std::numeric_limits<int>::max) ());
 
+  //////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+  /** \brief Decompose a region of space into clusters based on the Euclidean distance between points, using
+    * several threads. The neighborhoods of all points are searched in parallel and merged with a concurrent
+    * union-find, instead of growing one cluster after the other.
+    * \param cloud the point cloud message
+    * \param indices a list of point indices to use from \a cloud
+    * \param tree the spatial locator (e.g., kd-tree) used for nearest neighbors searching
+    * \note the tree has to be created as a spatial locator on \a cloud and \a indices
+    * \note The clusters, and their order, are the same as the ones of the serial version as long as the neighbor
+    * search is symmetric, i.e. as long as a point is a neighbor of all of its neighbors (e.g., exact kd-tree search).
+    * \param tolerance the spatial cluster tolerance as a measure in L2 Euclidean space
+    * \param clusters the resultant clusters containing point indices (as a vector of PointIndices)
+    * \param min_pts_per_cluster minimum number of points that a cluster may contain (default: 1)
+    * \param max_pts_per_cluster maximum number of points that a cluster may contain (default: max int)
+    * \param nr_threads the number of threads to use (default: 0, automatic)
+    * \ingroup segmentation
+    */
+  template <typename PointT> void 
+  extractEuclideanClustersParallel (
+      const PointCloud<PointT> &cloud, const std::vector<int> &indices, 
+      const boost::shared_ptr<search::Search<PointT> > &tree, float tolerance, std::vector<PointIndices> &clusters, 
+      unsigned int min_pts_per_cluster = 1, unsigned int max_pts_per_cluster = (std::numeric_limits<int>::max) (),
+      unsigned int nr_threads = 0);
+
+  //////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+  /** \brief Decompose a region of space into clusters based on the Euclidean distance between points, using a
+    * voxel grid instead of a spatial locator.
+    *
+    * The points are hashed into voxels whose diagonal is the cluster tolerance, so that all points of a voxel belong
+    * to the same cluster. Neighboring voxels are merged as soon as one pair of their points is closer than the
+    * tolerance, and pairs of voxels which already belong to the same cluster are not compared at all. This is much
+    * faster than a radius search per point on dense clouds, where each search returns hundreds of neighbors.
+    * \param cloud the point cloud message
+    * \param indices a list of point indices to use from \a cloud
+    * \param tolerance the spatial cluster tolerance as a measure in L2 Euclidean space
+    * \param clusters the resultant clusters containing point indices (as a vector of PointIndices), in the same
+    * order as the ones of extractEuclideanClusters
+    * \param min_pts_per_cluster minimum number of points that a cluster may contain (default: 1)
+    * \param max_pts_per_cluster maximum number of points that a cluster may contain (default: max int)
+    * \param nr_threads the number of threads to use (default: 0, automatic)
+    * \ingroup segmentation
+    */
+  template <typename PointT> void 
+  extractEuclideanClustersVoxelGrid (
+      const PointCloud<PointT> &cloud, const std::vector<int> &indices,
+      float tolerance, std::vector<PointIndices> &clusters, 
+      unsigned int min_pts_per_cluster = 1, unsigned int max_pts_per_cluster = (std::numeric_limits<int>::max) (),
+      unsigned int nr_threads = 0);
+
   //////////////////////////////////////////////////////////////////////////////////////////////////////////////////
   /** \brief Decompose a region of space into clusters based on the euclidean distance between points, and the normal
     * angular deviation
@@ -312,7 +361,9 @@ namespace pcl
       EuclideanClusterExtraction () : tree_ (), 
                                       cluster_tolerance_ (0),
                                       min_pts_per_cluster_ (1), 
-                                      max_pts_per_cluster_ (std::numeric_limits<int>::max ())
+                                      max_pts_per_cluster_ (std::numeric_limits<int>::max ()),
+                                      threads_ (1),
+                                      use_voxel_grid_ (false)
       {};
 
       /** \brief Provide a pointer to the search object.
@@ -381,6 +432,33 @@ namespace pcl
         return (max_pts_per_cluster_); 
       }
 
+      /** \brief Set the number of threads used to extract the clusters. With more than one thread, the neighborhoods
+        * are searched in parallel, see extractEuclideanClustersParallel ().
+        * \param[in] nr_threads the number of hardware threads to use (0 sets the value back to automatic)
+        */
+      inline void
+      setNumberOfThreads (unsigned int nr_threads = 0)
+      {
+        threads_ = nr_threads;
+      }
+
+      /** \brief Set whether to find the neighbors of the points with a voxel grid of the cluster tolerance instead of
+        * the search method, see extractEuclideanClustersVoxelGrid ().
+        * \param[in] use_voxel_grid true to use the voxel grid (default: false)
+        */
+      inline void
+      setUseVoxelGrid (bool use_voxel_grid)
+      {
+        use_voxel_grid_ = use_voxel_grid;
+      }
+
+      /** \brief Get whether the neighbors of the points are found with a voxel grid instead of the search method. */
+      inline bool
+      getUseVoxelGrid () const
+      {
+        return (use_voxel_grid_);
+      }
+
       /** \brief Cluster extraction in a PointCloud given by <setInputCloud (), setIndices ()>
         * \param[out] clusters the resultant point clusters
         */
@@ -406,6 +484,12 @@ namespace pcl
       /** \brief The maximum number of points that a cluster needs to contain in order to be considered valid (default = MAXINT). */
       int max_pts_per_cluster_;
 
+      /** \brief The number of threads the clusters are extracted with (default = 1). */
+      unsigned int threads_;
+
+      /** \brief Whether to use a voxel grid instead of the search method (default = false). */
+      bool use_voxel_grid_;
+
       /** \brief Class getName method. */
       virtual std::string getClassName () const { return ("EuclideanClusterExtraction"); }
 
@@ -39,6 +39,11 @@
 #define PCL_SEGMENTATION_IMPL_EXTRACT_CLUSTERS_H_
 
 #include <pcl/segmentation/extract_clusters.h>
+#include <pcl/segmentation/union_find.h>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 
 //////////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointT> void
@@ -202,6 +207,302 @@ pcl::extractEuclideanClusters (const PointCloud<PointT> &cloud,
   }
 }
 
+namespace pcl
+{
+  namespace detail
+  {
+    /** \brief Turn a labeling of the points into clusters, in the order in which extractEuclideanClusters would
+      * find them: by the position of their first point in \a indices.
+      * \param[in] indices the indices of the points
+      * \param[in] labels the label of the cluster of each point in \a indices, in [0, nr_labels)
+      * \param[in] nr_labels the number of possible labels
+      * \param[in] header the header of the clusters
+      * \param[in] min_pts_per_cluster minimum number of points that a cluster may contain
+      * \param[in] max_pts_per_cluster maximum number of points that a cluster may contain
+      * \param[in] nr_threads the number of threads to sort the clusters with (0: automatic)
+      * \param[out] clusters the clusters are appended to this vector
+      */
+    inline void
+    collectEuclideanClusters (const std::vector<int> &indices, const std::vector<int> &labels, int nr_labels,
+                              const pcl::PCLHeader &header,
+                              unsigned int min_pts_per_cluster, unsigned int max_pts_per_cluster,
+                              unsigned int nr_threads, std::vector<PointIndices> &clusters)
+    {
+#ifdef _OPENMP
+      const int threads = nr_threads == 0 ? omp_get_num_procs () : static_cast<int> (nr_threads);
+#else
+      (void) nr_threads;
+#endif
+      const int nr_indices = static_cast<int> (indices.size ());
+
+      // Number the clusters in the order of their first point in indices, which is the order in which the serial
+      // version grows them, and lay their points out one cluster after the other
+      std::vector<int> cluster_ids (nr_labels, -1);
+      std::vector<int> cluster_offsets (1, 0);
+      for (int i = 0; i < nr_indices; ++i)
+      {
+        int &id = cluster_ids[labels[i]];
+        if (id == -1)
+        {
+          id = static_cast<int> (cluster_offsets.size ()) - 1;
+          cluster_offsets.push_back (0);
+        }
+        ++cluster_offsets[id + 1];
+      }
+      const int nr_clusters = static_cast<int> (cluster_offsets.size ()) - 1;
+      for (int c = 0; c < nr_clusters; ++c)
+        cluster_offsets[c + 1] += cluster_offsets[c];
+
+      std::vector<int> cluster_points (nr_indices);
+      std::vector<int> fill (cluster_offsets.begin (), cluster_offsets.end () - 1);
+      for (int i = 0; i < nr_indices; ++i)
+        cluster_points[fill[cluster_ids[labels[i]]]++] = indices[i];
+
+      std::vector<PointIndices> candidates (nr_clusters);
+#ifdef _OPENMP
+#pragma omp parallel for num_threads(threads) schedule(dynamic, 16)
+#endif
+      for (int c = 0; c < nr_clusters; ++c)
+      {
+        std::vector<int> &r = candidates[c].indices;
+        r.assign (cluster_points.begin () + cluster_offsets[c], cluster_points.begin () + cluster_offsets[c + 1]);
+        std::sort (r.begin (), r.end ());
+        r.erase (std::unique (r.begin (), r.end ()), r.end ());
+      }
+
+      // If a cluster is satisfactory, add it to the clusters
+      for (int c = 0; c < nr_clusters; ++c)
+      {
+        if (candidates[c].indices.size () >= min_pts_per_cluster && candidates[c].indices.size () <= max_pts_per_cluster)
+        {
+          clusters.push_back (pcl::PointIndices ());
+          clusters.back ().indices.swap (candidates[c].indices);
+          clusters.back ().header = header;
+        }
+      }
+    }
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> void
+pcl::extractEuclideanClustersParallel (const PointCloud<PointT> &cloud,
+                                       const std::vector<int> &indices,
+                                       const boost::shared_ptr<search::Search<PointT> > &tree,
+                                       float tolerance, std::vector<PointIndices> &clusters,
+                                       unsigned int min_pts_per_cluster,
+                                       unsigned int max_pts_per_cluster,
+                                       unsigned int nr_threads)
+{
+  if (tree->getInputCloud ()->points.size () != cloud.points.size ())
+  {
+    PCL_ERROR ("[pcl::extractEuclideanClustersParallel] Tree built for a different point cloud dataset (%lu) than the input cloud (%lu)!\n", tree->getInputCloud ()->points.size (), cloud.points.size ());
+    return;
+  }
+  if (tree->getIndices ()->size () != indices.size ())
+  {
+    PCL_ERROR ("[pcl::extractEuclideanClustersParallel] Tree built for a different set of indices (%lu) than the input set (%lu)!\n", tree->getIndices ()->size (), indices.size ());
+    return;
+  }
+#ifdef _OPENMP
+  const int threads = nr_threads == 0 ? omp_get_num_procs () : static_cast<int> (nr_threads);
+#else
+  (void) nr_threads;
+#endif
+
+  const int nr_indices = static_cast<int> (indices.size ());
+  ConcurrentUnionFind sets (static_cast<int> (cloud.points.size ()));
+  bool search_failed = false;
+
+  // Merge every point with all of its neighbors
+#ifdef _OPENMP
+#pragma omp parallel num_threads(threads)
+#endif
+  {
+    std::vector<int> nn_indices;
+    std::vector<float> nn_distances;
+#ifdef _OPENMP
+#pragma omp for schedule(dynamic, 256)
+#endif
+    for (int i = 0; i < nr_indices; ++i)
+    {
+      const int index = indices[i];
+      const int ret = tree->radiusSearch (cloud.points[index], tolerance, nn_indices, nn_distances);
+      if (ret == -1)
+        search_failed = true;
+      if (ret <= 0)
+        continue;
+
+      for (size_t j = 0; j < nn_indices.size (); ++j)
+        if (nn_indices[j] != -1 && nn_indices[j] != index)
+          sets.merge (index, nn_indices[j]);
+    }
+  }
+  if (search_failed)
+  {
+    PCL_ERROR ("[pcl::extractEuclideanClustersParallel] Received error code -1 from radiusSearch\n");
+    return;
+  }
+
+  std::vector<int> roots (nr_indices);
+#ifdef _OPENMP
+#pragma omp parallel for num_threads(threads) schedule(static)
+#endif
+  for (int i = 0; i < nr_indices; ++i)
+    roots[i] = sets.find (indices[i]);
+
+  pcl::detail::collectEuclideanClusters (indices, roots, static_cast<int> (cloud.points.size ()), cloud.header,
+                                         min_pts_per_cluster, max_pts_per_cluster, nr_threads, clusters);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> void
+pcl::extractEuclideanClustersVoxelGrid (const PointCloud<PointT> &cloud,
+                                        const std::vector<int> &indices,
+                                        float tolerance, std::vector<PointIndices> &clusters,
+                                        unsigned int min_pts_per_cluster,
+                                        unsigned int max_pts_per_cluster,
+                                        unsigned int nr_threads)
+{
+  if (tolerance <= 0)
+  {
+    PCL_ERROR ("[pcl::extractEuclideanClustersVoxelGrid] Invalid cluster tolerance (%f)!\n", tolerance);
+    return;
+  }
+#ifdef _OPENMP
+  const int threads = nr_threads == 0 ? omp_get_num_procs () : static_cast<int> (nr_threads);
+#endif
+
+  // The diagonal of a voxel is (slightly less than) the tolerance, so all points of a voxel are connected. Points
+  // closer than the tolerance are then at most two voxels apart along each axis.
+  const double inverse_voxel_size = std::sqrt (3.0) / (tolerance * (1.0 - 1e-5));
+  const double sqr_tolerance = static_cast<double> (tolerance) * tolerance;
+  const int nr_indices = static_cast<int> (indices.size ());
+
+  Eigen::Vector3d min_p = Eigen::Vector3d::Constant (std::numeric_limits<double>::max ());
+  Eigen::Vector3d max_p = Eigen::Vector3d::Constant (-std::numeric_limits<double>::max ());
+  for (int i = 0; i < nr_indices; ++i)
+  {
+    const PointT &point = cloud.points[indices[i]];
+    if (!pcl_isfinite (point.x) || !pcl_isfinite (point.y) || !pcl_isfinite (point.z))
+      continue;
+    const Eigen::Vector3d p (point.x, point.y, point.z);
+    min_p = min_p.cwiseMin (p);
+    max_p = max_p.cwiseMax (p);
+  }
+
+  // Voxel coordinates are shifted by two voxels and the grid is padded by two voxels on each side, so that the keys
+  // of the neighbors of a voxel never wrap around into another row of the grid
+  const Eigen::Vector3d grid_min = (min_p * inverse_voxel_size).array ().floor () - 2.0;
+  Eigen::Vector3d grid_size = (max_p * inverse_voxel_size).array ().floor () - grid_min.array () + 3.0;
+  grid_size = grid_size.cwiseMax (Eigen::Vector3d::Ones ());
+  if (grid_size.prod () > static_cast<double> (std::numeric_limits<int64_t>::max () / 2))
+  {
+    PCL_ERROR ("[pcl::extractEuclideanClustersVoxelGrid] Cluster tolerance (%f) too small for the extent of the cloud!\n", tolerance);
+    return;
+  }
+  const int64_t stride_y = static_cast<int64_t> (grid_size[0]);
+  const int64_t stride_z = stride_y * static_cast<int64_t> (grid_size[1]);
+
+  // Sort the points by voxel, invalid points are sorted last and form clusters of their own
+  const int64_t invalid_key = std::numeric_limits<int64_t>::max ();
+  std::vector<std::pair<int64_t, int> > keys (nr_indices);
+#ifdef _OPENMP
+#pragma omp parallel for num_threads(threads) schedule(static)
+#endif
+  for (int i = 0; i < nr_indices; ++i)
+  {
+    const PointT &point = cloud.points[indices[i]];
+    keys[i].second = i;
+    if (!pcl_isfinite (point.x) || !pcl_isfinite (point.y) || !pcl_isfinite (point.z))
+    {
+      keys[i].first = invalid_key;
+      continue;
+    }
+    const Eigen::Vector3d ijk = (Eigen::Vector3d (point.x, point.y, point.z) * inverse_voxel_size).array ().floor () - grid_min.array ();
+    keys[i].first = static_cast<int64_t> (ijk[0]) + static_cast<int64_t> (ijk[1]) * stride_y + static_cast<int64_t> (ijk[2]) * stride_z;
+  }
+  std::sort (keys.begin (), keys.end ());
+
+  // One voxel per run of equal keys
+  std::vector<int64_t> voxel_keys;
+  std::vector<int> voxel_begin;
+  for (int k = 0; k < nr_indices && keys[k].first != invalid_key; ++k)
+  {
+    if (voxel_keys.empty () || voxel_keys.back () != keys[k].first)
+    {
+      voxel_keys.push_back (keys[k].first);
+      voxel_begin.push_back (k);
+    }
+  }
+  const int nr_voxels = static_cast<int> (voxel_keys.size ());
+  voxel_begin.push_back (static_cast<int> (std::lower_bound (keys.begin (), keys.end (), std::make_pair (invalid_key, 0)) - keys.begin ()));
+
+  // Key offsets of the neighboring voxels, only one of each pair of opposite offsets is needed
+  std::vector<int64_t> neighbor_offsets;
+  for (int dz = -2; dz <= 2; ++dz)
+    for (int dy = -2; dy <= 2; ++dy)
+      for (int dx = -2; dx <= 2; ++dx)
+        if (dz > 0 || (dz == 0 && (dy > 0 || (dy == 0 && dx > 0))))
+          neighbor_offsets.push_back (dx + dy * stride_y + dz * stride_z);
+
+  ConcurrentUnionFind sets (nr_voxels);
+#ifdef _OPENMP
+#pragma omp parallel for num_threads(threads) schedule(dynamic, 64)
+#endif
+  for (int v = 0; v < nr_voxels; ++v)
+  {
+    for (size_t o = 0; o < neighbor_offsets.size (); ++o)
+    {
+      const int64_t neighbor_key = voxel_keys[v] + neighbor_offsets[o];
+      const std::vector<int64_t>::const_iterator it = std::lower_bound (voxel_keys.begin (), voxel_keys.end (), neighbor_key);
+      if (it == voxel_keys.end () || *it != neighbor_key)
+        continue;
+      const int u = static_cast<int> (it - voxel_keys.begin ());
+      if (sets.find (v) == sets.find (u))
+        continue;
+
+      // Merge the voxels if any pair of their points is within the tolerance
+      bool connected = false;
+      for (int a = voxel_begin[v]; a < voxel_begin[v + 1] && !connected; ++a)
+      {
+        const PointT &pa = cloud.points[indices[keys[a].second]];
+        for (int b = voxel_begin[u]; b < voxel_begin[u + 1]; ++b)
+        {
+          const PointT &pb = cloud.points[indices[keys[b].second]];
+          const double dx = static_cast<double> (pa.x) - pb.x;
+          const double dy = static_cast<double> (pa.y) - pb.y;
+          const double dz = static_cast<double> (pa.z) - pb.z;
+          if (dx * dx + dy * dy + dz * dz <= sqr_tolerance)
+          {
+            connected = true;
+            break;
+          }
+        }
+      }
+      if (connected)
+        sets.merge (v, u);
+    }
+  }
+
+  // Label every point with the root of its voxel, invalid points get labels of their own
+  std::vector<int> labels (nr_indices);
+#ifdef _OPENMP
+#pragma omp parallel for num_threads(threads) schedule(static)
+#endif
+  for (int v = 0; v < nr_voxels; ++v)
+  {
+    const int root = sets.find (v);
+    for (int k = voxel_begin[v]; k < voxel_begin[v + 1]; ++k)
+      labels[keys[k].second] = root;
+  }
+  for (int k = voxel_begin[nr_voxels]; k < nr_indices; ++k)
+    labels[keys[k].second] = nr_voxels + k;
+
+  pcl::detail::collectEuclideanClusters (indices, labels, nr_voxels + nr_indices, cloud.header,
+                                         min_pts_per_cluster, max_pts_per_cluster, nr_threads, clusters);
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////
 //////////////////////////////////////////////////////////////////////////////////////////////
 //////////////////////////////////////////////////////////////////////////////////////////////
@@ -217,6 +518,17 @@ pcl::EuclideanClusterExtraction<PointT>::extract (std::vector<PointIndices> &clu
     return;
   }
 
+  if (use_voxel_grid_)
+  {
+    extractEuclideanClustersVoxelGrid (*input_, *indices_, static_cast<float> (cluster_tolerance_), clusters, min_pts_per_cluster_, max_pts_per_cluster_, threads_);
+
+    // Sort the clusters based on their size (largest one first)
+    std::sort (clusters.rbegin (), clusters.rend (), comparePointClusters);
+
+    deinitCompute ();
+    return;
+  }
+
   // Initialize the spatial locator
   if (!tree_)
   {
@@ -228,7 +540,10 @@ pcl::EuclideanClusterExtraction<PointT>::extract (std::vector<PointIndices> &clu
 
   // Send the input dataset to the spatial locator
   tree_->setInputCloud (input_, indices_);
-  extractEuclideanClusters (*input_, *indices_, tree_, static_cast<float> (cluster_tolerance_), clusters, min_pts_per_cluster_, max_pts_per_cluster_);
+  if (threads_ == 1)
+    extractEuclideanClusters (*input_, *indices_, tree_, static_cast<float> (cluster_tolerance_), clusters, min_pts_per_cluster_, max_pts_per_cluster_);
+  else
+    extractEuclideanClustersParallel (*input_, *indices_, tree_, static_cast<float> (cluster_tolerance_), clusters, min_pts_per_cluster_, max_pts_per_cluster_, threads_);
 
   //tree_->setInputCloud (input_);
   //extractEuclideanClusters (*input_, tree_, cluster_tolerance_, clusters, min_pts_per_cluster_, max_pts_per_cluster_);
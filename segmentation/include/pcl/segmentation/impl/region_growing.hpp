@@ -41,6 +41,7 @@
 #define PCL_SEGMENTATION_REGION_GROWING_HPP_
 
 #include <pcl/segmentation/region_growing.h>
+#include <pcl/segmentation/union_find.h>
 
 #include <pcl/search/search.h>
 #include <pcl/search/kdtree.h>
@@ -52,6 +53,10 @@
 #include <cmath>
 #include <time.h>
 
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointT, typename NormalT>
 pcl::RegionGrowing<PointT, NormalT>::RegionGrowing () :
@@ -66,7 +71,15 @@ pcl::RegionGrowing<PointT, NormalT>::RegionGrowing () :
   neighbour_number_ (30),
   search_ (),
   normals_ (),
-  point_neighbours_ (0),
+  neighbour_offsets_ (0),
+  neighbour_indices_ (0),
+  threads_ (1),
+  reuse_neighbours_ (false),
+  graph_input_ (),
+  graph_indices_ (),
+  graph_nr_indices_ (0),
+  graph_search_ (),
+  graph_nr_neighbours_ (0),
   point_labels_ (0),
   normal_flag_ (true),
   num_pts_in_segment_ (0),
@@ -84,7 +97,8 @@ pcl::RegionGrowing<PointT, NormalT>::~RegionGrowing ()
   if (normals_ != 0)
     normals_.reset ();
 
-  point_neighbours_.clear ();
+  neighbour_offsets_.clear ();
+  neighbour_indices_.clear ();
   point_labels_.clear ();
   num_pts_in_segment_.clear ();
   clusters_.clear ();
@@ -239,6 +253,27 @@ pcl::RegionGrowing<PointT, NormalT>::setSearchMethod (const KdTreePtr& tree)
   search_ = tree;
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT, typename NormalT> void
+pcl::RegionGrowing<PointT, NormalT>::setNumberOfThreads (unsigned int nr_threads)
+{
+  threads_ = nr_threads;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT, typename NormalT> bool
+pcl::RegionGrowing<PointT, NormalT>::getReuseNeighboursFlag () const
+{
+  return (reuse_neighbours_);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT, typename NormalT> void
+pcl::RegionGrowing<PointT, NormalT>::setReuseNeighboursFlag (bool value)
+{
+  reuse_neighbours_ = value;
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointT, typename NormalT> typename pcl::RegionGrowing<PointT, NormalT>::NormalPtr
 pcl::RegionGrowing<PointT, NormalT>::getInputNormals () const
@@ -262,7 +297,6 @@ pcl::RegionGrowing<PointT, NormalT>::extract (std::vector <pcl::PointIndices>& c
 {
   clusters_.clear ();
   clusters.clear ();
-  point_neighbours_.clear ();
   point_labels_.clear ();
   num_pts_in_segment_.clear ();
   number_of_segments_ = 0;
@@ -281,7 +315,8 @@ pcl::RegionGrowing<PointT, NormalT>::extract (std::vector <pcl::PointIndices>& c
     return;
   }
 
-  findPointNeighbours ();
+  if (!reuse_neighbours_ || !isNeighbourGraphValid (neighbour_number_))
+    findPointNeighbours ();
   applySmoothRegionGrowingAlgorithm ();
   assembleRegions ();
 
@@ -337,14 +372,8 @@ pcl::RegionGrowing<PointT, NormalT>::prepareForSegmentation ()
   if (!search_)
     search_.reset (new pcl::search::KdTree<PointT>);
 
-  if (indices_)
-  {
-    if (indices_->empty ())
-      PCL_ERROR ("[pcl::RegionGrowing::prepareForSegmentation] Empty given indices!\n");
-    search_->setInputCloud (input_, indices_);
-  }
-  else
-    search_->setInputCloud (input_);
+  if (indices_ && indices_->empty ())
+    PCL_ERROR ("[pcl::RegionGrowing::prepareForSegmentation] Empty given indices!\n");
 
   return (true);
 }
@@ -353,33 +382,88 @@ pcl::RegionGrowing<PointT, NormalT>::prepareForSegmentation ()
 template <typename PointT, typename NormalT> void
 pcl::RegionGrowing<PointT, NormalT>::findPointNeighbours ()
 {
-  int point_number = static_cast<int> (indices_->size ());
-  std::vector<int> neighbours;
-  std::vector<float> distances;
+  buildNeighbourGraph (neighbour_number_, 0);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT, typename NormalT> void
+pcl::RegionGrowing<PointT, NormalT>::buildNeighbourGraph (unsigned int nr_neighbours, std::vector<float> *distances)
+{
+  search_->setInputCloud (input_, indices_);
 
-  point_neighbours_.resize (input_->points.size (), neighbours);
-  if (input_->is_dense)
+#ifdef _OPENMP
+  const int threads = threads_ == 0 ? omp_get_num_procs () : static_cast<int> (threads_);
+#endif
+  const int point_number = static_cast<int> (indices_->size ());
+  const int k = static_cast<int> (nr_neighbours);
+  const bool check_finite = !input_->is_dense;
+
+  // Search into k slots per point first, then compact the slots into the flat arrays
+  std::vector<int> slots (static_cast<size_t> (point_number) * k);
+  std::vector<float> slot_distances (distances ? slots.size () : 0);
+  std::vector<int> counts (point_number, 0);
+
+#ifdef _OPENMP
+#pragma omp parallel num_threads(threads)
+#endif
   {
+    std::vector<int> neighbours;
+    std::vector<float> sqr_distances;
+
+#ifdef _OPENMP
+#pragma omp for schedule(dynamic, 256)
+#endif
     for (int i_point = 0; i_point < point_number; i_point++)
     {
-      int point_index = (*indices_)[i_point];
-      neighbours.clear ();
-      search_->nearestKSearch (i_point, neighbour_number_, neighbours, distances);
-      point_neighbours_[point_index].swap (neighbours);
+      if (check_finite && !pcl::isFinite (input_->points[(*indices_)[i_point]]))
+        continue;
+      search_->nearestKSearch (i_point, k, neighbours, sqr_distances);
+      const int count = std::min (k, static_cast<int> (neighbours.size ()));
+      const size_t slot = static_cast<size_t> (i_point) * k;
+      std::copy (neighbours.begin (), neighbours.begin () + count, slots.begin () + slot);
+      if (distances)
+        std::copy (sqr_distances.begin (), sqr_distances.begin () + count, slot_distances.begin () + slot);
+      counts[i_point] = count;
     }
   }
-  else
+
+  neighbour_offsets_.assign (input_->points.size () + 1, 0);
+  for (int i_point = 0; i_point < point_number; i_point++)
+    neighbour_offsets_[(*indices_)[i_point] + 1] = counts[i_point];
+  for (size_t i = 1; i < neighbour_offsets_.size (); i++)
+    neighbour_offsets_[i] += neighbour_offsets_[i - 1];
+
+  neighbour_indices_.resize (neighbour_offsets_.back ());
+  if (distances)
+    distances->resize (neighbour_indices_.size ());
+
+#ifdef _OPENMP
+#pragma omp parallel for num_threads(threads) schedule(static)
+#endif
+  for (int i_point = 0; i_point < point_number; i_point++)
   {
-    for (int i_point = 0; i_point < point_number; i_point++)
-    {
-      neighbours.clear ();
-      int point_index = (*indices_)[i_point];
-      if (!pcl::isFinite (input_->points[point_index]))
-        continue;
-      search_->nearestKSearch (i_point, neighbour_number_, neighbours, distances);
-      point_neighbours_[point_index].swap (neighbours);
-    }
+    const size_t slot = static_cast<size_t> (i_point) * k;
+    const int offset = neighbour_offsets_[(*indices_)[i_point]];
+    std::copy (slots.begin () + slot, slots.begin () + slot + counts[i_point], neighbour_indices_.begin () + offset);
+    if (distances)
+      std::copy (slot_distances.begin () + slot, slot_distances.begin () + slot + counts[i_point], distances->begin () + offset);
   }
+
+  graph_input_ = input_;
+  graph_indices_ = indices_;
+  graph_nr_indices_ = indices_->size ();
+  graph_search_ = search_;
+  graph_nr_neighbours_ = nr_neighbours;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT, typename NormalT> bool
+pcl::RegionGrowing<PointT, NormalT>::isNeighbourGraphValid (unsigned int nr_neighbours) const
+{
+  return (graph_input_ && graph_input_ == input_ &&
+          graph_indices_ == indices_ && graph_nr_indices_ == indices_->size () &&
+          graph_search_ == search_ && graph_nr_neighbours_ == nr_neighbours &&
+          neighbour_offsets_.size () == input_->points.size () + 1);
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -412,6 +496,13 @@ pcl::RegionGrowing<PointT, NormalT>::applySmoothRegionGrowingAlgorithm ()
       point_residual[i_point].second = point_index;
     }
   }
+
+  if (threads_ != 1 && smooth_mode_flag_)
+  {
+    growRegionsParallel (point_residual);
+    return;
+  }
+
   int seed_counter = 0;
   int seed = point_residual[seed_counter].second;
 
@@ -455,10 +546,11 @@ pcl::RegionGrowing<PointT, NormalT>::growRegion (int initial_seed, int segment_n
     curr_seed = seeds.front ();
     seeds.pop ();
 
-    size_t i_nghbr = 0;
-    while ( i_nghbr < neighbour_number_ && i_nghbr < point_neighbours_[curr_seed].size () )
+    int i_nghbr = neighbour_offsets_[curr_seed];
+    const int nghbr_end = std::min (neighbour_offsets_[curr_seed + 1], i_nghbr + static_cast<int> (neighbour_number_));
+    while ( i_nghbr < nghbr_end )
     {
-      int index = point_neighbours_[curr_seed][i_nghbr];
+      int index = neighbour_indices_[i_nghbr];
       if (point_labels_[index] != -1)
       {
         i_nghbr++;
@@ -489,6 +581,94 @@ pcl::RegionGrowing<PointT, NormalT>::growRegion (int initial_seed, int segment_n
   return (num_pts_in_segment);
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT, typename NormalT> void
+pcl::RegionGrowing<PointT, NormalT>::growRegionsParallel (const std::vector<std::pair<float, int> > &point_residual)
+{
+#ifdef _OPENMP
+  const int threads = threads_ == 0 ? omp_get_num_procs () : static_cast<int> (threads_);
+#endif
+  const int num_of_pts = static_cast<int> (point_residual.size ());
+
+  // Work on the positions in the seed order, so that the root of every set is its first seed
+  std::vector<int> point_rank (input_->points.size (), -1);
+  for (int i_point = 0; i_point < num_of_pts; i_point++)
+    point_rank[point_residual[i_point].second] = i_point;
+
+  // A point may seed a region if it passes the tests against itself
+  std::vector<char> is_seed (num_of_pts, 0);
+#ifdef _OPENMP
+#pragma omp parallel for num_threads(threads) schedule(static)
+#endif
+  for (int i_point = 0; i_point < num_of_pts; i_point++)
+  {
+    const int point = point_residual[i_point].second;
+    bool is_a_seed = false;
+    is_seed[i_point] = validatePoint (point, point, point, is_a_seed) && is_a_seed;
+  }
+
+  // Merge the seeds with the neighbours they accept as seeds, and remember the first seed accepting each other point
+  ConcurrentUnionFind sets (num_of_pts);
+  std::vector<int> first_seed (num_of_pts, num_of_pts);
+#ifdef _OPENMP
+#pragma omp parallel for num_threads(threads) schedule(dynamic, 256)
+#endif
+  for (int i_point = 0; i_point < num_of_pts; i_point++)
+  {
+    if (!is_seed[i_point])
+      continue;
+
+    const int point = point_residual[i_point].second;
+    const int nghbr_begin = neighbour_offsets_[point];
+    const int nghbr_end = std::min (neighbour_offsets_[point + 1], nghbr_begin + static_cast<int> (neighbour_number_));
+    for (int i_nghbr = nghbr_begin; i_nghbr < nghbr_end; i_nghbr++)
+    {
+      const int index = neighbour_indices_[i_nghbr];
+      const int nghbr_rank = point_rank[index];
+      bool is_a_seed = false;
+      if (!validatePoint (point, point, index, is_a_seed))
+        continue;
+
+      if (is_seed[nghbr_rank])
+      {
+        if (is_a_seed)
+          sets.merge (i_point, nghbr_rank);
+      }
+      else
+        detail::atomicMin (&first_seed[nghbr_rank], i_point);
+    }
+  }
+
+  std::vector<int> roots (num_of_pts);
+#ifdef _OPENMP
+#pragma omp parallel for num_threads(threads) schedule(static)
+#endif
+  for (int i_point = 0; i_point < num_of_pts; i_point++)
+  {
+    if (is_seed[i_point] || first_seed[i_point] == num_of_pts)
+      roots[i_point] = sets.find (i_point);
+    else
+      roots[i_point] = sets.find (first_seed[i_point]);
+  }
+
+  // Number the segments in the order of their first seed
+  std::vector<int> segment_numbers (num_of_pts, -1);
+  for (int i_point = 0; i_point < num_of_pts; i_point++)
+  {
+    if (roots[i_point] == i_point)
+    {
+      segment_numbers[i_point] = static_cast<int> (num_pts_in_segment_.size ());
+      num_pts_in_segment_.push_back (0);
+    }
+  }
+  for (int i_point = 0; i_point < num_of_pts; i_point++)
+  {
+    const int segment_number = segment_numbers[roots[i_point]];
+    point_labels_[point_residual[i_point].second] = segment_number;
+    num_pts_in_segment_[segment_number]++;
+  }
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointT, typename NormalT> bool
 pcl::RegionGrowing<PointT, NormalT>::validatePoint (int initial_seed, int point, int nghbr, bool& is_a_seed) const
@@ -604,7 +784,6 @@ pcl::RegionGrowing<PointT, NormalT>::getSegmentFromPoint (int index, pcl::PointI
   {
     if (clusters_.empty ())
     {
-      point_neighbours_.clear ();
       point_labels_.clear ();
       num_pts_in_segment_.clear ();
       number_of_segments_ = 0;
@@ -616,7 +795,8 @@ pcl::RegionGrowing<PointT, NormalT>::getSegmentFromPoint (int index, pcl::PointI
         return;
       }
 
-      findPointNeighbours ();
+      if (!reuse_neighbours_ || !isNeighbourGraphValid (neighbour_number_))
+        findPointNeighbours ();
       applySmoothRegionGrowingAlgorithm ();
       assembleRegions ();
     }
@@ -67,6 +67,7 @@ namespace pcl
       typedef pcl::PointCloud <NormalT> Normal;
       typedef typename Normal::Ptr NormalPtr;
       typedef pcl::PointCloud <PointT> PointCloud;
+      typedef typename PointCloud::ConstPtr PointCloudConstPtr;
 
       using PCLBase <PointT>::input_;
       using PCLBase <PointT>::indices_;
@@ -190,6 +191,33 @@ namespace pcl
       void
       setSearchMethod (const KdTreePtr& tree);
 
+      /** \brief Set the number of threads used to find the neighbours and to grow the regions.
+        * With more than one thread, the regions are grown in parallel with disjoint sets. Every point
+        * which may seed a region (see validatePoint ()) is merged with the neighbours it accepts as seeds,
+        * all other points join the region of the first seed, in the order of growing, which accepts them.
+        * This matches the serial algorithm except for the order dependent cases: the neighbourhood of a
+        * point is not symmetric, and points which fail the curvature or residual test may be reached from
+        * several regions. The serial algorithm is always used when the smooth mode is off, since the points
+        * are then tested against the normal of the initial seed.
+        * \param[in] nr_threads the number of hardware threads to use (0 sets the value back to automatic)
+        */
+      void
+      setNumberOfThreads (unsigned int nr_threads = 0);
+
+      /** \brief Returns the flag that signalize if the neighbours of the points are reused. */
+      bool
+      getReuseNeighboursFlag () const;
+
+      /** \brief Allows to keep the neighbours of the points between calls to extract (), as long as the
+        * input cloud, the indices, the search method and the number of neighbours do not change. This
+        * saves all the searches when only the thresholds or test flags change, e.g. in a parameter sweep.
+        * Note that the cloud and the indices are compared by pointer, so the flag must be turned off (or the
+        * input set again as a new cloud) if the points are modified in place.
+        * \param[in] value new value for the flag, false by default
+        */
+      void
+      setReuseNeighboursFlag (bool value);
+
       /** \brief Returns normals. */
       NormalPtr
       getInputNormals () const;
@@ -247,6 +275,22 @@ namespace pcl
       virtual void
       findPointNeighbours ();
 
+      /** \brief Finds the nearest neighbours of all the points in parallel, and stores them in
+        * neighbour_offsets_ and neighbour_indices_. The search method is set up on the input first.
+        * \param[in] nr_neighbours the number of neighbours to find for every point
+        * \param[out] distances if not null, filled with the squared distances to the neighbours,
+        * in the same layout as neighbour_indices_
+        */
+      void
+      buildNeighbourGraph (unsigned int nr_neighbours, std::vector<float> *distances);
+
+      /** \brief Returns true if the neighbours were found before on the current input, indices and search
+        * method with the given number of neighbours, and may be reused.
+        * \param[in] nr_neighbours the number of neighbours
+        */
+      bool
+      isNeighbourGraphValid (unsigned int nr_neighbours) const;
+
       /** \brief This function implements the algorithm described in the article
         * "Segmentation of point clouds using smoothness constraint"
         * by T. Rabbania, F. A. van den Heuvelb, G. Vosselmanc.
@@ -261,6 +305,12 @@ namespace pcl
       int
       growRegion (int initial_seed, int segment_number);
 
+      /** \brief Grows all the regions at once in parallel, see setNumberOfThreads ().
+        * \param[in] point_residual the points, in the order in which they serve as seeds
+        */
+      void
+      growRegionsParallel (const std::vector<std::pair<float, int> > &point_residual);
+
       /** \brief This function is checking if the point with index 'nghbr' belongs to the segment.
         * If so, then it returns true. It also checks if this point can serve as the seed.
         * \param[in] initial_seed index of the initial point that was passed to the growRegion() function
@@ -312,8 +362,34 @@ namespace pcl
       /** \brief Contains normals of the points that will be segmented. */
       NormalPtr normals_;
 
-      /** \brief Contains neighbours of each point. */
-      std::vector<std::vector<int> > point_neighbours_;
+      /** \brief Start of the neighbours of each point in neighbour_indices_. The neighbours of point i are
+        * stored at neighbour_offsets_[i] up to (excluding) neighbour_offsets_[i + 1].
+        */
+      std::vector<int> neighbour_offsets_;
+
+      /** \brief Contains the neighbours of all the points, one after the other. */
+      std::vector<int> neighbour_indices_;
+
+      /** \brief The number of threads the scheduler should use. */
+      unsigned int threads_;
+
+      /** \brief If set to true then the neighbours are kept between the calls to extract (). */
+      bool reuse_neighbours_;
+
+      /** \brief The input cloud the neighbours were found on. */
+      PointCloudConstPtr graph_input_;
+
+      /** \brief The indices the neighbours were found for. */
+      IndicesPtr graph_indices_;
+
+      /** \brief The number of indices the neighbours were found for. */
+      size_t graph_nr_indices_;
+
+      /** \brief The search method the neighbours were found with. */
+      KdTreePtr graph_search_;
+
+      /** \brief The number of neighbours that were searched for every point. */
+      unsigned int graph_nr_neighbours_;
 
       /** \brief Point labels that tells to which segment each point belongs. */
       std::vector<int> point_labels_;
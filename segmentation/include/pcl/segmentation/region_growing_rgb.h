@@ -71,12 +71,16 @@ namespace pcl
       using RegionGrowing<PointT, NormalT>::smooth_mode_flag_;
       using RegionGrowing<PointT, NormalT>::theta_threshold_;
       using RegionGrowing<PointT, NormalT>::curvature_threshold_;
-      using RegionGrowing<PointT, NormalT>::point_neighbours_;
+      using RegionGrowing<PointT, NormalT>::neighbour_offsets_;
+      using RegionGrowing<PointT, NormalT>::neighbour_indices_;
+      using RegionGrowing<PointT, NormalT>::reuse_neighbours_;
       using RegionGrowing<PointT, NormalT>::point_labels_;
       using RegionGrowing<PointT, NormalT>::num_pts_in_segment_;
       using RegionGrowing<PointT, NormalT>::clusters_;
       using RegionGrowing<PointT, NormalT>::number_of_segments_;
       using RegionGrowing<PointT, NormalT>::applySmoothRegionGrowingAlgorithm;
+      using RegionGrowing<PointT, NormalT>::buildNeighbourGraph;
+      using RegionGrowing<PointT, NormalT>::isNeighbourGraphValid;
       using RegionGrowing<PointT, NormalT>::assembleRegions;
 
     public:
@@ -261,8 +265,8 @@ namespace pcl
       /** \brief Number of neighbouring segments to find. */
       unsigned int region_neighbour_number_;
 
-      /** \brief Stores distances for the point neighbours from point_neighbours_ */
-      std::vector< std::vector<float> > point_distances_;
+      /** \brief Stores distances for the point neighbours, in the same layout as neighbour_indices_ */
+      std::vector<float> point_distances_;
 
       /** \brief Stores the neighboures for the corresponding segments. */
       std::vector< std::vector<int> > segment_neighbours_;
@@ -0,0 +1,157 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2012-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#ifndef PCL_SEGMENTATION_UNION_FIND_H_
+#define PCL_SEGMENTATION_UNION_FIND_H_
+
+#include <pcl/pcl_macros.h>
+#include <algorithm>
+#include <vector>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+namespace pcl
+{
+  namespace detail
+  {
+    /** \brief Atomically replace the value at \a ptr with \a desired, if it is equal to \a expected.
+      * \return true if the value was replaced
+      */
+    inline bool
+    compareAndSwap (volatile int *ptr, int expected, int desired)
+    {
+#ifdef _MSC_VER
+      return (_InterlockedCompareExchange (reinterpret_cast<volatile long*> (ptr), desired, expected) == expected);
+#else
+      return (__sync_bool_compare_and_swap (ptr, expected, desired));
+#endif
+    }
+
+    /** \brief Atomically replace the value at \a ptr with \a value, if \a value is smaller. */
+    inline void
+    atomicMin (volatile int *ptr, int value)
+    {
+      int current = *ptr;
+      while (value < current && !compareAndSwap (ptr, current, value))
+        current = *ptr;
+    }
+  }
+
+  /** \brief Disjoint sets over the elements 0..n-1, which may be merged concurrently from several threads.
+    *
+    * Sets are linked by compare-and-swap on their roots, always attaching the root with the larger index
+    * to the one with the smaller index. The root of every set is therefore its smallest element, no matter
+    * in which order (or from how many threads) the sets were merged.
+    * \ingroup segmentation
+    */
+  class ConcurrentUnionFind
+  {
+    public:
+      /** \brief Constructor.
+        * \param[in] size the number of elements, each of which starts in its own set
+        */
+      explicit ConcurrentUnionFind (int size = 0) : parents_ ()
+      {
+        reset (size);
+      }
+
+      /** \brief Put each of \a size elements in its own set. Not thread safe. */
+      inline void
+      reset (int size)
+      {
+        parents_.resize (size);
+        for (int i = 0; i < size; ++i)
+          parents_[i] = i;
+      }
+
+      /** \brief Get the number of elements. */
+      inline int
+      size () const
+      {
+        return (static_cast<int> (parents_.size ()));
+      }
+
+      /** \brief Get the root (smallest element) of the set containing \a element.
+        * Compresses the path on the way (path halving), may be called concurrently with merge ().
+        */
+      inline int
+      find (int element)
+      {
+        volatile int *parents = &parents_[0];
+        int parent = parents[element];
+        while (parent != element)
+        {
+          const int grand_parent = parents[parent];
+          // Only succeeds if no other thread relinked the element in the meantime
+          if (grand_parent != parent)
+            detail::compareAndSwap (parents + element, parent, grand_parent);
+          element = parent;
+          parent = parents[element];
+        }
+        return (element);
+      }
+
+      /** \brief Merge the sets containing \a a and \a b. May be called concurrently.
+        * \return true if the two elements were in different sets
+        */
+      inline bool
+      merge (int a, int b)
+      {
+        volatile int *parents = &parents_[0];
+        for (;;)
+        {
+          a = find (a);
+          b = find (b);
+          if (a == b)
+            return (false);
+          if (a > b)
+            std::swap (a, b);
+          // Link the larger root below the smaller one, retry if it is not a root anymore
+          if (detail::compareAndSwap (parents + b, b, a))
+            return (true);
+        }
+      }
+
+    private:
+      /** \brief The parent of each element, roots are their own parents. */
+      std::vector<int> parents_;
+  };
+}
+
+#endif  //#ifndef PCL_SEGMENTATION_UNION_FIND_H_
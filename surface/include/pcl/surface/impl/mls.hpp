@@ -53,6 +53,15 @@
 #include <omp.h>
 #endif
 
+namespace pcl
+{
+  namespace detail
+  {
+    /** \brief Number of points MovingLeastSquares processes as one unit of work, with its own output buffers. */
+    const int MLS_BLOCK_SIZE = 1024;
+  }
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointInT, typename PointOutT> void
 pcl::MovingLeastSquares<PointInT, PointOutT>::process (PointCloudOut &output)
@@ -175,9 +184,23 @@ pcl::MovingLeastSquares<PointInT, PointOutT>::computeMLSPointNormal (int index,
                                                                      NormalCloud &projected_points_normals,
                                                                      PointIndices &corresponding_input_indices,
                                                                      MLSResult &mls_result) const
+{
+  computeMLSPointNormal (index, nn_indices, projected_points, projected_points_normals, corresponding_input_indices, mls_result,
+                         rng_uniform_distribution_.get ());
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointInT, typename PointOutT> void
+pcl::MovingLeastSquares<PointInT, PointOutT>::computeMLSPointNormal (int index,
+                                                                     const std::vector<int> &nn_indices,
+                                                                     PointCloudOut &projected_points,
+                                                                     NormalCloud &projected_points_normals,
+                                                                     PointIndices &corresponding_input_indices,
+                                                                     MLSResult &mls_result,
+                                                                     boost::variate_generator<boost::mt19937&, boost::uniform_real<float> > *rng_uniform_distribution) const
 {
   // Note: this method is const because it needs to be thread-safe
-  //       (MovingLeastSquaresOMP calls it from multiple threads)
+  //       (performProcessing calls it from multiple threads)
 
   mls_result.computeMLSSurface<PointInT> (*input_, index, nn_indices, search_radius_, order_);
 
@@ -220,8 +243,8 @@ pcl::MovingLeastSquares<PointInT, PointOutT>::computeMLSPointNormal (int index,
         // Sample the local plane
         for (int num_added = 0; num_added < num_points_to_add;)
         {
-          double u = (*rng_uniform_distribution_) ();
-          double v = (*rng_uniform_distribution_) ();
+          double u = (*rng_uniform_distribution) ();
+          double v = (*rng_uniform_distribution) ();
 
           // Check if inside circle; if not, try another coin flip
           if (u * u + v * v > search_radius_ * search_radius_/4)
@@ -284,184 +307,204 @@ pcl::MovingLeastSquares<PointInT, PointOutT>::performProcessing (PointCloudOut &
   // Compute the number of coefficients
   nr_coeff_ = (order_ + 1) * (order_ + 2) / 2;
 
-  // Allocate enough space to hold the results of nearest neighbor searches
-  // \note resize is irrelevant for a radiusSearch ().
-  std::vector<int> nn_indices;
-  std::vector<float> nn_sqr_dists;
-  
-  size_t mls_result_index = 0;
-
-  // For all points
-  for (size_t cp = 0; cp < indices_->size (); ++cp)
-  {
-    // Get the initial estimates of point positions and their neighborhoods
-    if (!searchForNeighbors ((*indices_)[cp], nn_indices, nn_sqr_dists))
-      continue;
+#ifdef _OPENMP
+  const int threads = threads_ == 0 ? omp_get_num_procs () : static_cast<int> (threads_);
+#endif
 
+  // Create temporaries for each block in order to avoid synchronization, and to keep the output in the order of the indices
+  const int nr_indices = static_cast<int> (indices_->size ());
+  const int nr_blocks = (nr_indices + detail::MLS_BLOCK_SIZE - 1) / detail::MLS_BLOCK_SIZE;
+  typename PointCloudOut::CloudVectorType projected_points (nr_blocks);
+  typename NormalCloud::CloudVectorType projected_points_normals (nr_blocks);
+  std::vector<PointIndices> corresponding_input_indices (nr_blocks);
 
-    // Check the number of nearest neighbors for normal estimation (and later
-    // for polynomial fit as well)
-    if (nn_indices.size () < 3)
-      continue;
+  // Each block draws its random samples from its own generator, seeded from the shared one
+  const boost::mt19937::result_type seed = (upsample_method_ == RANDOM_UNIFORM_DENSITY) ? rng_alg_ () : 0;
+  const boost::uniform_real<float> uniform_distrib (-static_cast<float> (search_radius_ / 2.0), static_cast<float> (search_radius_ / 2.0));
 
+  // For all points
+#ifdef _OPENMP
+#pragma omp parallel for schedule (dynamic, 1) num_threads (threads)
+#endif
+  for (int block = 0; block < nr_blocks; ++block)
+  {
+    // Allocate enough space to hold the results of nearest neighbor searches
+    // \note resize is irrelevant for a radiusSearch ().
+    std::vector<int> nn_indices;
+    std::vector<float> nn_sqr_dists;
+    MLSResult mls_result;
+    boost::mt19937 rng_alg (seed + static_cast<boost::mt19937::result_type> (block));
+    boost::variate_generator<boost::mt19937&, boost::uniform_real<float> > rng_uniform_distribution (rng_alg, uniform_distrib);
 
-    PointCloudOut projected_points;
-    NormalCloud projected_points_normals;
-    // Get a plane approximating the local surface's tangent and project point onto it
-    int index = (*indices_)[cp];
-    
-    if (cache_mls_results_)
-      mls_result_index = index; // otherwise we give it a dummy location.
+    const int block_end = std::min (nr_indices, (block + 1) * detail::MLS_BLOCK_SIZE);
+    for (int cp = block * detail::MLS_BLOCK_SIZE; cp < block_end; ++cp)
+    {
+      // Get the initial estimates of point positions and their neighborhoods
+      if (!searchForNeighbors ((*indices_)[cp], nn_indices, nn_sqr_dists))
+        continue;
 
-    computeMLSPointNormal (index, nn_indices, projected_points, projected_points_normals, *corresponding_input_indices_, mls_results_[mls_result_index]);
+      // Check the number of nearest neighbors for normal estimation (and later
+      // for polynomial fit as well)
+      if (nn_indices.size () < 3)
+        continue;
 
-    // Append projected points to output
-    output.insert (output.end (), projected_points.begin (), projected_points.end ());
-    if (compute_normals_)
-      normals_->insert (normals_->end (), projected_points_normals.begin (), projected_points_normals.end ());
+      // Get a plane approximating the local surface's tangent and project point onto it
+      int index = (*indices_)[cp];
+      computeMLSPointNormal (index, nn_indices, projected_points[block], projected_points_normals[block], corresponding_input_indices[block],
+                             cache_mls_results_ ? mls_results_[index] : mls_result, &rng_uniform_distribution);
+    }
   }
 
+  // Combine all blocks' results into the output vectors
+  appendBlocks (projected_points, projected_points_normals, corresponding_input_indices, output);
+
   // Perform the distinct-cloud or voxel-grid upsampling
   performUpsampling (output);
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////////
-#ifdef _OPENMP
 template <typename PointInT, typename PointOutT> void
-pcl::MovingLeastSquaresOMP<PointInT, PointOutT>::performProcessing (PointCloudOut &output)
+pcl::MovingLeastSquares<PointInT, PointOutT>::appendBlocks (const typename PointCloudOut::CloudVectorType &projected_points,
+                                                            const typename NormalCloud::CloudVectorType &projected_points_normals,
+                                                            const std::vector<PointIndices> &corresponding_input_indices,
+                                                            PointCloudOut &output)
 {
-  // Compute the number of coefficients
-  nr_coeff_ = (order_ + 1) * (order_ + 2) / 2;
+#ifdef _OPENMP
+  const int threads = threads_ == 0 ? omp_get_num_procs () : static_cast<int> (threads_);
+#endif
+  const int nr_blocks = static_cast<int> (projected_points.size ());
 
-  // (Maximum) number of threads
-  unsigned int threads = threads_ == 0 ? 1 : threads_;
+  // Every block starts where the previous one ends
+  std::vector<size_t> offsets (nr_blocks + 1, 0);
+  for (int block = 0; block < nr_blocks; ++block)
+    offsets[block + 1] = offsets[block] + projected_points[block].size ();
 
-  // Create temporaries for each thread in order to avoid synchronization
-  typename PointCloudOut::CloudVectorType projected_points (threads);
-  typename NormalCloud::CloudVectorType projected_points_normals (threads);
-  std::vector<PointIndices> corresponding_input_indices (threads);
+  const size_t output_start = output.size ();
+  const size_t indices_start = corresponding_input_indices_->indices.size ();
+  output.points.resize (output_start + offsets[nr_blocks]);
+  corresponding_input_indices_->indices.resize (indices_start + offsets[nr_blocks]);
+  if (compute_normals_)
+    normals_->points.resize (output_start + offsets[nr_blocks]);
 
-  // For all points
-#pragma omp parallel for schedule (dynamic,1000) num_threads (threads)
-  for (int cp = 0; cp < static_cast<int> (indices_->size ()); ++cp)
+#ifdef _OPENMP
+#pragma omp parallel for schedule (dynamic, 16) num_threads (threads)
+#endif
+  for (int block = 0; block < nr_blocks; ++block)
   {
-    // Allocate enough space to hold the results of nearest neighbor searches
-    // \note resize is irrelevant for a radiusSearch ().
-    std::vector<int> nn_indices;
-    std::vector<float> nn_sqr_dists;
-
-    // Get the initial estimates of point positions and their neighborhoods
-    if (this->searchForNeighbors ((*indices_)[cp], nn_indices, nn_sqr_dists))
-    {
-      // Check the number of nearest neighbors for normal estimation (and later
-      // for polynomial fit as well)
-      if (nn_indices.size () >= 3)
-      {
-        // This thread's ID (range 0 to threads-1)
-        int tn = omp_get_thread_num ();
-
-        // Size of projected points before computeMLSPointNormal () adds points
-        size_t pp_size = projected_points[tn].size ();
-
-        // Get a plane approximating the local surface's tangent and project point onto it
-        int index = (*indices_)[cp];
-        size_t mls_result_index = 0;
-        
-        if (this->cache_mls_results_)
-          mls_result_index = index; // otherwise we give it a dummy location.
-        
-        this->computeMLSPointNormal (index, nn_indices, projected_points[tn], projected_points_normals[tn], corresponding_input_indices[tn], this->mls_results_[mls_result_index]);
-
-        // Copy all information from the input cloud to the output points (not doing any interpolation)
-        for (size_t pp = pp_size; pp < projected_points[tn].size (); ++pp)
-          this->copyMissingFields (input_->points[(*indices_)[cp]], projected_points[tn][pp]);
-	    }
-	  }
+    std::copy (projected_points[block].points.begin (), projected_points[block].points.end (),
+               output.points.begin () + output_start + offsets[block]);
+    std::copy (corresponding_input_indices[block].indices.begin (), corresponding_input_indices[block].indices.end (),
+               corresponding_input_indices_->indices.begin () + indices_start + offsets[block]);
+    if (compute_normals_)
+      std::copy (projected_points_normals[block].points.begin (), projected_points_normals[block].points.end (),
+                 normals_->points.begin () + output_start + offsets[block]);
   }
+}
 
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointInT, typename PointOutT> void
+pcl::MovingLeastSquares<PointInT, PointOutT>::addClosestProjectedPoint (const PointInT &point,
+                                                                        PointCloudOut &projected_points,
+                                                                        NormalCloud &projected_points_normals,
+                                                                        PointIndices &corresponding_input_indices) const
+{
+  std::vector<int> nn_indices;
+  std::vector<float> nn_dists;
+  tree_->nearestKSearch (point, 1, nn_indices, nn_dists);
+  int input_index = nn_indices.front ();
 
-  // Combine all threads' results into the output vectors
-  for (unsigned int tn = 0; tn < threads; ++tn)
-  {
-    output.insert (output.end (), projected_points[tn].begin (), projected_points[tn].end ());
-    corresponding_input_indices_->indices.insert (corresponding_input_indices_->indices.end (),
-        corresponding_input_indices[tn].indices.begin (), corresponding_input_indices[tn].indices.end ());
-    if (compute_normals_)
-      normals_->insert (normals_->end (), projected_points_normals[tn].begin (), projected_points_normals[tn].end ());
-  }
+  // If the closest point did not have a valid MLS fitting result
+  // OR if it is too far away from the sampled point
+  if (mls_results_[input_index].valid == false)
+    return;
 
-  // Perform the distinct-cloud or voxel-grid upsampling
-  this->performUpsampling (output);
+  Eigen::Vector3d add_point = point.getVector3fMap ().template cast<double> ();
+  MLSResult::MLSProjectionResults proj = mls_results_[input_index].projectPoint (add_point, projection_method_,  5 * nr_coeff_);
+  addProjectedPointNormal (input_index, proj.point, proj.normal, mls_results_[input_index].curvature, projected_points, projected_points_normals, corresponding_input_indices);
 }
-#endif
 
 //////////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointInT, typename PointOutT> void
 pcl::MovingLeastSquares<PointInT, PointOutT>::performUpsampling (PointCloudOut &output)
 {
+  if (upsample_method_ != DISTINCT_CLOUD && upsample_method_ != VOXEL_GRID_DILATION)
+    return;
+
+#ifdef _OPENMP
+  const int threads = threads_ == 0 ? omp_get_num_procs () : static_cast<int> (threads_);
+#endif
+
+  corresponding_input_indices_.reset (new PointIndices);
 
   if (upsample_method_ == DISTINCT_CLOUD)
   {
-    corresponding_input_indices_.reset (new PointIndices);
-    for (size_t dp_i = 0; dp_i < distinct_cloud_->size (); ++dp_i) // dp_i = distinct_point_i
-    {
-      // Distinct cloud may have nan points, skip them
-      if (!pcl_isfinite (distinct_cloud_->points[dp_i].x))
-        continue;
+    const int nr_points = static_cast<int> (distinct_cloud_->size ());
+    const int nr_blocks = (nr_points + detail::MLS_BLOCK_SIZE - 1) / detail::MLS_BLOCK_SIZE;
+    typename PointCloudOut::CloudVectorType projected_points (nr_blocks);
+    typename NormalCloud::CloudVectorType projected_points_normals (nr_blocks);
+    std::vector<PointIndices> corresponding_input_indices (nr_blocks);
 
-      // Get 3D position of point
-      //Eigen::Vector3f pos = distinct_cloud_->points[dp_i].getVector3fMap ();
-      std::vector<int> nn_indices;
-      std::vector<float> nn_dists;
-      tree_->nearestKSearch (distinct_cloud_->points[dp_i], 1, nn_indices, nn_dists);
-      int input_index = nn_indices.front ();
-
-      // If the closest point did not have a valid MLS fitting result
-      // OR if it is too far away from the sampled point
-      if (mls_results_[input_index].valid == false)
-        continue;
+#ifdef _OPENMP
+#pragma omp parallel for schedule (dynamic, 1) num_threads (threads)
+#endif
+    for (int block = 0; block < nr_blocks; ++block)
+    {
+      const int block_end = std::min (nr_points, (block + 1) * detail::MLS_BLOCK_SIZE);
+      for (int dp_i = block * detail::MLS_BLOCK_SIZE; dp_i < block_end; ++dp_i) // dp_i = distinct_point_i
+      {
+        // Distinct cloud may have nan points, skip them
+        if (!pcl_isfinite (distinct_cloud_->points[dp_i].x))
+          continue;
 
-      Eigen::Vector3d add_point = distinct_cloud_->points[dp_i].getVector3fMap ().template cast<double> ();
-      MLSResult::MLSProjectionResults proj =  mls_results_[input_index].projectPoint (add_point, projection_method_,  5 * nr_coeff_);
-      addProjectedPointNormal (input_index, proj.point, proj.normal, mls_results_[input_index].curvature, output, *normals_, *corresponding_input_indices_);
+        addClosestProjectedPoint (distinct_cloud_->points[dp_i], projected_points[block], projected_points_normals[block], corresponding_input_indices[block]);
+      }
     }
+
+    appendBlocks (projected_points, projected_points_normals, corresponding_input_indices, output);
   }
 
   // For the voxel grid upsampling method, generate the voxel grid and dilate it
   // Then, project the newly obtained points to the MLS surface
   if (upsample_method_ == VOXEL_GRID_DILATION)
   {
-    corresponding_input_indices_.reset (new PointIndices);
-
-    MLSVoxelGrid voxel_grid (input_, indices_, voxel_size_);
+    MLSVoxelGrid voxel_grid (input_, indices_, voxel_size_, threads_);
     for (int iteration = 0; iteration < dilation_iteration_num_; ++iteration)
       voxel_grid.dilate ();
 
-    for (typename MLSVoxelGrid::HashMap::iterator m_it = voxel_grid.voxel_grid_.begin (); m_it != voxel_grid.voxel_grid_.end (); ++m_it)
+    // Flatten the voxels, in the order of the grid
+    std::vector<uint64_t> voxels;
+    voxels.reserve (voxel_grid.voxel_grid_.size ());
+    for (typename MLSVoxelGrid::HashMap::const_iterator m_it = voxel_grid.voxel_grid_.begin (); m_it != voxel_grid.voxel_grid_.end (); ++m_it)
+      voxels.push_back (m_it->first);
+
+    const int nr_voxels = static_cast<int> (voxels.size ());
+    const int nr_blocks = (nr_voxels + detail::MLS_BLOCK_SIZE - 1) / detail::MLS_BLOCK_SIZE;
+    typename PointCloudOut::CloudVectorType projected_points (nr_blocks);
+    typename NormalCloud::CloudVectorType projected_points_normals (nr_blocks);
+    std::vector<PointIndices> corresponding_input_indices (nr_blocks);
+
+#ifdef _OPENMP
+#pragma omp parallel for schedule (dynamic, 1) num_threads (threads)
+#endif
+    for (int block = 0; block < nr_blocks; ++block)
     {
-      // Get 3D position of point
-      Eigen::Vector3f pos;
-      voxel_grid.getPosition (m_it->first, pos);
-
-      PointInT p;
-      p.x = pos[0];
-      p.y = pos[1];
-      p.z = pos[2];
-
-      std::vector<int> nn_indices;
-      std::vector<float> nn_dists;
-      tree_->nearestKSearch (p, 1, nn_indices, nn_dists);
-      int input_index = nn_indices.front ();
-
-      // If the closest point did not have a valid MLS fitting result
-      // OR if it is too far away from the sampled point
-      if (mls_results_[input_index].valid == false)
-        continue;
+      const int block_end = std::min (nr_voxels, (block + 1) * detail::MLS_BLOCK_SIZE);
+      for (int i = block * detail::MLS_BLOCK_SIZE; i < block_end; ++i)
+      {
+        // Get 3D position of point
+        Eigen::Vector3f pos;
+        voxel_grid.getPosition (voxels[i], pos);
 
-      Eigen::Vector3d add_point = p.getVector3fMap ().template cast<double> ();
-      MLSResult::MLSProjectionResults proj = mls_results_[input_index].projectPoint (add_point, projection_method_,  5 * nr_coeff_);
-      addProjectedPointNormal (input_index, proj.point, proj.normal, mls_results_[input_index].curvature, output, *normals_, *corresponding_input_indices_);
+        PointInT p;
+        p.x = pos[0];
+        p.y = pos[1];
+        p.z = pos[2];
+
+        addClosestProjectedPoint (p, projected_points[block], projected_points_normals[block], corresponding_input_indices[block]);
+      }
     }
+
+    appendBlocks (projected_points, projected_points_normals, corresponding_input_indices, output);
   }
 }
 
@@ -866,8 +909,9 @@ pcl::MLSResult::computeMLSSurface (const pcl::PointCloud<PointT> &cloud,
 template <typename PointInT, typename PointOutT>
 pcl::MovingLeastSquares<PointInT, PointOutT>::MLSVoxelGrid::MLSVoxelGrid (PointCloudInConstPtr& cloud,
     IndicesPtr &indices,
-    float voxel_size) :
-    voxel_grid_ (), bounding_min_ (), bounding_max_ (), data_size_ (), voxel_size_ (voxel_size)
+    float voxel_size,
+    unsigned int nr_threads) :
+    voxel_grid_ (), bounding_min_ (), bounding_max_ (), data_size_ (), voxel_size_ (voxel_size), threads_ (nr_threads)
 {
   pcl::getMinMax3D (*cloud, *indices, bounding_min_, bounding_max_);
 
@@ -875,45 +919,101 @@ pcl::MovingLeastSquares<PointInT, PointOutT>::MLSVoxelGrid::MLSVoxelGrid (PointC
   double max_size = (std::max) ((std::max)(bounding_box_size.x (), bounding_box_size.y ()), bounding_box_size.z ());
   // Put initial cloud in voxel grid
   data_size_ = static_cast<uint64_t> (1.5 * max_size / voxel_size_);
-  for (unsigned int i = 0; i < indices->size (); ++i)
+
+#ifdef _OPENMP
+  const int threads = threads_ == 0 ? omp_get_num_procs () : static_cast<int> (threads_);
+#endif
+  const int nr_indices = static_cast<int> (indices->size ());
+  const uint64_t invalid = std::numeric_limits<uint64_t>::max ();
+  std::vector<uint64_t> voxels (nr_indices);
+#ifdef _OPENMP
+#pragma omp parallel for schedule (static) num_threads (threads)
+#endif
+  for (int i = 0; i < nr_indices; ++i)
+  {
+    voxels[i] = invalid;
     if (pcl_isfinite (cloud->points[(*indices)[i]].x))
     {
       Eigen::Vector3i pos;
       getCellIndex (cloud->points[(*indices)[i]].getVector3fMap (), pos);
-
-      uint64_t index_1d;
-      getIndexIn1D (pos, index_1d);
-      Leaf leaf;
-      voxel_grid_[index_1d] = leaf;
+      getIndexIn1D (pos, voxels[i]);
     }
+  }
+
+  std::sort (voxels.begin (), voxels.end ());
+  voxels.erase (std::unique (voxels.begin (), voxels.end ()), voxels.end ());
+  if (!voxels.empty () && voxels.back () == invalid)
+    voxels.pop_back ();
+  setVoxels (voxels);
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointInT, typename PointOutT> void
 pcl::MovingLeastSquares<PointInT, PointOutT>::MLSVoxelGrid::dilate ()
 {
-  HashMap new_voxel_grid = voxel_grid_;
-  for (typename MLSVoxelGrid::HashMap::iterator m_it = voxel_grid_.begin (); m_it != voxel_grid_.end (); ++m_it)
+#ifdef _OPENMP
+  const int threads = threads_ == 0 ? omp_get_num_procs () : static_cast<int> (threads_);
+#endif
+
+  std::vector<uint64_t> voxels;
+  voxels.reserve (voxel_grid_.size ());
+  for (typename HashMap::const_iterator m_it = voxel_grid_.begin (); m_it != voxel_grid_.end (); ++m_it)
+    voxels.push_back (m_it->first);
+
+  // Dilate the voxels block by block, the neighbors of consecutive voxels mostly overlap
+  const int nr_voxels = static_cast<int> (voxels.size ());
+  const int nr_blocks = (nr_voxels + detail::MLS_BLOCK_SIZE - 1) / detail::MLS_BLOCK_SIZE;
+  std::vector<std::vector<uint64_t> > dilated_voxels (nr_blocks);
+#ifdef _OPENMP
+#pragma omp parallel for schedule (dynamic, 1) num_threads (threads)
+#endif
+  for (int block = 0; block < nr_blocks; ++block)
   {
-    Eigen::Vector3i index;
-    getIndexIn3D (m_it->first, index);
-
-    // Now dilate all of its voxels
-    for (int x = -1; x <= 1; ++x)
-      for (int y = -1; y <= 1; ++y)
-        for (int z = -1; z <= 1; ++z)
-          if (x != 0 || y != 0 || z != 0)
+    std::vector<uint64_t> &dilated = dilated_voxels[block];
+    const int block_end = std::min (nr_voxels, (block + 1) * detail::MLS_BLOCK_SIZE);
+    dilated.reserve (27 * (block_end - block * detail::MLS_BLOCK_SIZE));
+    for (int i = block * detail::MLS_BLOCK_SIZE; i < block_end; ++i)
+    {
+      Eigen::Vector3i index;
+      getIndexIn3D (voxels[i], index);
+
+      // Now dilate all of its voxels, including itself
+      for (int x = -1; x <= 1; ++x)
+        for (int y = -1; y <= 1; ++y)
+          for (int z = -1; z <= 1; ++z)
           {
             Eigen::Vector3i new_index;
             new_index = index + Eigen::Vector3i (x, y, z);
 
             uint64_t index_1d;
             getIndexIn1D (new_index, index_1d);
-            Leaf leaf;
-            new_voxel_grid[index_1d] = leaf;
+            dilated.push_back (index_1d);
           }
+    }
+    std::sort (dilated.begin (), dilated.end ());
+    dilated.erase (std::unique (dilated.begin (), dilated.end ()), dilated.end ());
+  }
+
+  voxels.clear ();
+  for (int block = 0; block < nr_blocks; ++block)
+  {
+    voxels.insert (voxels.end (), dilated_voxels[block].begin (), dilated_voxels[block].end ());
+    std::vector<uint64_t> ().swap (dilated_voxels[block]);
   }
-  voxel_grid_ = new_voxel_grid;
+  std::sort (voxels.begin (), voxels.end ());
+  voxels.erase (std::unique (voxels.begin (), voxels.end ()), voxels.end ());
+  setVoxels (voxels);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointInT, typename PointOutT> void
+pcl::MovingLeastSquares<PointInT, PointOutT>::MLSVoxelGrid::setVoxels (const std::vector<uint64_t> &voxels)
+{
+  // The voxels are sorted, so every insertion is amortized constant time at the end of the map
+  voxel_grid_.clear ();
+  Leaf leaf;
+  for (size_t i = 0; i < voxels.size (); ++i)
+    voxel_grid_.insert (voxel_grid_.end (), std::make_pair (voxels[i], leaf));
 }
 
 
@@ -307,6 +307,7 @@ namespace pcl
                               dilation_iteration_num_ (0),
                               nr_coeff_ (),
                               corresponding_input_indices_ (),
+                              threads_ (1),
                               rng_alg_ (),
                               rng_uniform_distribution_ ()
                               {};
@@ -503,6 +504,15 @@ namespace pcl
       inline MLSResult::ProjectionMethod
       getProjectionMethod () const { return (projection_method_); }
 
+      /** \brief Set the number of threads to use. All the upsampling methods run in parallel as well. The points are
+        * processed in fixed blocks, whose results are concatenated in order, so the output does not depend on the number
+        * of threads. In the case of RANDOM_UNIFORM_DENSITY upsampling, every block draws from its own random number
+        * generator.
+        * \param[in] nr_threads the number of hardware threads to use (0 sets the value back to automatic)
+        */
+      inline void
+      setNumberOfThreads (unsigned int nr_threads = 0) { threads_ = nr_threads; }
+
       /** \brief Get the MLSResults for input cloud
         * \note The results are only stored if setCacheMLSResults(true) was called or when using the upsampling method DISTINCT_CLOUD or VOXEL_GRID_DILATION.
         * \note This vector is align with the input cloud indices, so use getCorrespondingIndices to get the correct results when using output cloud indices.
@@ -589,11 +599,18 @@ namespace pcl
 
           MLSVoxelGrid (PointCloudInConstPtr& cloud,
                         IndicesPtr &indices,
-                        float voxel_size);
+                        float voxel_size,
+                        unsigned int nr_threads = 1);
 
           void
           dilate ();
 
+          /** \brief Replace the voxels by the given ones.
+            * \param[in] voxels the 1D indices of the voxels, sorted and without duplicates
+            */
+          void
+          setVoxels (const std::vector<uint64_t> &voxels);
+
           inline void
           getIndexIn1D (const Eigen::Vector3i &index, uint64_t &index_1d) const
           {
@@ -632,6 +649,7 @@ namespace pcl
           Eigen::Vector4f bounding_min_, bounding_max_;
           uint64_t data_size_;
           float voxel_size_;
+          unsigned int threads_;
       };
 
 
@@ -647,6 +665,9 @@ namespace pcl
       /** \brief Collects for each point in output the corrseponding point in the input. */
       PointIndicesPtr corresponding_input_indices_;
 
+      /** \brief The number of threads the scheduler should use. */
+      unsigned int threads_;
+
       /** \brief Search for the closest nearest neighbors of a given point using a radius search
         * \param[in] index the index of the query point
         * \param[out] indices the resultant vector of indices representing the k-nearest neighbors
@@ -677,6 +698,25 @@ namespace pcl
                              PointIndices &corresponding_input_indices,
                              MLSResult &mls_result) const;
 
+      /** \brief Smooth a given point and its neighborghood using Moving Least Squares, drawing the random samples
+        * of the RANDOM_UNIFORM_DENSITY upsampling from the given generator.
+        * \param[in] index the index of the query point in the input cloud
+        * \param[in] nn_indices the set of nearest neighbors indices for pt
+        * \param[out] projected_points the set of points projected points around the query point
+        * \param[out] projected_points_normals the normals corresponding to the projected points
+        * \param[out] corresponding_input_indices the set of indices with each point in output having the corresponding point in input
+        * \param[out] mls_result stores the MLS result for each point in the input cloud
+        * \param[in] rng_uniform_distribution the random number generator (used only in the case of RANDOM_UNIFORM_DENSITY upsampling)
+        */
+      void
+      computeMLSPointNormal (int index,
+                             const std::vector<int> &nn_indices,
+                             PointCloudOut &projected_points,
+                             NormalCloud &projected_points_normals,
+                             PointIndices &corresponding_input_indices,
+                             MLSResult &mls_result,
+                             boost::variate_generator<boost::mt19937&, boost::uniform_real<float> > *rng_uniform_distribution) const;
+
 
       /** \brief This is a helper function for add projected points
         * \param[in] index the index of the query point in the input cloud
@@ -697,6 +737,32 @@ namespace pcl
                               PointIndices &corresponding_input_indices) const;
 
 
+      /** \brief Project a point to the MLS surface of the closest input point, if that has a valid MLS result.
+        * Used by the DISTINCT_CLOUD and VOXEL_GRID_DILATION upsampling methods.
+        * \param[in] point the point to project
+        * \param[out] projected_points the set of projected points to append the result to
+        * \param[out] projected_points_normals the normals corresponding to the projected points
+        * \param[out] corresponding_input_indices the set of indices with each point in output having the corresponding point in input
+        */
+      void
+      addClosestProjectedPoint (const PointInT &point,
+                                PointCloudOut &projected_points,
+                                NormalCloud &projected_points_normals,
+                                PointIndices &corresponding_input_indices) const;
+
+      /** \brief Append the results computed for the blocks of a parallel loop to the output, the normals and the
+        * corresponding input indices, in the order of the blocks.
+        * \param[in] projected_points the projected points of every block
+        * \param[in] projected_points_normals the normals of every block
+        * \param[in] corresponding_input_indices the corresponding input indices of every block
+        * \param[out] output the cloud to append the points to
+        */
+      void
+      appendBlocks (const typename PointCloudOut::CloudVectorType &projected_points,
+                    const typename NormalCloud::CloudVectorType &projected_points_normals,
+                    const std::vector<PointIndices> &corresponding_input_indices,
+                    PointCloudOut &output);
+
       void
       copyMissingFields (const PointInT &point_in,
                          PointOutT &point_out) const;
@@ -734,8 +800,8 @@ namespace pcl
 
 #ifdef _OPENMP
   /** \brief MovingLeastSquaresOMP is a parallelized version of MovingLeastSquares, using the OpenMP standard.
-   * \note Compared to MovingLeastSquares, an overhead is incurred in terms of runtime and memory usage.
-   * \note The upsampling methods DISTINCT_CLOUD and VOXEL_GRID_DILATION are not parallelized completely, i.e. parts of the algorithm run on a single thread only.
+   * \note MovingLeastSquares itself runs in parallel when given a number of threads, see
+   * MovingLeastSquares::setNumberOfThreads (). This class only keeps the previous interface, where 0 threads means 1.
    * \author Robert Huitl
    * \ingroup surface
    */
@@ -759,9 +825,9 @@ namespace pcl
       /** \brief Constructor for parallelized Moving Least Squares
         * \param threads the maximum number of hardware threads to use (0 sets the value to 1)
         */
-      MovingLeastSquaresOMP (unsigned int threads = 0) : threads_ (threads)
+      MovingLeastSquaresOMP (unsigned int threads = 0)
       {
-
+        setNumberOfThreads (threads);
       }
 
       /** \brief Set the maximum number of threads to use
@@ -770,28 +836,8 @@ namespace pcl
       inline void
       setNumberOfThreads (unsigned int threads = 0)
       {
-        threads_ = threads;
+        MovingLeastSquares<PointInT, PointOutT>::setNumberOfThreads (threads == 0 ? 1 : threads);
       }
-
-    protected:
-      using PCLBase<PointInT>::input_;
-      using PCLBase<PointInT>::indices_;
-      using MovingLeastSquares<PointInT, PointOutT>::normals_;
-      using MovingLeastSquares<PointInT, PointOutT>::corresponding_input_indices_;
-      using MovingLeastSquares<PointInT, PointOutT>::nr_coeff_;
-      using MovingLeastSquares<PointInT, PointOutT>::order_;
-      using MovingLeastSquares<PointInT, PointOutT>::compute_normals_;
-      using MovingLeastSquares<PointInT, PointOutT>::upsample_method_;
-      using MovingLeastSquares<PointInT, PointOutT>::cache_mls_results_;
-
-      /** \brief Abstract surface reconstruction method.
-        * \param[out] output the result of the reconstruction
-        */
-      virtual void
-      performProcessing (PointCloudOut &output);
-
-      /** \brief The maximum number of threads the scheduler should use. */
-      unsigned int threads_;
   };
 #endif
 }
@@ -351,6 +351,126 @@ TEST (PCL, CopyPointCloudWithSameTypes)
   ASSERT_EQ (0, cloud_out.size ());
 }
 
+/** \brief Build a message with float fields at the given offsets, filled with distinct values. */
+static PCLPointCloud2
+makeMessage (const std::vector<std::string> &names, const std::vector<uint32_t> &offsets,
+             uint32_t point_step, uint32_t width, uint32_t height, uint32_t row_padding)
+{
+  PCLPointCloud2 msg;
+  for (size_t f = 0; f < names.size (); ++f)
+  {
+    PCLPointField field;
+    field.name = names[f];
+    field.offset = offsets[f];
+    field.datatype = PCLPointField::FLOAT32;
+    field.count = 1;
+    msg.fields.push_back (field);
+  }
+  msg.width = width;
+  msg.height = height;
+  msg.point_step = point_step;
+  msg.row_step = point_step * width + row_padding;
+  msg.data.resize (msg.row_step * height);
+  for (size_t i = 0; i < msg.data.size () / 4; ++i)
+  {
+    float value = static_cast<float> (i) * 0.25f;
+    memcpy (&msg.data[i * 4], &value, 4);
+  }
+  return (msg);
+}
+
+TEST (PCL, PCLPointCloud2Converter)
+{
+  // Identical layouts: a single block copy
+  PointCloud<PointXYZRGB> cloud_rgb;
+  for (int i = 0; i < 100; ++i)
+  {
+    PointXYZRGB p;
+    p.x = static_cast<float> (i); p.y = 2.0f * p.x; p.z = -p.x;
+    p.r = static_cast<uint8_t> (i); p.g = 3; p.b = static_cast<uint8_t> (255 - i);
+    cloud_rgb.push_back (p);
+  }
+  PCLPointCloud2Converter<PointXYZRGB> converter_rgb;
+  PCLPointCloud2 msg_rgb, msg_rgb_ref;
+  converter_rgb.toPCLPointCloud2 (cloud_rgb, msg_rgb);
+  toPCLPointCloud2 (cloud_rgb, msg_rgb_ref);
+  EXPECT_EQ (msg_rgb.fields.size (), msg_rgb_ref.fields.size ());
+  EXPECT_EQ (msg_rgb.point_step, msg_rgb_ref.point_step);
+  EXPECT_TRUE (msg_rgb.data == msg_rgb_ref.data);
+
+  PointCloud<PointXYZRGB> cloud_rgb_out;
+  converter_rgb.fromPCLPointCloud2 (msg_rgb, cloud_rgb_out);
+  EXPECT_EQ (converter_rgb.getCopyMode (), PCLPointCloud2Converter<PointXYZRGB>::COPY_BLOCK);
+  ASSERT_EQ (cloud_rgb_out.size (), cloud_rgb.size ());
+  for (size_t i = 0; i < cloud_rgb.size (); ++i)
+  {
+    EXPECT_XYZ_EQ (cloud_rgb_out[i], cloud_rgb[i]);
+    EXPECT_EQ (cloud_rgb_out[i].rgba, cloud_rgb[i].rgba);
+  }
+
+  // Foreign XYZI layout, organized with padded rows: de-interleave with an extra field
+  std::vector<std::string> names;
+  names.push_back ("x"); names.push_back ("y"); names.push_back ("z"); names.push_back ("intensity");
+  std::vector<uint32_t> offsets;
+  offsets.push_back (0); offsets.push_back (4); offsets.push_back (8); offsets.push_back (12);
+  PCLPointCloud2 msg_xyzi = makeMessage (names, offsets, 16, 33, 7, 8);
+
+  PCLPointCloud2Converter<PointXYZI> converter_xyzi;
+  PointCloud<PointXYZI> cloud_xyzi, cloud_xyzi_ref;
+  converter_xyzi.fromPCLPointCloud2 (msg_xyzi, cloud_xyzi);
+  fromPCLPointCloud2 (msg_xyzi, cloud_xyzi_ref);
+  EXPECT_EQ (converter_xyzi.getCopyMode (), PCLPointCloud2Converter<PointXYZI>::COPY_XYZ_EXTRA);
+  EXPECT_EQ (cloud_xyzi.width, 33);
+  EXPECT_EQ (cloud_xyzi.height, 7);
+  ASSERT_EQ (cloud_xyzi.size (), cloud_xyzi_ref.size ());
+  for (size_t i = 0; i < cloud_xyzi.size (); ++i)
+  {
+    EXPECT_XYZ_EQ (cloud_xyzi[i], cloud_xyzi_ref[i]);
+    EXPECT_EQ (cloud_xyzi[i].data[3], cloud_xyzi_ref[i].data[3]);
+    EXPECT_EQ (cloud_xyzi[i].intensity, cloud_xyzi_ref[i].intensity);
+  }
+
+  // Packed XYZ layout, where the last points cannot be loaded 16 bytes at a time
+  names.resize (3);
+  offsets.resize (3);
+  PCLPointCloud2 msg_xyz = makeMessage (names, offsets, 12, 50, 1, 0);
+  PCLPointCloud2Converter<PointXYZ> converter_xyz;
+  PointCloud<PointXYZ> cloud_xyz, cloud_xyz_ref;
+  converter_xyz.fromPCLPointCloud2 (msg_xyz, cloud_xyz);
+  fromPCLPointCloud2 (msg_xyz, cloud_xyz_ref);
+  EXPECT_EQ (converter_xyz.getCopyMode (), PCLPointCloud2Converter<PointXYZ>::COPY_XYZ);
+  ASSERT_EQ (cloud_xyz.size (), cloud_xyz_ref.size ());
+  for (size_t i = 0; i < cloud_xyz.size (); ++i)
+  {
+    EXPECT_XYZ_EQ (cloud_xyz[i], cloud_xyz_ref[i]);
+    EXPECT_EQ (cloud_xyz[i].data[3], 1.0f);
+  }
+
+  // The mapping follows changes of the layout
+  converter_xyzi.fromPCLPointCloud2 (msg_xyz, cloud_xyzi);
+  EXPECT_EQ (converter_xyzi.getCopyMode (), PCLPointCloud2Converter<PointXYZI>::COPY_XYZ);
+  ASSERT_EQ (cloud_xyzi.size (), msg_xyz.width);
+  for (size_t i = 0; i < cloud_xyzi.size (); ++i)
+    EXPECT_XYZ_EQ (cloud_xyzi[i], cloud_xyz_ref[i]);
+
+  // Anything else is copied field by field
+  names.push_back ("normal_x"); names.push_back ("normal_y"); names.push_back ("normal_z"); names.push_back ("curvature");
+  offsets.push_back (16); offsets.push_back (20); offsets.push_back (24); offsets.push_back (12);
+  PCLPointCloud2 msg_normal = makeMessage (names, offsets, 28, 20, 2, 0);
+  PCLPointCloud2Converter<PointNormal> converter_normal;
+  PointCloud<PointNormal> cloud_normal, cloud_normal_ref;
+  converter_normal.fromPCLPointCloud2 (msg_normal, cloud_normal);
+  fromPCLPointCloud2 (msg_normal, cloud_normal_ref);
+  EXPECT_EQ (converter_normal.getCopyMode (), PCLPointCloud2Converter<PointNormal>::COPY_FIELDS);
+  ASSERT_EQ (cloud_normal.size (), cloud_normal_ref.size ());
+  for (size_t i = 0; i < cloud_normal.size (); ++i)
+  {
+    EXPECT_XYZ_EQ (cloud_normal[i], cloud_normal_ref[i]);
+    EXPECT_EQ (cloud_normal[i].normal_y, cloud_normal_ref[i].normal_y);
+    EXPECT_EQ (cloud_normal[i].curvature, cloud_normal_ref[i].curvature);
+  }
+}
+
 /* ---[ */
 int
 main (int argc, char** argv)
@@ -40,6 +40,7 @@
 #include <pcl/point_types.h>
 #include <pcl/features/normal_3d.h>
 #include <pcl/features/integral_image_normal.h>
+#include <pcl/features/organized_normal_estimation.h>
 
 #include <iostream>
 
@@ -506,6 +507,88 @@ TEST (PCL, IINormalEstimationSimple3DGradientUnorganized)
   EXPECT_EQ (output.height, 0);
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PCL, OrganizedNormalEstimation)
+{
+  // A tilted plane far away from the origin, where float integral images lose too much precision
+  PointCloud<PointXYZ>::Ptr plane (new PointCloud<PointXYZ> (160, 120));
+  Eigen::Vector3f normal (0.3f, -0.2f, 1.0f);
+  normal.normalize ();
+  const Eigen::Vector3f u_axis = normal.unitOrthogonal ();
+  const Eigen::Vector3f v_axis = normal.cross (u_axis);
+  for (size_t v = 0; v < plane->height; ++v)
+  {
+    for (size_t u = 0; u < plane->width; ++u)
+    {
+      (*plane) (u, v).getVector3fMap () = Eigen::Vector3f (1000.0f, 2000.0f, 3000.0f) +
+                                          0.01f * static_cast<float> (u) * u_axis +
+                                          0.01f * static_cast<float> (v) * v_axis;
+      if ((u * 7 + v * 13) % 97 == 0)
+        (*plane) (u, v).x = std::numeric_limits<float>::quiet_NaN ();
+    }
+  }
+  plane->is_dense = false;
+
+  OrganizedNormalEstimation<PointXYZ, Normal> one (1);
+  one.setRectSize (5, 5);
+  one.setViewPoint (0.0f, 0.0f, 0.0f);
+  one.setInputCloud (plane);
+  PointCloud<Normal> output;
+  one.compute (output);
+
+  EXPECT_EQ (output.points.size (), plane->points.size ());
+  EXPECT_EQ (output.width, plane->width);
+  EXPECT_EQ (output.height, plane->height);
+  EXPECT_FALSE (output.is_dense);
+
+  for (size_t i = 0; i < output.points.size (); ++i)
+  {
+    if (!isFinite (plane->points[i]))
+    {
+      EXPECT_FALSE (pcl_isfinite (output.points[i].normal_x));
+      continue;
+    }
+    // Normals are flipped towards the viewpoint at the origin
+    EXPECT_NEAR (-1.0, output.points[i].getNormalVector3fMap ().dot (normal), 1e-4);
+    EXPECT_NEAR (0.0, output.points[i].curvature, 1e-4);
+  }
+
+  // The result does not depend on the number of threads
+  PointCloud<Normal> output_parallel;
+  one.setNumberOfThreads (4);
+  one.compute (output_parallel);
+  ASSERT_EQ (output.points.size (), output_parallel.points.size ());
+  for (size_t i = 0; i < output.points.size (); ++i)
+  {
+    if (!pcl_isfinite (output.points[i].normal_x))
+      continue;
+    EXPECT_EQ (output.points[i].normal_x, output_parallel.points[i].normal_x);
+    EXPECT_EQ (output.points[i].normal_y, output_parallel.points[i].normal_y);
+    EXPECT_EQ (output.points[i].normal_z, output_parallel.points[i].normal_z);
+    EXPECT_EQ (output.points[i].curvature, output_parallel.points[i].curvature);
+  }
+
+  // With indices, the normals of the indexed points are returned
+  boost::shared_ptr<std::vector<int> > indices (new std::vector<int>);
+  indices->push_back (1);
+  indices->push_back (5000);
+  one.setIndices (indices);
+  PointCloud<Normal> output_indices;
+  one.compute (output_indices);
+  ASSERT_EQ (2, output_indices.points.size ());
+  EXPECT_EQ (output.points[1].normal_z, output_indices.points[0].normal_z);
+  EXPECT_EQ (output.points[5000].normal_z, output_indices.points[1].normal_z);
+
+  // Unorganized clouds are rejected
+  PointCloud<PointXYZ>::Ptr unorganized (new PointCloud<PointXYZ> (*plane));
+  unorganized->width = static_cast<uint32_t> (unorganized->points.size ());
+  unorganized->height = 1;
+  OrganizedNormalEstimation<PointXYZ, Normal> one_unorganized;
+  one_unorganized.setInputCloud (unorganized);
+  one_unorganized.compute (output);
+  EXPECT_EQ (0, output.points.size ());
+}
+
 /* ---[ */
 int
 main (int argc, char** argv)
@@ -499,6 +499,57 @@ TEST (PCL, FPFHEstimationOpenMP)
   (cloud.makeShared (), normals, test_indices, 33);
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PCL, FPFHEstimationOpenMPNeighborCache)
+{
+  NormalEstimation<PointXYZ, Normal> n;
+  PointCloud<Normal>::Ptr normals (new PointCloud<Normal> ());
+  n.setInputCloud (cloud.makeShared ());
+  n.setSearchMethod (tree);
+  n.setKSearch (10);
+  n.compute (*normals);
+
+  boost::shared_ptr<vector<int> > test_indices (new vector<int> (0));
+  for (size_t i = 0; i < cloud.size (); i += 3)
+    test_indices->push_back (static_cast<int> (i));
+
+  // Every point, and a subset of the points of the search surface
+  for (int subset = 0; subset < 2; ++subset)
+  {
+    FPFHEstimation<PointXYZ, Normal, FPFHSignature33> fpfh;
+    fpfh.setInputCloud (cloud.makeShared ());
+    fpfh.setInputNormals (normals);
+    fpfh.setSearchMethod (tree);
+    fpfh.setRadiusSearch (0.01);
+    if (subset)
+      fpfh.setIndices (test_indices);
+    PointCloud<FPFHSignature33> expected;
+    fpfh.compute (expected);
+
+    // No cache, a cache holding part of the neighborhoods, and one holding all of them
+    const size_t cache_sizes[] = {0, 16 * 1024, 256 * 1024 * 1024};
+    for (int c = 0; c < 3; ++c)
+    {
+      FPFHEstimationOMP<PointXYZ, Normal, FPFHSignature33> fpfh_omp (4);
+      fpfh_omp.setInputCloud (cloud.makeShared ());
+      fpfh_omp.setInputNormals (normals);
+      fpfh_omp.setSearchMethod (tree);
+      fpfh_omp.setRadiusSearch (0.01);
+      fpfh_omp.setNeighborCacheSize (cache_sizes[c]);
+      EXPECT_EQ (fpfh_omp.getNeighborCacheSize (), cache_sizes[c]);
+      if (subset)
+        fpfh_omp.setIndices (test_indices);
+      PointCloud<FPFHSignature33> output;
+      fpfh_omp.compute (output);
+
+      ASSERT_EQ (output.size (), expected.size ());
+      for (size_t i = 0; i < output.size (); ++i)
+        for (int d = 0; d < 33; ++d)
+          EXPECT_NEAR (output.points[i].histogram[d], expected.points[i].histogram[d], 1e-4);
+    }
+  }
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 TEST (PCL, VFHEstimation)
 {
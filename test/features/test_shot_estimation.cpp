@@ -714,6 +714,68 @@ TEST (PCL, SHOTShapeEstimationOpenMP)
   testSHOTLocalReferenceFrame<SHOTEstimationOMP<PointXYZ, Normal, SHOT352>, PointXYZ, Normal, SHOT352> (cloud.makeShared (), normals, test_indices);
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PCL, SHOTShapeEstimationOpenMPFused)
+{
+  double mr = 0.002;
+  NormalEstimationOMP<PointXYZ, Normal> n;
+  PointCloud<Normal>::Ptr normals (new PointCloud<Normal> ());
+  n.setInputCloud (cloud.makeShared ());
+  n.setSearchMethod (tree);
+  n.setRadiusSearch (20 * mr);
+  n.compute (*normals);
+
+  // Reference: reference frames estimated separately
+  SHOTEstimationOMP<PointXYZ, Normal, SHOT352> shot352;
+  shot352.setInputCloud (cloud.makeShared ());
+  shot352.setInputNormals (normals);
+  shot352.setSearchMethod (search::KdTree<PointXYZ>::Ptr (new search::KdTree<PointXYZ> (false)));
+  shot352.setRadiusSearch (20 * mr);
+  PointCloud<SHOT352> shots352;
+  shot352.compute (shots352);
+
+  // Reference frames computed from the neighborhoods of the descriptors
+  SHOTEstimationOMP<PointXYZ, Normal, SHOT352> fused;
+  EXPECT_FALSE (fused.getUseFusedLRF ());
+  fused.setUseFusedLRF (true);
+  EXPECT_TRUE (fused.getUseFusedLRF ());
+  fused.setInputCloud (cloud.makeShared ());
+  fused.setInputNormals (normals);
+  search::KdTree<PointXYZ>::Ptr fused_tree (new search::KdTree<PointXYZ> (false));
+  fused.setSearchMethod (fused_tree);
+  fused.setRadiusSearch (20 * mr);
+  PointCloud<SHOT352> fused_shots;
+  fused.compute (fused_shots);
+  // The neighbors are sorted for the reference frames without changing the search method
+  EXPECT_FALSE (fused_tree->getSortedResults ());
+
+  ASSERT_EQ (shots352.size (), fused_shots.size ());
+  ASSERT_EQ (cloud.size (), fused.getInputReferenceFrames ()->size ());
+  for (size_t i = 0; i < shots352.size (); ++i)
+  {
+    for (int d = 0; d < 9; ++d)
+      EXPECT_NEAR (shots352[i].rf[d], fused_shots[i].rf[d], 1e-5);
+    for (int d = 0; d < 352; ++d)
+      EXPECT_NEAR (shots352[i].descriptor[d], fused_shots[i].descriptor[d], 1e-5);
+  }
+
+  // The same descriptors in a padded matrix
+  SHOTEstimationOMP<PointXYZ, Normal, SHOT352>::DescriptorMatrix descriptors;
+  size_t stride = 0;
+  ASSERT_TRUE (fused.computeDescriptorMatrix (descriptors, stride));
+  EXPECT_EQ (352, stride);
+  ASSERT_EQ (fused_shots.size () * stride, descriptors.size ());
+  EXPECT_EQ (0, reinterpret_cast<size_t> (&descriptors[0]) % 16);
+  for (size_t i = 0; i < fused_shots.size (); ++i)
+    for (int d = 0; d < 352; ++d)
+    {
+      if (pcl_isfinite (fused_shots[i].descriptor[d]))
+        EXPECT_EQ (fused_shots[i].descriptor[d], descriptors[i * stride + d]);
+      else
+        EXPECT_FALSE (pcl_isfinite (descriptors[i * stride + d]));
+    }
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 TEST (PCL,SHOTShapeAndColorEstimationOpenMP)
 {
@@ -39,6 +39,9 @@
  */
 
 #include <gtest/gtest.h>
+#include <fstream>
+#include <iterator>
+#include <set>
 #include <pcl/point_types.h>
 #include <pcl/io/pcd_io.h>
 #include <pcl/features/normal_3d.h>
@@ -48,6 +51,7 @@
 #include <pcl/filters/frustum_culling.h>
 #include <pcl/filters/sampling_surface_normal.h>
 #include <pcl/filters/voxel_grid.h>
+#include <pcl/filters/voxel_grid_omp.h>
 #include <pcl/filters/voxel_grid_covariance.h>
 #include <pcl/filters/extract_indices.h>
 #include <pcl/filters/project_inliers.h>
@@ -722,6 +726,70 @@ TEST (VoxelGrid, Filters)
   EXPECT_LE (output.points[neighbors2.at (0)].z - output.points[centroidIdx2].z, 0.02 * 2);
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (VoxelGridOMP, Filters)
+{
+  PointCloud<PointXYZ> output, output_omp;
+  VoxelGrid<PointXYZ> grid;
+  VoxelGridOMP<PointXYZ> grid_omp (4);
+
+  grid.setLeafSize (0.02f, 0.02f, 0.02f);
+  grid.setInputCloud (cloud);
+  grid_omp.setLeafSize (0.02f, 0.02f, 0.02f);
+  grid_omp.setInputCloud (cloud);
+
+  // Reversed indices exercise the tie breaking between points in the same voxel
+  IndicesPtr indices (new vector<int> (indices_.rbegin (), indices_.rend ()));
+  for (int run = 0; run < 3; ++run)
+  {
+    if (run == 1)
+    {
+      grid.setFilterFieldName ("z");
+      grid.setFilterLimits (0.05, 0.1);
+      grid_omp.setFilterFieldName ("z");
+      grid_omp.setFilterLimits (0.05, 0.1);
+    }
+    else if (run == 2)
+    {
+      grid.setIndices (indices);
+      grid.setMinimumPointsNumberPerVoxel (2);
+      grid_omp.setIndices (indices);
+      grid_omp.setMinimumPointsNumberPerVoxel (2);
+    }
+
+    grid.filter (output);
+    grid_omp.filter (output_omp);
+
+    ASSERT_EQ (output.points.size (), output_omp.points.size ());
+    EXPECT_EQ (output.width, output_omp.width);
+    EXPECT_EQ (output.height, output_omp.height);
+    EXPECT_EQ (output.is_dense, output_omp.is_dense);
+    for (size_t i = 0; i < output.points.size (); ++i)
+    {
+      EXPECT_EQ (output.points[i].x, output_omp.points[i].x);
+      EXPECT_EQ (output.points[i].y, output_omp.points[i].y);
+      EXPECT_EQ (output.points[i].z, output_omp.points[i].z);
+    }
+  }
+
+  // A grid of more than 2^31 voxels is handled as long as no leaf layout is requested
+  PointCloud<PointXYZ>::Ptr sparse_cloud (new PointCloud<PointXYZ>);
+  sparse_cloud->points.push_back (PointXYZ (0.0f, 0.0f, 0.0f));
+  sparse_cloud->points.push_back (PointXYZ (0.0f, 0.0f, 0.0001f));
+  sparse_cloud->points.push_back (PointXYZ (100.0f, 100.0f, 100.0f));
+  sparse_cloud->width = 3;
+  sparse_cloud->height = 1;
+
+  VoxelGridOMP<PointXYZ> sparse_grid;
+  sparse_grid.setLeafSize (0.001f, 0.001f, 0.001f);
+  sparse_grid.setInputCloud (sparse_cloud);
+  sparse_grid.filter (output_omp);
+
+  ASSERT_EQ (int (output_omp.points.size ()), 2);
+  EXPECT_NEAR (output_omp.points[0].z, 0.00005f, 1e-6);
+  EXPECT_EQ (output_omp.points[1].x, 100.0f);
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 TEST (VoxelGrid_No_DownsampleAllData, Filters)
 {
@@ -1327,6 +1395,192 @@ TEST (VoxelGridCovariance, Filters)
   EXPECT_NEAR (leaves[2]->getMean ()[2], 0.0508024, 1e-4);
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (VoxelGridCovarianceLeaves, Filters)
+{
+  typedef VoxelGridCovariance<PointXYZ> Grid;
+  PointCloud<PointXYZ> output, output_mt;
+  Grid grid, grid_mt;
+
+  grid.setLeafSize (0.02f, 0.02f, 0.02f);
+  grid.setInputCloud (cloud);
+  grid.filter (output, true);
+
+  // The voxel structure must not depend on the number of threads
+  grid_mt.setLeafSize (0.02f, 0.02f, 0.02f);
+  grid_mt.setInputCloud (cloud);
+  grid_mt.setNumberOfThreads (4);
+  grid_mt.filter (output_mt, true);
+
+  const Grid::LeafVector &leaves = grid.getLeaves ();
+  const vector<size_t> &voxel_indices = grid.getLeafVoxelIndices ();
+  ASSERT_EQ (leaves.size (), voxel_indices.size ());
+  ASSERT_EQ (leaves.size (), grid_mt.getLeaves ().size ());
+  ASSERT_EQ (output.points.size (), output_mt.points.size ());
+  for (size_t i = 0; i < output.points.size (); ++i)
+  {
+    EXPECT_EQ (output.points[i].x, output_mt.points[i].x);
+    EXPECT_EQ (output.points[i].y, output_mt.points[i].y);
+    EXPECT_EQ (output.points[i].z, output_mt.points[i].z);
+  }
+
+  // Leaves are sorted by voxel index and found by it
+  int nr_points = 0;
+  for (size_t i = 0; i < leaves.size (); ++i)
+  {
+    if (i > 0)
+      EXPECT_LT (voxel_indices[i - 1], voxel_indices[i]);
+    EXPECT_EQ (grid.getLeaf (static_cast<int> (voxel_indices[i])), &leaves[i]);
+    EXPECT_EQ (grid_mt.getLeaves ()[i].nr_points, leaves[i].nr_points);
+    EXPECT_EQ (grid_mt.getLeaves ()[i].getInverseCov (), leaves[i].getInverseCov ());
+    nr_points += std::abs (leaves[i].nr_points);
+  }
+  EXPECT_LE (nr_points, int (cloud->points.size ()));
+  EXPECT_TRUE (grid.getLeaf (-1) == NULL);
+
+  // Save and load the voxel structure
+  const std::string file_name = "test_voxel_grid_covariance.bin";
+  ASSERT_TRUE (grid.saveLeaves (file_name));
+  Grid loaded;
+  ASSERT_TRUE (loaded.loadLeaves (file_name, true));
+
+  // Truncated files and corrupt leaf counts are rejected without allocating
+  std::string contents;
+  {
+    std::ifstream fs (file_name.c_str (), std::ios::in | std::ios::binary);
+    contents.assign ((std::istreambuf_iterator<char> (fs)), std::istreambuf_iterator<char> ());
+  }
+  const std::string corrupt_file_name = "test_voxel_grid_covariance_corrupt.bin";
+  {
+    std::ofstream fs (corrupt_file_name.c_str (), std::ios::out | std::ios::binary);
+    fs.write (contents.data (), contents.size () / 2);
+  }
+  Grid corrupt;
+  EXPECT_FALSE (corrupt.loadLeaves (corrupt_file_name));
+  {
+    // nr_leaves follows the magic, the point size, five 4-vectors and the two parameters
+    const uint64_t nr_leaves = uint64_t (1) << 60;
+    std::string header = contents;
+    header.replace (8 + 4 + 5 * 16 + 4 + 8, sizeof (nr_leaves), reinterpret_cast<const char*> (&nr_leaves), sizeof (nr_leaves));
+    std::ofstream fs (corrupt_file_name.c_str (), std::ios::out | std::ios::binary);
+    fs.write (header.data (), header.size ());
+  }
+  EXPECT_FALSE (corrupt.loadLeaves (corrupt_file_name));
+  remove (corrupt_file_name.c_str ());
+  remove (file_name.c_str ());
+  EXPECT_FALSE (loaded.loadLeaves (file_name));
+
+  EXPECT_EQ (loaded.getLeafSize (), grid.getLeafSize ());
+  ASSERT_EQ (loaded.getLeaves ().size (), leaves.size ());
+  for (size_t i = 0; i < leaves.size (); ++i)
+  {
+    const Grid::Leaf &leaf = loaded.getLeaves ()[i];
+    EXPECT_EQ (loaded.getLeafVoxelIndices ()[i], voxel_indices[i]);
+    EXPECT_EQ (leaf.nr_points, leaves[i].nr_points);
+    EXPECT_EQ (leaf.getMean (), leaves[i].getMean ());
+    EXPECT_EQ (leaf.getCov (), leaves[i].getCov ());
+    EXPECT_EQ (leaf.getInverseCov (), leaves[i].getInverseCov ());
+    EXPECT_EQ (leaf.getEvals (), leaves[i].getEvals ());
+    EXPECT_EQ (leaf.centroid, leaves[i].centroid);
+  }
+  ASSERT_EQ (loaded.getCentroids ()->points.size (), output.points.size ());
+  for (size_t i = 0; i < output.points.size (); ++i)
+  {
+    EXPECT_EQ (loaded.getCentroids ()->points[i].x, output.points[i].x);
+    EXPECT_EQ (loaded.getCentroids ()->points[i].y, output.points[i].y);
+    EXPECT_EQ (loaded.getCentroids ()->points[i].z, output.points[i].z);
+  }
+
+  // Searches and direct lookups return the same leaves as the original structure
+  vector<Grid::LeafConstPtr> found, found_loaded;
+  vector<float> distances;
+  grid.radiusSearch (PointXYZ (0, 0, 0), 0.075, found, distances);
+  loaded.radiusSearch (PointXYZ (0, 0, 0), 0.075, found_loaded, distances);
+  ASSERT_EQ (found.size (), found_loaded.size ());
+  for (size_t i = 0; i < found.size (); ++i)
+    EXPECT_EQ (found[i]->getMean (), found_loaded[i]->getMean ());
+
+  for (size_t i = 0; i < cloud->points.size (); i += 10)
+  {
+    grid.getAllNeighborsAtPoint (cloud->points[i], found);
+    loaded.getAllNeighborsAtPoint (cloud->points[i], found_loaded);
+    ASSERT_EQ (found.size (), found_loaded.size ());
+    for (size_t j = 0; j < found.size (); ++j)
+    {
+      EXPECT_GE (found[j]->nr_points, grid.getMinPointPerVoxel ());
+      EXPECT_EQ (found[j]->getMean (), found_loaded[j]->getMean ());
+    }
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (VoxelGridCovariancePowerOfTwoGrid, Filters)
+{
+  typedef VoxelGridCovariance<PointXYZ> Grid;
+
+  // A grid of 512 x 4 x 2 unit voxels, so that the voxel indices of neighboring rows and
+  // layers only differ in their high bits. Voxels with x < 100 are filled, plus one at x = 511.
+  const float offsets[6][3] = { {0.2f, 0, 0}, {-0.2f, 0, 0}, {0, 0.15f, 0}, {0, -0.15f, 0}, {0, 0, 0.1f}, {0, 0, -0.1f} };
+  PointCloud<PointXYZ>::Ptr input (new PointCloud<PointXYZ>);
+  std::set<int> occupied;
+  for (int k = 0; k < 2; ++k)
+    for (int j = 0; j < 4; ++j)
+      for (int i = 0; i < 101; ++i)
+      {
+        const int x = i < 100 ? i : 511;
+        occupied.insert (x + 512 * j + 2048 * k);
+        for (int o = 0; o < 6; ++o)
+          input->push_back (PointXYZ (x + 0.5f + offsets[o][0], j + 0.5f + offsets[o][1], k + 0.5f + offsets[o][2]));
+      }
+
+  Grid grid;
+  PointCloud<PointXYZ> output;
+  grid.setLeafSize (1.0f, 1.0f, 1.0f);
+  grid.setInputCloud (input);
+  grid.filter (output, true);
+  ASSERT_EQ (grid.getNrDivisions (), Eigen::Vector3i (512, 4, 2));
+  ASSERT_EQ (grid.getLeaves ().size (), occupied.size ());
+
+  // Every voxel of the grid is found if, and only if, it is occupied
+  for (int k = 0; k < 2; ++k)
+    for (int j = 0; j < 4; ++j)
+      for (int x = 0; x < 512; ++x)
+      {
+        Eigen::Vector3f center (x + 0.5f, j + 0.5f, k + 0.5f);
+        Grid::LeafConstPtr leaf = grid.getLeaf (center);
+        if (occupied.count (x + 512 * j + 2048 * k) == 0)
+        {
+          EXPECT_TRUE (leaf == NULL);
+          continue;
+        }
+        ASSERT_TRUE (leaf != NULL);
+        EXPECT_EQ (leaf->nr_points, 6);
+        EXPECT_NEAR (leaf->getMean ()[0], center[0], 1e-4);
+        EXPECT_NEAR (leaf->getMean ()[1], center[1], 1e-4);
+        EXPECT_NEAR (leaf->getMean ()[2], center[2], 1e-4);
+      }
+
+  // The nearest leaves match a brute force search over the leaf means
+  vector<Grid::LeafConstPtr> found;
+  vector<float> distances;
+  for (int q = 0; q < 50; ++q)
+  {
+    const PointXYZ query (q * 10.37f - 5.0f, q * 0.0931f, q * 0.0417f);
+    ASSERT_EQ (grid.nearestKSearch (query, 1, found, distances), 1);
+
+    float best = std::numeric_limits<float>::max ();
+    for (size_t li = 0; li < grid.getLeaves ().size (); ++li)
+    {
+      const Eigen::Vector3d mean = grid.getLeaves ()[li].getMean ();
+      best = std::min (best, static_cast<float> ((mean - Eigen::Vector3d (query.x, query.y, query.z)).squaredNorm ()));
+    }
+    EXPECT_NEAR (distances[0], best, 1e-3);
+
+    Eigen::Vector3f mean = found[0]->getMean ().cast<float> ();
+    EXPECT_EQ (grid.getLeaf (mean), found[0]);
+  }
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 TEST (ProjectInliers, Filters)
 {
@@ -1548,6 +1802,66 @@ TEST (StatisticalOutlierRemoval, Filters)
   EXPECT_NEAR (output.points[output.points.size () - 1].z, -0.0444, 1e-4);
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (OutlierRemovalParallel, Filters)
+{
+  // A copy of the cloud with invalid points exercises the radius searches
+  PointCloud<PointXYZ>::Ptr cloud_nan (new PointCloud<PointXYZ> (*cloud));
+  for (size_t i = 0; i < cloud_nan->points.size (); i += 10)
+    cloud_nan->points[i].x = std::numeric_limits<float>::quiet_NaN ();
+  cloud_nan->is_dense = false;
+
+  IndicesPtr indices (new vector<int> (indices_.begin (), indices_.begin () + indices_.size () / 2));
+  PointCloud<PointXYZ>::Ptr inputs[] = { cloud, cloud_nan };
+  std::vector<int> output, output_parallel;
+  for (int run = 0; run < 4; ++run)
+  {
+    RadiusOutlierRemoval<PointXYZ> outrem (true), outrem_parallel (true);
+    outrem.setInputCloud (inputs[run % 2]);
+    outrem.setRadiusSearch (0.02);
+    outrem.setMinNeighborsInRadius (14);
+    outrem_parallel.setInputCloud (inputs[run % 2]);
+    outrem_parallel.setRadiusSearch (0.02);
+    outrem_parallel.setMinNeighborsInRadius (14);
+    outrem_parallel.setNumberOfThreads (4);
+    if (run >= 2)
+    {
+      outrem.setIndices (indices);
+      outrem.setNegative (true);
+      outrem_parallel.setIndices (indices);
+      outrem_parallel.setNegative (true);
+    }
+    outrem.filter (output);
+
+    // The voxel grid counts the same neighbors as the searches
+    for (int voxel_counting = 0; voxel_counting < 2; ++voxel_counting)
+    {
+      outrem_parallel.setUseVoxelCounting (voxel_counting == 1);
+      outrem_parallel.filter (output_parallel);
+      EXPECT_EQ (output, output_parallel);
+      EXPECT_EQ (*outrem.getRemovedIndices (), *outrem_parallel.getRemovedIndices ());
+    }
+  }
+
+  StatisticalOutlierRemoval<PointXYZ> sor (true), sor_parallel (true);
+  sor.setInputCloud (cloud_nan);
+  sor.setMeanK (50);
+  sor.setStddevMulThresh (1.0);
+  sor.filter (output);
+  sor_parallel.setInputCloud (cloud_nan);
+  sor_parallel.setMeanK (50);
+  sor_parallel.setStddevMulThresh (1.0);
+  sor_parallel.setNumberOfThreads (4);
+  sor_parallel.filter (output_parallel);
+  EXPECT_EQ (output, output_parallel);
+  EXPECT_EQ (*sor.getRemovedIndices (), *sor_parallel.getRemovedIndices ());
+
+  // Approximate searches may only overestimate the mean distances slightly
+  sor_parallel.setSearchEpsilon (0.5f);
+  sor_parallel.filter (output_parallel);
+  EXPECT_NEAR (double (output.size ()), double (output_parallel.size ()), 0.05 * double (output.size ()));
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////
 TEST (ConditionalRemoval, Filters)
 {
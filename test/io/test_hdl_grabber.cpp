@@ -0,0 +1,288 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2012-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#include <gtest/gtest.h>
+#include <pcl/point_types.h>
+#include <pcl/io/hdl_grabber.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <vector>
+
+typedef pcl::PointCloud<pcl::PointXYZI> CloudT;
+
+/** \brief Gives access to the conversion of single data packets. */
+class TestHDLGrabber : public pcl::HDLGrabber
+{
+  public:
+    typedef pcl::HDLGrabber::HDLDataPacket DataPacket;
+
+    TestHDLGrabber (const std::string& pcapFile = "") : pcl::HDLGrabber ("", pcapFile)
+    {
+    }
+
+    using pcl::HDLGrabber::toPointClouds;
+};
+
+// Helper function for collecting the sweeps
+void
+sweepCallback (std::vector<CloudT::ConstPtr> *sweeps, const CloudT::ConstPtr &sweep)
+{
+  sweeps->push_back (sweep);
+}
+
+// Helper function for collecting the sweeps emitted by the replay thread
+void
+lockedSweepCallback (boost::mutex *mutex, std::vector<CloudT::ConstPtr> *sweeps, const CloudT::ConstPtr &sweep)
+{
+  boost::mutex::scoped_lock lock (*mutex);
+  sweeps->push_back (sweep);
+}
+
+// Synthetic HDL-32 packets, 12 firings each, firing f of the whole sequence at an azimuth of 2.5 * f degrees.
+// All the lasers return at 2 meters, except laser 5 which never returns. The intensity is the firing number in its sweep.
+void
+makePackets (const size_t nr_packets, std::vector<TestHDLGrabber::DataPacket> &packets)
+{
+  const unsigned int firings_per_sweep = 144;
+  packets.resize (nr_packets);
+  for (size_t p = 0; p < nr_packets; ++p)
+  {
+    TestHDLGrabber::DataPacket &packet = packets[p];
+    memset (&packet, 0, sizeof (packet));
+    packet.gpsTimestamp = static_cast<uint32_t> (p);
+    for (unsigned int f = 0; f < 12; ++f)
+    {
+      const unsigned int firing = static_cast<unsigned int> (p * 12 + f) % firings_per_sweep;
+      packet.firingData[f].blockIdentifier = 0xeeff;
+      packet.firingData[f].rotationalPosition = static_cast<uint16_t> (firing * 250);
+      for (unsigned int laser = 0; laser < 32; ++laser)
+      {
+        packet.firingData[f].laserReturns[laser].distance = static_cast<uint16_t> (laser == 5 ? 0 : 1000);
+        packet.firingData[f].laserReturns[laser].intensity = static_cast<uint8_t> (firing);
+      }
+    }
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PCL, HDLGrabberOrganizedSweep)
+{
+  TestHDLGrabber grabber;
+  std::vector<CloudT::ConstPtr> sweeps;
+  boost::function<void (const CloudT::ConstPtr&)> callback = boost::bind (sweepCallback, &sweeps, _1);
+  grabber.registerCallback (callback);
+
+  // 5 degree bins, two firings per bin
+  grabber.setOrganizedOutput (true, 72);
+  EXPECT_TRUE (grabber.getOrganizedOutput ());
+
+  // three sweeps, the last one is not complete
+  std::vector<TestHDLGrabber::DataPacket> packets;
+  makePackets (25, packets);
+  for (size_t p = 0; p < packets.size (); ++p)
+    grabber.toPointClouds (&packets[p]);
+  ASSERT_EQ (2, sweeps.size ());
+
+  // the rows are sorted by elevation from the top, laser 31 (10.67 degrees) to laser 0 (-30.67 degrees)
+  const float elevations[] = { -30.67f, -9.33f, -29.33f, -8.0f, -28.0f, -6.67f, -26.67f, -5.33f, -25.33f, -4.0f, -24.0f,
+                               -2.67f, -22.67f, -1.33f, -21.33f, 0.0f, -20.0f, 1.33f, -18.67f, 2.67f, -17.33f, 4.0f,
+                               -16.0f, 5.33f, -14.67f, 6.67f, -13.33f, 8.0f, -12.0f, 9.33f, -10.67f, 10.67f };
+  std::vector<std::pair<float, int> > rows;
+  for (int laser = 0; laser < 32; ++laser)
+    rows.push_back (std::make_pair (-elevations[laser], laser));
+  std::sort (rows.begin (), rows.end ());
+
+  for (size_t s = 0; s < sweeps.size (); ++s)
+  {
+    const CloudT &sweep = *sweeps[s];
+    EXPECT_EQ (s, sweep.header.seq);
+    ASSERT_EQ (72, sweep.width);
+    ASSERT_EQ (32, sweep.height);
+    EXPECT_FALSE (sweep.is_dense);
+
+    for (unsigned int row = 0; row < sweep.height; ++row)
+    {
+      const int laser = rows[row].second;
+      for (unsigned int column = 0; column < sweep.width; ++column)
+      {
+        const pcl::PointXYZI &point = sweep (column, row);
+        if (laser == 5)
+        {
+          // no return, the cell is left empty
+          EXPECT_TRUE (pcl_isnan (point.x) && pcl_isnan (point.y) && pcl_isnan (point.z));
+          continue;
+        }
+
+        // the second firing of the bin overwrites the first one
+        ASSERT_FALSE (pcl_isnan (point.x));
+        EXPECT_EQ (2 * column + 1, static_cast<unsigned int> (point.intensity));
+
+        const double azimuth = std::atan2 (point.x, point.y) * 180.0 / M_PI;
+        EXPECT_NEAR (2.5 * (2 * column + 1), azimuth < 0.0 ? azimuth + 360.0 : azimuth, 1e-3);
+        EXPECT_NEAR (2.0 * std::sin (elevations[laser] * M_PI / 180.0), point.z, 1e-4);
+      }
+    }
+  }
+
+  // the sweeps held by the callback are not reused by the next ones
+  EXPECT_NE (sweeps[0].get (), sweeps[1].get ());
+  EXPECT_EQ (0, sweeps[0]->header.seq);
+}
+
+enum FrameType
+{
+  FRAME_IPV4, FRAME_VLAN, FRAME_IP_OPTIONS, FRAME_IPV6, FRAME_TCP, FRAME_FRAGMENT
+};
+
+// Appends a PCAP record of an Ethernet frame carrying a data packet from 192.168.1.201:2368
+void
+appendFrame (std::vector<uint8_t> &pcap, const TestHDLGrabber::DataPacket &packet, const FrameType type)
+{
+  std::vector<uint8_t> frame (12, 0xff);
+  if (type == FRAME_VLAN)
+  {
+    const uint8_t tag[] = { 0x81, 0x00, 0x00, 0x07 };
+    frame.insert (frame.end (), tag, tag + 4);
+  }
+  frame.push_back (type == FRAME_IPV6 ? 0x86 : 0x08);
+  frame.push_back (type == FRAME_IPV6 ? 0xdd : 0x00);
+
+  const size_t ip = frame.size ();
+  const size_t ip_header_size = (type == FRAME_IP_OPTIONS) ? 24 : 20;
+  frame.resize (ip + ip_header_size, 0);
+  frame[ip] = static_cast<uint8_t> (0x40 | (ip_header_size / 4));
+  frame[ip + 6] = (type == FRAME_FRAGMENT) ? 0x20 : 0x40;
+  frame[ip + 8] = 64;
+  frame[ip + 9] = (type == FRAME_TCP) ? 6 : 17;
+  const uint8_t source[] = { 192, 168, 1, 201 };
+  std::copy (source, source + 4, frame.begin () + ip + 12);
+
+  const uint8_t udp[] = { 0x09, 0x40, 0x09, 0x40, 0x04, 0xbe, 0x00, 0x00 };
+  frame.insert (frame.end (), udp, udp + 8);
+  const uint8_t *payload = reinterpret_cast<const uint8_t *> (&packet);
+  frame.insert (frame.end (), payload, payload + 1206);
+
+  const uint32_t record[] = { 0, 0, static_cast<uint32_t> (frame.size ()), static_cast<uint32_t> (frame.size ()) };
+  const uint8_t *record_bytes = reinterpret_cast<const uint8_t *> (record);
+  pcap.insert (pcap.end (), record_bytes, record_bytes + sizeof (record));
+  pcap.insert (pcap.end (), frame.begin (), frame.end ());
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PCL, HDLGrabberFastPcapReplay)
+{
+  std::vector<TestHDLGrabber::DataPacket> packets;
+  makePackets (40, packets);
+
+  // the data packets in all the supported framings, interleaved with frames that have to be skipped, which would
+  // start extra sweeps if they were not
+  const uint32_t header[] = { 0xa1b2c3d4, 0x00040002, 0, 0, 65535, 1 };
+  std::vector<uint8_t> pcap (reinterpret_cast<const uint8_t *> (header),
+                             reinterpret_cast<const uint8_t *> (header) + sizeof (header));
+  for (size_t p = 0; p < packets.size (); ++p)
+  {
+    appendFrame (pcap, packets[p], static_cast<FrameType> (p % 3));
+    if (p % 5 == 2)
+      appendFrame (pcap, packets[0], static_cast<FrameType> (FRAME_IPV6 + p % 3));
+  }
+
+  const std::string pcap_file = "test_hdl_grabber.pcap";
+  std::ofstream file (pcap_file.c_str (), std::ios::binary);
+  file.write (reinterpret_cast<const char *> (&pcap[0]), pcap.size ());
+  file.close ();
+
+  // reference sweeps, packet by packet
+  std::vector<CloudT::ConstPtr> expected;
+  {
+    TestHDLGrabber grabber;
+    boost::function<void (const CloudT::ConstPtr&)> callback = boost::bind (sweepCallback, &expected, _1);
+    grabber.registerCallback (callback);
+    for (size_t p = 0; p < packets.size (); ++p)
+      grabber.toPointClouds (&packets[p]);
+  }
+  ASSERT_EQ (3, expected.size ());
+
+  boost::mutex mutex;
+  std::vector<CloudT::ConstPtr> sweeps;
+  {
+    TestHDLGrabber grabber (pcap_file);
+    boost::function<void (const CloudT::ConstPtr&)> callback = boost::bind (lockedSweepCallback, &mutex, &sweeps, _1);
+    grabber.registerCallback (callback);
+    grabber.setFastPcapReplay (true, 2);
+    EXPECT_TRUE (grabber.getFastPcapReplay ());
+    grabber.start ();
+
+    // wait for the expected sweeps, and a bit longer for an unexpected one
+    for (int i = 0; i < 100; ++i)
+    {
+      boost::this_thread::sleep (boost::posix_time::milliseconds (20));
+      boost::mutex::scoped_lock lock (mutex);
+      if (sweeps.size () >= expected.size ())
+        break;
+    }
+    boost::this_thread::sleep (boost::posix_time::milliseconds (100));
+    grabber.stop ();
+  }
+  remove (pcap_file.c_str ());
+
+  ASSERT_EQ (expected.size (), sweeps.size ());
+  for (size_t s = 0; s < sweeps.size (); ++s)
+  {
+    ASSERT_EQ (expected[s]->size (), sweeps[s]->size ());
+    for (size_t i = 0; i < sweeps[s]->size (); ++i)
+    {
+      EXPECT_EQ (expected[s]->points[i].x, sweeps[s]->points[i].x);
+      EXPECT_EQ (expected[s]->points[i].y, sweeps[s]->points[i].y);
+      EXPECT_EQ (expected[s]->points[i].z, sweeps[s]->points[i].z);
+      EXPECT_EQ (expected[s]->points[i].intensity, sweeps[s]->points[i].intensity);
+    }
+  }
+}
+
+/* ---[ */
+int
+main (int argc, char** argv)
+{
+  testing::InitGoogleTest (&argc, argv);
+  return (RUN_ALL_TESTS ());
+}
+/* ]--- */
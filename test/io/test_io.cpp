@@ -722,6 +722,101 @@ TEST (PCL, PCDReaderWriter)
   EXPECT_FLOAT_EQ (cloud.points[nr_p - 1].intensity, last.intensity); // test for fromPCLPointCloud2 ()
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PCL, PCDMappedCloud)
+{
+  PointCloud<PointXYZRGBNormal> cloud;
+  cloud.width  = 64;
+  cloud.height = 48;
+  cloud.points.resize (cloud.width * cloud.height);
+  cloud.sensor_origin_ = Eigen::Vector4f (1.0f, 2.0f, 3.0f, 0.0f);
+  for (size_t i = 0; i < cloud.points.size (); ++i)
+  {
+    cloud.points[i].x = static_cast<float> (i);
+    cloud.points[i].y = static_cast<float> (i) * 0.5f;
+    cloud.points[i].z = -static_cast<float> (i);
+    cloud.points[i].normal_x = 1.0f / static_cast<float> (i + 1);
+    cloud.points[i].rgba = static_cast<uint32_t> (i * 7919);
+  }
+
+  PCDWriter writer;
+  writer.writeBinary ("test_pcl_io_mapped.pcd", cloud);
+
+  PCDMappedCloud mapped;
+  EXPECT_FALSE (mapped.isOpen ());
+  ASSERT_EQ (mapped.open ("test_pcl_io_mapped.pcd"), 0);
+  EXPECT_TRUE (mapped.isOpen ());
+  EXPECT_EQ (mapped.size (), cloud.points.size ());
+  EXPECT_EQ (mapped.getInfo ().width, cloud.width);
+  EXPECT_EQ (mapped.getInfo ().height, cloud.height);
+  EXPECT_TRUE (mapped.getInfo ().data.empty ());
+  EXPECT_EQ (mapped.getOrigin (), cloud.sensor_origin_);
+
+  // Strided field access, straight from the mapping
+  PCDMappedCloud::FieldView<float> x = mapped.getField<float> ("x");
+  PCDMappedCloud::FieldView<float> normal_x = mapped.getField<float> ("normal_x");
+  PCDMappedCloud::FieldView<uint32_t> rgb = mapped.getField<uint32_t> ("rgb");    // stored as U by PCDWriter
+  ASSERT_TRUE (x.isValid ());
+  ASSERT_TRUE (normal_x.isValid ());
+  ASSERT_TRUE (rgb.isValid ());
+  EXPECT_EQ (x.size (), cloud.points.size ());
+  for (size_t i = 0; i < cloud.points.size (); ++i)
+  {
+    EXPECT_EQ (x[i], cloud.points[i].x);
+    EXPECT_EQ (normal_x[i], cloud.points[i].normal_x);
+    EXPECT_EQ (rgb[i], cloud.points[i].rgba);
+  }
+  EXPECT_FALSE (mapped.getField<float> ("intensity").isValid ());
+  EXPECT_FALSE (mapped.getField<double> ("x").isValid ());
+
+  // Conversion to a pcl::PointCloud, both whole and through indices
+  PointCloud<PointXYZ> xyz;
+  ASSERT_EQ (mapped.copyToPointCloud (xyz), 0);
+  EXPECT_EQ (xyz.width, cloud.width);
+  EXPECT_EQ (xyz.height, cloud.height);
+  ASSERT_EQ (xyz.points.size (), cloud.points.size ());
+  for (size_t i = 0; i < cloud.points.size (); ++i)
+  {
+    EXPECT_EQ (xyz.points[i].x, cloud.points[i].x);
+    EXPECT_EQ (xyz.points[i].y, cloud.points[i].y);
+    EXPECT_EQ (xyz.points[i].z, cloud.points[i].z);
+  }
+
+  std::vector<int> indices;
+  for (int i = static_cast<int> (cloud.points.size ()) - 1; i >= 0; i -= 5)
+    indices.push_back (i);
+  PointCloud<PointXYZRGBNormal> subset;
+  ASSERT_EQ (mapped.copyToPointCloud (indices, subset), 0);
+  EXPECT_EQ (subset.width, indices.size ());
+  EXPECT_EQ (subset.height, 1);
+  ASSERT_EQ (subset.points.size (), indices.size ());
+  for (size_t i = 0; i < indices.size (); ++i)
+  {
+    EXPECT_EQ (subset.points[i].z, cloud.points[indices[i]].z);
+    EXPECT_EQ (subset.points[i].normal_x, cloud.points[indices[i]].normal_x);
+    EXPECT_EQ (subset.points[i].rgba, cloud.points[indices[i]].rgba);
+  }
+
+  // Out of range indices are rejected
+  std::vector<int> bad_indices (1, static_cast<int> (cloud.points.size ()));
+  EXPECT_EQ (mapped.copyToPointCloud (bad_indices, subset), -1);
+  bad_indices[0] = -1;
+  EXPECT_EQ (mapped.copyToPointCloud (bad_indices, subset), -1);
+
+  mapped.close ();
+  EXPECT_FALSE (mapped.isOpen ());
+  EXPECT_EQ (mapped.copyToPointCloud (xyz), -1);
+
+  // Only uncompressed binary files can be mapped
+  writer.writeASCII ("test_pcl_io_mapped.pcd", cloud);
+  EXPECT_EQ (mapped.open ("test_pcl_io_mapped.pcd"), -1);
+  writer.writeBinaryCompressed ("test_pcl_io_mapped.pcd", cloud);
+  EXPECT_EQ (mapped.open ("test_pcl_io_mapped.pcd"), -1);
+  EXPECT_FALSE (mapped.isOpen ());
+
+  remove ("test_pcl_io_mapped.pcd");
+}
+
 TEST (PCL, PCDReaderWriterASCIIColorPrecision)
 {
   PointCloud<PointXYZRGB> cloud;
@@ -1127,6 +1222,103 @@ TEST (PCL, LZFInMem)
   }
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PCL, LZFChunked)
+{
+  PointCloud<PointXYZRGBNormal> cloud;
+  cloud.width  = 640;
+  cloud.height = 480;
+  cloud.points.resize (cloud.width * cloud.height);
+  cloud.is_dense = true;
+
+  srand (static_cast<unsigned int> (time (NULL)));
+  for (size_t i = 0; i < cloud.points.size (); ++i)
+  {
+    // Smooth coordinates compress well, random normals do not
+    cloud.points[i].x = static_cast<float> (i % cloud.width) * 0.01f;
+    cloud.points[i].y = static_cast<float> (i / cloud.width) * 0.01f;
+    cloud.points[i].z = 1.0f;
+    cloud.points[i].normal_x = static_cast<float> (rand () / (RAND_MAX + 1.0));
+    cloud.points[i].normal_y = static_cast<float> (rand () / (RAND_MAX + 1.0));
+    cloud.points[i].normal_z = static_cast<float> (rand () / (RAND_MAX + 1.0));
+    cloud.points[i].rgba = static_cast<uint32_t> (rand ()) & 0x00ffffff;    // rgb is a float field, keep it finite
+  }
+
+  pcl::PCLPointCloud2 blob;
+  pcl::toPCLPointCloud2 (cloud, blob);
+
+  // The output must not depend on the number of threads
+  PCDWriter writer;
+  writer.setCompressionChunkSize (10000);
+  std::ostringstream oss_1, oss_4;
+  writer.setNumberOfThreads (1);
+  EXPECT_EQ (writer.writeBinaryCompressed (oss_1, blob), 0);
+  writer.setNumberOfThreads (4);
+  EXPECT_EQ (writer.writeBinaryCompressed (oss_4, blob), 0);
+  std::string pcd_str = oss_1.str ();
+  EXPECT_TRUE (pcd_str == oss_4.str ());
+
+  Eigen::Vector4f origin;
+  Eigen::Quaternionf orientation;
+  int pcd_version = -1;
+  int data_type = -1;
+  unsigned int data_idx = 0;
+  std::istringstream iss (pcd_str, std::ios::binary);
+  PCDReader reader;
+  pcl::PCLPointCloud2 blob2;
+  EXPECT_EQ (reader.readHeader (iss, blob2, origin, orientation, pcd_version, data_type, data_idx), 0);
+  EXPECT_EQ (data_type, 3);
+
+  // Readers of the legacy format fail cleanly
+  const unsigned char *data = reinterpret_cast<const unsigned char *> (pcd_str.data ());
+  pcl::PCLPointCloud2 legacy_blob = blob2;
+  EXPECT_EQ (reader.readBodyBinary (data, legacy_blob, pcd_version, true, data_idx), -1);
+
+  EXPECT_EQ (reader.readBodyBinaryChunked (data, pcd_str.size (), blob2, data_idx), 0);
+  EXPECT_EQ (reader.readBodyBinaryChunked (data, pcd_str.size () - 1, blob2, data_idx), -1);
+  EXPECT_EQ (reader.readBodyBinaryChunked (data, pcd_str.size (), blob2, data_idx), 0);
+  PointCloud<PointXYZRGBNormal> cloud2;
+  pcl::fromPCLPointCloud2 (blob2, cloud2);
+  EXPECT_EQ (cloud2.is_dense, cloud.is_dense);
+  ASSERT_EQ (cloud2.points.size (), cloud.points.size ());
+  for (size_t i = 0; i < cloud2.points.size (); ++i)
+  {
+    EXPECT_EQ (cloud2.points[i].x, cloud.points[i].x);
+    EXPECT_EQ (cloud2.points[i].y, cloud.points[i].y);
+    EXPECT_EQ (cloud2.points[i].z, cloud.points[i].z);
+    EXPECT_EQ (cloud2.points[i].normal_x, cloud.points[i].normal_x);
+    EXPECT_EQ (cloud2.points[i].normal_z, cloud.points[i].normal_z);
+    EXPECT_EQ (cloud2.points[i].rgba, cloud.points[i].rgba);
+  }
+
+  // Templated writer and file based reader
+  writer.setCompressionChunkSize (4096);
+  EXPECT_EQ (writer.writeBinaryCompressed<PointXYZRGBNormal> ("test_pcl_io_chunked.pcd", cloud), 0);
+  PointCloud<PointXYZRGBNormal> cloud3;
+  reader.setNumberOfThreads (2);
+  EXPECT_EQ (reader.read<PointXYZRGBNormal> ("test_pcl_io_chunked.pcd", cloud3), 0);
+  EXPECT_EQ (cloud3.width, cloud.width);
+  EXPECT_EQ (cloud3.height, cloud.height);
+  ASSERT_EQ (cloud3.points.size (), cloud.points.size ());
+  for (size_t i = 0; i < cloud3.points.size (); ++i)
+  {
+    EXPECT_EQ (cloud3.points[i].y, cloud.points[i].y);
+    EXPECT_EQ (cloud3.points[i].normal_y, cloud.points[i].normal_y);
+    EXPECT_EQ (cloud3.points[i].rgba, cloud.points[i].rgba);
+  }
+
+  // The legacy format is still written by default, and read alongside the chunked one
+  writer.setCompressionChunkSize (0);
+  EXPECT_EQ (writer.writeBinaryCompressed<PointXYZRGBNormal> ("test_pcl_io_chunked.pcd", cloud), 0);
+  EXPECT_EQ (reader.readHeader ("test_pcl_io_chunked.pcd", blob2, origin, orientation, pcd_version, data_type, data_idx), 0);
+  EXPECT_EQ (data_type, 2);
+  EXPECT_EQ (reader.read<PointXYZRGBNormal> ("test_pcl_io_chunked.pcd", cloud3), 0);
+  ASSERT_EQ (cloud3.points.size (), cloud.points.size ());
+  EXPECT_EQ (cloud3.points.back ().normal_z, cloud.points.back ().normal_z);
+
+  remove ("test_pcl_io_chunked.pcd");
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 TEST (PCL, Locale)
 {
@@ -39,6 +39,8 @@
 #include <gtest/gtest.h>
 
 #include <vector>
+#include <algorithm>
+#include <limits>
 
 #include <stdio.h>
 
@@ -1517,6 +1519,292 @@ TEST (PCL, Octree_Pointcloud_Neighbours_Within_Radius_Search)
 
 }
 
+TEST (PCL, Octree_Pointcloud_Contiguous_Leaves_Search)
+{
+  PointCloud<PointXYZ>::Ptr cloudIn (new PointCloud<PointXYZ> ());
+  PointCloud<PointXYZ> queries;
+
+  srand (static_cast<unsigned int> (time (NULL)));
+
+  cloudIn->width = 5000;
+  cloudIn->height = 1;
+  cloudIn->points.resize (cloudIn->width * cloudIn->height);
+  for (size_t i = 0; i < cloudIn->points.size (); i++)
+  {
+    cloudIn->points[i] = PointXYZ (static_cast<float> (10.0 * rand () / RAND_MAX),
+                                   static_cast<float> (10.0 * rand () / RAND_MAX),
+                                   static_cast<float> (5.0  * rand () / RAND_MAX));
+  }
+
+  // queries from the cloud, random ones (partly outside of the bounding box) and a non-finite one
+  std::vector<int> query_indices;
+  for (size_t i = 0; i < 500; i++)
+  {
+    if (i % 2)
+      queries.push_back (cloudIn->points[rand () % cloudIn->points.size ()]);
+    else
+      queries.push_back (PointXYZ (static_cast<float> (12.0 * rand () / RAND_MAX - 1.0),
+                                   static_cast<float> (12.0 * rand () / RAND_MAX - 1.0),
+                                   static_cast<float> (7.0  * rand () / RAND_MAX - 1.0)));
+    query_indices.push_back (static_cast<int> (queries.size ()) - 1);
+  }
+  queries.push_back (PointXYZ (std::numeric_limits<float>::quiet_NaN (), 0.0f, 0.0f));
+  query_indices.push_back (static_cast<int> (queries.size ()) - 1);
+  std::reverse (query_indices.begin (), query_indices.end ());
+
+  OctreePointCloudSearch<PointXYZ> octree (0.25);
+  octree.setInputCloud (cloudIn);
+  octree.addPointsFromInputCloud ();
+
+  const double radius = 0.6;
+  const int K = 12;
+
+  // reference results, one query at a time through the octree nodes
+  std::vector<std::vector<int> > radius_indices (queries.size ()), radius_limited_indices (queries.size ());
+  std::vector<std::vector<float> > radius_sqr_distances (queries.size ()), radius_limited_sqr_distances (queries.size ());
+  std::vector<std::vector<int> > knn_indices (queries.size ());
+  std::vector<std::vector<float> > knn_sqr_distances (queries.size ());
+  for (size_t i = 0; i < queries.size () - 1; i++)
+  {
+    octree.radiusSearch (queries[i], radius, radius_indices[i], radius_sqr_distances[i]);
+    octree.radiusSearch (queries[i], radius, radius_limited_indices[i], radius_limited_sqr_distances[i], 5);
+    octree.nearestKSearch (queries[i], K, knn_indices[i], knn_sqr_distances[i]);
+    ASSERT_EQ (K, static_cast<int> (knn_indices[i].size ()));
+  }
+
+  octree.buildContiguousLeaves ();
+  ASSERT_TRUE (octree.hasContiguousLeaves ());
+
+  // single queries on contiguous leaves visit the points in the same order
+  std::vector<int> k_indices;
+  std::vector<float> k_sqr_distances;
+  for (size_t i = 0; i < queries.size () - 1; i++)
+  {
+    octree.radiusSearch (queries[i], radius, k_indices, k_sqr_distances);
+    ASSERT_EQ (radius_indices[i], k_indices);
+    for (size_t j = 0; j < k_indices.size (); j++)
+      EXPECT_NEAR (radius_sqr_distances[i][j], k_sqr_distances[j], 1e-5);
+
+    octree.radiusSearch (queries[i], radius, k_indices, k_sqr_distances, 5);
+    ASSERT_EQ (radius_limited_indices[i], k_indices);
+
+    octree.nearestKSearch (queries[i], K, k_indices, k_sqr_distances);
+    ASSERT_EQ (knn_indices[i], k_indices);
+    for (size_t j = 0; j < k_indices.size (); j++)
+      EXPECT_NEAR (knn_sqr_distances[i][j], k_sqr_distances[j], 1e-5);
+  }
+
+  // batch queries, with and without contiguous leaves, match the single ones
+  for (int contiguous = 1; contiguous >= 0; contiguous--)
+  {
+    if (!contiguous)
+      octree.clearContiguousLeaves ();
+    ASSERT_EQ (contiguous != 0, octree.hasContiguousLeaves ());
+
+    for (unsigned int threads = 1; threads <= 4; threads += 3)
+    {
+      octree.setNumberOfThreads (threads);
+      std::vector<size_t> offsets;
+
+      octree.radiusSearch (queries, query_indices, radius, offsets, k_indices, k_sqr_distances);
+      ASSERT_EQ (query_indices.size () + 1, offsets.size ());
+      for (size_t q = 0; q < query_indices.size (); q++)
+      {
+        const std::vector<int> &expected = radius_indices[query_indices[q]];
+        ASSERT_EQ (expected.size (), offsets[q + 1] - offsets[q]);
+        EXPECT_TRUE (std::equal (expected.begin (), expected.end (), k_indices.begin () + offsets[q]));
+      }
+
+      octree.radiusSearch (queries, query_indices, radius, offsets, k_indices, k_sqr_distances, 5);
+      for (size_t q = 0; q < query_indices.size (); q++)
+      {
+        const std::vector<int> &expected = radius_limited_indices[query_indices[q]];
+        ASSERT_EQ (expected.size (), offsets[q + 1] - offsets[q]);
+        EXPECT_TRUE (std::equal (expected.begin (), expected.end (), k_indices.begin () + offsets[q]));
+      }
+
+      octree.nearestKSearch (queries, query_indices, K, offsets, k_indices, k_sqr_distances);
+      ASSERT_EQ (query_indices.size () + 1, offsets.size ());
+      for (size_t q = 0; q < query_indices.size (); q++)
+      {
+        const std::vector<int> &expected = knn_indices[query_indices[q]];
+        ASSERT_EQ (expected.size (), offsets[q + 1] - offsets[q]);
+        EXPECT_TRUE (std::equal (expected.begin (), expected.end (), k_indices.begin () + offsets[q]));
+        for (size_t j = 0; j < expected.size (); j++)
+          EXPECT_NEAR (knn_sqr_distances[query_indices[q]][j], k_sqr_distances[offsets[q] + j], 1e-5);
+      }
+    }
+  }
+
+  // adding points drops the contiguous leaves
+  octree.buildContiguousLeaves ();
+  octree.addPointToCloud (PointXYZ (1.0f, 1.0f, 1.0f), cloudIn);
+  EXPECT_FALSE (octree.hasContiguousLeaves ());
+
+  // deleting voxels drops them, and the deleted points are not found any more
+  octree.buildContiguousLeaves ();
+  octree.deleteVoxelAtPoint (PointXYZ (1.0f, 1.0f, 1.0f));
+  EXPECT_FALSE (octree.hasContiguousLeaves ());
+  octree.buildContiguousLeaves ();
+  octree.radiusSearch (PointXYZ (1.0f, 1.0f, 1.0f), 0.01, k_indices, k_sqr_distances);
+  EXPECT_TRUE (k_indices.empty ());
+
+  // so does deleting the tree, also through the base class
+  OctreePointCloud<PointXYZ>& octree_base = octree;
+  octree_base.deleteTree ();
+  EXPECT_FALSE (octree.hasContiguousLeaves ());
+}
+
+template<typename OctreeT> void
+compareOctreeLeaves (OctreeT& octree_a, OctreeT& octree_b)
+{
+  ASSERT_EQ (octree_a.getTreeDepth (), octree_b.getTreeDepth ());
+  ASSERT_EQ (octree_a.getLeafCount (), octree_b.getLeafCount ());
+  ASSERT_EQ (octree_a.getBranchCount (), octree_b.getBranchCount ());
+
+  double min_a[3], max_a[3], min_b[3], max_b[3];
+  octree_a.getBoundingBox (min_a[0], min_a[1], min_a[2], max_a[0], max_a[1], max_a[2]);
+  octree_b.getBoundingBox (min_b[0], min_b[1], min_b[2], max_b[0], max_b[1], max_b[2]);
+  for (int i = 0; i < 3; ++i)
+  {
+    ASSERT_EQ (min_a[i], min_b[i]);
+    ASSERT_EQ (max_a[i], max_b[i]);
+  }
+
+  // the leaf count bounds the loop, since the end iterator of double buffered octrees does not compare equal
+  typename OctreeT::LeafNodeIterator it_a = octree_a.leaf_begin ();
+  typename OctreeT::LeafNodeIterator it_b = octree_b.leaf_begin ();
+  for (size_t leaf = 0; leaf < octree_a.getLeafCount (); ++leaf, ++it_a, ++it_b)
+  {
+    ASSERT_EQ (it_a.getCurrentOctreeKey (), it_b.getCurrentOctreeKey ());
+    ASSERT_EQ (it_a.getCurrentOctreeDepth (), it_b.getCurrentOctreeDepth ());
+
+    std::vector<int> indices_a, indices_b;
+    it_a.getLeafContainer ().getPointIndices (indices_a);
+    it_b.getLeafContainer ().getPointIndices (indices_b);
+    ASSERT_EQ (indices_a, indices_b);
+  }
+}
+
+TEST (PCL, Octree_Pointcloud_Bulk_Insertion)
+{
+  PointCloud<PointXYZ>::Ptr cloudIn (new PointCloud<PointXYZ> ());
+
+  srand (static_cast<unsigned int> (time (NULL)));
+
+  // start in the middle so that the bounding box grows towards both ends of every axis, and repeat points so
+  // that leaves hold several of them
+  cloudIn->push_back (PointXYZ (0.0f, 0.0f, 0.0f));
+  for (size_t i = 0; i < 20000; i++)
+  {
+    const float scale = static_cast<float> (1 + i / 1000);
+    cloudIn->push_back (PointXYZ (static_cast<float> (scale * (2.0 * rand () / RAND_MAX - 1.0)),
+                                  static_cast<float> (scale * (2.0 * rand () / RAND_MAX - 1.0)),
+                                  static_cast<float> (scale * (2.0 * rand () / RAND_MAX - 1.0))));
+    if (i % 7 == 0)
+      cloudIn->push_back (cloudIn->points[rand () % cloudIn->points.size ()]);
+    if (i % 997 == 0)
+      cloudIn->push_back (PointXYZ (std::numeric_limits<float>::quiet_NaN (), 0.0f, 0.0f));
+  }
+
+  IndicesPtr indices (new std::vector<int> ());
+  for (int i = static_cast<int> (cloudIn->points.size ()) - 1; i >= 0; i -= 3)
+    indices->push_back (i);
+
+  const double resolutions[] = {0.01, 0.1, 0.7, 5e-6};
+  for (size_t r = 0; r < sizeof (resolutions) / sizeof (resolutions[0]); ++r)
+  {
+    // point indices, with and without an indices subset
+    {
+      OctreePointCloudPointVector<PointXYZ> sequential (resolutions[r]);
+      sequential.setInputCloud (cloudIn);
+      sequential.addPointsFromInputCloud ();
+
+      OctreePointCloudPointVector<PointXYZ> bulk (resolutions[r]);
+      bulk.setNumberOfThreads (4);
+      bulk.setInputCloud (cloudIn);
+      bulk.addPointsFromInputCloud ();
+
+      compareOctreeLeaves (sequential, bulk);
+
+      sequential.deleteTree ();
+      sequential.setInputCloud (cloudIn, indices);
+      sequential.addPointsFromInputCloud ();
+
+      bulk.deleteTree ();
+      bulk.setInputCloud (cloudIn, indices);
+      bulk.addPointsFromInputCloud ();
+
+      compareOctreeLeaves (sequential, bulk);
+    }
+
+    // single point index per leaf, within a predefined bounding box that is too small
+    {
+      OctreePointCloudSinglePoint<PointXYZ> sequential (resolutions[r]);
+      sequential.defineBoundingBox (-0.5, -0.5, -0.5, 0.5, 0.5, 0.5);
+      sequential.setInputCloud (cloudIn);
+      sequential.addPointsFromInputCloud ();
+
+      OctreePointCloudSinglePoint<PointXYZ> bulk (resolutions[r]);
+      bulk.setNumberOfThreads (4);
+      bulk.defineBoundingBox (-0.5, -0.5, -0.5, 0.5, 0.5, 0.5);
+      bulk.setInputCloud (cloudIn);
+      bulk.addPointsFromInputCloud ();
+
+      compareOctreeLeaves (sequential, bulk);
+    }
+  }
+
+  // voxel centroids are accumulated in the same order
+  OctreePointCloudVoxelCentroid<PointXYZ> centroid_sequential (0.1);
+  centroid_sequential.setInputCloud (cloudIn);
+  centroid_sequential.addPointsFromInputCloud ();
+
+  OctreePointCloudVoxelCentroid<PointXYZ> centroid_bulk (0.1);
+  centroid_bulk.setNumberOfThreads (4);
+  centroid_bulk.setInputCloud (cloudIn);
+  centroid_bulk.addPointsFromInputCloud ();
+
+  std::vector<PointXYZ, Eigen::aligned_allocator<PointXYZ> > centroids_sequential, centroids_bulk;
+  ASSERT_EQ (centroid_sequential.getVoxelCentroids (centroids_sequential),
+             centroid_bulk.getVoxelCentroids (centroids_bulk));
+  for (size_t i = 0; i < centroids_sequential.size (); ++i)
+  {
+    ASSERT_EQ (centroids_sequential[i].x, centroids_bulk[i].x);
+    ASSERT_EQ (centroids_sequential[i].y, centroids_bulk[i].y);
+    ASSERT_EQ (centroids_sequential[i].z, centroids_bulk[i].z);
+  }
+
+  // double buffered octree, the second frame reuses the nodes of the first one
+  PointCloud<PointXYZ>::Ptr cloudMoved (new PointCloud<PointXYZ> (*cloudIn));
+  for (size_t i = 0; i < cloudMoved->points.size (); i += 2)
+    cloudMoved->points[i].x += 0.35f;
+
+  OctreePointCloudChangeDetector<PointXYZ> detector_sequential (0.05);
+  OctreePointCloudChangeDetector<PointXYZ> detector_bulk (0.05);
+  detector_bulk.setNumberOfThreads (4);
+
+  detector_sequential.setInputCloud (cloudIn);
+  detector_sequential.addPointsFromInputCloud ();
+  detector_sequential.switchBuffers ();
+  detector_sequential.setInputCloud (cloudMoved);
+  detector_sequential.addPointsFromInputCloud ();
+
+  detector_bulk.setInputCloud (cloudIn);
+  detector_bulk.addPointsFromInputCloud ();
+  detector_bulk.switchBuffers ();
+  detector_bulk.setInputCloud (cloudMoved);
+  detector_bulk.addPointsFromInputCloud ();
+
+  compareOctreeLeaves (detector_sequential, detector_bulk);
+
+  std::vector<int> new_sequential, new_bulk;
+  detector_sequential.getPointIndicesFromNewVoxels (new_sequential);
+  detector_bulk.getPointIndicesFromNewVoxels (new_bulk);
+  ASSERT_GT (new_sequential.size (), 0u);
+  ASSERT_EQ (new_sequential, new_bulk);
+}
+
 TEST (PCL, Octree_Pointcloud_Ray_Traversal)
 {
   const unsigned int test_runs = 100;
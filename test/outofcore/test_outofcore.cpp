@@ -949,6 +949,88 @@ TEST_F (OutofcoreTest, PointCloud2_Query)
   cleanUpFilesystem ();
 }
 
+//test that the queries return the same points through the node cache, and that the cache follows the writes
+TEST_F (OutofcoreTest, NodeCache)
+{
+  cleanUpFilesystem ();
+
+  const Eigen::Vector3d min (-100.1, -100.1, -100.1);
+  const Eigen::Vector3d max (100.1, 100.1, 100.1);
+
+  const boost::uint64_t depth = 2;
+
+  pcl::PointCloud<PointT>::Ptr test_cloud (new pcl::PointCloud<PointT> ());
+  for (size_t i=0; i < numPts; i++)
+    test_cloud->points.push_back (PointT (static_cast<float> (i % 50) - 50,
+                                          static_cast<float> (i % 40) - 40,
+                                          static_cast<float> (i % 30) - 30));
+  test_cloud->width = static_cast<uint32_t> (test_cloud->points.size ());
+  test_cloud->height = 1;
+
+  pcl::PCLPointCloud2::Ptr dst_blob (new pcl::PCLPointCloud2 ());
+  pcl::toPCLPointCloud2 (*test_cloud, *dst_blob);
+
+  octree_disk octreeA (depth, min, max, filename_otreeA, "ECEF");
+  ASSERT_EQ (test_cloud->points.size (), octreeA.addPointCloud (dst_blob, false));
+
+  OutofcoreNodeCache &cache = OutofcoreNodeCache::getInstance ();
+  ASSERT_EQ (0, cache.getCapacity ());
+
+  pcl::PCLPointCloud2::Ptr reference (new pcl::PCLPointCloud2 ());
+  octreeA.queryBBIncludes (min, max, depth, reference);
+  EXPECT_EQ (test_cloud->points.size (), reference->width * reference->height);
+  EXPECT_EQ (0, cache.getSize ());
+
+  cache.setCapacity (size_t (64) << 20);
+
+  //the first query fills the cache, the second one is served by it
+  for (int i = 0; i < 2; ++i)
+  {
+    pcl::PCLPointCloud2::Ptr result (new pcl::PCLPointCloud2 ());
+    octreeA.queryBBIncludes (min, max, depth, result);
+    cache.waitForPrefetches ();
+    EXPECT_EQ (reference->width * reference->height, result->width * result->height);
+    EXPECT_TRUE (reference->data == result->data);
+    EXPECT_GT (cache.getSize (), 0);
+  }
+
+  //the nodes written by an insertion are read again
+  ASSERT_EQ (test_cloud->points.size (), octreeA.addPointCloud (dst_blob, false));
+  pcl::PCLPointCloud2::Ptr result (new pcl::PCLPointCloud2 ());
+  octreeA.queryBBIncludes (min, max, depth, result);
+  EXPECT_EQ (2 * test_cloud->points.size (), result->width * result->height);
+
+  //prefetching, and files which do not fit
+  const std::string pcd_file = (filename_otreeB.parent_path () / "prefetch_test.pcd").string ();
+  boost::filesystem::create_directories (filename_otreeB.parent_path ());
+  ASSERT_EQ (0, pcl::io::savePCDFileBinaryCompressed (pcd_file, *test_cloud));
+
+  cache.clear ();
+  EXPECT_EQ (0, cache.getSize ());
+  cache.prefetch (pcd_file);
+  cache.waitForPrefetches ();
+  EXPECT_TRUE (cache.contains (pcd_file));
+  pcl::PCLPointCloud2::ConstPtr loaded = cache.load (pcd_file);
+  ASSERT_TRUE (loaded);
+  EXPECT_EQ (test_cloud->points.size (), loaded->width * loaded->height);
+
+  cache.invalidate (pcd_file);
+  EXPECT_FALSE (cache.contains (pcd_file));
+
+  cache.setCapacity (loaded->data.size () / 2);
+  loaded = cache.load (pcd_file);
+  ASSERT_TRUE (loaded);
+  EXPECT_EQ (test_cloud->points.size (), loaded->width * loaded->height);
+  EXPECT_FALSE (cache.contains (pcd_file));
+
+  EXPECT_FALSE (cache.load (pcd_file + ".missing"));
+
+  cache.setCapacity (0);
+  EXPECT_EQ (0, cache.getSize ());
+
+  cleanUpFilesystem ();
+}
+
 /* [--- */
 int
 main (int argc, char** argv)
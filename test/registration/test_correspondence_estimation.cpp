@@ -119,6 +119,49 @@ TEST (CorrespondenceEstimation, CorrespondenceEstimationSetSearchMethod)
   
 }
 
+//////////////////////////////////////////////////////////////////////////////////////
+TEST (CorrespondenceEstimation, CorrespondenceEstimationNumberOfThreads)
+{
+  pcl::PointCloud<pcl::PointXYZ>::Ptr cloud1 (new pcl::PointCloud<pcl::PointXYZ> ());
+  pcl::PointCloud<pcl::PointXYZ>::Ptr cloud2 (new pcl::PointCloud<pcl::PointXYZ> ());
+  srand (0);
+  for (size_t i = 0; i < 2000; i++)
+  {
+    cloud1->points.push_back (pcl::PointXYZ (float (rand ()) / float (RAND_MAX), float (rand ()) / float (RAND_MAX), float (rand ()) / float (RAND_MAX)));
+    cloud2->points.push_back (pcl::PointXYZ (float (rand ()) / float (RAND_MAX), float (rand ()) / float (RAND_MAX), float (rand ()) / float (RAND_MAX)));
+  }
+
+  pcl::registration::CorrespondenceEstimation<pcl::PointXYZ, pcl::PointXYZ> ce;
+  ce.setInputSource (cloud1);
+  ce.setInputTarget (cloud2);
+
+  pcl::Correspondences corr_serial, corr_serial_reciprocal;
+  ce.setNumberOfThreads (1);
+  ce.determineCorrespondences (corr_serial, 0.02);
+  ce.determineReciprocalCorrespondences (corr_serial_reciprocal, 0.02);
+
+  pcl::Correspondences corr_parallel, corr_parallel_reciprocal;
+  ce.setNumberOfThreads (4);
+  ce.determineCorrespondences (corr_parallel, 0.02);
+  ce.determineReciprocalCorrespondences (corr_parallel_reciprocal, 0.02);
+
+  // The output must not depend on the number of threads, including its order
+  ASSERT_EQ (corr_serial.size (), corr_parallel.size ());
+  EXPECT_GT (corr_serial.size (), corr_serial_reciprocal.size ());
+  for (size_t i = 0; i < corr_serial.size (); i++)
+  {
+    EXPECT_EQ (corr_serial[i].index_query, corr_parallel[i].index_query);
+    EXPECT_EQ (corr_serial[i].index_match, corr_parallel[i].index_match);
+    EXPECT_EQ (corr_serial[i].distance, corr_parallel[i].distance);
+  }
+  ASSERT_EQ (corr_serial_reciprocal.size (), corr_parallel_reciprocal.size ());
+  for (size_t i = 0; i < corr_serial_reciprocal.size (); i++)
+  {
+    EXPECT_EQ (corr_serial_reciprocal[i].index_query, corr_parallel_reciprocal[i].index_query);
+    EXPECT_EQ (corr_serial_reciprocal[i].index_match, corr_parallel_reciprocal[i].index_match);
+  }
+}
+
 /* ---[ */
 int
   main (int argc, char** argv)
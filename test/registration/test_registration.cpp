@@ -194,6 +194,27 @@ TEST (PCL, IterativeClosestPoint)
 //  EXPECT_EQ (transformation (3, 3), 1);
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PCL, IterativeClosestPointNumberOfThreads)
+{
+  IterativeClosestPoint<PointXYZ, PointXYZ> reg;
+  reg.setInputSource (cloud_source.makeShared ());
+  reg.setInputTarget (cloud_target.makeShared ());
+  reg.setMaximumIterations (5);
+  reg.setMaxCorrespondenceDistance (0.05);
+
+  // The setting of a custom estimator is kept as long as ICP's is not set
+  registration::CorrespondenceEstimation<PointXYZ, PointXYZ>::Ptr ce (new registration::CorrespondenceEstimation<PointXYZ, PointXYZ>);
+  ce->setNumberOfThreads (4);
+  reg.setCorrespondenceEstimation (ce);
+  reg.align (cloud_reg);
+  EXPECT_EQ (4, ce->getNumberOfThreads ());
+
+  reg.setNumberOfThreads (2);
+  reg.align (cloud_reg);
+  EXPECT_EQ (2, ce->getNumberOfThreads ());
+}
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////////
 void
 sampleRandomTransform (Eigen::Affine3f &trans, float max_angle, float max_trans)
@@ -536,6 +557,76 @@ TEST (PCL, GeneralizedIterativeClosestPoint)
   EXPECT_LT (reg.getFitnessScore (), 0.0001);
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PCL, GeneralizedIterativeClosestPointCovariances)
+{
+  typedef PointXYZ PointT;
+  typedef GeneralizedIterativeClosestPoint<PointT, PointT>::MatricesVectorPtr MatricesVectorPtr;
+  PointCloud<PointT>::Ptr src (new PointCloud<PointT>);
+  copyPointCloud (cloud_source, *src);
+  PointCloud<PointT>::Ptr tgt (new PointCloud<PointT>);
+  copyPointCloud (cloud_target, *tgt);
+  PointCloud<PointT> output;
+
+  // Reference, single threaded with the Jacobi SVD
+  GeneralizedIterativeClosestPoint<PointT, PointT> reg;
+  reg.setInputSource (src);
+  reg.setInputTarget (tgt);
+  reg.setMaximumIterations (50);
+  reg.setTransformationEpsilon (1e-8);
+  reg.align (output);
+  MatricesVectorPtr target_covariances = reg.getTargetCovariances ();
+  ASSERT_TRUE (target_covariances);
+  ASSERT_EQ (target_covariances->size (), tgt->size ());
+  ASSERT_TRUE (reg.getSourceCovariances ());
+  ASSERT_EQ (reg.getSourceCovariances ()->size (), src->size ());
+  const Eigen::Matrix4f reference = reg.getFinalTransformation ();
+
+  // The number of threads does not change the covariances, the closed form solver only slightly
+  for (int closed_form = 0; closed_form < 2; ++closed_form)
+  {
+    GeneralizedIterativeClosestPoint<PointT, PointT> reg_mt;
+    reg_mt.setNumberOfThreads (4);
+    reg_mt.setUseClosedFormEigenSolver (closed_form != 0);
+    EXPECT_EQ (reg_mt.getUseClosedFormEigenSolver (), closed_form != 0);
+    reg_mt.setInputSource (src);
+    reg_mt.setInputTarget (tgt);
+    reg_mt.setMaximumIterations (50);
+    reg_mt.setTransformationEpsilon (1e-8);
+    reg_mt.align (output);
+    EXPECT_LT (reg_mt.getFitnessScore (), 0.0001);
+
+    MatricesVectorPtr covariances = reg_mt.getTargetCovariances ();
+    ASSERT_EQ (covariances->size (), target_covariances->size ());
+    if (closed_form)
+    {
+      EXPECT_TRUE (reg_mt.getFinalTransformation ().isApprox (reference, 1e-3f));
+      continue;
+    }
+    for (size_t i = 0; i < covariances->size (); ++i)
+      EXPECT_TRUE ((*covariances)[i].isApprox ((*target_covariances)[i], 1e-12));
+    EXPECT_TRUE (reg_mt.getFinalTransformation ().isApprox (reference, 1e-5f));
+  }
+
+  // Reuse the target covariances for another scan against the same target
+  GeneralizedIterativeClosestPoint<PointT, PointT> reg_reuse;
+  reg_reuse.setInputSource (src);
+  reg_reuse.setInputTarget (tgt);
+  reg_reuse.setTargetCovariances (target_covariances);
+  reg_reuse.setMaximumIterations (50);
+  reg_reuse.setTransformationEpsilon (1e-8);
+  reg_reuse.align (output);
+  EXPECT_EQ (reg_reuse.getTargetCovariances (), target_covariances);
+  EXPECT_TRUE (reg_reuse.getFinalTransformation ().isApprox (reference, 1e-5f));
+
+  // Covariances which do not match the target are recomputed
+  MatricesVectorPtr wrong_covariances (new GeneralizedIterativeClosestPoint<PointT, PointT>::MatricesVector (3));
+  reg_reuse.setTargetCovariances (wrong_covariances);
+  reg_reuse.align (output);
+  ASSERT_TRUE (reg_reuse.getTargetCovariances ());
+  EXPECT_EQ (reg_reuse.getTargetCovariances ()->size (), tgt->size ());
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 TEST (PCL, GeneralizedIterativeClosestPoint6D)
 {
@@ -637,6 +728,69 @@ TEST (PCL, NormalDistributionsTransform)
   }
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PCL, NormalDistributionsTransformNeighborSearch)
+{
+  typedef PointNormal PointT;
+  PointCloud<PointT>::Ptr src (new PointCloud<PointT>);
+  copyPointCloud (cloud_source, *src);
+  PointCloud<PointT>::Ptr tgt (new PointCloud<PointT>);
+  copyPointCloud (cloud_target, *tgt);
+  PointCloud<PointT> output;
+
+  NormalDistributionsTransform<PointT, PointT> reg;
+  EXPECT_EQ (reg.getNeighborSearchMethod (), (NormalDistributionsTransform<PointT, PointT>::KDTREE));
+  reg.setStepSize (0.05);
+  reg.setResolution (0.025f);
+  reg.setInputSource (src);
+  reg.setInputTarget (tgt);
+  reg.setMaximumIterations (50);
+  reg.setTransformationEpsilon (1e-8);
+
+  // The result must not depend on the number of threads
+  reg.setNumberOfThreads (1);
+  reg.align (output);
+  const Eigen::Matrix4f single_threaded = reg.getFinalTransformation ();
+  reg.setNumberOfThreads (4);
+  reg.align (output);
+  EXPECT_EQ (int (output.points.size ()), int (cloud_source.points.size ()));
+  EXPECT_LT (reg.getFitnessScore (), 0.001);
+  for (int i = 0; i < 4; ++i)
+    for (int j = 0; j < 4; ++j)
+      EXPECT_EQ (single_threaded (i, j), reg.getFinalTransformation () (i, j));
+
+  // Direct voxel lookups instead of the radius search
+  const NormalDistributionsTransform<PointT, PointT>::NeighborSearchMethod methods[] =
+    { NormalDistributionsTransform<PointT, PointT>::DIRECT26,
+      NormalDistributionsTransform<PointT, PointT>::DIRECT7,
+      NormalDistributionsTransform<PointT, PointT>::DIRECT1 };
+  for (int m = 0; m < 3; ++m)
+  {
+    reg.setNeighborSearchMethod (methods[m]);
+    EXPECT_EQ (reg.getNeighborSearchMethod (), methods[m]);
+    reg.setNumberOfThreads (0);
+    reg.align (output);
+    EXPECT_EQ (int (output.points.size ()), int (cloud_source.points.size ()));
+    EXPECT_LT (reg.getFitnessScore (), 0.001);
+  }
+
+  // A saved target voxel structure gives the same result as the one built from the target cloud
+  const std::string file_name = "test_ndt_target_cells.bin";
+  ASSERT_TRUE (reg.saveTargetCells (file_name));
+  NormalDistributionsTransform<PointT, PointT> reg_loaded;
+  ASSERT_TRUE (reg_loaded.loadTargetCells (file_name));
+  remove (file_name.c_str ());
+  EXPECT_EQ (reg_loaded.getResolution (), reg.getResolution ());
+  reg_loaded.setStepSize (0.05);
+  reg_loaded.setInputSource (src);
+  reg_loaded.setMaximumIterations (50);
+  reg_loaded.setTransformationEpsilon (1e-8);
+  reg_loaded.setNeighborSearchMethod (NormalDistributionsTransform<PointT, PointT>::DIRECT1);
+  PointCloud<PointT> output_loaded;
+  reg_loaded.align (output_loaded);
+  EXPECT_EQ (reg_loaded.getFinalTransformation (), reg.getFinalTransformation ());
+}
+
 
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 TEST (PCL, SampleConsensusInitialAlignment)
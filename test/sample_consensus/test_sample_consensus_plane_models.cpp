@@ -223,6 +223,90 @@ TEST (SampleConsensusModelPlane, RMSAC)
   verifyPlaneSac (model, sac, 600, 1.0f, 1.0f, 0.01f);
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template <typename SacType>
+void verifyPlaneSacParallel (unsigned int inlier_number = 2000,
+                             float tol = 1e-1f,
+                             float refined_tol = 1e-1f,
+                             float proj_tol = 1e-3f)
+{
+  SampleConsensusModelPlanePtr model (new SampleConsensusModelPlane<PointXYZ> (cloud_));
+  SacType sac (model, 0.03);
+  sac.setNumberOfThreads (4);
+  ASSERT_EQ (4, sac.getNumberOfThreads ());
+  verifyPlaneSac (model, sac, inlier_number, tol, refined_tol, proj_tol);
+
+  // Runs with the same seed and number of threads must give the same result
+  SampleConsensusModelPlanePtr model2 (new SampleConsensusModelPlane<PointXYZ> (cloud_));
+  SacType sac2 (model2, 0.03);
+  sac2.setNumberOfThreads (4);
+  ASSERT_TRUE (sac2.computeModel ());
+
+  std::vector<int> sample, sample2;
+  sac.getModel (sample);
+  sac2.getModel (sample2);
+  EXPECT_EQ (sample, sample2);
+
+  std::vector<int> inliers, inliers2;
+  sac.getInliers (inliers);
+  sac2.getInliers (inliers2);
+  EXPECT_EQ (inliers, inliers2);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (SampleConsensusModelPlane, Parallel)
+{
+  verifyPlaneSacParallel<RandomSampleConsensus<PointXYZ> > ();
+  verifyPlaneSacParallel<LeastMedianSquares<PointXYZ> > ();
+  verifyPlaneSacParallel<MEstimatorSampleConsensus<PointXYZ> > ();
+  verifyPlaneSacParallel<RandomizedRandomSampleConsensus<PointXYZ> > (600, 1.0f, 1.0f, 0.01f);
+  verifyPlaneSacParallel<MaximumLikelihoodSampleConsensus<PointXYZ> > (1000, 0.3f, 0.2f, 0.01f);
+  verifyPlaneSacParallel<RandomizedMEstimatorSampleConsensus<PointXYZ> > (600, 1.0f, 1.0f, 0.01f);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (SampleConsensusModelPlane, DistanceKernels)
+{
+  SampleConsensusModelPlanePtr model (new SampleConsensusModelPlane<PointXYZ> (cloud_));
+  // Every other point, in reverse order, to exercise the gathers through the indices
+  std::vector<int> indices;
+  for (int i = static_cast<int> (cloud_->points.size ()) - 1; i >= 0; i -= 2)
+    indices.push_back (i);
+  model->setIndices (indices);
+
+  Eigen::VectorXf coeff (4);
+  coeff << 0.1f, 0.2f, 0.97f, -0.3f;
+
+  // The vectorized kernels must agree with the scalar fallback
+  const pcl::detail::SacKernelInstructionSet isa = pcl::detail::getSacKernelInstructionSet ();
+  std::vector<double> distances;
+  std::vector<int> inliers;
+  model->getDistancesToModel (coeff, distances);
+  model->selectWithinDistance (coeff, 0.05, inliers);
+  int nr_inliers = model->countWithinDistance (coeff, 0.05);
+
+  pcl::detail::setSacKernelInstructionSet (pcl::detail::SAC_KERNEL_SCALAR);
+  EXPECT_EQ (pcl::detail::SAC_KERNEL_SCALAR, pcl::detail::getSacKernelInstructionSet ());
+  std::vector<double> scalar_distances;
+  std::vector<int> scalar_inliers;
+  model->getDistancesToModel (coeff, scalar_distances);
+  model->selectWithinDistance (coeff, 0.05, scalar_inliers);
+  int scalar_nr_inliers = model->countWithinDistance (coeff, 0.05);
+  pcl::detail::setSacKernelInstructionSet (isa);
+
+  ASSERT_EQ (indices.size (), distances.size ());
+  ASSERT_EQ (indices.size (), scalar_distances.size ());
+  for (size_t i = 0; i < indices.size (); ++i)
+  {
+    const PointXYZ &pt = cloud_->points[indices[i]];
+    EXPECT_NEAR (fabs (coeff[0] * pt.x + coeff[1] * pt.y + coeff[2] * pt.z + coeff[3]), distances[i], 1e-5);
+    EXPECT_NEAR (scalar_distances[i], distances[i], 1e-5);
+  }
+  EXPECT_EQ (scalar_inliers, inliers);
+  EXPECT_EQ (scalar_nr_inliers, nr_inliers);
+  EXPECT_EQ (static_cast<int> (inliers.size ()), nr_inliers);
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 TEST (SampleConsensusModelNormalPlane, RANSAC)
 {
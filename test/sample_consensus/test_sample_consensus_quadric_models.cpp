@@ -395,6 +395,19 @@ TEST (SampleConsensusModelCylinder, RANSAC)
   model->optimizeModelCoefficients (inliers, coeff, coeff_refined);
   EXPECT_EQ (7, coeff_refined.size ());
   EXPECT_NEAR (0.5, coeff_refined[6], 1e-3);
+
+  // The vectorized distance kernels must agree with the scalar fallback
+  std::vector<double> distances, scalar_distances;
+  model->getDistancesToModel (coeff, distances);
+  const pcl::detail::SacKernelInstructionSet isa = pcl::detail::getSacKernelInstructionSet ();
+  pcl::detail::setSacKernelInstructionSet (pcl::detail::SAC_KERNEL_SCALAR);
+  model->getDistancesToModel (coeff, scalar_distances);
+  EXPECT_EQ (20, model->countWithinDistance (coeff, 0.03));
+  pcl::detail::setSacKernelInstructionSet (isa);
+  ASSERT_EQ (20, distances.size ());
+  ASSERT_EQ (20, scalar_distances.size ());
+  for (size_t i = 0; i < distances.size (); ++i)
+    EXPECT_NEAR (scalar_distances[i], distances[i], 1e-5);
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -209,6 +209,43 @@ TEST (PCL, FlannSearch_multipointKnnSearch)
 }
 
 /* Test for FlannSearch nearestKSearch with multiple query points */
+TEST (PCL, FlannSearch_batchKnnSearch)
+{
+  const int no_of_neighbors = 20;
+
+  pcl::search::FlannSearch<PointXYZ> flann_search (new search::FlannSearch<PointXYZ>::KdTreeIndexCreator);
+  flann_search.setInputCloud (cloud_big.makeShared ());
+  flann_search.setNumberOfThreads (4);
+
+  std::vector< std::vector< float > > dists;
+  std::vector< std::vector< int > > indices;
+  flann_search.nearestKSearch (cloud_big, std::vector<int> (), no_of_neighbors, indices, dists);
+
+  pcl::search::BatchSearchResult result;
+  flann_search.nearestKSearch (cloud_big, std::vector<int> (), no_of_neighbors, result);
+  ASSERT_EQ (result.size (), cloud_big.points.size ());
+
+  for (size_t i = 0; i < cloud_big.points.size (); ++i)
+  {
+    ASSERT_EQ (result.getNumberOfNeighbors (i), no_of_neighbors);
+    for (int j = 0; j < no_of_neighbors; j++)
+    {
+      const size_t k = result.offsets[i] + j;
+      EXPECT_TRUE (result.indices[k] == indices[i][j] || result.sqr_distances[k] == dists[i][j]);
+    }
+  }
+
+  // Asking for more neighbors than points returns every point once
+  std::vector<int> small_indices;
+  for (int i = 0; i < 5; ++i)
+    small_indices.push_back (i);
+  PointCloud<PointXYZ>::Ptr small_cloud (new PointCloud<PointXYZ> (cloud, small_indices));
+  flann_search.setInputCloud (small_cloud);
+  flann_search.nearestKSearch (cloud, std::vector<int> (1, 0), 10, result);
+  ASSERT_EQ (result.size (), size_t (1));
+  EXPECT_EQ (result.getNumberOfNeighbors (0), 5);
+}
+
 TEST (PCL, FlannSearch_knnByIndex)
 {
 
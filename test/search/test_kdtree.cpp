@@ -195,6 +195,49 @@ TEST (PCL, KdTree_multipointKnnSearch)
   }
 }
 
+TEST (PCL, KdTree_batchSearch)
+{
+  const int no_of_neighbors = 20;
+  const double radius = 40.0;
+
+  pcl::search::KdTree<PointXYZ> kdtree;
+  kdtree.setInputCloud (cloud_big.makeShared ());
+  kdtree.setNumberOfThreads (4);
+
+  std::vector<int> query_indices;
+  for (int i = 0; i < static_cast<int> (cloud_big.points.size ()); i += 7)
+    query_indices.push_back (i);
+
+  pcl::search::BatchSearchResult result;
+  kdtree.nearestKSearch (cloud_big, query_indices, no_of_neighbors, result);
+  ASSERT_EQ (result.size (), query_indices.size ());
+  EXPECT_EQ (result.indices.size (), query_indices.size () * no_of_neighbors);
+
+  vector<int> k_indices;
+  vector<float> k_distances;
+  for (size_t i = 0; i < query_indices.size (); ++i)
+  {
+    kdtree.nearestKSearch (cloud_big.points[query_indices[i]], no_of_neighbors, k_indices, k_distances);
+    ASSERT_EQ (result.getNumberOfNeighbors (i), static_cast<int> (k_indices.size ()));
+    for (size_t j = 0; j < k_indices.size (); ++j)
+    {
+      EXPECT_EQ (k_distances[j], result.sqr_distances[result.offsets[i] + j]);
+      EXPECT_TRUE (k_indices[j] == result.indices[result.offsets[i] + j] || k_distances[j] == result.sqr_distances[result.offsets[i] + j]);
+    }
+  }
+
+  kdtree.radiusSearch (cloud_big, query_indices, radius, result);
+  ASSERT_EQ (result.size (), query_indices.size ());
+  for (size_t i = 0; i < query_indices.size (); ++i)
+  {
+    kdtree.radiusSearch (cloud_big.points[query_indices[i]], radius, k_indices, k_distances);
+    ASSERT_EQ (result.getNumberOfNeighbors (i), static_cast<int> (k_indices.size ()));
+    for (size_t j = 0; j < k_indices.size (); ++j)
+      EXPECT_EQ (k_distances[j], result.sqr_distances[result.offsets[i] + j]);
+  }
+  EXPECT_EQ (result.offsets.back (), result.indices.size ());
+}
+
 int
 main (int argc, char** argv)
 {
@@ -362,6 +362,69 @@ TEST (PCL, Octree_Pointcloud_Neighbours_Within_Radius_Search)
   }
 }
 
+TEST (PCL, Octree_Contiguous_Leaves_Batch_Search)
+{
+  const int no_of_neighbors = 10;
+  const double radius = 0.5;
+
+  PointCloud<PointXYZ>::Ptr cloudIn (new PointCloud<PointXYZ> ());
+  cloudIn->width = 3000;
+  cloudIn->height = 1;
+  cloudIn->points.resize (cloudIn->width * cloudIn->height);
+  for (size_t i = 0; i < cloudIn->points.size (); i++)
+  {
+    cloudIn->points[i] = PointXYZ (static_cast<float> (10.0 * (rand () / static_cast<double> (RAND_MAX))),
+                                   static_cast<float> (10.0 * (rand () / static_cast<double> (RAND_MAX))),
+                                   static_cast<float> (5.0 *  (rand () / static_cast<double> (RAND_MAX))));
+  }
+
+  pcl::search::Octree<PointXYZ> octree (0.2);
+  octree.setInputCloud (cloudIn);
+  octree.setContiguousLeaves (true);
+  octree.setNumberOfThreads (4);
+  EXPECT_TRUE (octree.getContiguousLeaves ());
+  EXPECT_TRUE (octree.tree_->hasContiguousLeaves ());
+
+  std::vector<int> query_indices;
+  for (int i = static_cast<int> (cloudIn->points.size ()) - 1; i >= 0; i -= 5)
+    query_indices.push_back (i);
+
+  pcl::search::BatchSearchResult result;
+  vector<int> k_indices;
+  vector<float> k_distances;
+
+  octree.nearestKSearch (*cloudIn, query_indices, no_of_neighbors, result);
+  ASSERT_EQ (result.size (), query_indices.size ());
+  EXPECT_EQ (result.indices.size (), query_indices.size () * no_of_neighbors);
+  for (size_t i = 0; i < query_indices.size (); ++i)
+  {
+    octree.nearestKSearch (cloudIn->points[query_indices[i]], no_of_neighbors, k_indices, k_distances);
+    ASSERT_EQ (result.getNumberOfNeighbors (i), static_cast<int> (k_indices.size ()));
+    for (size_t j = 0; j < k_indices.size (); ++j)
+    {
+      EXPECT_EQ (k_indices[j], result.indices[result.offsets[i] + j]);
+      EXPECT_EQ (k_distances[j], result.sqr_distances[result.offsets[i] + j]);
+    }
+  }
+
+  octree.radiusSearch (*cloudIn, query_indices, radius, result);
+  ASSERT_EQ (result.size (), query_indices.size ());
+  for (size_t i = 0; i < query_indices.size (); ++i)
+  {
+    octree.radiusSearch (cloudIn->points[query_indices[i]], radius, k_indices, k_distances);
+    ASSERT_EQ (result.getNumberOfNeighbors (i), static_cast<int> (k_indices.size ()));
+    for (size_t j = 0; j < k_indices.size (); ++j)
+      EXPECT_EQ (k_distances[j], result.sqr_distances[result.offsets[i] + j]);
+  }
+  EXPECT_EQ (result.offsets.back (), result.indices.size ());
+
+  // the contiguous leaves are rebuilt along with the octree
+  octree.setInputCloud (cloudIn);
+  EXPECT_TRUE (octree.tree_->hasContiguousLeaves ());
+  octree.setContiguousLeaves (false);
+  EXPECT_FALSE (octree.tree_->hasContiguousLeaves ());
+}
+
 /* ---[ */
 int
 main (int argc, char** argv)
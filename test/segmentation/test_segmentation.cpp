@@ -45,6 +45,7 @@
 #include <pcl/search/search.h>
 #include <pcl/features/normal_3d.h>
 
+#include <pcl/segmentation/extract_clusters.h>
 #include <pcl/segmentation/extract_polygonal_prism_data.h>
 #include <pcl/segmentation/segment_differences.h>
 #include <pcl/segmentation/region_growing.h>
@@ -202,6 +203,99 @@ TEST (RegionGrowingTest, SegmentFromPoint)
   EXPECT_NE (0, cluster.indices.size());
 }
 
+////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (RegionGrowingTest, SegmentParallel)
+{
+  pcl::RegionGrowing<pcl::PointXYZ, pcl::Normal> rg;
+  rg.setInputCloud (cloud_);
+  rg.setInputNormals (normals_);
+
+  std::vector <pcl::PointIndices> serial_clusters;
+  rg.extract (serial_clusters);
+
+  std::vector <pcl::PointIndices> clusters;
+  rg.setNumberOfThreads (4);
+  rg.extract (clusters);
+  ASSERT_NE (0, clusters.size ());
+
+  // Every point belongs to exactly one segment
+  std::vector<int> labels (cloud_->points.size (), -1);
+  for (size_t i = 0; i < clusters.size (); ++i)
+    for (size_t j = 0; j < clusters[i].indices.size (); ++j)
+    {
+      EXPECT_EQ (-1, labels[clusters[i].indices[j]]);
+      labels[clusters[i].indices[j]] = static_cast<int> (i);
+    }
+  EXPECT_EQ (labels.end (), std::find (labels.begin (), labels.end (), -1));
+
+  // The segments do not depend on the number of threads
+  for (unsigned int threads = 2; threads <= 3; ++threads)
+  {
+    std::vector <pcl::PointIndices> other_clusters;
+    rg.setNumberOfThreads (threads);
+    rg.extract (other_clusters);
+    ASSERT_EQ (clusters.size (), other_clusters.size ());
+    for (size_t i = 0; i < clusters.size (); ++i)
+      EXPECT_EQ (clusters[i].indices, other_clusters[i].indices);
+  }
+
+  // The first segment grows from the same seed, and the largest one has about the same size
+  EXPECT_EQ (serial_clusters[0].indices[0], clusters[0].indices[0]);
+  size_t serial_largest = 0, largest = 0;
+  for (size_t i = 0; i < serial_clusters.size (); ++i)
+    serial_largest = std::max (serial_largest, serial_clusters[i].indices.size ());
+  for (size_t i = 0; i < clusters.size (); ++i)
+    largest = std::max (largest, clusters[i].indices.size ());
+  EXPECT_NEAR (static_cast<double> (serial_largest), static_cast<double> (largest), 0.1 * serial_largest);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (RegionGrowingTest, SegmentReuseNeighbours)
+{
+  pcl::RegionGrowing<pcl::PointXYZ, pcl::Normal> rg;
+  rg.setInputCloud (cloud_);
+  rg.setInputNormals (normals_);
+  rg.setReuseNeighboursFlag (true);
+  EXPECT_TRUE (rg.getReuseNeighboursFlag ());
+
+  const float thresholds[] = {0.1f, 0.3f, 0.5f};
+  for (int i = 0; i < 3; ++i)
+  {
+    std::vector <pcl::PointIndices> clusters;
+    rg.setSmoothnessThreshold (thresholds[i]);
+    rg.setCurvatureThreshold (thresholds[i]);
+    rg.extract (clusters);
+
+    pcl::RegionGrowing<pcl::PointXYZ, pcl::Normal> reference;
+    reference.setInputCloud (cloud_);
+    reference.setInputNormals (normals_);
+    reference.setSmoothnessThreshold (thresholds[i]);
+    reference.setCurvatureThreshold (thresholds[i]);
+    std::vector <pcl::PointIndices> reference_clusters;
+    reference.extract (reference_clusters);
+
+    ASSERT_EQ (reference_clusters.size (), clusters.size ());
+    for (size_t j = 0; j < clusters.size (); ++j)
+      EXPECT_EQ (reference_clusters[j].indices, clusters[j].indices);
+  }
+
+  // The neighbours are found again for a different number of neighbours or input
+  std::vector <pcl::PointIndices> clusters, reference_clusters;
+  rg.setNumberOfNeighbours (10);
+  rg.extract (clusters);
+  rg.setReuseNeighboursFlag (false);
+  rg.extract (reference_clusters);
+  ASSERT_EQ (reference_clusters.size (), clusters.size ());
+  for (size_t j = 0; j < clusters.size (); ++j)
+    EXPECT_EQ (reference_clusters[j].indices, clusters[j].indices);
+
+  rg.setReuseNeighboursFlag (true);
+  rg.setInputCloud (cloud_t_);
+  rg.extract (clusters);
+  ASSERT_EQ (reference_clusters.size (), clusters.size ());
+  EXPECT_EQ (cloud_t_, rg.getSearchMethod ()->getInputCloud ());
+}
+
 #if (BOOST_VERSION >= 104400)
 ////////////////////////////////////////////////////////////////////////////////////////////////
 TEST (MinCutSegmentationTest, Segment)
@@ -337,6 +431,97 @@ TEST (MinCutSegmentationTest, SegmentWithWrongParameters)
 }
 #endif
 
+//////////////////////////////////////////////////////////////////////////////////////////////
+void
+expectSameClusters (const std::vector<PointIndices> &expected, const std::vector<PointIndices> &clusters)
+{
+  ASSERT_EQ (expected.size (), clusters.size ());
+  for (size_t i = 0; i < expected.size (); ++i)
+    EXPECT_EQ (expected[i].indices, clusters[i].indices);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+TEST (EuclideanClusterExtraction, Segmentation)
+{
+  EuclideanClusterExtraction<PointXYZ> ec;
+  ec.setInputCloud (another_cloud_);
+  ec.setClusterTolerance (0.05);
+  ec.setMinClusterSize (2);
+
+  std::vector<PointIndices> serial, clusters;
+  ec.extract (serial);
+  EXPECT_GT (serial.size (), 1u);
+
+  // The parallel union-find extraction finds the same clusters, in the same order
+  const unsigned int nr_threads[] = { 0, 2, 4 };
+  for (int t = 0; t < 3; ++t)
+  {
+    ec.setNumberOfThreads (nr_threads[t]);
+    clusters.clear ();
+    ec.extract (clusters);
+    expectSameClusters (serial, clusters);
+  }
+
+  // Also on a subset of the points, given in reverse order
+  boost::shared_ptr<std::vector<int> > indices (new std::vector<int>);
+  for (int i = static_cast<int> (another_cloud_->points.size ()) - 1; i >= 0; i -= 3)
+    indices->push_back (i);
+  ec.setIndices (indices);
+  ec.setNumberOfThreads (1);
+  serial.clear ();
+  ec.extract (serial);
+  ec.setNumberOfThreads (4);
+  clusters.clear ();
+  ec.extract (clusters);
+  expectSameClusters (serial, clusters);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+TEST (EuclideanClusterExtraction, VoxelGrid)
+{
+  EuclideanClusterExtraction<PointXYZ> ec;
+  ec.setInputCloud (another_cloud_);
+  EXPECT_FALSE (ec.getUseVoxelGrid ());
+
+  const double tolerances[] = { 0.02, 0.05, 0.2 };
+  for (int t = 0; t < 3; ++t)
+  {
+    ec.setClusterTolerance (tolerances[t]);
+    ec.setUseVoxelGrid (false);
+    ec.setNumberOfThreads (1);
+    std::vector<PointIndices> expected, clusters;
+    ec.extract (expected);
+
+    // The voxel grid finds the same clusters as the radius search
+    ec.setUseVoxelGrid (true);
+    ec.extract (clusters);
+    expectSameClusters (expected, clusters);
+
+    ec.setNumberOfThreads (4);
+    clusters.clear ();
+    ec.extract (clusters);
+    expectSameClusters (expected, clusters);
+  }
+
+  // Cluster size limits and points with invalid coordinates
+  PointCloud<PointXYZ>::Ptr cloud (new PointCloud<PointXYZ> (*another_cloud_));
+  cloud->points[0].x = std::numeric_limits<float>::quiet_NaN ();
+  cloud->is_dense = false;
+  ec.setInputCloud (cloud);
+  ec.setClusterTolerance (0.05);
+  ec.setMinClusterSize (10);
+  ec.setMaxClusterSize (1000);
+  std::vector<PointIndices> clusters;
+  ec.extract (clusters);
+  EXPECT_FALSE (clusters.empty ());
+  for (size_t i = 0; i < clusters.size (); ++i)
+  {
+    EXPECT_GE (clusters[i].indices.size (), 10u);
+    EXPECT_LE (clusters[i].indices.size (), 1000u);
+    EXPECT_NE (clusters[i].indices[0], 0);
+  }
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////
 TEST (SegmentDifferences, Segmentation)
 {
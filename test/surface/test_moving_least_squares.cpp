@@ -173,6 +173,76 @@ TEST (PCL, MovingLeastSquares)
   EXPECT_NEAR (double (mls_normals->size ()), 29394, 2);
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PCL, MovingLeastSquaresThreads)
+{
+  typedef MovingLeastSquares<PointXYZ, PointNormal> MLS;
+  const MLS::UpsamplingMethod methods[] = {MLS::NONE, MLS::SAMPLE_LOCAL_PLANE, MLS::RANDOM_UNIFORM_DENSITY,
+                                           MLS::DISTINCT_CLOUD, MLS::VOXEL_GRID_DILATION};
+
+  // Upsample the input first, so that it spans several blocks of points
+  PointCloud<PointXYZ>::Ptr dense_cloud (new PointCloud<PointXYZ>);
+  MovingLeastSquares<PointXYZ, PointXYZ> upsampling;
+  upsampling.setInputCloud (cloud);
+  upsampling.setSearchMethod (tree);
+  upsampling.setSearchRadius (0.03);
+  upsampling.setUpsamplingMethod (MovingLeastSquares<PointXYZ, PointXYZ>::SAMPLE_LOCAL_PLANE);
+  upsampling.setUpsamplingRadius (0.01);
+  upsampling.setUpsamplingStepSize (0.005);
+  upsampling.process (*dense_cloud);
+  ASSERT_GT (dense_cloud->size (), 4000u);
+
+  // Use every other point as the distinct cloud, shifted a bit
+  PointCloud<PointXYZ>::Ptr distinct_cloud (new PointCloud<PointXYZ>);
+  for (size_t i = 0; i < dense_cloud->size (); i += 2)
+  {
+    PointXYZ p = dense_cloud->points[i];
+    p.x += 0.002f;
+    distinct_cloud->push_back (p);
+  }
+
+  for (int m = 0; m < 5; ++m)
+  {
+    MLS mls;
+    mls.setInputCloud (dense_cloud);
+    mls.setComputeNormals (true);
+    mls.setPolynomialOrder (2);
+    mls.setSearchRadius (0.01);
+    mls.setUpsamplingMethod (methods[m]);
+    mls.setUpsamplingRadius (0.005);
+    mls.setUpsamplingStepSize (0.003);
+    mls.setPointDensity (100);
+    mls.setDistinctCloud (distinct_cloud);
+    mls.setDilationIterations (2);
+    mls.setDilationVoxelSize (0.005f);
+
+    PointCloud<PointNormal> serial, parallel;
+    mls.process (serial);
+    std::vector<int> serial_indices = mls.getCorrespondingIndices ()->indices;
+    ASSERT_GT (serial.size (), 0u);
+    EXPECT_EQ (serial.size (), serial_indices.size ());
+
+    for (unsigned int threads = 2; threads <= 4; threads += 2)
+    {
+      mls.setNumberOfThreads (threads);
+      mls.process (parallel);
+      ASSERT_EQ (serial.size (), parallel.size ());
+      EXPECT_EQ (serial_indices, mls.getCorrespondingIndices ()->indices);
+
+      // The random samples depend on the seed, but not on the number of threads
+      if (methods[m] == MLS::RANDOM_UNIFORM_DENSITY)
+        continue;
+      for (size_t i = 0; i < serial.size (); ++i)
+      {
+        EXPECT_EQ (serial.points[i].x, parallel.points[i].x);
+        EXPECT_EQ (serial.points[i].y, parallel.points[i].y);
+        EXPECT_EQ (serial.points[i].z, parallel.points[i].z);
+        EXPECT_EQ (serial.points[i].curvature, parallel.points[i].curvature);
+      }
+    }
+  }
+}
+
 /* ---[ */
 int
 main (int argc, char** argv)